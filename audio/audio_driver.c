@@ -25,6 +25,7 @@
 #include "../retroarch.h"
 #include "../runloop.h"
 #include "../performance.h"
+#include "../benchmark.h"
 #include "../intl/intl.h"
 
 #ifndef AUDIO_BUFFER_FREE_SAMPLES_COUNT
@@ -598,7 +599,7 @@ ssize_t audio_driver_write(const void *buf, size_t size)
 }
 
 /**
- * audio_driver_flush:
+ * audio_driver_flush_samples:
  * @data                 : pointer to audio buffer.
  * @right                : amount of samples to write.
  *
@@ -608,7 +609,7 @@ ssize_t audio_driver_write(const void *buf, size_t size)
  * Returns: true (1) if audio samples were written to the audio
  * driver, false (0) in case of an error.
  **/
-bool audio_driver_flush(const int16_t *data, size_t samples)
+static bool audio_driver_flush_samples(const int16_t *data, size_t samples)
 {
    const void *output_data        = NULL;
    unsigned output_frames         = 0;
@@ -689,6 +690,26 @@ bool audio_driver_flush(const int16_t *data, size_t samples)
    return true;
 }
 
+/**
+ * audio_driver_flush:
+ * @data                 : pointer to audio buffer.
+ * @right                : amount of samples to write.
+ *
+ * Writes audio samples to audio driver. Will first
+ * perform DSP processing (if enabled) and resampling.
+ *
+ * Returns: true (1) if audio samples were written to the audio
+ * driver, false (0) in case of an error.
+ **/
+bool audio_driver_flush(const int16_t *data, size_t samples)
+{
+   retro_time_t start = benchmark_stage_begin();
+   bool ret           = audio_driver_flush_samples(data, samples);
+
+   benchmark_stage_end(BENCHMARK_STAGE_AUDIO, start);
+   return ret;
+}
+
 /**
  * audio_driver_sample:
  * @left                 : value of the left audio channel.
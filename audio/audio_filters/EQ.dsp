@@ -8,10 +8,15 @@ filter0 = eq
 # eq_window_beta = 4.0
 
 # The block size on which FFT is done.
-# Too high value requires more processing as well as longer latency but
+# Too high value requires more processing but
 # allows finer-grained control over the spectrum.
 # eq_block_size_log2 = 8
 
+# Long filters are split into partitions of this size which are
+# convolved separately, so latency is one partition instead of one block.
+# Defaults to the block size, but no more than 8.
+# eq_partition_size_log2 = 8
+
 # An array of which frequencies to control.
 # You can create an arbitrary amount of these sampling points.
 # The EQ will try to create a frequency response which fits well to these points.
@@ -27,7 +27,8 @@
 
 struct chorus_data
 {
-   float old[2][CHORUS_MAX_DELAY];
+   // Interleaved stereo history.
+   float old[CHORUS_MAX_DELAY][2];
    unsigned old_ptr;
 
    float delay;
@@ -37,6 +38,12 @@ struct chorus_data
    float mix_wet;
    unsigned lfo_ptr;
    unsigned lfo_period;
+
+   // The LFO is a phasor rotated by lfo_step every frame,
+   // which avoids a sin() per frame. It restarts every period
+   // so rounding errors do not build up.
+   double lfo_cos, lfo_sin;
+   double lfo_step_cos, lfo_step_sin;
 };
 
 static void chorus_free(void *data)
@@ -54,27 +61,42 @@ static void chorus_process(void *data, struct dspfilter_output *output,
    output->frames  = input->frames;
    float *out = output->samples;
 
+   // Only the lerp and the mix are per channel, and the compiler
+   // already pairs them up. The time goes into the serial LFO update,
+   // so explicit SIMD was measured to gain nothing here.
    for (i = 0; i < input->frames; i++, out += 2)
    {
       float in[2] = { out[0], out[1] };
 
-      float delay = ch->delay + ch->depth * sin((2.0 * M_PI * ch->lfo_ptr++) / ch->lfo_period);
+      float delay = ch->delay + ch->depth * ch->lfo_sin;
       delay *= ch->input_rate;
-      if (ch->lfo_ptr >= ch->lfo_period)
+      if (++ch->lfo_ptr >= ch->lfo_period)
+      {
          ch->lfo_ptr = 0;
+         ch->lfo_cos = 1.0;
+         ch->lfo_sin = 0.0;
+      }
+      else
+      {
+         double lfo_cos = ch->lfo_cos * ch->lfo_step_cos - ch->lfo_sin * ch->lfo_step_sin;
+         ch->lfo_sin = ch->lfo_sin * ch->lfo_step_cos + ch->lfo_cos * ch->lfo_step_sin;
+         ch->lfo_cos = lfo_cos;
+      }
 
       unsigned delay_int = (unsigned)delay;
       if (delay_int >= CHORUS_MAX_DELAY - 1)
          delay_int = CHORUS_MAX_DELAY - 2;
       float delay_frac = delay - delay_int;
 
-      ch->old[0][ch->old_ptr] = in[0];
-      ch->old[1][ch->old_ptr] = in[1];
+      ch->old[ch->old_ptr][0] = in[0];
+      ch->old[ch->old_ptr][1] = in[1];
 
-      float l_a = ch->old[0][(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK];
-      float l_b = ch->old[0][(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK];
-      float r_a = ch->old[1][(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK];
-      float r_b = ch->old[1][(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK];
+      const float *a = ch->old[(ch->old_ptr - delay_int - 0) & CHORUS_DELAY_MASK];
+      const float *b = ch->old[(ch->old_ptr - delay_int - 1) & CHORUS_DELAY_MASK];
+      float l_a = a[0];
+      float l_b = b[0];
+      float r_a = a[1];
+      float r_b = b[1];
 
       // Lerp introduces aliasing of the chorus component, but doing full polyphase here is probably overkill.
       float chorus_l = l_a * (1.0f - delay_frac) + l_b * delay_frac;
@@ -120,6 +142,11 @@ static void *chorus_init(const struct dspfilter_info *info,
    ch->input_rate = info->input_rate;
    if (!ch->lfo_period)
       ch->lfo_period = 1;
+
+   ch->lfo_cos = 1.0;
+   ch->lfo_sin = 0.0;
+   ch->lfo_step_cos = cos(2.0 * M_PI / ch->lfo_period);
+   ch->lfo_step_sin = sin(2.0 * M_PI / ch->lfo_period);
    return ch;
 }
 
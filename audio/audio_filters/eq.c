@@ -27,19 +27,30 @@
 
 #ifndef min
 #define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
 #endif
 
+// Uniformly partitioned overlap-save convolution.
+// The filter is split into partitions of block_size taps, so
+// latency is one block no matter how long the filter is.
 struct eq_data
 {
    fft_t *fft;
    float buffer[8 * 1024];
 
-   float *save;
-   float *block;
-   fft_complex_t *filter;
+   // Previous and current block, stereo frames with the left
+   // channel in the real part and the right in the imaginary part.
+   fft_complex_t *block;
+   fft_complex_t *accum;
    fft_complex_t *fftblock;
+   // Spectra of the last num_partitions input blocks.
+   fft_complex_t *spectra;
+   // Filter spectrum of each partition, see fft_prepare_multiplier().
+   float *filter;
    unsigned block_size;
    unsigned block_ptr;
+   unsigned num_partitions;
+   unsigned spectrum_ptr;
 };
 
 struct eq_gain
@@ -55,9 +66,10 @@ static void eq_free(void *data)
       return;
 
    fft_free(eq->fft);
-   free(eq->save);
    free(eq->block);
+   free(eq->accum);
    free(eq->fftblock);
+   free(eq->spectra);
    free(eq->filter);
    free(eq);
 }
@@ -80,7 +92,8 @@ static void eq_process(void *data, struct dspfilter_output *output,
       if (input_frames < write_avail)
          write_avail = input_frames;
 
-      memcpy(eq->block + eq->block_ptr * 2, in, write_avail * 2 * sizeof(float));
+      memcpy(eq->block + eq->block_size + eq->block_ptr, in,
+            write_avail * 2 * sizeof(float));
 
       in += write_avail * 2;
       input_frames -= write_avail;
@@ -89,22 +102,31 @@ static void eq_process(void *data, struct dspfilter_output *output,
       // Convolve a new block.
       if (eq->block_ptr == eq->block_size)
       {
-         unsigned i, c;
+         unsigned p;
+         unsigned size = 2 * eq->block_size;
+         fft_complex_t *spectrum = eq->spectra + eq->spectrum_ptr * size;
 
-         for (c = 0; c < 2; c++)
+         // The filter is real, so a single complex FFT
+         // filters both channels at once.
+         fft_process_forward_complex(eq->fft, spectrum, eq->block, 1);
+
+         memset(eq->accum, 0, size * sizeof(*eq->accum));
+         for (p = 0; p < eq->num_partitions; p++)
          {
-            fft_process_forward(eq->fft, eq->fftblock, eq->block + c, 2);
-            for (i = 0; i < 2 * eq->block_size; i++)
-               eq->fftblock[i] = fft_complex_mul(eq->fftblock[i], eq->filter[i]);
-            fft_process_inverse(eq->fft, out + c, eq->fftblock, 2);
+            unsigned index = (eq->spectrum_ptr + eq->num_partitions - p)
+               % eq->num_partitions;
+            fft_complex_mac(eq->accum, eq->spectra + index * size,
+                  eq->filter + p * FFT_MULTIPLIER_SIZE(size), size);
          }
 
-         // Overlap add method, so add in saved block now.
-         for (i = 0; i < 2 * eq->block_size; i++)
-            out[i] += eq->save[i];
+         fft_process_inverse_complex(eq->fft, eq->fftblock, eq->accum, 1);
 
-         // Save block for later.
-         memcpy(eq->save, out + 2 * eq->block_size, 2 * eq->block_size * sizeof(float));
+         // Overlap save method, the first half wrapped around.
+         memcpy(out, eq->fftblock + eq->block_size,
+               eq->block_size * 2 * sizeof(float));
+         memcpy(eq->block, eq->block + eq->block_size,
+               eq->block_size * sizeof(*eq->block));
+         eq->spectrum_ptr = (eq->spectrum_ptr + 1) % eq->num_partitions;
 
          out += eq->block_size * 2;
          output->frames += eq->block_size;
@@ -217,42 +239,48 @@ static INLINE double kaiser_window(double index, double beta)
    return kaiser_besseli0(beta * sqrt(1 - index * index));
 }
 
-static void create_filter(struct eq_data *eq, unsigned size_log2,
+static int create_filter(struct eq_data *eq, unsigned size_log2,
       struct eq_gain *gains, unsigned num_gains, double beta, const char *filter_path)
 {
    int i;
-   int half_block_size = eq->block_size >> 1;
+   unsigned p;
+   int ret = 0;
+   int filter_size = 1 << size_log2;
+   int half_filter_size = filter_size >> 1;
+   unsigned partition_size = 2 * eq->block_size;
    double window_mod = 1.0 / kaiser_window(0.0, beta);
 
    fft_t *fft = fft_new(size_log2);
-   float *time_filter = (float*)calloc(eq->block_size * 2 + 1, sizeof(*time_filter));
-   if (!fft || !time_filter)
+   float *time_filter = (float*)calloc(filter_size + 1, sizeof(*time_filter));
+   float *partition = (float*)calloc(partition_size, sizeof(*partition));
+   fft_complex_t *response = (fft_complex_t*)calloc(filter_size + 1, sizeof(*response));
+   if (!fft || !time_filter || !partition || !response)
       goto end;
 
    // Make sure bands are in correct order.
    qsort(gains, num_gains, sizeof(*gains), gains_cmp);
 
    // Compute desired filter response.
-   generate_response(eq->filter, gains, num_gains, half_block_size);
+   generate_response(response, gains, num_gains, half_filter_size);
 
    // Get equivalent time-domain filter.
-   fft_process_inverse(fft, time_filter, eq->filter, 1);
+   fft_process_inverse(fft, time_filter, response, 1);
 
    // ifftshift() to create the correct linear phase filter.
    // The filter response was designed with zero phase, which won't work unless we compensate
    // for the repeating property of the FFT here by flipping left and right blocks.
-   for (i = 0; i < half_block_size; i++)
+   for (i = 0; i < half_filter_size; i++)
    {
-      float tmp = time_filter[i + half_block_size];
-      time_filter[i + half_block_size] = time_filter[i];
+      float tmp = time_filter[i + half_filter_size];
+      time_filter[i + half_filter_size] = time_filter[i];
       time_filter[i] = tmp;
    }
 
    // Apply a window to smooth out the frequency repsonse.
-   for (i = 0; i < (int)eq->block_size; i++)
+   for (i = 0; i < filter_size; i++)
    {
       // Kaiser window.
-      double phase = (double)i / eq->block_size;
+      double phase = (double)i / filter_size;
       phase = 2.0 * (phase - 0.5);
       time_filter[i] *= window_mod * kaiser_window(phase, beta);
    }
@@ -263,20 +291,34 @@ static void create_filter(struct eq_data *eq, unsigned size_log2,
       FILE *file = fopen(filter_path, "w");
       if (file)
       {
-         for (i = 0; i < (int)eq->block_size - 1; i++)
+         for (i = 0; i < filter_size - 1; i++)
             fprintf(file, "%.8f\n", time_filter[i + 1]);
          fclose(file);
       }
    }
 
-   // Padded FFT to create our FFT filter.
+   // Padded FFT of each partition to create our FFT filters.
    // Make our even-length filter odd by discarding the first coefficient.
    // For some interesting reason, this allows us to design an odd-length linear phase filter.
-   fft_process_forward(eq->fft, eq->filter, time_filter + 1, 1);
+   for (p = 0; p < eq->num_partitions; p++)
+   {
+      memset(partition, 0, partition_size * sizeof(*partition));
+      memcpy(partition, time_filter + 1 + p * eq->block_size,
+            eq->block_size * sizeof(*partition));
+
+      fft_process_forward(eq->fft, eq->fftblock, partition, 1);
+      fft_prepare_multiplier(eq->filter + p * FFT_MULTIPLIER_SIZE(partition_size),
+            eq->fftblock, partition_size);
+   }
+
+   ret = 1;
 
 end:
    fft_free(fft);
    free(time_filter);
+   free(partition);
+   free(response);
+   return ret;
 }
 
 static void *eq_init(const struct dspfilter_info *info,
@@ -295,7 +337,13 @@ static void *eq_init(const struct dspfilter_info *info,
 
    int size_log2;
    config->get_int(userdata, "block_size_log2", &size_log2, 8);
-   unsigned size = 1 << size_log2;
+
+   // Filters longer than a partition are split up,
+   // latency is one partition.
+   int partition_log2;
+   config->get_int(userdata, "partition_size_log2", &partition_log2, min(size_log2, 8));
+   partition_log2 = max(min(partition_log2, size_log2), min(size_log2, 4));
+   unsigned size = 1 << partition_log2;
 
    struct eq_gain *gains = NULL;
    float *frequencies, *gain;
@@ -325,20 +373,23 @@ static void *eq_init(const struct dspfilter_info *info,
    config->free(gain);
 
    eq->block_size = size;
+   eq->num_partitions = 1 << (size_log2 - partition_log2);
 
-   eq->save     = (float*)calloc(    size, 2 * sizeof(*eq->save));
-   eq->block    = (float*)calloc(2 * size, 2 * sizeof(*eq->block));
+   eq->block    = (fft_complex_t*)calloc(2 * size, sizeof(*eq->block));
+   eq->accum    = (fft_complex_t*)calloc(2 * size, sizeof(*eq->accum));
    eq->fftblock = (fft_complex_t*)calloc(2 * size, sizeof(*eq->fftblock));
-   eq->filter   = (fft_complex_t*)calloc(2 * size, sizeof(*eq->filter));
+   eq->spectra  = (fft_complex_t*)calloc(eq->num_partitions * 2 * size, sizeof(*eq->spectra));
+   eq->filter   = (float*)calloc(eq->num_partitions, FFT_MULTIPLIER_SIZE(2 * size) * sizeof(*eq->filter));
 
    // Use an FFT which is twice the block size with zero-padding
    // to make circular convolution => proper convolution.
-   eq->fft = fft_new(size_log2 + 1);
+   eq->fft = fft_new(partition_log2 + 1);
 
-   if (!eq->fft || !eq->fftblock || !eq->save || !eq->block || !eq->filter)
+   if (!eq->fft || !eq->block || !eq->accum || !eq->fftblock || !eq->spectra || !eq->filter)
       goto error;
 
-   create_filter(eq, size_log2, gains, num_gain, beta, filter_path);
+   if (!create_filter(eq, size_log2, gains, num_gain, beta, filter_path))
+      goto error;
    config->free(filter_path);
    filter_path = NULL;
 
@@ -346,6 +397,7 @@ static void *eq_init(const struct dspfilter_info *info,
    return eq;
 
 error:
+   config->free(filter_path);
    free(gains);
    eq_free(eq);
    return NULL;
@@ -17,6 +17,12 @@
 #include <math.h>
 #include <stdlib.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #ifndef M_PI
 #define M_PI 3.1415926535897932384626433832795
 #endif
@@ -24,9 +30,12 @@
 struct fft
 {
    fft_complex_t *interleave_buffer;
-   fft_complex_t *phase_lut;
+   // Twiddle factors of all radix-4 passes, in the
+   // fft_prepare_multiplier() layout.
+   float *twiddles;
    unsigned *bitinverse_buffer;
    unsigned size;
+   unsigned size_log2;
 };
 
 static unsigned bitswap(unsigned x, unsigned size_log2)
@@ -52,12 +61,48 @@ static fft_complex_t exp_imag(double phase)
    return out;
 }
 
-static void build_phase_lut(fft_complex_t *out, int size)
+// Two consecutive multipliers are stored as
+// { re0, re0, re1, re1, -im0, im0, -im1, im1 },
+// which turns a complex multiply into two real
+// multiplies and an add on interleaved data.
+static void store_multiplier(float *out, fft_complex_t a, fft_complex_t b)
+{
+   out[0] =  a.real;
+   out[1] =  a.real;
+   out[2] =  b.real;
+   out[3] =  b.real;
+   out[4] = -a.imag;
+   out[5] =  a.imag;
+   out[6] = -b.imag;
+   out[7] =  b.imag;
+}
+
+// Each radix-4 pass merges two radix-2 stages. A pass with
+// quarter size m needs W(2m)^j and W(4m)^j for j < m.
+// The first pass is either a plain radix-2 stage (odd log2)
+// or a radix-4 pass without twiddles (m = 1).
+static unsigned first_quarter_size(unsigned size_log2)
 {
-   int i;
-   out += size;
-   for (i = -size; i <= size; i++)
-      out[i] = exp_imag((M_PI * i) / size);
+   return (size_log2 & 1) ? 2 : 4;
+}
+
+static void build_twiddles(float *out, unsigned size_log2)
+{
+   unsigned m, j;
+   unsigned size = 1 << size_log2;
+
+   for (m = first_quarter_size(size_log2); 4 * m <= size; m <<= 2)
+   {
+      for (j = 0; j < m; j += 2, out += 16)
+      {
+         store_multiplier(out,
+               exp_imag(-M_PI * j / m),
+               exp_imag(-M_PI * (j + 1) / m));
+         store_multiplier(out + 8,
+               exp_imag(-M_PI * j / (2 * m)),
+               exp_imag(-M_PI * (j + 1) / (2 * m)));
+      }
+   }
 }
 
 static void interleave_complex(const unsigned *bitinverse,
@@ -69,6 +114,15 @@ static void interleave_complex(const unsigned *bitinverse,
       out[bitinverse[i]] = *in;
 }
 
+static void interleave_complex_conj(const unsigned *bitinverse,
+      fft_complex_t *out, const fft_complex_t *in,
+      unsigned samples, unsigned step)
+{
+   unsigned i;
+   for (i = 0; i < samples; i++, in += step)
+      out[bitinverse[i]] = fft_complex_conj(*in);
+}
+
 static void interleave_float(const unsigned *bitinverse,
       fft_complex_t *out, const float *in,
       unsigned samples, unsigned step)
@@ -100,15 +154,17 @@ fft_t *fft_new(unsigned block_size_log2)
 
    fft->interleave_buffer = (fft_complex_t*)calloc(size, sizeof(*fft->interleave_buffer));
    fft->bitinverse_buffer = (unsigned*)calloc(size, sizeof(*fft->bitinverse_buffer));
-   fft->phase_lut         = (fft_complex_t*)calloc(2 * size + 1, sizeof(*fft->phase_lut));
+   // Passes use 8m floats each, m <= size / 4.
+   fft->twiddles          = (float*)calloc(3 * size, sizeof(*fft->twiddles));
 
-   if (!fft->interleave_buffer || !fft->bitinverse_buffer || !fft->phase_lut)
+   if (!fft->interleave_buffer || !fft->bitinverse_buffer || !fft->twiddles)
       goto error;
 
-   fft->size = size;
+   fft->size      = size;
+   fft->size_log2 = block_size_log2;
 
    build_bitinverse(fft->bitinverse_buffer, block_size_log2);
-   build_phase_lut(fft->phase_lut, size);
+   build_twiddles(fft->twiddles, block_size_log2);
    return fft;
 
 error:
@@ -123,74 +179,243 @@ void fft_free(fft_t *fft)
 
    free(fft->interleave_buffer);
    free(fft->bitinverse_buffer);
-   free(fft->phase_lut);
+   free(fft->twiddles);
    free(fft);
 }
 
-static void butterfly(fft_complex_t *a, fft_complex_t *b, fft_complex_t mod)
+// Multiplies by -i.
+static INLINE fft_complex_t fft_complex_rot(fft_complex_t a)
 {
-   mod = fft_complex_mul(mod, *b);
-   *b = fft_complex_sub(*a, mod);
-   *a = fft_complex_add(*a, mod);
+   fft_complex_t out = {
+      a.imag, -a.real,
+   };
+
+   return out;
 }
 
-static void butterflies(fft_complex_t *butterfly_buf,
-      const fft_complex_t *phase_lut,
-      int phase_dir, unsigned step_size, unsigned samples)
+#if defined(__SSE__)
+static INLINE __m128 fft_cmul_sse(__m128 x, const float *mul)
 {
-   unsigned i, j;
-   for (i = 0; i < samples; i += step_size << 1)
+   __m128 swapped = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+   return _mm_add_ps(_mm_mul_ps(x, _mm_loadu_ps(mul)),
+         _mm_mul_ps(swapped, _mm_loadu_ps(mul + 4)));
+}
+
+static INLINE __m128 fft_rot_sse(__m128 x)
+{
+   const __m128 sign = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+   return _mm_xor_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)), sign);
+}
+#elif defined(__ARM_NEON__)
+static INLINE float32x4_t fft_cmul_neon(float32x4_t x, const float *mul)
+{
+   return vmlaq_f32(vmulq_f32(x, vld1q_f32(mul)),
+         vrev64q_f32(x), vld1q_f32(mul + 4));
+}
+
+static INLINE float32x4_t fft_rot_neon(float32x4_t x)
+{
+   static const float sign[4] = { 1.0f, -1.0f, 1.0f, -1.0f };
+   return vmulq_f32(vrev64q_f32(x), vld1q_f32(sign));
+}
+#else
+static INLINE fft_complex_t fft_cmul_prepared(fft_complex_t x,
+      const float *mul, unsigned i)
+{
+   fft_complex_t out = {
+      x.real * mul[2 * i] + x.imag * mul[4 + 2 * i],
+      x.imag * mul[2 * i + 1] + x.real * mul[5 + 2 * i],
+   };
+
+   return out;
+}
+#endif
+
+static void radix2_pass(fft_complex_t *x, unsigned samples)
+{
+   unsigned i;
+   for (i = 0; i < samples; i += 2)
    {
-      int phase_step = (int)samples * phase_dir / (int)step_size;
-      for (j = i; j < i + step_size; j++)
-         butterfly(&butterfly_buf[j], &butterfly_buf[j + step_size], phase_lut[phase_step * (int)(j - i)]);
+      fft_complex_t a = x[i];
+      x[i]     = fft_complex_add(a, x[i + 1]);
+      x[i + 1] = fft_complex_sub(a, x[i + 1]);
    }
 }
 
-void fft_process_forward_complex(fft_t *fft,
-      fft_complex_t *out, const fft_complex_t *in, unsigned step)
+// Quarter size 1, every twiddle is 1.
+static void radix4_first_pass(fft_complex_t *x, unsigned samples)
 {
-   unsigned step_size;
-   unsigned samples = fft->size;
-   interleave_complex(fft->bitinverse_buffer, out, in, samples, step);
+   unsigned i;
+   for (i = 0; i < samples; i += 4)
+   {
+      fft_complex_t a = fft_complex_add(x[i], x[i + 1]);
+      fft_complex_t b = fft_complex_sub(x[i], x[i + 1]);
+      fft_complex_t c = fft_complex_add(x[i + 2], x[i + 3]);
+      fft_complex_t d = fft_complex_rot(fft_complex_sub(x[i + 2], x[i + 3]));
+
+      x[i]     = fft_complex_add(a, c);
+      x[i + 2] = fft_complex_sub(a, c);
+      x[i + 1] = fft_complex_add(b, d);
+      x[i + 3] = fft_complex_sub(b, d);
+   }
+}
 
-   for (step_size = 1; step_size < samples; step_size <<= 1)
+// Butterflies two adjacent columns j, j + 1 at once.
+static void radix4_pass(fft_complex_t *x, const float *twiddles,
+      unsigned m, unsigned samples)
+{
+   unsigned i, j;
+   for (i = 0; i < samples; i += 4 * m)
    {
-      butterflies(out,
-            fft->phase_lut + samples,
-            -1, step_size, samples);
+      float *p0 = (float*)(x + i);
+      float *p1 = (float*)(x + i + m);
+      float *p2 = (float*)(x + i + 2 * m);
+      float *p3 = (float*)(x + i + 3 * m);
+      const float *t = twiddles;
+
+      for (j = 0; j < 2 * m; j += 4, t += 16)
+      {
+#if defined(__SSE__)
+         __m128 a  = _mm_loadu_ps(p0 + j);
+         __m128 b  = fft_cmul_sse(_mm_loadu_ps(p1 + j), t);
+         __m128 c  = _mm_loadu_ps(p2 + j);
+         __m128 d  = fft_cmul_sse(_mm_loadu_ps(p3 + j), t);
+         __m128 a1 = _mm_add_ps(a, b);
+         __m128 b1 = _mm_sub_ps(a, b);
+         __m128 c1 = fft_cmul_sse(_mm_add_ps(c, d), t + 8);
+         __m128 d1 = fft_rot_sse(fft_cmul_sse(_mm_sub_ps(c, d), t + 8));
+
+         _mm_storeu_ps(p0 + j, _mm_add_ps(a1, c1));
+         _mm_storeu_ps(p2 + j, _mm_sub_ps(a1, c1));
+         _mm_storeu_ps(p1 + j, _mm_add_ps(b1, d1));
+         _mm_storeu_ps(p3 + j, _mm_sub_ps(b1, d1));
+#elif defined(__ARM_NEON__)
+         float32x4_t a  = vld1q_f32(p0 + j);
+         float32x4_t b  = fft_cmul_neon(vld1q_f32(p1 + j), t);
+         float32x4_t c  = vld1q_f32(p2 + j);
+         float32x4_t d  = fft_cmul_neon(vld1q_f32(p3 + j), t);
+         float32x4_t a1 = vaddq_f32(a, b);
+         float32x4_t b1 = vsubq_f32(a, b);
+         float32x4_t c1 = fft_cmul_neon(vaddq_f32(c, d), t + 8);
+         float32x4_t d1 = fft_rot_neon(fft_cmul_neon(vsubq_f32(c, d), t + 8));
+
+         vst1q_f32(p0 + j, vaddq_f32(a1, c1));
+         vst1q_f32(p2 + j, vsubq_f32(a1, c1));
+         vst1q_f32(p1 + j, vaddq_f32(b1, d1));
+         vst1q_f32(p3 + j, vsubq_f32(b1, d1));
+#else
+         unsigned k;
+         for (k = 0; k < 2; k++)
+         {
+            fft_complex_t *q0 = (fft_complex_t*)(p0 + j) + k;
+            fft_complex_t *q1 = (fft_complex_t*)(p1 + j) + k;
+            fft_complex_t *q2 = (fft_complex_t*)(p2 + j) + k;
+            fft_complex_t *q3 = (fft_complex_t*)(p3 + j) + k;
+            fft_complex_t b   = fft_cmul_prepared(*q1, t, k);
+            fft_complex_t d   = fft_cmul_prepared(*q3, t, k);
+            fft_complex_t a1  = fft_complex_add(*q0, b);
+            fft_complex_t b1  = fft_complex_sub(*q0, b);
+            fft_complex_t c1  = fft_cmul_prepared(
+                  fft_complex_add(*q2, d), t + 8, k);
+            fft_complex_t d1  = fft_complex_rot(fft_cmul_prepared(
+                  fft_complex_sub(*q2, d), t + 8, k));
+
+            *q0 = fft_complex_add(a1, c1);
+            *q2 = fft_complex_sub(a1, c1);
+            *q1 = fft_complex_add(b1, d1);
+            *q3 = fft_complex_sub(b1, d1);
+         }
+#endif
+      }
    }
 }
 
-void fft_process_forward(fft_t *fft,
-      fft_complex_t *out, const float *in, unsigned step)
+// Forward transform of bit-reversed data in place.
+static void fft_passes(fft_t *fft, fft_complex_t *x)
 {
-   unsigned step_size;
-   unsigned samples = fft->size;
-   interleave_float(fft->bitinverse_buffer, out, in, samples, step);
+   unsigned m;
+   unsigned samples      = fft->size;
+   const float *twiddles = fft->twiddles;
 
-   for (step_size = 1; step_size < fft->size; step_size <<= 1)
+   if (fft->size_log2 & 1)
+      radix2_pass(x, samples);
+   else if (samples >= 4)
+      radix4_first_pass(x, samples);
+
+   for (m = first_quarter_size(fft->size_log2); 4 * m <= samples; m <<= 2)
    {
-      butterflies(out,
-            fft->phase_lut + samples,
-            -1, step_size, samples);
+      radix4_pass(x, twiddles, m, samples);
+      twiddles += 8 * m;
    }
 }
 
+void fft_process_forward_complex(fft_t *fft,
+      fft_complex_t *out, const fft_complex_t *in, unsigned step)
+{
+   interleave_complex(fft->bitinverse_buffer, out, in, fft->size, step);
+   fft_passes(fft, out);
+}
+
+void fft_process_forward(fft_t *fft,
+      fft_complex_t *out, const float *in, unsigned step)
+{
+   interleave_float(fft->bitinverse_buffer, out, in, fft->size, step);
+   fft_passes(fft, out);
+}
+
+// The inverse transform is conj(FFT(conj(x))) / N.
 void fft_process_inverse(fft_t *fft,
       float *out, const fft_complex_t *in, unsigned step)
 {
-   unsigned step_size;
    unsigned samples = fft->size;
-   interleave_complex(fft->bitinverse_buffer, fft->interleave_buffer, in, samples, 1);
+   interleave_complex_conj(fft->bitinverse_buffer,
+         fft->interleave_buffer, in, samples, 1);
+   fft_passes(fft, fft->interleave_buffer);
+   resolve_float(out, fft->interleave_buffer, samples, 1.0f / samples, step);
+}
+
+void fft_process_inverse_complex(fft_t *fft,
+      fft_complex_t *out, const fft_complex_t *in, unsigned step)
+{
+   unsigned i;
+   unsigned samples = fft->size;
+   float gain       = 1.0f / samples;
+
+   interleave_complex_conj(fft->bitinverse_buffer, out, in, samples, step);
+   fft_passes(fft, out);
 
-   for (step_size = 1; step_size < samples; step_size <<= 1)
+   for (i = 0; i < samples; i++)
    {
-      butterflies(fft->interleave_buffer,
-            fft->phase_lut + samples,
-            1, step_size, samples);
+      out[i].real *=  gain;
+      out[i].imag *= -gain;
    }
+}
 
-   resolve_float(out, fft->interleave_buffer, samples, 1.0f / samples, step);
+void fft_prepare_multiplier(float *out, const fft_complex_t *in,
+      unsigned samples)
+{
+   unsigned i;
+   for (i = 0; i < samples; i += 2, out += 8)
+      store_multiplier(out, in[i], in[i + 1]);
 }
 
+void fft_complex_mac(fft_complex_t *out, const fft_complex_t *a,
+      const float *b, unsigned samples)
+{
+   unsigned i;
+   for (i = 0; i < samples; i += 2, b += 8)
+   {
+#if defined(__SSE__)
+      _mm_storeu_ps((float*)(out + i),
+            _mm_add_ps(_mm_loadu_ps((const float*)(out + i)),
+               fft_cmul_sse(_mm_loadu_ps((const float*)(a + i)), b)));
+#elif defined(__ARM_NEON__)
+      vst1q_f32((float*)(out + i),
+            vaddq_f32(vld1q_f32((const float*)(out + i)),
+               fft_cmul_neon(vld1q_f32((const float*)(a + i)), b)));
+#else
+      out[i]     = fft_complex_add(out[i], fft_cmul_prepared(a[i], b, 0));
+      out[i + 1] = fft_complex_add(out[i + 1], fft_cmul_prepared(a[i + 1], b, 1));
+#endif
+   }
+}
@@ -85,6 +85,21 @@ void fft_process_forward(fft_t *fft,
 void fft_process_inverse(fft_t *fft,
       float *out, const fft_complex_t *in, unsigned step);
 
+void fft_process_inverse_complex(fft_t *fft,
+      fft_complex_t *out, const fft_complex_t *in, unsigned step);
+
+// Size in floats of a multiplier prepared for fft_complex_mac().
+#define FFT_MULTIPLIER_SIZE(samples) (4 * (samples))
+
+// Rearranges @in so fft_complex_mac() can multiply with it
+// using SIMD. @samples must be even.
+void fft_prepare_multiplier(float *out, const fft_complex_t *in,
+      unsigned samples);
+
+// out[i] += a[i] * b[i], where @b comes from fft_prepare_multiplier().
+void fft_complex_mac(fft_complex_t *out, const fft_complex_t *a,
+      const float *b, unsigned samples);
+
 
 #endif
 
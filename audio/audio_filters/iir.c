@@ -19,6 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #ifndef M_PI
 #define M_PI		3.1415926535897932384626433832795
 #endif
@@ -43,14 +49,14 @@ enum IIRFilter
 
 struct iir_data
 {
+   // Normalized so that a0 is 1.
    float b0, b1, b2;
-   float a0, a1, a2;
+   float a1, a2;
 
-   struct
-   {
-      float xn1, xn2;
-      float yn1, yn2;
-   } l, r;
+   // Filter history, interleaved like the samples so that
+   // both channels can be processed as one vector.
+   float xn1[2], xn2[2];
+   float yn1[2], yn2[2];
 };
 
 static void iir_free(void *data)
@@ -69,30 +75,96 @@ static void iir_process(void *data, struct dspfilter_output *output,
 
    float *out = output->samples;
 
+   // Both channels share the coefficients, so each frame is a single
+   // two lane biquad. The recurrence still runs one frame at a time.
+#if defined(__SSE__)
+   __m128 b0  = _mm_set1_ps(iir->b0);
+   __m128 b1  = _mm_set1_ps(iir->b1);
+   __m128 b2  = _mm_set1_ps(iir->b2);
+   __m128 a1  = _mm_set1_ps(iir->a1);
+   __m128 a2  = _mm_set1_ps(iir->a2);
+
+   __m128 xn1 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)iir->xn1);
+   __m128 xn2 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)iir->xn2);
+   __m128 yn1 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)iir->yn1);
+   __m128 yn2 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)iir->yn2);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      __m128 in  = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+      __m128 res = _mm_add_ps(_mm_mul_ps(b0, in), _mm_mul_ps(b1, xn1));
+      res        = _mm_add_ps(res, _mm_mul_ps(b2, xn2));
+      res        = _mm_sub_ps(res, _mm_mul_ps(a1, yn1));
+      res        = _mm_sub_ps(res, _mm_mul_ps(a2, yn2));
+
+      xn2 = xn1;
+      xn1 = in;
+      yn2 = yn1;
+      yn1 = res;
+
+      _mm_storel_pi((__m64*)out, res);
+   }
+
+   _mm_storel_pi((__m64*)iir->xn1, xn1);
+   _mm_storel_pi((__m64*)iir->xn2, xn2);
+   _mm_storel_pi((__m64*)iir->yn1, yn1);
+   _mm_storel_pi((__m64*)iir->yn2, yn2);
+#elif defined(__ARM_NEON__)
+   float32x2_t b0  = vdup_n_f32(iir->b0);
+   float32x2_t b1  = vdup_n_f32(iir->b1);
+   float32x2_t b2  = vdup_n_f32(iir->b2);
+   float32x2_t a1  = vdup_n_f32(iir->a1);
+   float32x2_t a2  = vdup_n_f32(iir->a2);
+
+   float32x2_t xn1 = vld1_f32(iir->xn1);
+   float32x2_t xn2 = vld1_f32(iir->xn2);
+   float32x2_t yn1 = vld1_f32(iir->yn1);
+   float32x2_t yn2 = vld1_f32(iir->yn2);
+
+   for (i = 0; i < input->frames; i++, out += 2)
+   {
+      float32x2_t in  = vld1_f32(out);
+      float32x2_t res = vadd_f32(vmul_f32(b0, in), vmul_f32(b1, xn1));
+      res             = vadd_f32(res, vmul_f32(b2, xn2));
+      res             = vsub_f32(res, vmul_f32(a1, yn1));
+      res             = vsub_f32(res, vmul_f32(a2, yn2));
+
+      xn2 = xn1;
+      xn1 = in;
+      yn2 = yn1;
+      yn1 = res;
+
+      vst1_f32(out, res);
+   }
+
+   vst1_f32(iir->xn1, xn1);
+   vst1_f32(iir->xn2, xn2);
+   vst1_f32(iir->yn1, yn1);
+   vst1_f32(iir->yn2, yn2);
+#else
    float b0 = iir->b0;
    float b1 = iir->b1;
    float b2 = iir->b2;
-   float a0 = iir->a0;
    float a1 = iir->a1;
    float a2 = iir->a2;
 
-   float xn1_l = iir->l.xn1;
-   float xn2_l = iir->l.xn2;
-   float yn1_l = iir->l.yn1;
-   float yn2_l = iir->l.yn2;
+   float xn1_l = iir->xn1[0];
+   float xn2_l = iir->xn2[0];
+   float yn1_l = iir->yn1[0];
+   float yn2_l = iir->yn2[0];
 
-   float xn1_r = iir->r.xn1;
-   float xn2_r = iir->r.xn2;
-   float yn1_r = iir->r.yn1;
-   float yn2_r = iir->r.yn2;
+   float xn1_r = iir->xn1[1];
+   float xn2_r = iir->xn2[1];
+   float yn1_r = iir->yn1[1];
+   float yn2_r = iir->yn2[1];
 
    for (i = 0; i < input->frames; i++, out += 2)
    {
       float in_l = out[0];
       float in_r = out[1];
 
-      float l    = (b0 * in_l + b1 * xn1_l + b2 * xn2_l - a1 * yn1_l - a2 * yn2_l) / a0;
-      float r    = (b0 * in_r + b1 * xn1_r + b2 * xn2_r - a1 * yn1_r - a2 * yn2_r) / a0;
+      float l    = b0 * in_l + b1 * xn1_l + b2 * xn2_l - a1 * yn1_l - a2 * yn2_l;
+      float r    = b0 * in_r + b1 * xn1_r + b2 * xn2_r - a1 * yn1_r - a2 * yn2_r;
 
       xn2_l = xn1_l;
       xn1_l = in_l;
@@ -108,15 +180,16 @@ static void iir_process(void *data, struct dspfilter_output *output,
       out[1] = r;
    }
 
-   iir->l.xn1 = xn1_l;
-   iir->l.xn2 = xn2_l;
-   iir->l.yn1 = yn1_l;
-   iir->l.yn2 = yn2_l;
+   iir->xn1[0] = xn1_l;
+   iir->xn2[0] = xn2_l;
+   iir->yn1[0] = yn1_l;
+   iir->yn2[0] = yn2_l;
 
-   iir->r.xn1 = xn1_r;
-   iir->r.xn2 = xn2_r;
-   iir->r.yn1 = yn1_r;
-   iir->r.yn2 = yn2_r;
+   iir->xn1[1] = xn1_r;
+   iir->xn2[1] = xn2_r;
+   iir->yn1[1] = yn1_r;
+   iir->yn2[1] = yn2_r;
+#endif
 }
 
 #define CHECK(x) if (!strcmp(str, #x)) return x
@@ -308,12 +381,12 @@ static void iir_filter_init(struct iir_data *iir,
          break;
    }
 
-   iir->b0 = b0;
-   iir->b1 = b1;
-   iir->b2 = b2;
-   iir->a0 = a0;
-   iir->a1 = a1;
-   iir->a2 = a2;
+   // Divide once here instead of for every sample.
+   iir->b0 = b0 / a0;
+   iir->b1 = b1 / a0;
+   iir->b2 = b2 / a0;
+   iir->a1 = a1 / a0;
+   iir->a2 = a2 / a0;
 }
 
 static void *iir_init(const struct dspfilter_info *info,
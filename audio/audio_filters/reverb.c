@@ -20,15 +20,20 @@
 #include <string.h>
 #include <retro_inline.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+// Both channels use the same tunings, so the delay lines hold
+// interleaved stereo and each comb and allpass filters a stereo
+// pair per frame.
 struct comb
 {
    float *buffer;
    unsigned bufsize;
    unsigned bufidx;
-
-   float feedback;
-   float filterstore;
-   float damp1, damp2;
 };
 
 struct allpass
@@ -39,32 +44,33 @@ struct allpass
    unsigned bufidx;
 };
 
-static INLINE float comb_process(struct comb *c, float input)
+static INLINE float *comb_next(struct comb *c)
 {
-   float output = c->buffer[c->bufidx];
-   c->filterstore = (output * c->damp2) + (c->filterstore * c->damp1);
-
-   c->buffer[c->bufidx] = input + (c->filterstore * c->feedback);
+   float *ptr = c->buffer + 2 * c->bufidx;
 
    c->bufidx++;
    if (c->bufidx >= c->bufsize)
       c->bufidx = 0;
 
-   return output;
+   return ptr;
 }
 
-
-static INLINE float allpass_process(struct allpass *a, float input)
+static INLINE void allpass_process(struct allpass *a, float *inout)
 {
-   float bufout = a->buffer[a->bufidx];
-   float output = -input + bufout;
-   a->buffer[a->bufidx] = input + bufout * a->feedback;
+   unsigned c;
+   float *buf = a->buffer + 2 * a->bufidx;
+
+   for (c = 0; c < 2; c++)
+   {
+      float bufout = buf[c];
+      float input = inout[c];
+      inout[c] = -input + bufout;
+      buf[c] = input + bufout * a->feedback;
+   }
 
    a->bufidx++;
    if (a->bufidx >= a->bufsize)
       a->bufidx = 0;
-
-   return output;
 }
 
 #define numcombs 8
@@ -102,19 +108,24 @@ struct revmodel
    struct comb combL[numcombs];
    struct allpass allpassL[numallpasses];
 
-   float bufcombL1[combtuningL1];
-   float bufcombL2[combtuningL2];
-   float bufcombL3[combtuningL3];
-   float bufcombL4[combtuningL4];
-   float bufcombL5[combtuningL5];
-   float bufcombL6[combtuningL6];
-   float bufcombL7[combtuningL7];
-   float bufcombL8[combtuningL8];
-
-   float bufallpassL1[allpasstuningL1];
-   float bufallpassL2[allpasstuningL2];
-   float bufallpassL3[allpasstuningL3];
-   float bufallpassL4[allpasstuningL4];
+   float bufcombL1[2 * combtuningL1];
+   float bufcombL2[2 * combtuningL2];
+   float bufcombL3[2 * combtuningL3];
+   float bufcombL4[2 * combtuningL4];
+   float bufcombL5[2 * combtuningL5];
+   float bufcombL6[2 * combtuningL6];
+   float bufcombL7[2 * combtuningL7];
+   float bufcombL8[2 * combtuningL8];
+
+   float bufallpassL1[2 * allpasstuningL1];
+   float bufallpassL2[2 * allpasstuningL2];
+   float bufallpassL3[2 * allpasstuningL3];
+   float bufallpassL4[2 * allpasstuningL4];
+
+   // Lowpass state of each comb, stereo pairs.
+   float filterstore[2 * numcombs];
+   float feedback;
+   float damp2;
 
    float gain;
    float roomsize, roomsize1;
@@ -125,24 +136,120 @@ struct revmodel
    float mode;
 };
 
-static float revmodel_process(struct revmodel *rev, float in)
+static void revmodel_process(struct revmodel *rev,
+      float *samples, unsigned frames)
 {
    int i;
-   float mono_out = 0.0f;
-   float mono_in = in;
-   float input = mono_in * rev->gain;
-   for (i = 0; i < numcombs; i++)
-      mono_out += comb_process(&rev->combL[i], input);
+   unsigned f;
+
+#if defined(__SSE__)
+   // Two combs of two channels each per vector.
+   __m128 store[numcombs / 2];
+   __m128 vfeedback = _mm_set1_ps(rev->feedback);
+   __m128 vdamp1    = _mm_set1_ps(rev->damp1);
+   __m128 vdamp2    = _mm_set1_ps(rev->damp2);
+
+   for (i = 0; i < numcombs / 2; i++)
+      store[i] = _mm_loadu_ps(rev->filterstore + 4 * i);
+#elif defined(__ARM_NEON__)
+   // Two combs of two channels each per vector.
+   float32x4_t store[numcombs / 2];
+
+   for (i = 0; i < numcombs / 2; i++)
+      store[i] = vld1q_f32(rev->filterstore + 4 * i);
+#endif
 
-   for (i = 0; i < numallpasses; i++)
-      mono_out = allpass_process(&rev->allpassL[i], mono_out);
+   for (f = 0; f < frames; f++, samples += 2)
+   {
+      float out[2];
+      float in[2] = { samples[0], samples[1] };
+      float input[2] = { in[0] * rev->gain, in[1] * rev->gain };
+
+#if defined(__SSE__)
+      __m128 vinput = _mm_setr_ps(input[0], input[1], input[0], input[1]);
+      __m128 sum    = _mm_setzero_ps();
+
+      for (i = 0; i < numcombs / 2; i++)
+      {
+         float *a = comb_next(&rev->combL[2 * i + 0]);
+         float *b = comb_next(&rev->combL[2 * i + 1]);
+         __m128 output = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                  (const __m64*)a), (const __m64*)b);
+         __m128 feedback;
+
+         store[i] = _mm_add_ps(_mm_mul_ps(output, vdamp2),
+               _mm_mul_ps(store[i], vdamp1));
+
+         feedback = _mm_add_ps(vinput, _mm_mul_ps(store[i], vfeedback));
+         _mm_storel_pi((__m64*)a, feedback);
+         _mm_storeh_pi((__m64*)b, feedback);
+
+         sum = _mm_add_ps(sum, output);
+      }
+
+      sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+      _mm_storel_pi((__m64*)out, sum);
+#elif defined(__ARM_NEON__)
+      float32x2_t vinput2 = vld1_f32(input);
+      float32x4_t vinput  = vcombine_f32(vinput2, vinput2);
+      float32x4_t sum     = vdupq_n_f32(0.0f);
+
+      for (i = 0; i < numcombs / 2; i++)
+      {
+         float *a = comb_next(&rev->combL[2 * i + 0]);
+         float *b = comb_next(&rev->combL[2 * i + 1]);
+         float32x4_t output = vcombine_f32(vld1_f32(a), vld1_f32(b));
+         float32x4_t feedback;
+
+         store[i] = vmlaq_n_f32(vmulq_n_f32(output, rev->damp2),
+               store[i], rev->damp1);
+
+         feedback = vmlaq_n_f32(vinput, store[i], rev->feedback);
+         vst1_f32(a, vget_low_f32(feedback));
+         vst1_f32(b, vget_high_f32(feedback));
+
+         sum = vaddq_f32(sum, output);
+      }
+
+      vst1_f32(out, vadd_f32(vget_low_f32(sum), vget_high_f32(sum)));
+#else
+      out[0] = 0.0f;
+      out[1] = 0.0f;
+
+      for (i = 0; i < numcombs; i++)
+      {
+         unsigned c;
+         float *buf = comb_next(&rev->combL[i]);
+         float *store = rev->filterstore + 2 * i;
+
+         for (c = 0; c < 2; c++)
+         {
+            float output = buf[c];
+            store[c] = (output * rev->damp2) + (store[c] * rev->damp1);
+            buf[c] = input[c] + (store[c] * rev->feedback);
+            out[c] += output;
+         }
+      }
+#endif
 
-   return mono_in * rev->dry + mono_out * rev->wet1;
+      for (i = 0; i < numallpasses; i++)
+         allpass_process(&rev->allpassL[i], out);
+
+      samples[0] = in[0] * rev->dry + out[0] * rev->wet1;
+      samples[1] = in[1] * rev->dry + out[1] * rev->wet1;
+   }
+
+#if defined(__SSE__)
+   for (i = 0; i < numcombs / 2; i++)
+      _mm_storeu_ps(rev->filterstore + 4 * i, store[i]);
+#elif defined(__ARM_NEON__)
+   for (i = 0; i < numcombs / 2; i++)
+      vst1q_f32(rev->filterstore + 4 * i, store[i]);
+#endif
 }
 
 static void revmodel_update(struct revmodel *rev)
 {
-   int i;
    rev->wet1 = rev->wet * (rev->width / 2.0f + 0.5f);
 
    if (rev->mode >= freezemode)
@@ -158,12 +265,8 @@ static void revmodel_update(struct revmodel *rev)
       rev->gain = fixedgain;
    }
 
-   for (i = 0; i < numcombs; i++)
-   {
-      rev->combL[i].feedback = rev->roomsize1;
-      rev->combL[i].damp1 = rev->damp1;
-      rev->combL[i].damp2 = 1.0f - rev->damp1;
-   }
+   rev->feedback = rev->roomsize1;
+   rev->damp2 = 1.0f - rev->damp1;
 }
 
 static void revmodel_setroomsize(struct revmodel *rev, float value)
@@ -233,7 +336,7 @@ static void revmodel_init(struct revmodel *rev)
 
 struct reverb_data
 {
-   struct revmodel left, right;
+   struct revmodel rev;
 };
 
 static void reverb_free(void *data)
@@ -244,20 +347,12 @@ static void reverb_free(void *data)
 static void reverb_process(void *data, struct dspfilter_output *output,
       const struct dspfilter_input *input)
 {
-   unsigned i;
    struct reverb_data *rev = (struct reverb_data*)data;
 
    output->samples = input->samples;
    output->frames  = input->frames;
-   float *out = output->samples;
-
-   for (i = 0; i < input->frames; i++, out += 2)
-   {
-      float in[2] = { out[0], out[1] };
 
-      out[0] = revmodel_process(&rev->left, in[0]);
-      out[1] = revmodel_process(&rev->right, in[1]);
-   }
+   revmodel_process(&rev->rev, output->samples, output->frames);
 }
 
 static void *reverb_init(const struct dspfilter_info *info,
@@ -274,20 +369,13 @@ static void *reverb_init(const struct dspfilter_info *info,
    config->get_float(userdata, "roomwidth", &roomwidth, 0.56f);
    config->get_float(userdata, "roomsize", &roomsize, 0.56f);
 
-   revmodel_init(&rev->left);
-   revmodel_init(&rev->right);
-
-   revmodel_setdamp(&rev->left, damping);
-   revmodel_setdry(&rev->left, drytime);
-   revmodel_setwet(&rev->left, wettime);
-   revmodel_setwidth(&rev->left, roomwidth);
-   revmodel_setroomsize(&rev->left, roomsize);
+   revmodel_init(&rev->rev);
 
-   revmodel_setdamp(&rev->right, damping);
-   revmodel_setdry(&rev->right, drytime);
-   revmodel_setwet(&rev->right, wettime);
-   revmodel_setwidth(&rev->right, roomwidth);
-   revmodel_setroomsize(&rev->right, roomsize);
+   revmodel_setdamp(&rev->rev, damping);
+   revmodel_setdry(&rev->rev, drytime);
+   revmodel_setwet(&rev->rev, wettime);
+   revmodel_setwidth(&rev->rev, roomwidth);
+   revmodel_setroomsize(&rev->rev, roomsize);
 
    return rev;
 }
@@ -19,6 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #define wahwahlfoskipsamples 30
 
 #ifndef M_PI
@@ -29,15 +35,15 @@ struct wahwah_data
 {
    float phase;
    float lfoskip;
-   float b0, b1, b2, a0, a1, a2;
+   // Normalized so that a0 is 1.
+   float b0, b1, b2, a1, a2;
    float freq, startphase;
    float depth, freqofs, res;
    unsigned long skipcount;
 
-   struct
-   {
-      float xn1, xn2, yn1, yn2;
-   } l, r;
+   // Filter history, interleaved like the samples.
+   float xn1[2], xn2[2];
+   float yn1[2], yn2[2];
 };
 
 static void wahwah_free(void *data)
@@ -45,55 +51,143 @@ static void wahwah_free(void *data)
    free(data);
 }
 
+static void wahwah_update_coeffs(struct wahwah_data *wah,
+      unsigned long count)
+{
+   float frequency = (1.0 + cos(count * wah->lfoskip + wah->phase)) / 2.0;
+   frequency = frequency * wah->depth * (1.0 - wah->freqofs) + wah->freqofs;
+   frequency = exp((frequency - 1.0) * 6.0);
+
+   float omega = M_PI * frequency;
+   float sn = sin(omega);
+   float cs = cos(omega);
+   float alpha = sn / (2.0 * wah->res);
+   float a0 = 1.0 + alpha;
+
+   wah->b0 = (1.0 - cs) / 2.0 / a0;
+   wah->b1 = (1.0 - cs) / a0;
+   wah->b2 = (1.0 - cs) / 2.0 / a0;
+   wah->a1 = -2.0 * cs / a0;
+   wah->a2 = (1.0 - alpha) / a0;
+}
+
 static void wahwah_process(void *data, struct dspfilter_output *output,
       const struct dspfilter_input *input)
 {
-   unsigned i;
+   unsigned i = 0;
    struct wahwah_data *wah = (struct wahwah_data*)data;
 
    output->samples = input->samples;
    output->frames  = input->frames;
    float *out = output->samples;
 
-   for (i = 0; i < input->frames; i++, out += 2)
+   // The LFO only moves the coefficients every wahwahlfoskipsamples
+   // frames. In between, both channels run as one two lane biquad.
+#if defined(__SSE__)
+   __m128 xn1 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)wah->xn1);
+   __m128 xn2 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)wah->xn2);
+   __m128 yn1 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)wah->yn1);
+   __m128 yn2 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)wah->yn2);
+#elif defined(__ARM_NEON__)
+   float32x2_t xn1 = vld1_f32(wah->xn1);
+   float32x2_t xn2 = vld1_f32(wah->xn2);
+   float32x2_t yn1 = vld1_f32(wah->yn1);
+   float32x2_t yn2 = vld1_f32(wah->yn2);
+#endif
+
+   while (i < input->frames)
    {
-      float in[2] = { out[0], out[1] };
+      unsigned run = wahwahlfoskipsamples - wah->skipcount % wahwahlfoskipsamples;
+
+      // The LFO phase is taken after the first frame of the run.
+      if (run == wahwahlfoskipsamples)
+         wahwah_update_coeffs(wah, wah->skipcount + 1);
+
+      if (run > input->frames - i)
+         run = input->frames - i;
 
-      if ((wah->skipcount++ % wahwahlfoskipsamples) == 0)
+      wah->skipcount += run;
+      i              += run;
+
+#if defined(__SSE__)
+      __m128 b0 = _mm_set1_ps(wah->b0);
+      __m128 b1 = _mm_set1_ps(wah->b1);
+      __m128 b2 = _mm_set1_ps(wah->b2);
+      __m128 a1 = _mm_set1_ps(wah->a1);
+      __m128 a2 = _mm_set1_ps(wah->a2);
+
+      for (; run; run--, out += 2)
       {
-         float frequency = (1.0 + cos(wah->skipcount * wah->lfoskip + wah->phase)) / 2.0;
-         frequency = frequency * wah->depth * (1.0 - wah->freqofs) + wah->freqofs;
-         frequency = exp((frequency - 1.0) * 6.0);
-
-         float omega = M_PI * frequency;
-         float sn = sin(omega);
-         float cs = cos(omega);
-         float alpha = sn / (2.0 * wah->res);
-
-         wah->b0 = (1.0 - cs) / 2.0;
-         wah->b1 = 1.0 - cs;
-         wah->b2 = (1.0 - cs) / 2.0;
-         wah->a0 = 1.0 + alpha;
-         wah->a1 = -2.0 * cs;
-         wah->a2 = 1.0 - alpha;
+         __m128 in  = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)out);
+         __m128 res = _mm_add_ps(_mm_mul_ps(b0, in), _mm_mul_ps(b1, xn1));
+         res        = _mm_add_ps(res, _mm_mul_ps(b2, xn2));
+         res        = _mm_sub_ps(res, _mm_mul_ps(a1, yn1));
+         res        = _mm_sub_ps(res, _mm_mul_ps(a2, yn2));
+
+         xn2 = xn1;
+         xn1 = in;
+         yn2 = yn1;
+         yn1 = res;
+
+         _mm_storel_pi((__m64*)out, res);
       }
+#elif defined(__ARM_NEON__)
+      float32x2_t b0 = vdup_n_f32(wah->b0);
+      float32x2_t b1 = vdup_n_f32(wah->b1);
+      float32x2_t b2 = vdup_n_f32(wah->b2);
+      float32x2_t a1 = vdup_n_f32(wah->a1);
+      float32x2_t a2 = vdup_n_f32(wah->a2);
+
+      for (; run; run--, out += 2)
+      {
+         float32x2_t in  = vld1_f32(out);
+         float32x2_t res = vadd_f32(vmul_f32(b0, in), vmul_f32(b1, xn1));
+         res             = vadd_f32(res, vmul_f32(b2, xn2));
+         res             = vsub_f32(res, vmul_f32(a1, yn1));
+         res             = vsub_f32(res, vmul_f32(a2, yn2));
+
+         xn2 = xn1;
+         xn1 = in;
+         yn2 = yn1;
+         yn1 = res;
+
+         vst1_f32(out, res);
+      }
+#else
+      for (; run; run--, out += 2)
+      {
+         float in[2] = { out[0], out[1] };
 
-      float out_l = (wah->b0 * in[0] + wah->b1 * wah->l.xn1 + wah->b2 * wah->l.xn2 - wah->a1 * wah->l.yn1 - wah->a2 * wah->l.yn2) / wah->a0;
-      float out_r = (wah->b0 * in[1] + wah->b1 * wah->r.xn1 + wah->b2 * wah->r.xn2 - wah->a1 * wah->r.yn1 - wah->a2 * wah->r.yn2) / wah->a0;
+         float out_l = wah->b0 * in[0] + wah->b1 * wah->xn1[0] + wah->b2 * wah->xn2[0] - wah->a1 * wah->yn1[0] - wah->a2 * wah->yn2[0];
+         float out_r = wah->b0 * in[1] + wah->b1 * wah->xn1[1] + wah->b2 * wah->xn2[1] - wah->a1 * wah->yn1[1] - wah->a2 * wah->yn2[1];
 
-      wah->l.xn2 = wah->l.xn1;
-      wah->l.xn1 = in[0];
-      wah->l.yn2 = wah->l.yn1;
-      wah->l.yn1 = out_l;
+         wah->xn2[0] = wah->xn1[0];
+         wah->xn1[0] = in[0];
+         wah->yn2[0] = wah->yn1[0];
+         wah->yn1[0] = out_l;
 
-      wah->r.xn2 = wah->r.xn1;
-      wah->r.xn1 = in[1];
-      wah->r.yn2 = wah->r.yn1;
-      wah->r.yn1 = out_r;
+         wah->xn2[1] = wah->xn1[1];
+         wah->xn1[1] = in[1];
+         wah->yn2[1] = wah->yn1[1];
+         wah->yn1[1] = out_r;
 
-      out[0] = out_l;
-      out[1] = out_r;
+         out[0] = out_l;
+         out[1] = out_r;
+      }
+#endif
    }
+
+#if defined(__SSE__)
+   _mm_storel_pi((__m64*)wah->xn1, xn1);
+   _mm_storel_pi((__m64*)wah->xn2, xn2);
+   _mm_storel_pi((__m64*)wah->yn1, yn1);
+   _mm_storel_pi((__m64*)wah->yn2, yn2);
+#elif defined(__ARM_NEON__)
+   vst1_f32(wah->xn1, xn1);
+   vst1_f32(wah->xn2, xn2);
+   vst1_f32(wah->yn1, yn1);
+   vst1_f32(wah->yn2, yn2);
+#endif
 }
 
 static void *wahwah_init(const struct dspfilter_info *info,
@@ -0,0 +1,129 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Runs white noise through each .dsp preset given on the command line
+// and reports the processing cost per stereo frame.
+// Used for performance benchmarking of the DSP filters.
+
+#include "../audio_dsp_filter.h"
+#include "../../libretro.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RATE 44100.0f
+#define BENCH_CHUNK 512
+#define BENCH_SECONDS 20
+
+// Normally provided by performance.c. Report what the compiler targets.
+uint64_t rarch_get_cpu_features(void)
+{
+   uint64_t cpu = 0;
+#ifdef __SSE__
+   cpu |= RETRO_SIMD_SSE;
+#endif
+#ifdef __SSE2__
+   cpu |= RETRO_SIMD_SSE2;
+#endif
+#ifdef __AVX__
+   cpu |= RETRO_SIMD_AVX;
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+   cpu |= RETRO_SIMD_NEON;
+#endif
+   return cpu;
+}
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+static int bench_preset(const char *path, const float *noise, unsigned frames)
+{
+   unsigned i;
+   float input[BENCH_CHUNK * 2];
+   rarch_dsp_filter_t *dsp = rarch_dsp_filter_new(path, BENCH_RATE);
+   if (!dsp)
+   {
+      fprintf(stderr, "Failed to load DSP preset \"%s\".\n", path);
+      return 1;
+   }
+
+   unsigned chunks = frames / BENCH_CHUNK;
+   unsigned output_frames = 0;
+   double total = 0.0;
+
+   // The first chunks warm up caches and block based filters
+   // and are not timed.
+   for (i = 0; i < chunks + chunks / 10; i++)
+   {
+      // The filters may process in place, so feed a fresh copy every time.
+      memcpy(input, noise + (i % chunks) * BENCH_CHUNK * 2, sizeof(input));
+
+      struct rarch_dsp_data data = {
+         .input = input,
+         .input_frames = BENCH_CHUNK,
+      };
+
+      double start = get_time();
+      rarch_dsp_filter_process(dsp, &data);
+      double end = get_time();
+
+      if (i >= chunks / 10)
+      {
+         total += end - start;
+         output_frames += data.output_frames;
+      }
+   }
+
+   printf("%-40s %8.2f ns/frame (%6.2f%% of one core at %.0f Hz, %u frames out)\n",
+         path, 1e9 * total / chunks / BENCH_CHUNK,
+         100.0 * total * BENCH_RATE / (chunks * BENCH_CHUNK), BENCH_RATE,
+         output_frames);
+
+   rarch_dsp_filter_free(dsp);
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   int i, ret = 0;
+   unsigned frames = (unsigned)BENCH_RATE * BENCH_SECONDS;
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "Usage: %s <preset.dsp> [preset.dsp ...]\n", argv[0]);
+      return 1;
+   }
+
+   float *noise = (float*)malloc(frames * 2 * sizeof(*noise));
+   if (!noise)
+      return 1;
+
+   srand(0);
+   for (i = 0; i < (int)frames * 2; i++)
+      noise[i] = 0.5f * ((2.0f * rand()) / RAND_MAX - 1.0f);
+
+   for (i = 1; i < argc; i++)
+      ret |= bench_preset(argv[i], noise, frames);
+
+   free(noise);
+   return ret;
+}
@@ -20,8 +20,22 @@
 #include <boolean.h>
 #include <string.h>
 #include <stdio.h>
+#include <file/file_extract.h>
 #include "general.h"
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/* SRAM is compared and written in blocks of this size.
+ * The autosave lock is only held while comparing one block,
+ * so the main thread never waits for a whole SRAM scan. */
+#define AUTOSAVE_BLOCK_SIZE 4096
+
+#define AUTOSAVE_JOURNAL_MAGIC "RASJ"
+
 struct autosave
 {
    volatile bool quit;
@@ -36,6 +50,16 @@ struct autosave
    const char *path;
    size_t bufsize;
    unsigned interval;
+
+   size_t num_blocks;
+   uint32_t *dirty;
+
+   /* Whether the file at @path holds @buffer as of the last
+    * write, so that writing the dirty blocks is enough. */
+   bool file_valid;
+
+   char tmp_path[PATH_MAX_LENGTH];
+   char journal_path[PATH_MAX_LENGTH];
 };
 
 /**
@@ -60,6 +84,260 @@ static void autosave_unlock(autosave_t *handle)
    slock_unlock(handle->lock);
 }
 
+static size_t autosave_block_size(size_t bufsize, size_t block)
+{
+   size_t offset = block * AUTOSAVE_BLOCK_SIZE;
+   return bufsize - offset < AUTOSAVE_BLOCK_SIZE ?
+      bufsize - offset : AUTOSAVE_BLOCK_SIZE;
+}
+
+/* Journal blocks are only checksummed with zlib. Without it, the
+ * trailing magic alone tells a complete journal from a torn one. */
+static uint32_t autosave_block_crc(const uint8_t *data, size_t size)
+{
+#ifdef HAVE_ZLIB
+   return zlib_crc32_calculate(data, size);
+#else
+   return 0;
+#endif
+}
+
+/**
+ * autosave_write_at:
+ * @file            : file to write to.
+ * @data            : data to write.
+ * @size            : size of @data.
+ * @offset          : offset in @file to write @data at.
+ *
+ * Returns: true if all of @data was written.
+ **/
+static bool autosave_write_at(FILE *file, const void *data,
+      size_t size, size_t offset)
+{
+#ifdef _WIN32
+   return fseek(file, (long)offset, SEEK_SET) == 0
+      && fwrite(data, 1, size, file) == size;
+#else
+   const uint8_t *ptr = (const uint8_t*)data;
+
+   while (size)
+   {
+      ssize_t ret = pwrite(fileno(file), ptr, size, offset);
+
+      if (ret <= 0)
+         return false;
+
+      ptr    += ret;
+      size   -= ret;
+      offset += ret;
+   }
+
+   return true;
+#endif
+}
+
+/**
+ * autosave_sync:
+ * @file            : file to flush.
+ *
+ * Flushes @file to the disk, so later writes
+ * cannot reach the disk before it does.
+ *
+ * Returns: true on success.
+ **/
+static bool autosave_sync(FILE *file)
+{
+   if (fflush(file) != 0)
+      return false;
+#if defined(_WIN32)
+   return _commit(_fileno(file)) == 0;
+#else
+   return fsync(fileno(file)) == 0;
+#endif
+}
+
+/**
+ * autosave_scan:
+ * @save            : pointer to autosave object
+ *
+ * Compares SRAM against the last autosaved copy block by block,
+ * copying and marking every block which changed.
+ *
+ * Returns: true if any block changed.
+ **/
+static bool autosave_scan(autosave_t *save)
+{
+   size_t i;
+   bool differ             = false;
+   uint8_t *buffer         = (uint8_t*)save->buffer;
+   const uint8_t *retro    = (const uint8_t*)save->retro_buffer;
+
+   for (i = 0; i < save->num_blocks && !save->quit; i++)
+   {
+      size_t offset = i * AUTOSAVE_BLOCK_SIZE;
+      size_t size   = autosave_block_size(save->bufsize, i);
+
+      autosave_lock(save);
+      if (memcmp(buffer + offset, retro + offset, size) != 0)
+      {
+         memcpy(buffer + offset, retro + offset, size);
+         save->dirty[i >> 5] |= 1u << (i & 31);
+         differ = true;
+      }
+      autosave_unlock(save);
+   }
+
+   return differ;
+}
+
+/**
+ * autosave_write_full:
+ * @save            : pointer to autosave object
+ *
+ * Writes the whole SRAM copy to a temporary file and renames it
+ * over the autosave file, so a crash leaves either the old or
+ * the new file behind.
+ *
+ * Returns: true on success.
+ **/
+static bool autosave_write_full(autosave_t *save)
+{
+   bool failed = false;
+   FILE *file  = fopen(save->tmp_path, "wb");
+
+   if (!file)
+      return false;
+
+   failed |= fwrite(save->buffer, 1, save->bufsize, file) != save->bufsize;
+   failed |= !autosave_sync(file);
+   failed |= fclose(file) != 0;
+
+#ifdef _WIN32
+   /* rename() does not replace existing files here. */
+   if (!failed)
+      remove(save->path);
+#endif
+   if (failed || rename(save->tmp_path, save->path) != 0)
+   {
+      remove(save->tmp_path);
+      return false;
+   }
+
+   /* Stale after a full write. */
+   remove(save->journal_path);
+   return true;
+}
+
+/**
+ * autosave_write_journal:
+ * @save            : pointer to autosave object
+ *
+ * Writes every dirty block to the journal. The journal is only
+ * read back on the same machine, so it uses native byte order.
+ *
+ * Returns: true on success.
+ **/
+static bool autosave_write_journal(autosave_t *save)
+{
+   size_t i;
+   uint32_t header[3];
+   bool failed     = false;
+   uint8_t *buffer = (uint8_t*)save->buffer;
+   FILE *file      = fopen(save->journal_path, "wb");
+
+   if (!file)
+      return false;
+
+   header[0] = AUTOSAVE_BLOCK_SIZE;
+   header[1] = save->bufsize;
+   header[2] = 0;
+
+   for (i = 0; i < save->num_blocks; i++)
+      if (save->dirty[i >> 5] & (1u << (i & 31)))
+         header[2]++;
+
+   failed |= fwrite(AUTOSAVE_JOURNAL_MAGIC, 1, 4, file) != 4;
+   failed |= fwrite(header, sizeof(header), 1, file) != 1;
+
+   for (i = 0; i < save->num_blocks && !failed; i++)
+   {
+      uint32_t entry[2];
+      size_t size = autosave_block_size(save->bufsize, i);
+      uint8_t *block = buffer + i * AUTOSAVE_BLOCK_SIZE;
+
+      if (!(save->dirty[i >> 5] & (1u << (i & 31))))
+         continue;
+
+      entry[0] = i;
+      entry[1] = autosave_block_crc(block, size);
+
+      failed |= fwrite(entry, sizeof(entry), 1, file) != 1;
+      failed |= fwrite(block, 1, size, file) != size;
+   }
+
+   /* Marks the journal as complete. */
+   failed |= fwrite(AUTOSAVE_JOURNAL_MAGIC, 1, 4, file) != 4;
+   failed |= !autosave_sync(file);
+   failed |= fclose(file) != 0;
+
+   if (failed)
+      remove(save->journal_path);
+   return !failed;
+}
+
+/**
+ * autosave_write_blocks:
+ * @save            : pointer to autosave object
+ *
+ * Writes the dirty blocks into the autosave file in place,
+ * merging runs of adjacent blocks into one write. The blocks
+ * are journaled first, so a crash halfway through can be
+ * recovered with autosave_recover().
+ *
+ * Returns: true on success.
+ **/
+static bool autosave_write_blocks(autosave_t *save)
+{
+   size_t i;
+   FILE *file      = NULL;
+   bool failed     = false;
+   uint8_t *buffer = (uint8_t*)save->buffer;
+
+   if (!autosave_write_journal(save))
+      return false;
+
+   if (!(file = fopen(save->path, "r+b")))
+      return false;
+
+   for (i = 0; i < save->num_blocks && !failed; )
+   {
+      size_t start = i;
+
+      if (!(save->dirty[i >> 5] & (1u << (i & 31))))
+      {
+         i++;
+         continue;
+      }
+
+      while (i < save->num_blocks && (save->dirty[i >> 5] & (1u << (i & 31))))
+         i++;
+
+      failed |= !autosave_write_at(file,
+            buffer + start * AUTOSAVE_BLOCK_SIZE,
+            (i - 1 - start) * AUTOSAVE_BLOCK_SIZE
+            + autosave_block_size(save->bufsize, i - 1),
+            start * AUTOSAVE_BLOCK_SIZE);
+   }
+
+   failed |= !autosave_sync(file);
+   failed |= fclose(file) != 0;
+
+   /* On failure the next save rewrites the whole file,
+    * which makes the journal stale as well. */
+   remove(save->journal_path);
+   return !failed;
+}
+
 /**
  * autosave_thread:
  * @data            : pointer to autosave object
@@ -73,41 +351,31 @@ static void autosave_thread(void *data)
 
    while (!save->quit)
    {
-      bool differ = false;
-
-      autosave_lock(save);
-      differ = memcmp(save->buffer, save->retro_buffer,
-            save->bufsize) != 0;
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
-      autosave_unlock(save);
-
-      if (differ)
+      if (autosave_scan(save))
       {
-         /* Should probably deal with this more elegantly. */
-         FILE *file = fopen(save->path, "wb");
+         bool ok;
 
-         if (file)
+         /* Avoid spamming down stderr ... */
+         if (first_log)
          {
-            bool failed = false;
-
-            /* Avoid spamming down stderr ... */
-            if (first_log)
-            {
-               RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
-                     save->path, save->interval);
-               first_log = false;
-            }
-            else
-               RARCH_LOG("SRAM changed ... autosaving ...\n");
-
-            failed |= fwrite(save->buffer, 1, save->bufsize, file)
-               != save->bufsize;
-            failed |= fflush(file) != 0;
-            failed |= fclose(file) != 0;
-            if (failed)
-               RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
+            RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
+                  save->path, save->interval);
+            first_log = false;
          }
+         else
+            RARCH_LOG("SRAM changed ... autosaving ...\n");
+
+         if (save->file_valid)
+            ok = autosave_write_blocks(save);
+         else
+            ok = autosave_write_full(save);
+
+         save->file_valid = ok;
+         memset(save->dirty, 0,
+               ((save->num_blocks + 31) >> 5) * sizeof(uint32_t));
+
+         if (!ok)
+            RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
       }
 
       slock_lock(save->cond_lock);
@@ -144,14 +412,23 @@ autosave_t *autosave_new(const char *path, const void *data, size_t size,
    handle->path = path;
    handle->buffer = malloc(size);
    handle->retro_buffer = data;
+   handle->num_blocks = (size + AUTOSAVE_BLOCK_SIZE - 1) / AUTOSAVE_BLOCK_SIZE;
+   handle->dirty = (uint32_t*)calloc((handle->num_blocks + 31) >> 5,
+         sizeof(uint32_t));
 
-   if (!handle->buffer)
+   if (!handle->buffer || !handle->dirty)
    {
+      free(handle->buffer);
+      free(handle->dirty);
       free(handle);
       return NULL;
    }
    memcpy(handle->buffer, handle->retro_buffer, handle->bufsize);
 
+   snprintf(handle->tmp_path, sizeof(handle->tmp_path), "%s.tmp", path);
+   snprintf(handle->journal_path, sizeof(handle->journal_path),
+         "%s.journal", path);
+
    handle->lock = slock_new();
    handle->cond_lock = slock_new();
    handle->cond = scond_new();
@@ -161,6 +438,99 @@ autosave_t *autosave_new(const char *path, const void *data, size_t size,
    return handle;
 }
 
+/**
+ * autosave_recover:
+ * @path            : path to autosave file
+ *
+ * Finishes an autosave which was interrupted while writing
+ * blocks into @path. Does nothing unless a complete journal
+ * for @path exists. Call this before loading @path.
+ **/
+void autosave_recover(const char *path)
+{
+   char magic[4];
+   uint32_t i, header[3];
+   long file_size;
+   uint8_t *block = NULL;
+   FILE *journal  = NULL;
+   FILE *file     = NULL;
+   bool valid     = false;
+   char journal_path[PATH_MAX_LENGTH];
+
+   snprintf(journal_path, sizeof(journal_path), "%s.journal", path);
+
+   if (!(journal = fopen(journal_path, "rb")))
+      return;
+
+   if (fread(magic, 1, 4, journal) != 4
+         || memcmp(magic, AUTOSAVE_JOURNAL_MAGIC, 4)
+         || fread(header, sizeof(header), 1, journal) != 1
+         || header[0] != AUTOSAVE_BLOCK_SIZE
+         || !(block = (uint8_t*)malloc(AUTOSAVE_BLOCK_SIZE))
+         || !(file = fopen(path, "r+b")))
+      goto end;
+
+   /* The journal belongs to an uncompressed file of this size. */
+   fseek(file, 0, SEEK_END);
+   file_size = ftell(file);
+   if (file_size != (long)header[1])
+      goto end;
+
+   /* Only apply a journal which was written completely. */
+   for (valid = true, i = 0; i < header[2] && valid; i++)
+   {
+      uint32_t entry[2];
+      size_t size;
+
+      valid = fread(entry, sizeof(entry), 1, journal) == 1
+         && (size_t)entry[0] * AUTOSAVE_BLOCK_SIZE < header[1];
+      if (!valid)
+         break;
+
+      size  = autosave_block_size(header[1], entry[0]);
+      valid = fread(block, 1, size, journal) == size
+         && autosave_block_crc(block, size) == entry[1];
+   }
+
+   valid = valid && fread(magic, 1, 4, journal) == 4
+      && !memcmp(magic, AUTOSAVE_JOURNAL_MAGIC, 4);
+
+   if (!valid)
+      goto end;
+
+   fseek(journal, 4 + sizeof(header), SEEK_SET);
+
+   for (i = 0; i < header[2] && valid; i++)
+   {
+      uint32_t entry[2];
+      size_t size;
+
+      valid = fread(entry, sizeof(entry), 1, journal) == 1;
+      if (!valid)
+         break;
+
+      size  = autosave_block_size(header[1], entry[0]);
+      valid = fread(block, 1, size, journal) == size
+         && autosave_write_at(file, block, size,
+               (size_t)entry[0] * AUTOSAVE_BLOCK_SIZE);
+   }
+
+   valid = autosave_sync(file) && valid;
+
+   if (valid)
+      RARCH_LOG("Recovered interrupted SRAM autosave to \"%s\".\n", path);
+   else
+      RARCH_ERR("Failed to recover interrupted SRAM autosave to \"%s\".\n",
+            path);
+
+end:
+   if (file)
+      fclose(file);
+   fclose(journal);
+   free(block);
+   remove(journal_path);
+}
+
 /**
  * autosave_free:
  * @handle          : pointer to autosave object
@@ -183,6 +553,7 @@ void autosave_free(autosave_t *handle)
    scond_free(handle->cond);
 
    free(handle->buffer);
+   free(handle->dirty);
    free(handle);
 }
 
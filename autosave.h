@@ -40,6 +40,16 @@ typedef struct autosave autosave_t;
 autosave_t *autosave_new(const char *path, const void *data,
       size_t size, unsigned interval);
 
+/**
+ * autosave_recover:
+ * @path            : path to autosave file
+ *
+ * Finishes an autosave which was interrupted while writing
+ * blocks into @path. Does nothing unless a complete journal
+ * for @path exists. Call this before loading @path.
+ **/
+void autosave_recover(const char *path);
+
 /**
  * autosave_free:
  * @handle          : pointer to autosave object
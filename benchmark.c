@@ -0,0 +1,263 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "general.h"
+#include "runloop.h"
+#include "retroarch_logger.h"
+
+struct benchmark_samples
+{
+   uint32_t *data;
+   size_t count;
+   size_t capacity;
+};
+
+static const char *benchmark_stage_names[BENCHMARK_STAGE_LAST] = {
+   "frame",
+   "run",
+   "video",
+   "audio",
+   "rewind",
+   "preempt",
+   "netplay",
+};
+
+static struct
+{
+   bool enable;
+   retro_time_t start_time;
+
+   /* Time spent in each stage during the current frame. */
+   retro_time_t current[BENCHMARK_STAGE_LAST];
+   unsigned current_mask;
+
+   struct benchmark_samples samples[BENCHMARK_STAGE_LAST];
+} benchmark;
+
+/**
+ * benchmark_stage_begin:
+ *
+ * Returns: start time to pass to benchmark_stage_end(),
+ * or 0 if benchmark mode is off.
+ **/
+retro_time_t benchmark_stage_begin(void)
+{
+   if (!benchmark.enable)
+      return 0;
+   return rarch_get_time_usec();
+}
+
+/**
+ * benchmark_stage_end:
+ * @stage                : stage being timed.
+ * @start                : value returned by benchmark_stage_begin().
+ *
+ * Adds the time since @start to @stage for the current frame.
+ * Stages may be entered several times per frame.
+ **/
+void benchmark_stage_end(enum benchmark_stage stage, retro_time_t start)
+{
+   if (!start)
+      return;
+
+   benchmark.current[stage] += rarch_get_time_usec() - start;
+   benchmark.current_mask   |= 1 << stage;
+}
+
+static void benchmark_samples_push(struct benchmark_samples *samples,
+      retro_time_t val)
+{
+   if (samples->count == samples->capacity)
+   {
+      size_t capacity = samples->capacity ? samples->capacity * 2 : 4096;
+      uint32_t *data  = (uint32_t*)realloc(samples->data,
+            capacity * sizeof(*data));
+
+      if (!data)
+         return;
+
+      samples->data     = data;
+      samples->capacity = capacity;
+   }
+
+   samples->data[samples->count++] = (uint32_t)val;
+}
+
+/**
+ * benchmark_frame_end:
+ * @start                : value returned by benchmark_stage_begin()
+ *                         at the start of the frame.
+ *
+ * Stores the timings of the current frame.
+ **/
+void benchmark_frame_end(retro_time_t start)
+{
+   unsigned i;
+
+   if (!start)
+      return;
+
+   benchmark_stage_end(BENCHMARK_STAGE_FRAME, start);
+
+   /* Only stages which ran during a frame get a sample,
+    * so percentiles are not diluted by idle frames. */
+   for (i = 0; i < BENCHMARK_STAGE_LAST; i++)
+   {
+      if (benchmark.current_mask & (1 << i))
+         benchmark_samples_push(&benchmark.samples[i], benchmark.current[i]);
+      benchmark.current[i] = 0;
+   }
+
+   benchmark.current_mask = 0;
+}
+
+/**
+ * benchmark_get_frame_count:
+ *
+ * Returns: number of frames timed so far.
+ **/
+uint64_t benchmark_get_frame_count(void)
+{
+   return benchmark.samples[BENCHMARK_STAGE_FRAME].count;
+}
+
+static int benchmark_compare(const void *a, const void *b)
+{
+   uint32_t x = *(const uint32_t*)a;
+   uint32_t y = *(const uint32_t*)b;
+   return (x > y) - (x < y);
+}
+
+static uint32_t benchmark_percentile(const struct benchmark_samples *samples,
+      unsigned percent)
+{
+   size_t rank = (samples->count * percent + 99) / 100;
+   return samples->data[rank ? rank - 1 : 0];
+}
+
+static void benchmark_write_stage(FILE *file, unsigned stage, bool last)
+{
+   size_t i;
+   uint64_t total = 0;
+   struct benchmark_samples *samples = &benchmark.samples[stage];
+
+   fprintf(file, "    \"%s\": { \"count\": %u",
+         benchmark_stage_names[stage], (unsigned)samples->count);
+
+   if (samples->count)
+   {
+      qsort(samples->data, samples->count, sizeof(*samples->data),
+            benchmark_compare);
+
+      for (i = 0; i < samples->count; i++)
+         total += samples->data[i];
+
+      fprintf(file, ", \"mean_usec\": %.2f, \"p50_usec\": %u, "
+            "\"p90_usec\": %u, \"p99_usec\": %u, \"max_usec\": %u",
+            (double)total / samples->count,
+            benchmark_percentile(samples, 50),
+            benchmark_percentile(samples, 90),
+            benchmark_percentile(samples, 99),
+            samples->data[samples->count - 1]);
+   }
+
+   fprintf(file, " }%s\n", last ? "" : ",");
+}
+
+static void benchmark_write_report(const char *path)
+{
+   unsigned i;
+   FILE *file        = stdout;
+   retro_time_t wall = rarch_get_time_usec() - benchmark.start_time;
+   size_t frames     = benchmark.samples[BENCHMARK_STAGE_FRAME].count;
+   global_t *global  = global_get_ptr();
+
+   if (strcmp(path, "-"))
+   {
+      file = fopen(path, "w");
+      if (!file)
+      {
+         RARCH_ERR("Failed to write benchmark report to \"%s\".\n", path);
+         return;
+      }
+   }
+
+   fprintf(file, "{\n");
+   fprintf(file, "  \"core\": \"%s\",\n",
+         global->system.info.library_name
+         ? global->system.info.library_name : "");
+   fprintf(file, "  \"frames\": %u,\n", (unsigned)frames);
+   fprintf(file, "  \"wall_usec\": %llu,\n", (unsigned long long)wall);
+   fprintf(file, "  \"fps\": %.2f,\n",
+         wall > 0 ? frames * 1000000.0 / wall : 0.0);
+   fprintf(file, "  \"stages\": {\n");
+
+   for (i = 0; i < BENCHMARK_STAGE_LAST; i++)
+      benchmark_write_stage(file, i, i == BENCHMARK_STAGE_LAST - 1);
+
+   fprintf(file, "  }\n}\n");
+
+   if (file != stdout)
+   {
+      fclose(file);
+      RARCH_LOG("Wrote benchmark report to \"%s\".\n", path);
+   }
+}
+
+/**
+ * init_benchmark:
+ *
+ * Starts collecting per-frame timings if --benchmark was given.
+ * A run still in progress is written out and restarted.
+ **/
+void init_benchmark(void)
+{
+   global_t *global = global_get_ptr();
+
+   deinit_benchmark();
+
+   if (!global->benchmark.enable)
+      return;
+
+   benchmark.enable     = true;
+   benchmark.start_time = rarch_get_time_usec();
+}
+
+/**
+ * deinit_benchmark:
+ *
+ * Writes the JSON report and frees all samples.
+ **/
+void deinit_benchmark(void)
+{
+   unsigned i;
+   global_t *global = global_get_ptr();
+
+   if (!benchmark.enable)
+      return;
+
+   benchmark_write_report(global->benchmark.report_path);
+
+   for (i = 0; i < BENCHMARK_STAGE_LAST; i++)
+      free(benchmark.samples[i].data);
+
+   memset(&benchmark, 0, sizeof(benchmark));
+}
@@ -0,0 +1,93 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_BENCHMARK_H
+#define __RARCH_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <boolean.h>
+#include "libretro.h"
+#include "performance.h"
+
+enum benchmark_stage
+{
+   BENCHMARK_STAGE_FRAME = 0,
+   BENCHMARK_STAGE_RUN,
+   BENCHMARK_STAGE_VIDEO,
+   BENCHMARK_STAGE_AUDIO,
+   BENCHMARK_STAGE_REWIND,
+   BENCHMARK_STAGE_PREEMPT,
+   BENCHMARK_STAGE_NETPLAY,
+   BENCHMARK_STAGE_LAST
+};
+
+/**
+ * benchmark_stage_begin:
+ *
+ * Returns: start time to pass to benchmark_stage_end(),
+ * or 0 if benchmark mode is off.
+ **/
+retro_time_t benchmark_stage_begin(void);
+
+/**
+ * benchmark_stage_end:
+ * @stage                : stage being timed.
+ * @start                : value returned by benchmark_stage_begin().
+ *
+ * Adds the time since @start to @stage for the current frame.
+ * Stages may be entered several times per frame.
+ **/
+void benchmark_stage_end(enum benchmark_stage stage, retro_time_t start);
+
+/**
+ * benchmark_frame_end:
+ * @start                : value returned by benchmark_stage_begin()
+ *                         at the start of the frame.
+ *
+ * Stores the timings of the current frame.
+ **/
+void benchmark_frame_end(retro_time_t start);
+
+/**
+ * benchmark_get_frame_count:
+ *
+ * Returns: number of frames timed so far.
+ **/
+uint64_t benchmark_get_frame_count(void);
+
+/**
+ * init_benchmark:
+ *
+ * Starts collecting per-frame timings if --benchmark was given.
+ * A run still in progress is written out and restarted.
+ **/
+void init_benchmark(void);
+
+/**
+ * deinit_benchmark:
+ *
+ * Writes the JSON report and frees all samples.
+ **/
+void deinit_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,598 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+
+#include "cheat_search.h"
+#include "dynamic.h"
+#include "general.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Candidates are tracked one bit per aligned address and
+ * compared in blocks of 32, one bitset word at a time. Blocks
+ * without candidates left are skipped, so narrowed searches
+ * stay cheap enough to run every frame. */
+#define CHEAT_SEARCH_BLOCK 32
+
+struct cheat_search
+{
+   enum cheat_search_type type;
+   enum cheat_search_cmp auto_cmp;
+   bool auto_armed;
+   unsigned width;
+
+   uint8_t *prev;
+   size_t size;
+
+   uint32_t *bits;
+   size_t candidates;
+   size_t words;
+   size_t count;
+};
+
+static const unsigned cheat_search_widths[CHEAT_SEARCH_TYPE_LAST] = {
+   1, 2, 2, 4, 4
+};
+
+static INLINE unsigned cheat_search_popcount(uint32_t x)
+{
+   x = x - ((x >> 1) & 0x55555555);
+   x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+   x = (x + (x >> 4)) & 0x0f0f0f0f;
+   return (x * 0x01010101) >> 24;
+}
+
+static INLINE uint32_t cheat_search_read(const uint8_t *data,
+      enum cheat_search_type type)
+{
+   switch (type)
+   {
+      case CHEAT_SEARCH_16BIT_LE:
+         return data[0] | (data[1] << 8);
+      case CHEAT_SEARCH_16BIT_BE:
+         return (data[0] << 8) | data[1];
+      case CHEAT_SEARCH_32BIT_LE:
+         return data[0] | (data[1] << 8) | (data[2] << 16)
+            | ((uint32_t)data[3] << 24);
+      case CHEAT_SEARCH_32BIT_BE:
+         return ((uint32_t)data[0] << 24) | (data[1] << 16)
+            | (data[2] << 8) | data[3];
+      default:
+         break;
+   }
+
+   return data[0];
+}
+
+static void cheat_search_store(uint8_t *data,
+      enum cheat_search_type type, uint32_t value)
+{
+   switch (type)
+   {
+      case CHEAT_SEARCH_16BIT_LE:
+         data[0] = value;
+         data[1] = value >> 8;
+         break;
+      case CHEAT_SEARCH_16BIT_BE:
+         data[0] = value >> 8;
+         data[1] = value;
+         break;
+      case CHEAT_SEARCH_32BIT_LE:
+         data[0] = value;
+         data[1] = value >> 8;
+         data[2] = value >> 16;
+         data[3] = value >> 24;
+         break;
+      case CHEAT_SEARCH_32BIT_BE:
+         data[0] = value >> 24;
+         data[1] = value >> 16;
+         data[2] = value >> 8;
+         data[3] = value;
+         break;
+      default:
+         data[0] = value;
+         break;
+   }
+}
+
+static INLINE bool cheat_search_test(uint32_t a, uint32_t b,
+      enum cheat_search_cmp cmp)
+{
+   switch (cmp)
+   {
+      case CHEAT_SEARCH_CMP_EQ:
+         return a == b;
+      case CHEAT_SEARCH_CMP_NEQ:
+         return a != b;
+      case CHEAT_SEARCH_CMP_GT:
+         return a > b;
+      case CHEAT_SEARCH_CMP_LT:
+         return a < b;
+      default:
+         break;
+   }
+
+   return true;
+}
+
+/**
+ * cheat_search_block_c:
+ * @search                    : Cheat search handle.
+ * @cur                       : Current values of the block.
+ * @prev                      : Previous values of the block, or NULL
+ *                              to compare against @value.
+ * @value                     : Value to compare against.
+ * @cmp                       : Comparison.
+ * @n                         : Candidates in the block.
+ *
+ * Returns: bitmask of candidates that pass @cmp.
+ **/
+static uint32_t cheat_search_block_c(const cheat_search_t *search,
+      const uint8_t *cur, const uint8_t *prev, uint32_t value,
+      enum cheat_search_cmp cmp, unsigned n)
+{
+   unsigned i;
+   uint32_t mask = 0;
+
+   for (i = 0; i < n; i++)
+   {
+      size_t offset = i * search->width;
+      uint32_t a    = cheat_search_read(cur + offset, search->type);
+      uint32_t b    = prev ?
+         cheat_search_read(prev + offset, search->type) : value;
+
+      if (cheat_search_test(a, b, cmp))
+         mask |= 1u << i;
+   }
+
+   return mask;
+}
+
+#if defined(__SSE2__)
+static INLINE __m128i cheat_search_bswap_sse2(__m128i v, unsigned width)
+{
+   if (width == 1)
+      return v;
+
+   v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+   if (width == 4)
+      v = _mm_or_si128(_mm_slli_epi32(v, 16), _mm_srli_epi32(v, 16));
+   return v;
+}
+
+/* Lanes are all ones where @a passes @cmp against @b. SSE2 only
+ * has signed compares, so ordering flips the sign bits first. */
+static INLINE __m128i cheat_search_compare_sse2(__m128i a, __m128i b,
+      unsigned width, enum cheat_search_cmp cmp)
+{
+   __m128i eq, bias;
+
+   switch (width)
+   {
+      case 1:
+         eq   = _mm_cmpeq_epi8(a, b);
+         bias = _mm_set1_epi8((char)0x80);
+         break;
+      case 2:
+         eq   = _mm_cmpeq_epi16(a, b);
+         bias = _mm_set1_epi16((short)0x8000);
+         break;
+      default:
+         eq   = _mm_cmpeq_epi32(a, b);
+         bias = _mm_set1_epi32((int)0x80000000);
+         break;
+   }
+
+   switch (cmp)
+   {
+      case CHEAT_SEARCH_CMP_EQ:
+         return eq;
+      case CHEAT_SEARCH_CMP_NEQ:
+         return _mm_andnot_si128(eq, _mm_set1_epi32(-1));
+      case CHEAT_SEARCH_CMP_LT:
+         {
+            __m128i t = a;
+            a = b;
+            b = t;
+         }
+         /* fall-through */
+      case CHEAT_SEARCH_CMP_GT:
+         a = _mm_xor_si128(a, bias);
+         b = _mm_xor_si128(b, bias);
+         switch (width)
+         {
+            case 1:
+               return _mm_cmpgt_epi8(a, b);
+            case 2:
+               return _mm_cmpgt_epi16(a, b);
+            default:
+               return _mm_cmpgt_epi32(a, b);
+         }
+      default:
+         break;
+   }
+
+   return _mm_set1_epi32(-1);
+}
+
+/* Same as cheat_search_block_c() for a full block.
+ * @value holds the comparison value in RAM byte order. */
+static uint32_t cheat_search_block_sse2(const cheat_search_t *search,
+      const uint8_t *cur, const uint8_t *prev, __m128i value,
+      enum cheat_search_cmp cmp)
+{
+   unsigned i;
+   __m128i m[8];
+   unsigned width = search->width;
+   bool swap      = (cmp == CHEAT_SEARCH_CMP_GT || cmp == CHEAT_SEARCH_CMP_LT)
+      && (search->type == CHEAT_SEARCH_16BIT_BE
+            || search->type == CHEAT_SEARCH_32BIT_BE);
+
+   for (i = 0; i < width * 2; i++)
+   {
+      __m128i a = _mm_loadu_si128((const __m128i*)(cur + i * 16));
+      __m128i b = prev ?
+         _mm_loadu_si128((const __m128i*)(prev + i * 16)) : value;
+
+      if (swap)
+      {
+         a = cheat_search_bswap_sse2(a, width);
+         b = cheat_search_bswap_sse2(b, width);
+      }
+
+      m[i] = cheat_search_compare_sse2(a, b, width, cmp);
+   }
+
+   /* Narrow lane masks down to one byte per candidate. */
+   switch (width)
+   {
+      case 1:
+         return (uint32_t)_mm_movemask_epi8(m[0])
+            | ((uint32_t)_mm_movemask_epi8(m[1]) << 16);
+      case 2:
+         return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(m[0], m[1]))
+            | ((uint32_t)_mm_movemask_epi8(
+                     _mm_packs_epi16(m[2], m[3])) << 16);
+      default:
+         break;
+   }
+
+   return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(
+            _mm_packs_epi32(m[0], m[1]), _mm_packs_epi32(m[2], m[3])))
+      | ((uint32_t)_mm_movemask_epi8(_mm_packs_epi16(
+                  _mm_packs_epi32(m[4], m[5]),
+                  _mm_packs_epi32(m[6], m[7]))) << 16);
+}
+#endif
+
+static bool cheat_search_get_ram(const uint8_t **ram, size_t *size)
+{
+   global_t *global = global_get_ptr();
+
+   if (!global || !global->main_is_init)
+      return false;
+
+   *ram  = (const uint8_t*)pretro_get_memory_data(RETRO_MEMORY_SYSTEM_RAM);
+   *size = pretro_get_memory_size(RETRO_MEMORY_SYSTEM_RAM);
+
+   return *ram && *size;
+}
+
+static void cheat_search_reset(cheat_search_t *search)
+{
+   free(search->prev);
+   free(search->bits);
+
+   search->prev       = NULL;
+   search->bits       = NULL;
+   search->size       = 0;
+   search->candidates = 0;
+   search->words      = 0;
+   search->count      = 0;
+   search->auto_cmp   = CHEAT_SEARCH_CMP_NONE;
+}
+
+cheat_search_t *cheat_search_new(void)
+{
+   return (cheat_search_t*)calloc(1, sizeof(cheat_search_t));
+}
+
+void cheat_search_free(cheat_search_t *search)
+{
+   if (!search)
+      return;
+
+   cheat_search_reset(search);
+   free(search);
+}
+
+bool cheat_search_start(cheat_search_t *search,
+      enum cheat_search_type type)
+{
+   size_t i;
+   const uint8_t *ram = NULL;
+   size_t size        = 0;
+
+   if (!search || type >= CHEAT_SEARCH_TYPE_LAST)
+      return false;
+
+   cheat_search_reset(search);
+
+   if (!cheat_search_get_ram(&ram, &size))
+      return false;
+
+   search->type       = type;
+   search->width      = cheat_search_widths[type];
+   search->size       = size;
+   search->candidates = size / search->width;
+   search->words      = (search->candidates + CHEAT_SEARCH_BLOCK - 1)
+      / CHEAT_SEARCH_BLOCK;
+   search->count      = search->candidates;
+   search->prev       = (uint8_t*)malloc(size);
+   search->bits       = (uint32_t*)malloc(search->words * sizeof(uint32_t));
+
+   if (!search->prev || !search->bits || !search->candidates)
+   {
+      cheat_search_reset(search);
+      return false;
+   }
+
+   memcpy(search->prev, ram, size);
+   for (i = 0; i < search->words; i++)
+      search->bits[i] = ~(uint32_t)0;
+
+   if (search->candidates % CHEAT_SEARCH_BLOCK)
+      search->bits[search->words - 1] =
+         (1u << (search->candidates % CHEAT_SEARCH_BLOCK)) - 1;
+
+   RARCH_LOG("Cheat search: %u candidates (%s).\n",
+         (unsigned)search->count, cheat_search_type_str(type));
+
+   return true;
+}
+
+bool cheat_search_filter(cheat_search_t *search,
+      enum cheat_search_cmp cmp, bool use_value, uint32_t value)
+{
+   size_t i, full, count = 0;
+   size_t block_size     = 0;
+   const uint8_t *ram    = NULL;
+   size_t size           = 0;
+#if defined(__SSE2__)
+   uint8_t buf[16];
+   __m128i value_vec;
+#endif
+
+   if (!search || !search->bits || cmp >= CHEAT_SEARCH_CMP_LAST)
+      return false;
+
+   /* The SIMD and scalar paths must agree, so reject values
+    * which do not fit the search width instead of letting one
+    * truncate them. */
+   if (use_value && search->width < 4
+         && (value >> (8 * search->width)))
+   {
+      RARCH_WARN("Cheat search: value %u does not fit a %s search.\n",
+            (unsigned)value, cheat_search_type_str(search->type));
+      return false;
+   }
+
+   if (!cheat_search_get_ram(&ram, &size))
+      return false;
+
+   if (size != search->size)
+   {
+      RARCH_WARN("Cheat search: memory size changed, search reset.\n");
+      cheat_search_reset(search);
+      return false;
+   }
+
+   block_size = CHEAT_SEARCH_BLOCK * search->width;
+   full       = search->candidates / CHEAT_SEARCH_BLOCK;
+
+#if defined(__SSE2__)
+   for (i = 0; i < sizeof(buf); i += search->width)
+      cheat_search_store(buf + i, search->type, value);
+   value_vec = _mm_loadu_si128((const __m128i*)buf);
+#endif
+
+   for (i = 0; i < search->words; i++)
+   {
+      uint32_t bits     = search->bits[i];
+      size_t offset     = i * block_size;
+      const uint8_t *a  = ram + offset;
+      const uint8_t *b  = use_value ? NULL : search->prev + offset;
+      unsigned n        = CHEAT_SEARCH_BLOCK;
+
+      if (!bits)
+         continue;
+
+      if (i >= full)
+         n = search->candidates - i * CHEAT_SEARCH_BLOCK;
+
+#if defined(__SSE2__)
+      if (i < full)
+         bits &= cheat_search_block_sse2(search, a, b, value_vec, cmp);
+      else
+#endif
+         bits &= cheat_search_block_c(search, a, b, value, cmp, n);
+
+      search->bits[i] = bits;
+
+      if (!bits)
+         continue;
+
+      /* Survivors of an equality search already match the snapshot. */
+      if (use_value || cmp != CHEAT_SEARCH_CMP_EQ)
+         memcpy(search->prev + offset, a, n * search->width);
+      count += cheat_search_popcount(bits);
+   }
+
+   search->count = count;
+
+   return true;
+}
+
+void cheat_search_set_auto(cheat_search_t *search,
+      enum cheat_search_cmp cmp)
+{
+   if (!search || cmp >= CHEAT_SEARCH_CMP_LAST)
+      return;
+
+   search->auto_cmp   = search->bits ? cmp : CHEAT_SEARCH_CMP_NONE;
+   search->auto_armed = true;
+}
+
+void cheat_search_iterate(cheat_search_t *search)
+{
+   const uint8_t *ram = NULL;
+   size_t size        = 0;
+
+   if (!search || search->auto_cmp == CHEAT_SEARCH_CMP_NONE)
+      return;
+
+   /* Commands can arrive mid-frame from the core's input poll,
+    * so compare against a snapshot from the end of this frame. */
+   if (search->auto_armed)
+   {
+      if (cheat_search_get_ram(&ram, &size) && size == search->size)
+         memcpy(search->prev, ram, size);
+      search->auto_armed = false;
+      return;
+   }
+
+   cheat_search_filter(search, search->auto_cmp, false, 0);
+}
+
+void cheat_search_set_type(cheat_search_t *search,
+      enum cheat_search_type type)
+{
+   if (!search || type >= CHEAT_SEARCH_TYPE_LAST || type == search->type)
+      return;
+
+   cheat_search_reset(search);
+   search->type = type;
+}
+
+bool cheat_search_active(const cheat_search_t *search)
+{
+   return search && search->bits;
+}
+
+enum cheat_search_type cheat_search_get_type(const cheat_search_t *search)
+{
+   return search ? search->type : CHEAT_SEARCH_8BIT;
+}
+
+size_t cheat_search_count(const cheat_search_t *search)
+{
+   return search ? search->count : 0;
+}
+
+size_t cheat_search_results(const cheat_search_t *search, size_t start,
+      struct cheat_search_result *results, size_t max)
+{
+   size_t i, seen = 0, written = 0;
+   const uint8_t *ram = NULL;
+   size_t size        = 0;
+
+   if (!search || !search->bits || !max)
+      return 0;
+
+   if (!cheat_search_get_ram(&ram, &size) || size != search->size)
+      ram = search->prev;
+
+   for (i = 0; i < search->words && written < max; i++)
+   {
+      uint32_t bits = search->bits[i];
+      unsigned n    = cheat_search_popcount(bits);
+
+      if (seen + n <= start)
+      {
+         seen += n;
+         continue;
+      }
+
+      while (bits && written < max)
+      {
+         unsigned bit = 0;
+         size_t offset;
+
+         while (!(bits & (1u << bit)))
+            bit++;
+         bits &= ~(1u << bit);
+
+         if (seen++ < start)
+            continue;
+
+         offset = (i * CHEAT_SEARCH_BLOCK + bit) * search->width;
+         results[written].address = offset;
+         results[written].value   = cheat_search_read(ram + offset,
+               search->type);
+         results[written].prev    = cheat_search_read(search->prev + offset,
+               search->type);
+         written++;
+      }
+   }
+
+   return written;
+}
+
+const char *cheat_search_type_str(enum cheat_search_type type)
+{
+   switch (type)
+   {
+      case CHEAT_SEARCH_8BIT:
+         return "8-bit";
+      case CHEAT_SEARCH_16BIT_LE:
+         return "16-bit LE";
+      case CHEAT_SEARCH_16BIT_BE:
+         return "16-bit BE";
+      case CHEAT_SEARCH_32BIT_LE:
+         return "32-bit LE";
+      case CHEAT_SEARCH_32BIT_BE:
+         return "32-bit BE";
+      default:
+         break;
+   }
+
+   return "N/A";
+}
+
+const char *cheat_search_cmp_str(enum cheat_search_cmp cmp)
+{
+   switch (cmp)
+   {
+      case CHEAT_SEARCH_CMP_EQ:
+         return "EQ";
+      case CHEAT_SEARCH_CMP_NEQ:
+         return "NEQ";
+      case CHEAT_SEARCH_CMP_GT:
+         return "GT";
+      case CHEAT_SEARCH_CMP_LT:
+         return "LT";
+      default:
+         break;
+   }
+
+   return "NONE";
+}
@@ -0,0 +1,149 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_CHEAT_SEARCH_H
+#define __RARCH_CHEAT_SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* How values are laid out in core RAM. Wider values
+ * are searched at naturally aligned addresses only. */
+enum cheat_search_type
+{
+   CHEAT_SEARCH_8BIT = 0,
+   CHEAT_SEARCH_16BIT_LE,
+   CHEAT_SEARCH_16BIT_BE,
+   CHEAT_SEARCH_32BIT_LE,
+   CHEAT_SEARCH_32BIT_BE,
+   CHEAT_SEARCH_TYPE_LAST
+};
+
+enum cheat_search_cmp
+{
+   CHEAT_SEARCH_CMP_NONE = 0,
+   CHEAT_SEARCH_CMP_EQ,
+   CHEAT_SEARCH_CMP_NEQ,
+   CHEAT_SEARCH_CMP_GT,
+   CHEAT_SEARCH_CMP_LT,
+   CHEAT_SEARCH_CMP_LAST
+};
+
+struct cheat_search_result
+{
+   uint32_t address;
+   uint32_t value;
+   uint32_t prev;
+};
+
+typedef struct cheat_search cheat_search_t;
+
+cheat_search_t *cheat_search_new(void);
+
+void cheat_search_free(cheat_search_t *search);
+
+/**
+ * cheat_search_start:
+ * @search                    : Cheat search handle.
+ * @type                      : Value size and byte order.
+ *
+ * Snapshots system RAM of the loaded core and makes
+ * every address a candidate.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+bool cheat_search_start(cheat_search_t *search,
+      enum cheat_search_type type);
+
+/**
+ * cheat_search_filter:
+ * @search                    : Cheat search handle.
+ * @cmp                       : Comparison candidates must pass.
+ * @use_value                 : Compare against @value instead of
+ *                              the previous snapshot.
+ * @value                     : Value to compare against.
+ *
+ * Drops candidates whose current value fails @cmp and
+ * snapshots the values of the remaining ones.
+ *
+ * Returns: true (1) if successful, otherwise false (0),
+ * also if @value does not fit the width of the search.
+ **/
+bool cheat_search_filter(cheat_search_t *search,
+      enum cheat_search_cmp cmp, bool use_value, uint32_t value);
+
+/**
+ * cheat_search_set_auto:
+ * @search                    : Cheat search handle.
+ * @cmp                       : Comparison to apply every frame, or
+ *                              CHEAT_SEARCH_CMP_NONE to stop.
+ *
+ * Filters against the previous frame from cheat_search_iterate().
+ **/
+void cheat_search_set_auto(cheat_search_t *search,
+      enum cheat_search_cmp cmp);
+
+/**
+ * cheat_search_iterate:
+ * @search                    : Cheat search handle.
+ *
+ * Called once per frame after the core has run.
+ **/
+void cheat_search_iterate(cheat_search_t *search);
+
+/**
+ * cheat_search_set_type:
+ * @search                    : Cheat search handle.
+ * @type                      : Value size and byte order.
+ *
+ * Selects the type the next cheat_search_start() uses
+ * from the menu. Ends a search of a different type.
+ **/
+void cheat_search_set_type(cheat_search_t *search,
+      enum cheat_search_type type);
+
+bool cheat_search_active(const cheat_search_t *search);
+
+enum cheat_search_type cheat_search_get_type(const cheat_search_t *search);
+
+size_t cheat_search_count(const cheat_search_t *search);
+
+/**
+ * cheat_search_results:
+ * @search                    : Cheat search handle.
+ * @start                     : Index of the first candidate to return.
+ * @results                   : Output array.
+ * @max                       : Size of @results.
+ *
+ * Returns: number of results written.
+ **/
+size_t cheat_search_results(const cheat_search_t *search, size_t start,
+      struct cheat_search_result *results, size_t max);
+
+const char *cheat_search_type_str(enum cheat_search_type type);
+
+const char *cheat_search_cmp_str(enum cheat_search_cmp cmp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -39,9 +39,11 @@
 
 #include "general.h"
 #include "runloop.h"
+#include "cheat_search.h"
 
 #define DEFAULT_NETWORK_CMD_PORT 55355
 #define STDIN_BUF_SIZE 4096
+#define CMD_REPLY_SIZE 1024
 
 struct rarch_cmd
 {
@@ -53,6 +55,10 @@ struct rarch_cmd
 
 #if defined(HAVE_NETWORK_CMD) && defined(HAVE_NETPLAY)
    int net_fd;
+
+   /* Sender of the datagram being parsed, replies go here. */
+   struct sockaddr_storage reply_addr;
+   socklen_t reply_addr_len;
 #endif
 
    retro_input_t state;
@@ -176,7 +182,7 @@ struct cmd_map
 struct cmd_action_map
 {
    const char *str;
-   bool (*action)(const char *arg);
+   bool (*action)(rarch_cmd_t *handle, const char *arg);
    const char *arg_desc;
 };
 
@@ -224,7 +230,30 @@ static const struct cmd_map map[] = {
 #define COMMAND_EXT_CG        0x0059776fU
 #define COMMAND_EXT_CGP       0x0b8865bfU
 
-static bool cmd_set_shader(const char *arg)
+/**
+ * cmd_reply:
+ * @handle                    : Command handle.
+ * @msg                       : Reply, newline terminated.
+ *
+ * Answers the command being parsed, to the sender of the
+ * datagram for network commands, otherwise on stdout.
+ **/
+static void cmd_reply(rarch_cmd_t *handle, const char *msg)
+{
+#if defined(HAVE_NETWORK_CMD) && defined(HAVE_NETPLAY)
+   if (handle->reply_addr_len)
+   {
+      sendto(handle->net_fd, msg, strlen(msg), 0,
+            (struct sockaddr*)&handle->reply_addr, handle->reply_addr_len);
+      return;
+   }
+#endif
+
+   fputs(msg, stdout);
+   fflush(stdout);
+}
+
+static bool cmd_set_shader(rarch_cmd_t *handle, const char *arg)
 {
    char msg[PATH_MAX_LENGTH]   = {0};
    enum rarch_shader_type type = RARCH_SHADER_NONE;
@@ -252,8 +281,119 @@ static bool cmd_set_shader(const char *arg)
    return video_driver_set_shader(type, arg);
 }
 
+static const char *cheat_search_type_args[CHEAT_SEARCH_TYPE_LAST] = {
+   "8", "16LE", "16BE", "32LE", "32BE"
+};
+
+static const char *cheat_search_cmp_args[CHEAT_SEARCH_CMP_LAST] = {
+   "OFF", "EQ", "NEQ", "GT", "LT"
+};
+
+static bool cmd_cheat_search_list(rarch_cmd_t *handle,
+      cheat_search_t *search, size_t start)
+{
+   size_t i, count;
+   struct cheat_search_result results[32];
+   char reply[CMD_REPLY_SIZE] = {0};
+   size_t len                 = 0;
+
+   count = cheat_search_results(search, start,
+         results, ARRAY_SIZE(results));
+
+   len += snprintf(reply + len, sizeof(reply) - len,
+         "CHEAT_SEARCH %u\n", (unsigned)cheat_search_count(search));
+
+   for (i = 0; i < count; i++)
+      len += snprintf(reply + len, sizeof(reply) - len, "%06x %u %u\n",
+            (unsigned)results[i].address, (unsigned)results[i].value,
+            (unsigned)results[i].prev);
+
+   cmd_reply(handle, reply);
+   return true;
+}
+
+/* CHEAT_SEARCH START [8|16LE|16BE|32LE|32BE]
+ * CHEAT_SEARCH EQ|NEQ|GT|LT [value]
+ * CHEAT_SEARCH AUTO OFF|EQ|NEQ|GT|LT
+ * CHEAT_SEARCH LIST [first]
+ *
+ * Replies with the candidate count, LIST adds up to 32
+ * lines of "<address> <value> <previous value>". */
+static bool cmd_cheat_search(rarch_cmd_t *handle, const char *arg)
+{
+   unsigned i;
+   char op[16]      = {0};
+   char param[16]   = {0};
+   char reply[64]   = {0};
+   global_t *global = global_get_ptr();
+   int args         = sscanf(arg, "%15s %15s", op, param);
+
+   if (args < 1 || !global)
+      return false;
+
+   if (!global->cheat_search)
+      global->cheat_search = cheat_search_new();
+   if (!global->cheat_search)
+      return false;
+
+   if (!strcmp(op, "START"))
+   {
+      enum cheat_search_type type = CHEAT_SEARCH_8BIT;
+
+      if (args > 1)
+      {
+         for (i = 0; i < CHEAT_SEARCH_TYPE_LAST; i++)
+            if (!strcmp(param, cheat_search_type_args[i]))
+               break;
+         if (i == CHEAT_SEARCH_TYPE_LAST)
+            return false;
+         type = (enum cheat_search_type)i;
+      }
+
+      if (!cheat_search_start(global->cheat_search, type))
+         return false;
+   }
+   else if (!strcmp(op, "LIST"))
+      return cmd_cheat_search_list(handle, global->cheat_search,
+            args > 1 ? strtoul(param, NULL, 0) : 0);
+   else if (!strcmp(op, "AUTO"))
+   {
+      if (args < 2)
+         return false;
+
+      for (i = 0; i < CHEAT_SEARCH_CMP_LAST; i++)
+         if (!strcmp(param, cheat_search_cmp_args[i]))
+            break;
+      if (i == CHEAT_SEARCH_CMP_LAST)
+         return false;
+
+      cheat_search_set_auto(global->cheat_search,
+            (enum cheat_search_cmp)i);
+   }
+   else
+   {
+      for (i = CHEAT_SEARCH_CMP_EQ; i < CHEAT_SEARCH_CMP_LAST; i++)
+         if (!strcmp(op, cheat_search_cmp_args[i]))
+            break;
+      if (i == CHEAT_SEARCH_CMP_LAST)
+         return false;
+
+      if (!cheat_search_filter(global->cheat_search,
+               (enum cheat_search_cmp)i, args > 1,
+               args > 1 ? strtoul(param, NULL, 0) : 0))
+         return false;
+   }
+
+   snprintf(reply, sizeof(reply), "CHEAT_SEARCH %u\n",
+         (unsigned)cheat_search_count(global->cheat_search));
+   cmd_reply(handle, reply);
+
+   return true;
+}
+
 static const struct cmd_action_map action_map[] = {
-   { "SET_SHADER", cmd_set_shader, "<shader path>" },
+   { "SET_SHADER",   cmd_set_shader,   "<shader path>" },
+   { "CHEAT_SEARCH", cmd_cheat_search, "<operation> [argument]" },
 };
 
 static bool command_get_arg(const char *tok,
@@ -306,7 +446,7 @@ static void parse_sub_msg(rarch_cmd_t *handle, const char *tok)
    {
       if (arg)
       {
-         if (!action_map[index].action(arg))
+         if (!action_map[index].action(handle, arg))
             RARCH_ERR("Command \"%s\" failed.\n", arg);
       }
       else
@@ -364,14 +504,21 @@ static void network_cmd_poll(rarch_cmd_t *handle)
    for (;;)
    {
       char buf[1024];
-      ssize_t ret = recvfrom(handle->net_fd, buf,
-            sizeof(buf) - 1, 0, NULL, NULL);
+      ssize_t ret;
+
+      handle->reply_addr_len = sizeof(handle->reply_addr);
+      ret = recvfrom(handle->net_fd, buf, sizeof(buf) - 1, 0,
+            (struct sockaddr*)&handle->reply_addr, &handle->reply_addr_len);
 
       if (ret <= 0)
+      {
+         handle->reply_addr_len = 0;
          break;
+      }
 
       buf[ret] = '\0';
       parse_msg(handle, buf);
+      handle->reply_addr_len = 0;
    }
 }
 #endif
@@ -22,6 +22,7 @@
 #include "runloop_data.h"
 #include "runloop.h"
 #include "dynamic.h"
+#include "libretro_version_1.h"
 #include "content.h"
 #include "screenshot.h"
 #include "intl/intl.h"
@@ -580,6 +581,8 @@ static bool event_init_content(void)
    if (!init_content_file())
       return false;
 
+   event_command(EVENT_CMD_MOVIE_INIT);
+
    if (global->libretro_no_content)
       return true;
 
@@ -950,6 +953,9 @@ bool event_command(enum event_command cmd)
          if (global->cheat)
             cheat_manager_free(global->cheat);
          global->cheat = NULL;
+
+         cheat_search_free(global->cheat_search);
+         global->cheat_search = NULL;
          break;
       case EVENT_CMD_CHEATS_INIT:
          event_command(EVENT_CMD_CHEATS_DEINIT);
@@ -1358,6 +1364,12 @@ bool event_command(enum event_command cmd)
       case EVENT_CMD_PREEMPT_FRAMES_UPDATE:
          update_preempt_frames();
          break;
+      case EVENT_CMD_MOVIE_INIT:
+         init_movie();
+         break;
+      case EVENT_CMD_MOVIE_DEINIT:
+         deinit_movie();
+         break;
       case EVENT_CMD_FULLSCREEN_TOGGLE:
          if (!video_driver_has_windowed())
             return false;
@@ -1483,6 +1495,7 @@ bool event_command(enum event_command cmd)
          break;
       case EVENT_CMD_PERFCNT_REPORT_FRONTEND_LOG:
          rarch_perf_log();
+         input_state_perf_log();
          break;
       case EVENT_CMD_VOLUME_UP:
          event_set_volume(0.5f);
@@ -157,6 +157,10 @@ enum event_command
    /* Flip netplay players. */
    EVENT_CMD_NETPLAY_FLIP_PLAYERS,
    EVENT_CMD_PREEMPT_FRAMES_UPDATE,
+   /* Starts input log playback or recording. */
+   EVENT_CMD_MOVIE_INIT,
+   /* Stops input log playback or recording. */
+   EVENT_CMD_MOVIE_DEINIT,
    /* Initializes command interface. */
    EVENT_CMD_COMMAND_INIT,
    /* Deinitialize command interface. */
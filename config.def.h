@@ -397,6 +397,11 @@ static const unsigned hard_sync_frames = 1;
  */
 static const unsigned frame_delay = 0;
 
+/* Picks the frame delay from measured core run time instead,
+ * using frame_delay as the upper limit (15 ms if 0). Backs off
+ * when frames are missed. */
+static const bool frame_delay_auto = false;
+
 /* Inserts a black frame inbetween frames.
  * Useful for 120 Hz monitors who want to play 60 Hz material with eliminated 
  * ghosting. video_refresh_rate should still be configured as if it 
@@ -421,6 +426,13 @@ static bool fake_swap_interval = false;
  */
 static const bool video_threaded = false;
 
+/* Upload software-rendered frames through pixel buffer objects
+ * (persistently mapped where supported) instead of client memory.
+ * Lets the driver copy asynchronously; helps on drivers where
+ * plain texture uploads stall. GL only.
+ */
+static const bool video_pbo_upload = false;
+
 /* Set to true if HW render cores should get their private context. */
 static const bool video_shared_context = false;
 
@@ -571,6 +583,10 @@ static const bool post_filter_record = false;
 /* Screenshots post-shaded GPU output if available. */
 static const bool gpu_screenshot = true;
 
+/* Encode PNG screenshots with a single fixed filter and the
+ * fastest compression level. Larger files, less CPU time. */
+static const bool fast_screenshot = false;
+
 /* Record post-shaded GPU output instead of raw game footage if available. */
 static const bool gpu_record = false;
 
@@ -646,6 +662,11 @@ static const bool rewind_enable = false;
 /* The buffer size for the rewind buffer. Very core dependant. */
 static const unsigned rewind_buffer_size = 20; /* 20MiB */
 
+/* Size of the cache of archived content extracted for cores
+ * that load from a path, in MiB. With 0, content is extracted
+ * again on every launch. Needs an extraction directory. */
+static const unsigned extraction_cache_size = 4096;
+
 /* How many frames to rewind at a time. */
 static const unsigned rewind_granularity = 1;
 
@@ -680,6 +701,11 @@ static const bool savestate_auto_load = false;
 /* Slowmotion ratio. */
 static const float slowmotion_ratio = 3.0;
 
+/* When throttling, sleep until this many microseconds before
+ * a frame is due and yield the CPU for the rest. Higher values
+ * pace frames more evenly at the cost of CPU time. */
+static const unsigned frame_throttle_spin = 1000;
+
 /* Maximum fast forward ratio. */
 static const float fastforward_ratio = 1.0;
 
@@ -729,6 +755,10 @@ static const float axis_threshold = 0.5f;
  * gamepads, plug-and-play style. */
 static const bool input_autodetect_enable = true;
 
+/* Read udev input on a separate thread which blocks on evdev,
+ * instead of draining events once per frame. */
+static const bool input_udev_thread = false;
+
 #if defined(ANDROID)
 #if defined(ANDROID_ARM)
 static char buildbot_server_url[] = "http://buildbot.libretro.com/nightly/android/latest/armeabi-v7a/";
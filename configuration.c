@@ -480,6 +480,7 @@ static void config_set_defaults(void)
    settings->video.hard_sync             = hard_sync;
    settings->video.hard_sync_frames      = hard_sync_frames;
    settings->video.frame_delay           = frame_delay;
+   settings->video.frame_delay_auto      = frame_delay_auto;
    settings->video.black_frame_insertion = black_frame_insertion;
    settings->video.swap_interval         = swap_interval;
    settings->video.fake_swap_interval    = fake_swap_interval;
@@ -488,6 +489,8 @@ static void config_set_defaults(void)
    if (g_defaults.settings.video_threaded_enable != video_threaded)
       settings->video.threaded           = g_defaults.settings.video_threaded_enable;
 
+   settings->video.pbo_upload            = video_pbo_upload;
+
    settings->video.shared_context              = video_shared_context;
    settings->video.force_srgb_disable          = false;
 #ifdef GEKKO
@@ -521,6 +524,7 @@ static void config_set_defaults(void)
    settings->video.post_filter_record          = post_filter_record;
    settings->video.gpu_record                  = gpu_record;
    settings->video.gpu_screenshot              = gpu_screenshot;
+   settings->video.fast_screenshot             = fast_screenshot;
    settings->video.rotation                    = ORIENTATION_NORMAL;
 
    settings->audio.enable                      = audio_enable;
@@ -546,8 +550,10 @@ static void config_set_defaults(void)
    settings->rewind_enable                     = rewind_enable;
    settings->rewind_buffer_size                = rewind_buffer_size;
    settings->rewind_granularity                = rewind_granularity;
+   settings->extraction_cache_size             = extraction_cache_size;
    settings->slowmotion_ratio                  = slowmotion_ratio;
    settings->fastforward_ratio                 = fastforward_ratio;
+   settings->frame_throttle_spin               = frame_throttle_spin;
    settings->throttle_using_core_fps           = throttle_using_core_fps;
    settings->pause_nonactive                   = pause_nonactive;
    settings->autosave_interval                 = autosave_interval;
@@ -656,6 +662,7 @@ static void config_set_defaults(void)
    settings->input.netplay_client_swap_input       = netplay_client_swap_input;
    
    settings->input.autodetect_enable               = input_autodetect_enable;
+   settings->input.udev_thread                     = input_udev_thread;
    *settings->input.keyboard_layout                = '\0';
 
 #ifdef HAVE_OVERLAY
@@ -1325,6 +1332,7 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_INT_BASE(conf, settings, video.frame_delay, "video_frame_delay");
    if (settings->video.frame_delay > 15)
       settings->video.frame_delay = 15;
+   CONFIG_GET_BOOL_BASE(conf, settings, video.frame_delay_auto, "video_frame_delay_auto");
 
    CONFIG_GET_BOOL_BASE(conf, settings, video.black_frame_insertion, "video_black_frame_insertion");
    CONFIG_GET_INT_BASE(conf, settings, video.swap_interval, "video_swap_interval");
@@ -1333,6 +1341,7 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_BOOL_BASE(conf, settings, video.fake_swap_interval, "video_fake_swap_interval");
    CONFIG_GET_BOOL_BASE(conf, settings, video.threaded, "video_threaded");
    CONFIG_GET_BOOL_BASE(conf, settings, video.shared_context, "video_shared_context");
+   CONFIG_GET_BOOL_BASE(conf, settings, video.pbo_upload, "video_pbo_upload");
 #ifdef GEKKO
    CONFIG_GET_INT_BASE(conf, settings, video.viwidth, "video_viwidth");
    CONFIG_GET_BOOL_BASE(conf, settings, video.vfilter, "video_vfilter");
@@ -1407,6 +1416,7 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_BOOL_BASE(conf, settings, video.post_filter_record, "video_post_filter_record");
    CONFIG_GET_BOOL_BASE(conf, settings, video.gpu_record, "video_gpu_record");
    CONFIG_GET_BOOL_BASE(conf, settings, video.gpu_screenshot, "video_gpu_screenshot");
+   CONFIG_GET_BOOL_BASE(conf, settings, video.fast_screenshot, "video_fast_screenshot");
 
    config_get_path(conf, "video_shader_dir", settings->video.shader_dir, sizeof(settings->video.shader_dir));
    if (!strcmp(settings->video.shader_dir, "default"))
@@ -1553,6 +1563,7 @@ static bool config_load_file(const char *path, bool set_defaults)
    }
    
    config_get_path(conf, "extraction_directory", settings->extraction_directory, sizeof(settings->extraction_directory));
+   CONFIG_GET_INT_BASE(conf, settings, extraction_cache_size, "extraction_cache_size");
    config_get_path(conf, "input_remapping_directory", settings->input_remapping_directory, sizeof(settings->input_remapping_directory));
    config_get_path(conf, "core_assets_directory", settings->core_assets_directory, sizeof(settings->core_assets_directory));
    config_get_path(conf, "assets_directory", settings->assets_directory, sizeof(settings->assets_directory));
@@ -1652,6 +1663,7 @@ static bool config_load_file(const char *path, bool set_defaults)
       settings->slowmotion_ratio = 1.0f;
 
    CONFIG_GET_FLOAT_BASE(conf, settings, fastforward_ratio, "fastforward_ratio");
+   CONFIG_GET_INT_BASE(conf, settings, frame_throttle_spin, "frame_throttle_spin");
 
    /* Sanitize fastforward_ratio value - previously range was -1
     * and up (with 0 being skipped) */
@@ -1676,6 +1688,7 @@ static bool config_load_file(const char *path, bool set_defaults)
    CONFIG_GET_BOOL_BASE(conf, settings, stdin_cmd_enable, "stdin_cmd_enable");
 
    CONFIG_GET_BOOL_BASE(conf, settings, input.autodetect_enable, "input_autodetect_enable");
+   CONFIG_GET_BOOL_BASE(conf, settings, input.udev_thread, "input_udev_thread");
    CONFIG_GET_PATH_BASE(conf, settings, input.autoconfig_dir, "joypad_autoconfig_dir");
 
    if (!global->has_set_username)
@@ -2036,6 +2049,7 @@ bool main_config_file_save(const char *path)
    config_set_int(conf,   "video_monitor_index", settings->video.monitor_index);
    config_set_string(conf,"video_context_driver", settings->video.context_driver);
    config_set_bool(conf,  "video_shared_context", settings->video.shared_context);
+   config_set_bool(conf,  "video_pbo_upload", settings->video.pbo_upload);
    config_set_float(conf, "video_refresh_rate", settings->video.refresh_rate);
    config_set_bool(conf,  "fps_show", settings->fps_show);
    if (settings->video.vsync_scope == GLOBAL)
@@ -2089,12 +2103,15 @@ bool main_config_file_save(const char *path)
       config_set_int(conf, "preempt_frames", settings->preempt_frames);
    if (settings->video.frame_delay_scope == GLOBAL)
       config_set_int(conf, "video_frame_delay", settings->video.frame_delay);
+   config_set_bool(conf,  "video_frame_delay_auto",
+         settings->video.frame_delay_auto);
    config_set_bool(conf,  "video_black_frame_insertion",
          settings->video.black_frame_insertion);
    config_set_bool(conf,  "video_disable_composition",
          settings->video.disable_composition);
    config_set_bool(conf,  "pause_nonactive", settings->pause_nonactive);
    config_set_bool(conf, "video_gpu_screenshot", settings->video.gpu_screenshot);
+   config_set_bool(conf, "video_fast_screenshot", settings->video.fast_screenshot);
    
    if (settings->video.rotation_scope == GLOBAL)
       config_set_int(conf, "video_rotation", settings->video.rotation);
@@ -2232,6 +2249,8 @@ bool main_config_file_save(const char *path)
 
    config_set_path(conf, "extraction_directory",
          settings->extraction_directory);
+   config_set_int(conf, "extraction_cache_size",
+         settings->extraction_cache_size);
    config_set_path(conf, "core_assets_directory",
          *settings->core_assets_directory ?
          settings->core_assets_directory : "default");
@@ -2281,6 +2300,8 @@ bool main_config_file_save(const char *path)
          settings->input_remapping_directory);
    config_set_bool(conf, "input_autodetect_enable",
          settings->input.autodetect_enable);
+   config_set_bool(conf, "input_udev_thread",
+         settings->input.udev_thread);
    config_set_path(conf, "joypad_autoconfig_dir",
          settings->input.autoconfig_dir);
    config_set_bool(conf, "autoconfig_descriptor_label_show",
@@ -2370,6 +2391,7 @@ bool main_config_file_save(const char *path)
    }
    
    config_set_float(conf, "slowmotion_ratio", settings->slowmotion_ratio);
+   config_set_int(conf, "frame_throttle_spin", settings->frame_throttle_spin);
 
 #ifdef HAVE_NETPLAY
    config_set_bool(conf, "netplay_mode", global->netplay_is_client);
@@ -76,6 +76,7 @@ typedef struct settings
       unsigned hard_sync_frames;
       unsigned frame_delay;
       unsigned frame_delay_scope;
+      bool frame_delay_auto;
 #ifdef GEKKO
       unsigned viwidth;
       bool vfilter;
@@ -98,6 +99,7 @@ typedef struct settings
       float refresh_rate;
       bool threaded;
       unsigned threaded_scope;
+      bool pbo_upload;
 
       char filter_dir[PATH_MAX_LENGTH];
       char shader_dir[PATH_MAX_LENGTH];
@@ -116,6 +118,7 @@ typedef struct settings
       bool post_filter_record;
       bool gpu_record;
       bool gpu_screenshot;
+      bool fast_screenshot;
 
       bool allow_rotate;
       bool shared_context;
@@ -291,6 +294,7 @@ typedef struct settings
       unsigned joypad_map[MAX_USERS];
       char device_names[MAX_USERS][64];
       bool autodetect_enable;
+      bool udev_thread;
       bool netplay_client_swap_input;
 
       bool overlay_enable;
@@ -362,6 +366,7 @@ typedef struct settings
    char system_directory[PATH_MAX_LENGTH];
 
    char extraction_directory[PATH_MAX_LENGTH];
+   unsigned extraction_cache_size; /* MB */
 
    bool rewind_enable;
    unsigned rewind_buffer_size; /* MB */
@@ -372,6 +377,7 @@ typedef struct settings
 
    float slowmotion_ratio;
    float fastforward_ratio;
+   unsigned frame_throttle_spin; /* usec */
    bool core_throttle_enable;
    unsigned throttle_setting_scope;
    bool throttle_using_core_fps;
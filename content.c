@@ -28,6 +28,22 @@
 #include <rhash.h>
 #include <file/file_extract.h>
 
+#ifdef HAVE_COMPRESSION
+#include "extract_cache.h"
+#endif
+
+#if defined(HAVE_THREADS)
+#include "autosave.h"
+#include <rthreads/rthreads.h>
+#endif
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef _WIN32
 #ifdef _XBOX
 #include <xtl.h>
@@ -40,11 +56,179 @@
 #endif
 #endif
 
+/* Checksum of the first content file. It runs on a thread
+ * while patches are looked up and the remaining content is
+ * read, which also pages mapped content in ahead of the core. */
+struct content_crc
+{
+   const uint8_t *data;
+   size_t size;
+   uint32_t crc;
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+#endif
+};
+
+static void content_crc_calculate(struct content_crc *crc)
+{
+#ifdef HAVE_ZLIB
+   crc->crc = zlib_crc32_continue(0, crc->data, crc->size);
+#endif
+}
+
+#ifdef HAVE_THREADS
+static void content_crc_thread(void *data)
+{
+   content_crc_calculate((struct content_crc*)data);
+}
+#endif
+
+static void content_crc_start(struct content_crc *crc,
+      const uint8_t *data, size_t size)
+{
+   crc->data = data;
+   crc->size = size;
+   crc->crc  = 0;
+
+#ifdef HAVE_THREADS
+   crc->thread = sthread_create(content_crc_thread, crc);
+   if (crc->thread)
+      return;
+#endif
+
+   content_crc_calculate(crc);
+}
+
+/**
+ * content_crc_finish:
+ * @crc          : checksum started with content_crc_start().
+ *
+ * Waits for the checksum. Must be called before the
+ * checksummed buffer is released.
+ *
+ * Returns: CRC32 of the buffer.
+ **/
+static uint32_t content_crc_finish(struct content_crc *crc)
+{
+#ifdef HAVE_THREADS
+   if (crc->thread)
+      sthread_join(crc->thread);
+   crc->thread = NULL;
+#endif
+   crc->data = NULL;
+   return crc->crc;
+}
+
+/**
+ * content_crc_store:
+ * @crc          : checksum started with content_crc_start(), if any.
+ *
+ * Waits for the checksum and stores it as the content CRC.
+ * Cores may modify content in place, so this must be called
+ * before the core gets to see it.
+ **/
+static void content_crc_store(struct content_crc *crc)
+{
+   uint32_t content_crc;
+   global_t *global = global_get_ptr();
+
+   if (!crc->data)
+      return;
+
+   content_crc = content_crc_finish(crc);
+#ifdef HAVE_ZLIB
+   global->content_crc = content_crc;
+   RARCH_LOG("CRC32: 0x%x .\n", (unsigned)global->content_crc);
+#endif
+   (void)content_crc;
+   (void)global;
+}
+
+/**
+ * content_file_map:
+ * @path         : path of the content file.
+ * @buf          : mapped contents of the file.
+ * @length       : size of the file.
+ * @map_size     : size of the mapping, for content_file_free().
+ *
+ * Maps a content file privately, so cores may still write to it.
+ * The mapping is followed by at least one zero byte, like the
+ * buffers from read_file().
+ *
+ * Returns: true if successful, false if the file should be read instead.
+ **/
+static bool content_file_map(const char *path, void **buf,
+      ssize_t *length, size_t *map_size)
+{
+#ifdef HAVE_MMAP
+   struct stat st;
+   size_t page, size;
+   uint8_t *map = (uint8_t*)MAP_FAILED;
+   int fd       = -1;
+
+   if (path_contains_compressed_file(path))
+      return false;
+
+   if ((fd = open(path, O_RDONLY)) < 0)
+      return false;
+
+   if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0
+         || (uint64_t)st.st_size >= (size_t)-1)
+      goto error;
+
+   /* Reserve zeroed pages past the end for the terminator,
+    * then map the file over the start of them. */
+   page = sysconf(_SC_PAGESIZE);
+   size = ((size_t)st.st_size + page) & ~(page - 1);
+
+   map  = (uint8_t*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (map == (uint8_t*)MAP_FAILED)
+      goto error;
+
+   if (mmap(map, st.st_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+   {
+      munmap(map, size);
+      goto error;
+   }
+
+   close(fd);
+
+#if defined(MADV_WILLNEED)
+   madvise(map, st.st_size, MADV_WILLNEED);
+#endif
+
+   *buf      = map;
+   *length   = st.st_size;
+   *map_size = size;
+   return true;
+
+error:
+   close(fd);
+#endif
+   return false;
+}
+
+static void content_file_free(void *buf, size_t map_size)
+{
+#ifdef HAVE_MMAP
+   if (map_size)
+   {
+      munmap(buf, map_size);
+      return;
+   }
+#endif
+   free(buf);
+}
+
 /**
  * read_content_file:
  * @path         : buffer of the content file.
  * @buf          : size   of the content file.
  * @length       : size of the content file that has been read from.
+ * @map_size     : size of the mapping if @buf is mapped, otherwise 0.
+ * @crc          : checksum of the patched content, started here.
  *
  * Read the content file. If read into memory, also performs soft patching
  * (see patch_content function) in case soft patching has not been
@@ -53,31 +237,38 @@
  * Returns: true if successful, false on error.
  **/
 static bool read_content_file(unsigned i, const char *path, void **buf,
-      ssize_t *length)
+      ssize_t *length, size_t *map_size, struct content_crc *crc)
 {
    uint8_t *ret_buf = NULL;
    global_t *global = global_get_ptr();
 
    RARCH_LOG("Loading content file: %s.\n", path);
-   if (!read_file(path, (void**) &ret_buf, length))
+
+   *map_size = 0;
+   if (!content_file_map(path, (void**)&ret_buf, length, map_size)
+         && !read_file(path, (void**) &ret_buf, length))
       return false;
 
    if (*length < 0)
       return false;
 
+   *buf = ret_buf;
+
    if (i != 0)
       return true;
 
+   content_crc_start(crc, ret_buf, *length);
+
    /* Attempt to apply a patch. */
-   if (!global->block_patch)
-      patch_content(&ret_buf, length);
-   
-#ifdef HAVE_ZLIB
-   global->content_crc = zlib_crc32_calculate(ret_buf, *length);
+   if (!global->block_patch && patch_content(&ret_buf, length))
+   {
+      content_crc_finish(crc);
+      content_file_free(*buf, *map_size);
 
-   RARCH_LOG("CRC32: 0x%x .\n", (unsigned)global->content_crc);
-#endif
-   *buf = ret_buf;
+      *buf      = ret_buf;
+      *map_size = 0;
+      content_crc_start(crc, ret_buf, *length);
+   }
 
    return true;
 }
@@ -283,6 +474,10 @@ void load_ram_file(const char *path, int type)
    if (size == 0 || !data)
       return;
 
+#if defined(HAVE_THREADS)
+   autosave_recover(path);
+#endif
+
    ret = read_rzip_file(path, &buf, &rc);
    if (!ret)
       ret = read_file(path, &buf, &rc);
@@ -344,19 +539,16 @@ void save_ram_file(const char *path, int type)
 }
 
 static bool load_content_dont_need_fullpath(
-      struct retro_game_info *info, unsigned i, const char *path)
+      struct retro_game_info *info, unsigned i, const char *path,
+      size_t *map_size, struct content_crc *crc)
 {
    ssize_t len;
    /* Load the content into memory. */
 
    /* First content file is significant, attempt to do patching,
     * CRC checking, etc. */
-   bool ret = false;
-
-   if (i == 0)
-      ret = read_content_file(i, path, (void**)&info->data, &len);
-   else
-      ret = read_file(path, (void**)&info->data, &len);
+   bool ret = read_content_file(i, path, (void**)&info->data, &len,
+         map_size, crc);
 
    if (!ret || len < 0)
    {
@@ -392,6 +584,23 @@ static bool load_content_need_fullpath(
    if (!path_contains_compressed_file(path))
       return true;
 
+   attributes.i = 0;
+
+   /* Big disc images take minutes to extract, keep them around. */
+   if (settings->extraction_cache_size
+         && *settings->extraction_directory
+         && path_is_directory(settings->extraction_directory)
+         && extract_cache_fetch(path, settings->extraction_directory,
+            (uint64_t)settings->extraction_cache_size << 20,
+            new_path, sizeof(new_path)))
+   {
+      string_list_append(additional_path_allocs, new_path, attributes);
+      info[i].path =
+         additional_path_allocs->elems
+         [additional_path_allocs->size -1 ].data;
+      return true;
+   }
+
    RARCH_LOG("Compressed file in case of need_fullpath."
          "Now extracting to temporary directory.\n");
 
@@ -409,7 +618,6 @@ static bool load_content_need_fullpath(
             sizeof(new_basedir));
    }
 
-   attributes.i = 0;
    fill_pathname_join(new_path, new_basedir,
          path_basename(path), sizeof(new_path));
 
@@ -451,17 +659,29 @@ static bool load_content(const struct retro_subsystem_info *special,
       const struct string_list *content)
 {
    unsigned i;
+   struct content_crc crc;
    bool ret = true;
    struct string_list* additional_path_allocs = string_list_new();
    struct retro_game_info *info = (struct retro_game_info*)
       calloc(content->size, sizeof(*info));
+   size_t *map_size = (size_t*)calloc(content->size, sizeof(*map_size));
 
-   if (!info)
+   memset(&crc, 0, sizeof(crc));
+
+   if (!info || !map_size)
    {
       string_list_free(additional_path_allocs);
+      free(info);
+      free(map_size);
       return false;
    }
 
+#ifdef HAVE_COMPRESSION
+   /* Several files from one archive, e.g. subsystem content. */
+   if (content->size > 1)
+      compressed_files_prefetch(content);
+#endif
+
    for (i = 0; i < content->size; i++)
    {
       const char *path     = content->elems[i].data;
@@ -483,7 +703,8 @@ static bool load_content(const struct retro_subsystem_info *special,
 
       if (!need_fullpath && *path)
       {
-         if (!load_content_dont_need_fullpath(&info[i], i, path))
+         if (!load_content_dont_need_fullpath(&info[i], i, path,
+                  &map_size[i], &crc))
             goto end;
       }
       else
@@ -497,6 +718,8 @@ static bool load_content(const struct retro_subsystem_info *special,
       }
    }
 
+   content_crc_store(&crc);
+
    if (special)
       ret = pretro_load_game_special(special->id, info, content->size);
    else
@@ -506,10 +729,14 @@ static bool load_content(const struct retro_subsystem_info *special,
       RARCH_ERR("Failed to load content.\n");
 
 end:
+   /* Content is freed below, the checksum thread must be done. */
+   content_crc_finish(&crc);
+
    for (i = 0; i < content->size; i++)
-      free((void*)info[i].data);
+      content_file_free((void*)info[i].data, map_size[i]);
 
    string_list_free(additional_path_allocs);
+   free(map_size);
    if (info)
       free(info);
    return ret;
@@ -15,9 +15,12 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <ctype.h>
+
 #include "core_info.h"
 #include "general.h"
 #include <file/file_path.h>
+#include <rhash.h>
 #include "file_ext.h"
 #include <file/file_extract.h>
 #include "dir_list_special.h"
@@ -27,15 +30,268 @@
 #include "config.h"
 #endif
 
+#include <stddef.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "file_ops.h"
+
+/* Consoles have no reliable stat() mtime, they always parse. */
+#if !defined(RARCH_CONSOLE)
+#define HAVE_CORE_INFO_CACHE
+#endif
+
+#define CORE_INFO_CACHE_MAGIC   0x49434152U /* "RACI" */
+#define CORE_INFO_CACHE_VERSION 1
+#define CORE_INFO_CACHE_NULL    0xffffffffU
+
+/* String keys read from an info file, in cache order. */
+static const struct
+{
+   const char *key;
+   size_t offset;
+   size_t list_offset;
+} core_info_strings[] = {
+   { "display_name",         offsetof(core_info_t, display_name),         0 },
+   { "corename",             offsetof(core_info_t, core_name),            0 },
+   { "systemname",           offsetof(core_info_t, systemname),           0 },
+   { "manufacturer",         offsetof(core_info_t, system_manufacturer),
+      offsetof(core_info_t, system_manufacturer_list) },
+   { "supported_extensions", offsetof(core_info_t, supported_extensions),
+      offsetof(core_info_t, supported_extensions_list) },
+   { "authors",              offsetof(core_info_t, authors),
+      offsetof(core_info_t, authors_list) },
+   { "permissions",          offsetof(core_info_t, permissions),
+      offsetof(core_info_t, permissions_list) },
+   { "license",              offsetof(core_info_t, licenses),
+      offsetof(core_info_t, licenses_list) },
+   { "categories",           offsetof(core_info_t, categories),
+      offsetof(core_info_t, categories_list) },
+   { "database",             offsetof(core_info_t, databases),
+      offsetof(core_info_t, databases_list) },
+   { "notes",                offsetof(core_info_t, notes),
+      offsetof(core_info_t, note_list) },
+   { "required_hw_api",      offsetof(core_info_t, required_hw_api),
+      offsetof(core_info_t, required_hw_api_list) },
+   { "description",          offsetof(core_info_t, description),          0 },
+};
+
+#define CORE_INFO_STRING(info, i) \
+   ((char**)((uint8_t*)(info) + core_info_strings[i].offset))
+#define CORE_INFO_LIST(info, i) \
+   ((struct string_list**)((uint8_t*)(info) + core_info_strings[i].list_offset))
+
+/**
+ * core_info_hash_ext:
+ * @ext                  : Extension, without or with a leading dot.
+ *
+ * Case-insensitive djb2 over @ext, ignoring one leading dot
+ * so "sfc" and ".sfc" land on the same hash.
+ *
+ * Returns: hash of @ext.
+ **/
+static uint32_t core_info_hash_ext(const char *ext)
+{
+   uint32_t hash = 5381;
+
+   if (*ext == '.')
+      ext++;
+
+   for (; *ext; ext++)
+      hash = (hash << 5) + hash + (uint8_t)tolower((uint8_t)*ext);
+
+   return hash;
+}
+
+/* Supported cores of each extension, as a bitset over
+ * core_info_t::list_index. */
+typedef struct core_info_ext_index
+{
+   /* Unique extensions, lowercase and without the dot. */
+   char **exts;
+   uint32_t *hashes;
+   size_t num_exts;
+
+   /* Open addressing over exts, -1 marks a free slot. */
+   int32_t *slots;
+   size_t slot_mask;
+
+   uint32_t *bits;
+   size_t words;
+
+   /* Scratch bitset for core_info_list_get_supported_cores(). */
+   uint32_t *query;
+} core_info_ext_index_t;
+
+static void core_info_ext_index_free(core_info_ext_index_t *index)
+{
+   size_t i;
+
+   if (!index)
+      return;
+
+   for (i = 0; i < index->num_exts; i++)
+      free(index->exts[i]);
+   free(index->exts);
+   free(index->hashes);
+   free(index->slots);
+   free(index->bits);
+   free(index->query);
+   free(index);
+}
+
+static int32_t *core_info_ext_index_slot(const core_info_ext_index_t *index,
+      const char *ext, uint32_t hash)
+{
+   size_t pos = hash & index->slot_mask;
+
+   for (;; pos = (pos + 1) & index->slot_mask)
+   {
+      int32_t *slot = &index->slots[pos];
+
+      if (*slot < 0)
+         return slot;
+      if (index->hashes[*slot] == hash && !strcasecmp(index->exts[*slot], ext))
+         return slot;
+   }
+}
+
+/**
+ * core_info_ext_index_find:
+ * @index                : Extension index.
+ * @ext                  : Extension, without the dot.
+ *
+ * Returns: bitset of the cores supporting @ext, or NULL if none does.
+ **/
+static const uint32_t *core_info_ext_index_find(
+      const core_info_ext_index_t *index, const char *ext)
+{
+   int32_t *slot;
+
+   if (*ext == '.')
+      ext++;
+   if (!*ext)
+      return NULL;
+
+   slot = core_info_ext_index_slot(index, ext, core_info_hash_ext(ext));
+   return *slot < 0 ? NULL : &index->bits[*slot * index->words];
+}
+
+/**
+ * core_info_ext_index_new:
+ * @core_info_list       : Core info list with its lists resolved.
+ *
+ * Builds the extension -> supporting cores map used by
+ * core_info_list_get_supported_cores().
+ *
+ * Returns: extension index, or NULL on failure.
+ **/
+static core_info_ext_index_t *core_info_ext_index_new(
+      core_info_list_t *core_info_list)
+{
+   size_t i, j, total = 0, num_slots = 16;
+   core_info_ext_index_t *index = (core_info_ext_index_t*)
+      calloc(1, sizeof(*index));
+
+   if (!index)
+      return NULL;
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const struct string_list *list =
+         core_info_list->list[i].supported_extensions_list;
+      if (list)
+         total += list->size;
+   }
+
+   while (num_slots < total * 2)
+      num_slots *= 2;
+
+   index->words     = (core_info_list->count + 31) / 32;
+   index->slot_mask = num_slots - 1;
+   index->exts      = (char**)calloc(total + 1, sizeof(*index->exts));
+   index->hashes    = (uint32_t*)calloc(total + 1, sizeof(*index->hashes));
+   index->slots     = (int32_t*)malloc(num_slots * sizeof(*index->slots));
+   index->bits      = (uint32_t*)calloc((total + 1) * index->words + 1,
+         sizeof(*index->bits));
+   index->query     = (uint32_t*)calloc(index->words + 1,
+         sizeof(*index->query));
+
+   if (!index->exts || !index->hashes || !index->slots
+         || !index->bits || !index->query)
+      goto error;
+
+   memset(index->slots, 0xff, num_slots * sizeof(*index->slots));
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const core_info_t *info        = &core_info_list->list[i];
+      const struct string_list *list = info->supported_extensions_list;
+
+      for (j = 0; list && j < list->size; j++)
+      {
+         int32_t *slot;
+         uint32_t hash;
+         const char *ext = list->elems[j].data;
+
+         if (*ext == '.')
+            ext++;
+         if (!*ext)
+            continue;
+
+         hash = core_info_hash_ext(ext);
+         slot = core_info_ext_index_slot(index, ext, hash);
+
+         if (*slot < 0)
+         {
+            char *lower = strdup(ext);
+            char *c;
+
+            if (!lower)
+               goto error;
+            for (c = lower; *c; c++)
+               *c = tolower((uint8_t)*c);
+
+            *slot = index->num_exts;
+            index->exts[index->num_exts]   = lower;
+            index->hashes[index->num_exts] = hash;
+            index->num_exts++;
+         }
+
+         index->bits[*slot * index->words + info->list_index / 32] |=
+            1U << (info->list_index & 31);
+      }
+   }
+
+   return index;
+
+error:
+   core_info_ext_index_free(index);
+   return NULL;
+}
+
 static void core_info_list_resolve_all_extensions(
       core_info_list_t *core_info_list)
 {
    size_t i, all_ext_len = 0;
+   char *ptr;
+   const core_info_ext_index_t *index = NULL;
 
    if (!core_info_list)
       return;
 
-   for (i = 0; i < core_info_list->count; i++)
+   index = core_info_list->ext_index;
+
+   /* With the index at hand, list every extension only once. */
+   for (i = 0; index && i < index->num_exts; i++)
+      all_ext_len += strlen(index->exts[i]) + 1;
+
+   for (i = 0; !index && i < core_info_list->count; i++)
    {
       if (core_info_list->list[i].supported_extensions)
          all_ext_len += 
@@ -43,143 +299,741 @@ static void core_info_list_resolve_all_extensions(
    }
 
    if (all_ext_len)
-      core_info_list->all_ext = (char*)calloc(1, all_ext_len);
+      core_info_list->all_ext = (char*)calloc(1, all_ext_len + 1);
 
    if (!core_info_list->all_ext)
       return;
 
-   for (i = 0; i < core_info_list->count; i++)
+   /* Append in place, strlcat() would rescan the string every time. */
+   ptr = core_info_list->all_ext;
+
+   for (i = 0; index && i < index->num_exts; i++)
+   {
+      size_t len = strlen(index->exts[i]);
+
+      memcpy(ptr, index->exts[i], len);
+      ptr   += len;
+      *ptr++ = '|';
+   }
+
+   for (i = 0; !index && i < core_info_list->count; i++)
    {
-      if (!core_info_list->list[i].supported_extensions)
+      size_t len;
+      const char *ext = core_info_list->list[i].supported_extensions;
+
+      if (!ext)
          continue;
 
-      strlcat(core_info_list->all_ext,
-            core_info_list->list[i].supported_extensions, all_ext_len);
-      strlcat(core_info_list->all_ext, "|", all_ext_len);
+      len = strlen(ext);
+      memcpy(ptr, ext, len);
+      ptr   += len;
+      *ptr++ = '|';
    }
+
+   *ptr = '\0';
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
+/**
+ * core_info_resolve_lists:
+ * @info                 : Core info with its strings filled in.
+ *
+ * Splits the '|'-separated strings into their lists and hashes
+ * the supported extensions, unless the hashes came from the cache.
+ **/
+static void core_info_resolve_lists(core_info_t *info)
 {
    size_t i;
-   unsigned c;
 
-   if (!core_info_list)
+   for (i = 0; i < ARRAY_SIZE(core_info_strings); i++)
+   {
+      const char *str = *CORE_INFO_STRING(info, i);
+
+      if (str && core_info_strings[i].list_offset)
+         *CORE_INFO_LIST(info, i) = string_split(str, "|");
+   }
+
+   if (!info->supported_extensions_list || info->supported_extensions_hashes)
       return;
 
-   for (i = 0; i < core_info_list->count; i++)
-   {
-      unsigned count    = 0;
-      core_info_t *info = (core_info_t*)&core_info_list->list[i];
+   info->supported_extensions_hashes = (uint32_t*)malloc(
+         (info->supported_extensions_list->size + 1) * sizeof(uint32_t));
+   if (!info->supported_extensions_hashes)
+      return;
 
-      if (!info || !info->data)
-         continue;
+   for (i = 0; i < info->supported_extensions_list->size; i++)
+      info->supported_extensions_hashes[i] = core_info_hash_ext(
+            info->supported_extensions_list->elems[i].data);
+}
 
-      if (!config_get_uint(info->data, "firmware_count", &count))
-         continue;
+/**
+ * core_info_list_free_info:
+ * @info                 : Core info.
+ *
+ * Frees everything parsed from @info's info file,
+ * leaving @info->path intact.
+ **/
+static void core_info_list_free_info(core_info_t *info)
+{
+   size_t i;
 
-      info->firmware = (core_info_firmware_t*)
-         calloc(count, sizeof(*info->firmware));
+   for (i = 0; i < ARRAY_SIZE(core_info_strings); i++)
+   {
+      char **str = CORE_INFO_STRING(info, i);
 
-      if (!info->firmware)
-         continue;
+      free(*str);
+      *str = NULL;
 
-      for (c = 0; c < count; c++)
+      if (core_info_strings[i].list_offset)
       {
-         char path_key[64] = {0};
-         char desc_key[64] = {0};
-         char opt_key[64]  = {0};
-
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+         struct string_list **list = CORE_INFO_LIST(info, i);
 
-         config_get_string(info->data, path_key, &info->firmware[c].path);
-         config_get_string(info->data, desc_key, &info->firmware[c].desc);
-         config_get_bool(info->data, opt_key , &info->firmware[c].optional);
+         string_list_free(*list);
+         *list = NULL;
       }
    }
+
+   free(info->supported_extensions_hashes);
+   info->supported_extensions_hashes = NULL;
+
+   for (i = 0; i < info->firmware_count; i++)
+   {
+      free(info->firmware[i].path);
+      free(info->firmware[i].desc);
+   }
+   free(info->firmware);
+   info->firmware         = NULL;
+   info->firmware_count   = 0;
+   info->supports_no_game = false;
+   info->has_info         = false;
 }
 
-static void core_info_parse_installed(core_info_t *core_info)
-{
-   unsigned fw_count = 0;
-
-   config_get_string(core_info->data, "display_name",
-         &core_info->display_name);
-   config_get_string(core_info->data, "corename",
-         &core_info->core_name);
-   config_get_string(core_info->data, "systemname",
-         &core_info->systemname);
-
-   if (config_get_string(core_info->data, "manufacturer",
-            &core_info->system_manufacturer) &&
-         core_info->system_manufacturer)
-      core_info->system_manufacturer_list =
-         string_split(core_info->system_manufacturer, "|");
-
-   config_get_uint(core_info->data, "firmware_count", &fw_count);
-   core_info->firmware_count = fw_count;
-   if (config_get_string(core_info->data, "supported_extensions",
-            &core_info->supported_extensions) &&
-         core_info->supported_extensions)
-      core_info->supported_extensions_list =
-         string_split(core_info->supported_extensions, "|");
-
-   if (config_get_string(core_info->data, "authors",
-            &core_info->authors) &&
-         core_info->authors)
-      core_info->authors_list =
-         string_split(core_info->authors, "|");
-
-   if (config_get_string(core_info->data, "permissions",
-            &core_info->permissions) &&
-         core_info->permissions)
-      core_info->permissions_list =
-         string_split(core_info->permissions, "|");
-
-   if (config_get_string(core_info->data, "license",
-            &core_info->licenses) &&
-         core_info->licenses)
-      core_info->licenses_list =
-         string_split(core_info->licenses, "|");
-
-   if (config_get_string(core_info->data, "categories",
-            &core_info->categories) &&
-         core_info->categories)
-      core_info->categories_list =
-         string_split(core_info->categories, "|");
-
-   if (config_get_string(core_info->data, "database",
-            &core_info->databases) &&
-         core_info->databases)
-      core_info->databases_list =
-         string_split(core_info->databases, "|");
-
-   if (config_get_string(core_info->data, "notes",
-            &core_info->notes) &&
-         core_info->notes)
-      core_info->note_list = string_split(core_info->notes, "|");
-
-   if (config_get_string(core_info->data, "required_hw_api",
-            &core_info->required_hw_api) &&
-         core_info->required_hw_api)
-      core_info->required_hw_api_list = string_split(
-            core_info->required_hw_api, "|");
-
-   config_get_bool(core_info->data, "supports_no_game",
+static void core_info_parse(core_info_t *core_info, config_file_t *conf)
+{
+   size_t i;
+   unsigned c, fw_count = 0;
+
+   for (i = 0; i < ARRAY_SIZE(core_info_strings); i++)
+      config_get_string(conf, core_info_strings[i].key,
+            CORE_INFO_STRING(core_info, i));
+
+   config_get_bool(conf, "supports_no_game",
          &core_info->supports_no_game);
+
+   if (config_get_uint(conf, "firmware_count", &fw_count) && fw_count)
+   {
+      core_info->firmware = (core_info_firmware_t*)
+         calloc(fw_count, sizeof(*core_info->firmware));
+
+      if (core_info->firmware)
+         core_info->firmware_count = fw_count;
+   }
+
+   for (c = 0; c < core_info->firmware_count; c++)
+   {
+      char path_key[64] = {0};
+      char desc_key[64] = {0};
+      char opt_key[64]  = {0};
+
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+
+      config_get_string(conf, path_key, &core_info->firmware[c].path);
+      config_get_string(conf, desc_key, &core_info->firmware[c].desc);
+      config_get_bool(conf, opt_key , &core_info->firmware[c].optional);
+   }
+
+   core_info_resolve_lists(core_info);
+   core_info->has_info = true;
+}
+
+#ifdef HAVE_CORE_INFO_CACHE
+/* One info file in the cache. Pointers reference the loaded cache
+ * image, which stays valid until the cache is freed. */
+typedef struct core_info_cache_record
+{
+   const char *path;
+   uint32_t hash;
+   uint64_t mtime;
+   uint64_t size;
+   const uint8_t *data;
+   size_t len;
+   bool stale;
+} core_info_cache_record_t;
+
+typedef struct core_info_cache
+{
+   char path[PATH_MAX_LENGTH];
+
+   uint8_t *image;
+   size_t image_size;
+   bool mapped;
+
+   core_info_cache_record_t *records;
+   size_t count;
+
+   /* Open addressing table of record index + 1, keyed by
+    * path hash, so a lookup does not scan every record. */
+   uint32_t *table;
+   size_t table_mask;
+
+   /* Records for info files parsed during this run. */
+   uint8_t *out;
+   size_t out_size;
+   size_t out_cap;
+   unsigned out_count;
+
+   bool dirty;
+} core_info_cache_t;
+
+typedef struct
+{
+   const uint8_t *ptr;
+   const uint8_t *end;
+} core_info_reader_t;
+
+static bool core_info_read(core_info_reader_t *r, void *out, size_t len)
+{
+   if ((size_t)(r->end - r->ptr) < len)
+      return false;
+   memcpy(out, r->ptr, len);
+   r->ptr += len;
+   return true;
+}
+
+/* Strings are a length, the bytes and a terminator, so they can be
+ * used straight from the cache image. */
+static bool core_info_read_string(core_info_reader_t *r, const char **out)
+{
+   uint32_t len;
+
+   *out = NULL;
+
+   if (!core_info_read(r, &len, sizeof(len)))
+      return false;
+   if (len == CORE_INFO_CACHE_NULL)
+      return true;
+   if ((size_t)(r->end - r->ptr) <= len || r->ptr[len] != '\0')
+      return false;
+
+   *out    = (const char*)r->ptr;
+   r->ptr += len + 1;
+   return true;
+}
+
+static bool core_info_write(core_info_cache_t *cache,
+      const void *data, size_t len)
+{
+   if (cache->out_size + len > cache->out_cap)
+   {
+      size_t cap   = cache->out_cap ? cache->out_cap * 2 : 4096;
+      uint8_t *out = NULL;
+
+      while (cap < cache->out_size + len)
+         cap *= 2;
+
+      out = (uint8_t*)realloc(cache->out, cap);
+      if (!out)
+         return false;
+
+      cache->out     = out;
+      cache->out_cap = cap;
+   }
+
+   memcpy(cache->out + cache->out_size, data, len);
+   cache->out_size += len;
+   return true;
+}
+
+static bool core_info_write_string(core_info_cache_t *cache, const char *str)
+{
+   uint32_t len = str ? strlen(str) : CORE_INFO_CACHE_NULL;
+
+   if (!core_info_write(cache, &len, sizeof(len)))
+      return false;
+   return !str || core_info_write(cache, str, len + 1);
+}
+
+static bool core_info_stat(const char *path, uint64_t *mtime, uint64_t *size)
+{
+   struct stat buf;
+
+   if (stat(path, &buf) < 0)
+      return false;
+
+   *mtime = buf.st_mtime;
+   *size  = buf.st_size;
+   return true;
+}
+
+static bool core_info_cache_read_image(core_info_cache_t *cache)
+{
+#ifdef HAVE_MMAP
+   struct stat buf;
+   void *image;
+   int fd = open(cache->path, O_RDONLY);
+
+   if (fd < 0)
+      return false;
+
+   if (fstat(fd, &buf) < 0 || !buf.st_size)
+   {
+      close(fd);
+      return false;
+   }
+
+   image = mmap(NULL, buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+
+   if (image == MAP_FAILED)
+      return false;
+
+   cache->image      = (uint8_t*)image;
+   cache->image_size = buf.st_size;
+   cache->mapped     = true;
+   return true;
+#else
+   void *image = NULL;
+   ssize_t len = 0;
+
+   if (!read_file(cache->path, &image, &len) || len <= 0)
+   {
+      free(image);
+      return false;
+   }
+
+   cache->image      = (uint8_t*)image;
+   cache->image_size = len;
+   return true;
+#endif
 }
 
-static void core_info_parse_downloadable(core_info_t *core_info)
+static void core_info_cache_free_image(core_info_cache_t *cache)
 {
-   config_get_string(core_info->data, "display_name",
-         &core_info->display_name);
-   config_get_string(core_info->data, "description",
-         &core_info->description);
+   if (!cache->image)
+      return;
+
+#ifdef HAVE_MMAP
+   if (cache->mapped)
+      munmap(cache->image, cache->image_size);
+   else
+#endif
+      free(cache->image);
+
+   cache->image = NULL;
 }
 
+/**
+ * core_info_cache_index:
+ * @cache                : Cache with its image loaded.
+ *
+ * Builds the record table of the cache image.
+ *
+ * Returns: true if the image is a valid cache, otherwise false.
+ **/
+static bool core_info_cache_index(core_info_cache_t *cache)
+{
+   size_t i;
+   uint32_t header[3];
+   core_info_reader_t r;
+
+   r.ptr = cache->image;
+   r.end = cache->image + cache->image_size;
+
+   if (!core_info_read(&r, header, sizeof(header)))
+      return false;
+   if (header[0] != CORE_INFO_CACHE_MAGIC
+         || header[1] != CORE_INFO_CACHE_VERSION)
+      return false;
+   if (header[2] > cache->image_size)
+      return false;
+
+   cache->records = (core_info_cache_record_t*)
+      calloc(header[2] + 1, sizeof(*cache->records));
+   if (!cache->records)
+      return false;
+
+   for (i = 0; i < header[2]; i++)
+   {
+      uint32_t len;
+      core_info_reader_t rec;
+      core_info_cache_record_t *record = &cache->records[i];
+
+      record->data = r.ptr;
+
+      if (!core_info_read(&r, &len, sizeof(len))
+            || len < sizeof(len) || len - sizeof(len) > (size_t)(r.end - r.ptr))
+         return false;
+
+      rec.ptr      = r.ptr;
+      rec.end      = r.ptr + len - sizeof(len);
+      r.ptr        = rec.end;
+      record->len  = len;
+
+      if (!core_info_read(&rec, &record->mtime, sizeof(record->mtime))
+            || !core_info_read(&rec, &record->size, sizeof(record->size))
+            || !core_info_read_string(&rec, &record->path)
+            || !record->path)
+         return false;
+
+      record->hash = djb2_calculate(record->path);
+      cache->count++;
+   }
+
+   cache->table_mask = 1;
+   while (cache->table_mask < 2 * cache->count)
+      cache->table_mask <<= 1;
+
+   cache->table = (uint32_t*)calloc(cache->table_mask, sizeof(*cache->table));
+   if (!cache->table)
+      return false;
+   cache->table_mask--;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      size_t slot = cache->records[i].hash & cache->table_mask;
+
+      while (cache->table[slot])
+         slot = (slot + 1) & cache->table_mask;
+      cache->table[slot] = i + 1;
+   }
+
+   return true;
+}
+
+static core_info_cache_t *core_info_cache_new(void)
+{
+   global_t          *global = global_get_ptr();
+   core_info_cache_t  *cache = NULL;
+
+   if (!global || !*global->config_path)
+      return NULL;
+
+   cache = (core_info_cache_t*)calloc(1, sizeof(*cache));
+   if (!cache)
+      return NULL;
+
+   fill_pathname_resolve_relative(cache->path, global->config_path,
+         "core_info.cache", sizeof(cache->path));
+
+   if (core_info_cache_read_image(cache) && !core_info_cache_index(cache))
+   {
+      RARCH_WARN("[Core info]: Ignoring invalid cache %s.\n", cache->path);
+      free(cache->records);
+      free(cache->table);
+      cache->records = NULL;
+      cache->table   = NULL;
+      cache->count   = 0;
+      cache->dirty   = true;
+   }
+
+   return cache;
+}
+
+static core_info_cache_record_t *core_info_cache_find(
+      core_info_cache_t *cache, const char *path)
+{
+   size_t slot;
+   uint32_t hash;
+
+   if (!cache->table)
+      return NULL;
+
+   hash = djb2_calculate(path);
+
+   for (slot = hash & cache->table_mask; cache->table[slot];
+         slot = (slot + 1) & cache->table_mask)
+   {
+      core_info_cache_record_t *record =
+         &cache->records[cache->table[slot] - 1];
+
+      if (record->hash == hash && !record->stale
+            && !strcmp(record->path, path))
+         return record;
+   }
+
+   return NULL;
+}
+
+/**
+ * core_info_cache_apply:
+ * @record               : Cache record.
+ * @info                 : Core info to fill in.
+ *
+ * Copies a cached parse of an info file into @info.
+ *
+ * Returns: true on success, otherwise false.
+ **/
+static bool core_info_cache_apply(const core_info_cache_record_t *record,
+      core_info_t *info)
+{
+   size_t i;
+   uint8_t no_game;
+   uint32_t fw_count, ext_count;
+   const char *str;
+   core_info_reader_t r;
+
+   r.ptr = record->data + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+   r.end = record->data + record->len;
+
+   if (!core_info_read_string(&r, &str))
+      return false;
+
+   for (i = 0; i < ARRAY_SIZE(core_info_strings); i++)
+   {
+      if (!core_info_read_string(&r, &str))
+         return false;
+      if (str)
+         *CORE_INFO_STRING(info, i) = strdup(str);
+   }
+
+   if (!core_info_read(&r, &no_game, sizeof(no_game))
+         || !core_info_read(&r, &fw_count, sizeof(fw_count)))
+      return false;
+
+   info->supports_no_game = no_game;
+
+   if (fw_count)
+   {
+      if (fw_count > record->len)
+         return false;
+
+      info->firmware = (core_info_firmware_t*)
+         calloc(fw_count, sizeof(*info->firmware));
+      if (!info->firmware)
+         return false;
+      info->firmware_count = fw_count;
+   }
+
+   for (i = 0; i < fw_count; i++)
+   {
+      uint8_t optional;
+
+      if (!core_info_read_string(&r, &str))
+         return false;
+      if (str)
+         info->firmware[i].path = strdup(str);
+
+      if (!core_info_read_string(&r, &str))
+         return false;
+      if (str)
+         info->firmware[i].desc = strdup(str);
+
+      if (!core_info_read(&r, &optional, sizeof(optional)))
+         return false;
+      info->firmware[i].optional = optional;
+   }
+
+   if (!core_info_read(&r, &ext_count, sizeof(ext_count)))
+      return false;
+
+   if (ext_count)
+   {
+      if (ext_count > record->len)
+         return false;
+
+      info->supported_extensions_hashes = (uint32_t*)
+         malloc(ext_count * sizeof(uint32_t));
+      if (!info->supported_extensions_hashes
+            || !core_info_read(&r, info->supported_extensions_hashes,
+               ext_count * sizeof(uint32_t)))
+         return false;
+   }
+
+   core_info_resolve_lists(info);
+
+   /* Hashes must line up with the list they were built from. */
+   if ((info->supported_extensions_list
+            ? info->supported_extensions_list->size : 0) != ext_count)
+      return false;
+
+   info->has_info = true;
+   return true;
+}
+
+static void core_info_cache_store(core_info_cache_t *cache,
+      const core_info_t *info, const char *path,
+      uint64_t mtime, uint64_t size)
+{
+   size_t i;
+   uint8_t no_game    = info->supports_no_game;
+   uint32_t fw_count  = info->firmware_count;
+   uint32_t ext_count = info->supported_extensions_list ?
+      info->supported_extensions_list->size : 0;
+   uint32_t len       = 0;
+   size_t start       = cache->out_size;
+   bool ok            = true;
+
+   ok = ok && core_info_write(cache, &len, sizeof(len));
+   ok = ok && core_info_write(cache, &mtime, sizeof(mtime));
+   ok = ok && core_info_write(cache, &size, sizeof(size));
+   ok = ok && core_info_write_string(cache, path);
+
+   for (i = 0; i < ARRAY_SIZE(core_info_strings); i++)
+      ok = ok && core_info_write_string(cache,
+            *CORE_INFO_STRING(info, i));
+
+   ok = ok && core_info_write(cache, &no_game, sizeof(no_game));
+   ok = ok && core_info_write(cache, &fw_count, sizeof(fw_count));
+
+   for (i = 0; i < fw_count; i++)
+   {
+      uint8_t optional = info->firmware[i].optional;
+
+      ok = ok && core_info_write_string(cache, info->firmware[i].path);
+      ok = ok && core_info_write_string(cache, info->firmware[i].desc);
+      ok = ok && core_info_write(cache, &optional, sizeof(optional));
+   }
+
+   ok = ok && core_info_write(cache, &ext_count, sizeof(ext_count));
+   if (ext_count)
+      ok = ok && core_info_write(cache,
+            info->supported_extensions_hashes, ext_count * sizeof(uint32_t));
+
+   if (!ok)
+   {
+      cache->out_size = start;
+      return;
+   }
+
+   len = cache->out_size - start;
+   memcpy(cache->out + start, &len, sizeof(len));
+   cache->out_count++;
+   cache->dirty = true;
+}
+
+/**
+ * core_info_cache_load:
+ * @cache                : Cache handle, may be NULL.
+ * @info                 : Core info to fill in.
+ * @path                 : Path to the info file.
+ *
+ * Fills in @info from the cache if the info file is unchanged since it
+ * was cached, otherwise parses the info file and caches the result.
+ **/
+static void core_info_cache_load(core_info_cache_t *cache,
+      core_info_t *info, const char *path)
+{
+   uint64_t mtime, size;
+   config_file_t *conf;
+   core_info_cache_record_t *record;
+
+   record = cache ? core_info_cache_find(cache, path) : NULL;
+
+   if (!core_info_stat(path, &mtime, &size))
+   {
+      /* Info file is gone, drop it from the cache. */
+      if (record)
+      {
+         record->stale = true;
+         cache->dirty  = true;
+      }
+      return;
+   }
+
+   if (record)
+   {
+      if (record->mtime == mtime && record->size == size
+            && core_info_cache_apply(record, info))
+         return;
+
+      /* Changed on disk or unreadable, parse it again. */
+      core_info_list_free_info(info);
+      record->stale = true;
+      cache->dirty  = true;
+   }
+
+   if (!(conf = config_file_new(path)))
+      return;
+
+   core_info_parse(info, conf);
+   config_file_free(conf);
+
+   if (cache)
+      core_info_cache_store(cache, info, path, mtime, size);
+}
+
+/**
+ * core_info_cache_free:
+ * @cache                : Cache handle.
+ *
+ * Writes the cache back if anything was parsed or invalidated,
+ * keeping unchanged records of info files not looked at this time.
+ **/
+static void core_info_cache_free(core_info_cache_t *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   if (cache->dirty)
+   {
+      char tmp_path[PATH_MAX_LENGTH + 4] = {0};
+      uint32_t header[3];
+      size_t old_size = 0, pos;
+      uint8_t *out    = NULL;
+
+      header[0] = CORE_INFO_CACHE_MAGIC;
+      header[1] = CORE_INFO_CACHE_VERSION;
+      header[2] = cache->out_count;
+
+      for (i = 0; i < cache->count; i++)
+      {
+         if (cache->records[i].stale)
+            continue;
+         old_size += cache->records[i].len;
+         header[2]++;
+      }
+
+      out = (uint8_t*)malloc(sizeof(header) + old_size + cache->out_size);
+
+      if (out)
+      {
+         memcpy(out, header, sizeof(header));
+         pos = sizeof(header);
+
+         for (i = 0; i < cache->count; i++)
+         {
+            if (cache->records[i].stale)
+               continue;
+            memcpy(out + pos, cache->records[i].data, cache->records[i].len);
+            pos += cache->records[i].len;
+         }
+
+         if (cache->out_size)
+            memcpy(out + pos, cache->out, cache->out_size);
+         pos += cache->out_size;
+
+         /* Write a copy and swap it in, so a crash never leaves
+          * a torn cache behind. */
+         snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", cache->path);
+         core_info_cache_free_image(cache);
+
+         if (write_file(tmp_path, out, pos))
+         {
+#ifdef _WIN32
+            remove(cache->path);
+#endif
+            if (rename(tmp_path, cache->path) != 0)
+               remove(tmp_path);
+         }
+         else
+            RARCH_WARN("[Core info]: Failed to write cache %s.\n",
+                  cache->path);
+
+         free(out);
+      }
+   }
+
+   core_info_cache_free_image(cache);
+   free(cache->records);
+   free(cache->table);
+   free(cache->out);
+   free(cache);
+}
+#endif
+
 core_info_list_t *core_info_list_new(enum info_list_target target)
 {
    size_t i;
@@ -188,6 +1042,9 @@ core_info_list_t *core_info_list_new(enum info_list_target target)
    settings_t *settings = config_get_ptr();
    global_t *global     = global_get_ptr();
    struct string_list *contents;
+#ifdef HAVE_CORE_INFO_CACHE
+   core_info_cache_t *cache = NULL;
+#endif
    
    if (target == DOWNLOADABLE_CORES)
       contents = dir_list_new(settings->libretro_info_path, "info", false);
@@ -197,6 +1054,10 @@ core_info_list_t *core_info_list_new(enum info_list_target target)
    if (!contents)
       return NULL;
 
+#ifdef HAVE_CORE_INFO_CACHE
+   cache = core_info_cache_new();
+#endif
+
    core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
    if (!core_info_list)
       goto error;
@@ -216,6 +1077,8 @@ core_info_list_t *core_info_list_new(enum info_list_target target)
       /* get platform-free name */
       path_libretro_name(info_path_base, contents->elems[i].data);
       
+      core_info[i].list_index = i;
+
       /* set path (search key) */
       if (target == DOWNLOADABLE_CORES)
          core_info[i].path = strdup(info_path_base); /* key on libretro name */
@@ -232,27 +1095,37 @@ core_info_list_t *core_info_list_new(enum info_list_target target)
             settings->libretro_info_path : settings->libretro_directory,
             info_path_base, sizeof(info_path));
 
-      core_info[i].data = config_file_new(info_path);
-
-      if (core_info[i].data)
+#ifdef HAVE_CORE_INFO_CACHE
+      core_info_cache_load(cache, &core_info[i], info_path);
+#else
       {
-         if (target == DOWNLOADABLE_CORES)
-            core_info_parse_downloadable(&core_info[i]);
-         else
-            core_info_parse_installed(&core_info[i]);
+         config_file_t *conf = config_file_new(info_path);
+
+         if (conf)
+         {
+            core_info_parse(&core_info[i], conf);
+            config_file_free(conf);
+         }
       }
+#endif
 
       if (!core_info[i].display_name)
          core_info[i].display_name = strdup(path_basename(core_info[i].path));
    }
 
+   core_info_list->ext_index = core_info_ext_index_new(core_info_list);
    core_info_list_resolve_all_extensions(core_info_list);
-   core_info_list_resolve_all_firmware(core_info_list);
 
+#ifdef HAVE_CORE_INFO_CACHE
+   core_info_cache_free(cache);
+#endif
    dir_list_free(contents);
    return core_info_list;
 
 error:
+#ifdef HAVE_CORE_INFO_CACHE
+   core_info_cache_free(cache);
+#endif
    if (contents)
       dir_list_free(contents);
    core_info_list_free(core_info_list);
@@ -261,7 +1134,7 @@ error:
 
 void core_info_list_free(core_info_list_t *core_info_list)
 {
-   size_t i, j;
+   size_t i;
 
    if (!core_info_list)
       return;
@@ -273,37 +1146,11 @@ void core_info_list_free(core_info_list_t *core_info_list)
       if (!info)
          continue;
 
+      core_info_list_free_info(info);
       free(info->path);
-      free(info->core_name);
-      free(info->systemname);
-      free(info->system_manufacturer);
-      free(info->display_name);
-      free(info->supported_extensions);
-      free(info->authors);
-      free(info->permissions);
-      free(info->licenses);
-      free(info->categories);
-      free(info->databases);
-      free(info->notes);
-      if (info->supported_extensions_list)
-         string_list_free(info->supported_extensions_list);
-      string_list_free(info->system_manufacturer_list);
-      string_list_free(info->authors_list);
-      string_list_free(info->note_list);
-      string_list_free(info->permissions_list);
-      string_list_free(info->licenses_list);
-      string_list_free(info->categories_list);
-      string_list_free(info->databases_list);
-      config_file_free(info->data);
-
-      for (j = 0; j < info->firmware_count; j++)
-      {
-         free(info->firmware[j].path);
-         free(info->firmware[j].desc);
-      }
-      free(info->firmware);
    }
 
+   core_info_ext_index_free(core_info_list->ext_index);
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -317,7 +1164,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
       return 0;
 
    for (i = 0; i < core_info_list->count; i++)
-      num += !!core_info_list->list[i].data;
+      num += core_info_list->list[i].has_info;
 
    return num;
 }
@@ -420,6 +1267,33 @@ bool core_info_list_get_info(core_info_list_t *core_info_list,
    return false;
 }
 
+static bool core_info_does_support_ext(const core_info_t *core,
+      const char *ext)
+{
+   size_t i;
+   uint32_t hash;
+   const struct string_list *list = core->supported_extensions_list;
+
+   if (!core->supported_extensions_hashes)
+      return string_list_find_elem_prefix(list, ".", ext);
+
+   hash = core_info_hash_ext(ext);
+
+   for (i = 0; i < list->size; i++)
+   {
+      const char *elem = list->elems[i].data;
+
+      if (core->supported_extensions_hashes[i] != hash)
+         continue;
+      if (*elem == '.' && *ext != '.')
+         elem++;
+      if (!strcasecmp(elem, ext))
+         return true;
+   }
+
+   return false;
+}
+
 bool core_info_does_support_any_file(const core_info_t *core,
       const struct string_list *list)
 {
@@ -428,8 +1302,8 @@ bool core_info_does_support_any_file(const core_info_t *core,
       return false;
 
    for (i = 0; i < list->size; i++)
-      if (string_list_find_elem_prefix(core->supported_extensions_list,
-               ".", path_get_extension(list->elems[i].data)))
+      if (core_info_does_support_ext(core,
+               path_get_extension(list->elems[i].data)))
          return true;
    return false;
 }
@@ -438,8 +1312,7 @@ bool core_info_does_support_file(const core_info_t *core, const char *path)
 {
    if (!path || !core || !core->supported_extensions_list)
       return false;
-   return string_list_find_elem_prefix(
-         core->supported_extensions_list, ".", path_get_extension(path));
+   return core_info_does_support_ext(core, path_get_extension(path));
 }
 
 const char *core_info_list_get_all_extensions(core_info_list_t *core_info_list)
@@ -452,21 +1325,64 @@ const char *core_info_list_get_all_extensions(core_info_list_t *core_info_list)
 /* qsort_r() is not in standard C, sadly. */
 static const char *core_info_tmp_path;
 static const struct string_list *core_info_tmp_list;
+static const uint32_t *core_info_tmp_bits;
+
+static bool core_info_tmp_supports(const core_info_t *info)
+{
+   if (core_info_tmp_bits)
+      return core_info_tmp_bits[info->list_index / 32]
+         & (1U << (info->list_index & 31));
+
+   return core_info_does_support_any_file(info, core_info_tmp_list) ||
+      core_info_does_support_file(info, core_info_tmp_path);
+}
 
 static int core_info_qsort_cmp(const void *a_, const void *b_)
 {
    const core_info_t *a = (const core_info_t*)a_;
    const core_info_t *b = (const core_info_t*)b_;
-   int support_a        = core_info_does_support_any_file(a, core_info_tmp_list) ||
-      core_info_does_support_file(a, core_info_tmp_path);
-   int support_b        = core_info_does_support_any_file(b, core_info_tmp_list) ||
-      core_info_does_support_file(b, core_info_tmp_path);
+   int support_a        = core_info_tmp_supports(a);
+   int support_b        = core_info_tmp_supports(b);
 
    if (support_a != support_b)
       return support_b - support_a;
    return strcasecmp(a->display_name, b->display_name);
 }
 
+/**
+ * core_info_ext_index_query:
+ * @index                : Extension index.
+ * @path                 : Content path.
+ * @list                 : Files inside @path if it is an archive, or NULL.
+ *
+ * Collects the cores supporting @path, or any file in @list,
+ * into the index's scratch bitset.
+ *
+ * Returns: scratch bitset of supporting cores.
+ **/
+static const uint32_t *core_info_ext_index_query(
+      core_info_ext_index_t *index, const char *path,
+      const struct string_list *list)
+{
+   size_t i, w;
+   const uint32_t *bits = core_info_ext_index_find(index,
+         path_get_extension(path));
+
+   for (w = 0; w < index->words; w++)
+      index->query[w] = bits ? bits[w] : 0;
+
+   for (i = 0; list && i < list->size; i++)
+   {
+      bits = core_info_ext_index_find(index,
+            path_get_extension(list->elems[i].data));
+
+      for (w = 0; bits && w < index->words; w++)
+         index->query[w] |= bits[w];
+   }
+
+   return index->query;
+}
+
 void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
       const char *path, const core_info_t **infos, size_t *num_infos)
 {
@@ -486,6 +1402,9 @@ void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
    core_info_tmp_list = list;
 #endif
 
+   core_info_tmp_bits = core_info_list->ext_index ?
+      core_info_ext_index_query(core_info_list->ext_index, path, list) : NULL;
+
    /* Let supported core come first in list so we can return 
     * a pointer to them. */
    qsort(core_info_list->list, core_info_list->count,
@@ -493,22 +1412,13 @@ void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
 
    for (i = 0; i < core_info_list->count; i++, supported++)
    {
-      const core_info_t *core = &core_info_list->list[i];
-
-      if (!core)
-         continue;
-
-      if (core_info_does_support_file(core, path))
-         continue;
-
-#ifdef HAVE_ZLIB
-      if (core_info_does_support_any_file(core, list))
-         continue;
-#endif
-
-      break;
+      if (!core_info_tmp_supports(&core_info_list->list[i]))
+         break;
    }
 
+   core_info_tmp_bits = NULL;
+   core_info_tmp_list = NULL;
+
 #ifdef HAVE_ZLIB
    if (list)
       string_list_free(list);
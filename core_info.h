@@ -20,6 +20,7 @@
 
 #include <file/config_file.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,7 +39,6 @@ typedef struct
 typedef struct
 {
    char *path;
-   config_file_t *data;
    char *display_name;
    char *core_name;
    char *system_manufacturer;
@@ -61,18 +61,27 @@ typedef struct
    struct string_list *permissions_list;
    struct string_list *licenses_list;
    struct string_list *required_hw_api_list;
+   /* Hash of each entry in supported_extensions_list. */
+   uint32_t *supported_extensions_hashes;
 
    core_info_firmware_t *firmware;
    size_t firmware_count;
+   /* Set when an info file was found and parsed. */
+   bool has_info;
+   /* Position in the list at creation, stays put when the list is sorted. */
+   unsigned list_index;
    bool supports_no_game;
    void *userdata;
 } core_info_t;
 
+struct core_info_ext_index;
+
 typedef struct
 {
    core_info_t *list;
    size_t count;
    char *all_ext;
+   struct core_info_ext_index *ext_index;
 } core_info_list_t;
 
 enum info_list_target
@@ -17,15 +17,22 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 
 #include <string.h>
 #include <retro_miscellaneous.h>
+#include <compat/strl.h>
 #include <file/file_path.h>
 #include <string/string_list.h>
 #include "7zip_support.h"
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "../deps/7zip/7z.h"
 #include "../deps/7zip/7zAlloc.h"
 #include "../deps/7zip/7zCrc.h"
@@ -171,153 +178,418 @@ static SRes ConvertUtf16toCharString(const uint16_t *s, char *outstring)
    res = Utf16_To_Char(&buf, s, 0);
 
    if (res == SZ_OK)
-      strncpy(outstring, (const char*)buf.data, PATH_MAX_LENGTH);
+      strlcpy(outstring, (const char*)buf.data, PATH_MAX_LENGTH);
 
    Buf_Free(&buf, &g_Alloc);
    return res;
 }
 
-/* Extract the relative path relative_path from a 7z archive 
- * archive_path and allocate a buf for it to write it in.
- * If optional_outfile is set, extract to that instead and don't alloc buffer.
- */
-int read_7zip_file(
-      const char *archive_path,
-      const char *relative_path, void **buf,
-      const char *optional_outfile)
+/* Opened archives, so browsing into an archive and then
+ * loading from it parses the headers only once. The file
+ * itself is only kept open while reading from it. */
+#define SZ_ARCHIVE_CACHE_SIZE 2
+
+/* Decoded solid blocks are kept up to this many bytes in total. */
+#define SZ_BLOCK_CACHE_MAX (64 * 1024 * 1024)
+
+/* Most independent blocks decoded at once by compressed_7zip_prefetch(). */
+#define SZ_PREFETCH_THREADS 4
+
+struct sz_stream
 {
    CFileInStream archiveStream;
    CLookToRead lookStream;
+};
+
+struct sz_block
+{
+   uint32_t folder;
+   uint8_t *data;
+   size_t size;
+   unsigned last_used;
+};
+
+struct sz_archive
+{
+   char path[PATH_MAX_LENGTH];
+   uint64_t size;
+   uint64_t mtime;
    CSzArEx db;
-   SRes res;
-   ISzAlloc allocImp;
-   ISzAlloc allocTempImp;
-   uint16_t *temp  = NULL;
-   size_t tempSize = 0;
-   long outsize    = -1;
-   bool file_found = false;
+   char **names;
+   struct sz_block *blocks;
+   size_t num_blocks;
+   unsigned last_used;
+   bool open;
+};
+
+static ISzAlloc sz_alloc      = { SzAlloc, SzFree };
+static ISzAlloc sz_alloc_temp = { SzAllocTemp, SzFreeTemp };
+
+static struct sz_archive sz_archives[SZ_ARCHIVE_CACHE_SIZE];
+static size_t sz_block_total;
+static unsigned sz_clock;
+
+#ifdef HAVE_THREADS
+static slock_t *sz_lock;
+#endif
+
+static void sz_cache_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (!sz_lock)
+   {
+      slock_t *lock = slock_new();
+
+#ifdef _MSC_VER
+      if (InterlockedCompareExchangePointer(
+               (PVOID volatile*)&sz_lock, lock, NULL) != NULL)
+#else
+      if (!__sync_bool_compare_and_swap(&sz_lock, NULL, lock))
+#endif
+         slock_free(lock);
+   }
 
-   /*These are the allocation routines.
-    * Currently using the non-standard 7zip choices. */
-   allocImp.Alloc     = SzAlloc;
-   allocImp.Free      = SzFree;
-   allocTempImp.Alloc = SzAllocTemp;
-   allocTempImp.Free  = SzFreeTemp;
+   slock_lock(sz_lock);
+#endif
+}
+
+static void sz_cache_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(sz_lock);
+#endif
+}
+
+static bool sz_stream_open(struct sz_stream *stream, const char *path)
+{
+   if (InFile_Open(&stream->archiveStream.file, path))
+      return false;
+
+   FileInStream_CreateVTable(&stream->archiveStream);
+   LookToRead_CreateVTable(&stream->lookStream, False);
+   stream->lookStream.realStream = &stream->archiveStream.s;
+   LookToRead_Init(&stream->lookStream);
+   return true;
+}
 
-   if (InFile_Open(&archiveStream.file, archive_path))
+static void sz_stream_close(struct sz_stream *stream)
+{
+   File_Close(&stream->archiveStream.file);
+}
+
+static void sz_archive_close(struct sz_archive *archive)
+{
+   size_t i;
+
+   if (!archive->open)
+      return;
+
+   for (i = 0; i < archive->num_blocks; i++)
    {
-      RARCH_ERR("Could not open %s as 7z archive\n.",archive_path);
-      return -1;
+      sz_block_total -= archive->blocks[i].size;
+      IAlloc_Free(&sz_alloc, archive->blocks[i].data);
    }
-   else
+   free(archive->blocks);
+
+   if (archive->names)
    {
-      RARCH_LOG_OUTPUT("Openend archive %s. Now trying to extract %s\n",
-            archive_path,relative_path);
+      for (i = 0; i < archive->db.db.NumFiles; i++)
+         free(archive->names[i]);
+      free(archive->names);
    }
 
-   FileInStream_CreateVTable(&archiveStream);
-   LookToRead_CreateVTable(&lookStream, False);
-   lookStream.realStream = &archiveStream.s;
-   LookToRead_Init(&lookStream);
-   CrcGenerateTable();
-   SzArEx_Init(&db);
-   res = SzArEx_Open(&db, &lookStream.s, &allocImp, &allocTempImp);
+   SzArEx_Free(&archive->db, &sz_alloc);
+   memset(archive, 0, sizeof(*archive));
+}
 
-   if (res == SZ_OK)
+static SRes sz_archive_read_names(struct sz_archive *archive)
+{
+   uint32_t i;
+   uint16_t *temp  = NULL;
+   size_t tempSize = 0;
+   SRes res        = SZ_OK;
+
+   archive->names = (char**)calloc(archive->db.db.NumFiles + 1,
+         sizeof(*archive->names));
+   if (!archive->names)
+      return SZ_ERROR_MEM;
+
+   for (i = 0; i < archive->db.db.NumFiles; i++)
    {
-      uint32_t i;
-      uint32_t blockIndex  = 0xFFFFFFFF;
-      uint8_t *outBuffer   = 0;
-      size_t outBufferSize = 0;
+      char infile[PATH_MAX_LENGTH] = {0};
+      size_t len                   = 0;
 
-      for (i = 0; i < db.db.NumFiles; i++)
+      if (archive->db.db.Files[i].IsDir)
+         continue;
+
+      len = SzArEx_GetFileNameUtf16(&archive->db, i, NULL);
+      if (len > tempSize)
       {
-         size_t len;
-         char infile[PATH_MAX_LENGTH] = {0};
-         size_t offset           = 0;
-         size_t outSizeProcessed = 0;
-         const CSzFileItem    *f = db.db.Files + i;
+         free(temp);
+         tempSize = len;
+         temp     = (uint16_t *)malloc(tempSize * sizeof(temp[0]));
 
-         if (f->IsDir)
+         if (!temp)
          {
-            /* We skip over everything which is not a directory. 
-             * FIXME: Why continue then if f->IsDir is true?*/
-            continue;
+            res = SZ_ERROR_MEM;
+            break;
          }
+      }
 
-         len = SzArEx_GetFileNameUtf16(&db, i, NULL);
-         if (len > tempSize)
-         {
-            free(temp);
-            tempSize = len;
-            temp = (uint16_t *)malloc(tempSize * sizeof(temp[0]));
-            if (temp == 0)
-            {
-               res = SZ_ERROR_MEM;
-               break;
-            }
-         }
-         SzArEx_GetFileNameUtf16(&db, i, temp);
-         res = ConvertUtf16toCharString(temp,infile);
+      SzArEx_GetFileNameUtf16(&archive->db, i, temp);
+      if (ConvertUtf16toCharString(temp, infile) != SZ_OK)
+         continue;
+
+      if (!(archive->names[i] = strdup(infile)))
+      {
+         res = SZ_ERROR_MEM;
+         break;
+      }
+   }
+
+   free(temp);
+   return res;
+}
+
+/**
+ * sz_archive_get:
+ * @path                      : Path of the 7z archive.
+ * @res                       : SZ_ERROR_READ if the archive could not
+ *                              be opened, otherwise the decoder result.
+ *
+ * Returns the cached archive for @path, parsing it first if it is
+ * not cached or changed on disk. Call with the cache lock held.
+ *
+ * Returns: archive, or NULL on error.
+ **/
+static struct sz_archive *sz_archive_get(const char *path, SRes *res)
+{
+   size_t i;
+   struct stat st;
+   struct sz_stream stream;
+   struct sz_archive *archive = NULL;
+
+   *res = SZ_ERROR_READ;
+
+   if (stat(path, &st) != 0)
+      return NULL;
+
+   for (i = 0; i < SZ_ARCHIVE_CACHE_SIZE; i++)
+   {
+      struct sz_archive *cached = &sz_archives[i];
+
+      if (!cached->open || strcmp(cached->path, path))
+         continue;
 
-         if (!strcmp(infile, relative_path))
+      if (cached->size == (uint64_t)st.st_size
+            && cached->mtime == (uint64_t)st.st_mtime)
+      {
+         cached->last_used = ++sz_clock;
+         *res              = SZ_OK;
+         return cached;
+      }
+
+      sz_archive_close(cached);
+   }
+
+   for (i = 0; i < SZ_ARCHIVE_CACHE_SIZE; i++)
+   {
+      if (!archive || !sz_archives[i].open
+            || (archive->open
+               && sz_archives[i].last_used < archive->last_used))
+         archive = &sz_archives[i];
+   }
+   sz_archive_close(archive);
+
+   if (!sz_stream_open(&stream, path))
+      return NULL;
+
+   CrcGenerateTable();
+   SzArEx_Init(&archive->db);
+   *res = SzArEx_Open(&archive->db, &stream.lookStream.s,
+         &sz_alloc, &sz_alloc_temp);
+   sz_stream_close(&stream);
+
+   if (*res != SZ_OK)
+   {
+      SzArEx_Free(&archive->db, &sz_alloc);
+      return NULL;
+   }
+
+   strlcpy(archive->path, path, sizeof(archive->path));
+   archive->size      = st.st_size;
+   archive->mtime     = st.st_mtime;
+   archive->last_used = ++sz_clock;
+   archive->open      = true;
+
+   if ((*res = sz_archive_read_names(archive)) != SZ_OK)
+   {
+      sz_archive_close(archive);
+      return NULL;
+   }
+
+   return archive;
+}
+
+static int64_t sz_archive_find(const struct sz_archive *archive,
+      const char *relative_path)
+{
+   uint32_t i;
+
+   for (i = 0; i < archive->db.db.NumFiles; i++)
+   {
+      if (archive->names[i] && !strcmp(archive->names[i], relative_path))
+         return i;
+   }
+
+   return -1;
+}
+
+static struct sz_block *sz_block_find(struct sz_archive *archive,
+      uint32_t folder)
+{
+   size_t i;
+
+   for (i = 0; i < archive->num_blocks; i++)
+   {
+      if (archive->blocks[i].folder == folder)
+         return &archive->blocks[i];
+   }
+
+   return NULL;
+}
+
+static void sz_block_evict(size_t need)
+{
+   while (sz_block_total + need > SZ_BLOCK_CACHE_MAX)
+   {
+      size_t i, j;
+      struct sz_archive *owner = NULL;
+      struct sz_block *oldest  = NULL;
+
+      for (i = 0; i < SZ_ARCHIVE_CACHE_SIZE; i++)
+      {
+         for (j = 0; j < sz_archives[i].num_blocks; j++)
          {
-            /* C LZMA SDK does not support chunked extraction - see here:
-             * sourceforge.net/p/sevenzip/discussion/45798/thread/6fb59aaf/
-             * */
-            file_found = true;
-            res = SzArEx_Extract(&db, &lookStream.s, i,&blockIndex,
-                  &outBuffer, &outBufferSize,&offset, &outSizeProcessed,
-                  &allocImp, &allocTempImp);
-            if (res != SZ_OK)
-            {
-               break; /* This goes to the error section. */
-            }
-            outsize = outSizeProcessed;
-            if (optional_outfile != NULL)
-            {
-               FILE* outsink = fopen(optional_outfile,"wb");
-               if (outsink == NULL)
-               {
-                  RARCH_ERR("Could not open outfilepath %s.\n",
-                        optional_outfile);
-                  IAlloc_Free(&allocImp, outBuffer);
-                  SzArEx_Free(&db, &allocImp);
-                  free(temp);
-                  File_Close(&archiveStream.file);
-                  return -1;
-               }
-               fwrite(outBuffer+offset,1,outsize,outsink);
-               fclose(outsink);
-            }
-            else
+            struct sz_block *block = &sz_archives[i].blocks[j];
+
+            if (!oldest || block->last_used < oldest->last_used)
             {
-               /*We could either use the 7Zip allocated buffer,
-                * or create our own and use it.
-                * We would however need to realloc anyways, because RetroArch
-                * expects a \0 at the end, therefore we allocate new,
-                * copy and free the old one. */
-               *buf = malloc(outsize + 1);
-               ((char*)(*buf))[outsize] = '\0';
-               memcpy(*buf,outBuffer+offset,outsize);
+               oldest = block;
+               owner  = &sz_archives[i];
             }
-            IAlloc_Free(&allocImp, outBuffer);
-            break;
          }
       }
+
+      if (!oldest)
+         break;
+
+      sz_block_total -= oldest->size;
+      IAlloc_Free(&sz_alloc, oldest->data);
+      *oldest = owner->blocks[--owner->num_blocks];
    }
-   SzArEx_Free(&db, &allocImp);
-   free(temp);
+}
+
+/* Takes ownership of @data if it returns true. */
+static bool sz_block_insert(struct sz_archive *archive,
+      uint32_t folder, uint8_t *data, size_t size)
+{
+   struct sz_block *blocks = NULL;
+
+   if (!data || size > SZ_BLOCK_CACHE_MAX)
+      return false;
+
+   sz_block_evict(size);
+
+   blocks = (struct sz_block*)realloc(archive->blocks,
+         (archive->num_blocks + 1) * sizeof(*blocks));
+   if (!blocks)
+      return false;
+
+   archive->blocks = blocks;
+   blocks[archive->num_blocks].folder    = folder;
+   blocks[archive->num_blocks].data      = data;
+   blocks[archive->num_blocks].size      = size;
+   blocks[archive->num_blocks].last_used = ++sz_clock;
+   archive->num_blocks++;
+   sz_block_total += size;
+   return true;
+}
 
-   File_Close(&archiveStream.file);
+/**
+ * sz_archive_extract:
+ * @archive                   : Cached archive.
+ * @index                     : File to extract.
+ * @data                      : Contents of the file.
+ * @size                      : Size of the file.
+ * @owned                     : Buffer to IAlloc_Free() after use,
+ *                              NULL if @data lives in the block cache.
+ *
+ * Decodes the solid block holding @index unless it is cached.
+ * Call with the cache lock held.
+ *
+ * Returns: SZ_OK on success.
+ **/
+static SRes sz_archive_extract(struct sz_archive *archive, uint32_t index,
+      const uint8_t **data, size_t *size, uint8_t **owned)
+{
+   SRes res;
+   struct sz_stream stream;
+   size_t offset          = 0;
+   size_t outSizeProcessed = 0;
+   uint32_t blockIndex    = 0xFFFFFFFF;
+   uint8_t *outBuffer     = NULL;
+   size_t outBufferSize   = 0;
+   uint32_t folder        = archive->db.FileIndexToFolderIndexMap[index];
+   struct sz_block *block = (folder != (uint32_t)-1)
+      ? sz_block_find(archive, folder) : NULL;
+
+   *owned = NULL;
+
+   if (block)
+   {
+      block->last_used = ++sz_clock;
+      blockIndex       = folder;
+      outBuffer        = block->data;
+      outBufferSize    = block->size;
+
+      /* No decoding, the stream is not touched. */
+      res = SzArEx_Extract(&archive->db, NULL, index,
+            &blockIndex, &outBuffer, &outBufferSize, &offset,
+            &outSizeProcessed, &sz_alloc, &sz_alloc_temp);
+   }
+   else
+   {
+      if (!sz_stream_open(&stream, archive->path))
+         return SZ_ERROR_READ;
+
+      /* C LZMA SDK does not support chunked extraction - see here:
+       * sourceforge.net/p/sevenzip/discussion/45798/thread/6fb59aaf/
+       * */
+      res = SzArEx_Extract(&archive->db, &stream.lookStream.s, index,
+            &blockIndex, &outBuffer, &outBufferSize, &offset,
+            &outSizeProcessed, &sz_alloc, &sz_alloc_temp);
+      sz_stream_close(&stream);
+
+      /* A block that failed to decode or to pass its CRC
+       * must never be served from the cache. */
+      if (res != SZ_OK)
+      {
+         IAlloc_Free(&sz_alloc, outBuffer);
+         outBuffer = NULL;
+      }
+      else if (!sz_block_insert(archive, folder, outBuffer, outBufferSize))
+         *owned = outBuffer;
+   }
 
-   if (res == SZ_OK && file_found == true)
-      return outsize;
+   *data = outBuffer ? outBuffer + offset : NULL;
+   *size = outSizeProcessed;
+   return res;
+}
 
-   /* Error handling */
-   if (!file_found)
-      RARCH_ERR("File %s not found in %s\n",relative_path,archive_path);
-   else if (res == SZ_ERROR_UNSUPPORTED)
+static void sz_report_error(SRes res)
+{
+   if (res == SZ_ERROR_UNSUPPORTED)
       RARCH_ERR("7Zip decoder doesn't support this archive\n");
    else if (res == SZ_ERROR_MEM)
       RARCH_ERR("7Zip decoder could not allocate memory\n");
@@ -325,151 +597,344 @@ int read_7zip_file(
       RARCH_ERR("7Zip decoder encountered a CRC error in the archive\n");
    else
       RARCH_ERR("\nUnspecified error in 7-ZIP archive, error number was: #%d\n", res);
-   return -1;
 }
 
-struct string_list *compressed_7zip_file_list_new(const char *path,
-      const char* ext)
+/* Extract the relative path relative_path from a 7z archive 
+ * archive_path and allocate a buf for it to write it in.
+ * If optional_outfile is set, extract to that instead and don't alloc buffer.
+ */
+int read_7zip_file(
+      const char *archive_path,
+      const char *relative_path, void **buf,
+      const char *optional_outfile)
 {
-   CFileInStream archiveStream;
-   CLookToRead lookStream;
-   CSzArEx db;
    SRes res;
-   ISzAlloc allocImp;
-   ISzAlloc allocTempImp;
-   uint16_t *temp               = NULL;
-   size_t tempSize              = 0;
-   long outsize                 = -1;
-
-   struct string_list *ext_list = NULL;
-   struct string_list     *list = string_list_new();
-
-   if (!list)
-      return NULL;
+   int64_t index;
+   const uint8_t *data        = NULL;
+   uint8_t *owned             = NULL;
+   size_t size                = 0;
+   long outsize               = -1;
+   struct sz_archive *archive = NULL;
 
-   if (ext)
-      ext_list = string_split(ext, "|");
+   sz_cache_lock();
 
-   (void)outsize;
+   if (!(archive = sz_archive_get(archive_path, &res)))
+   {
+      sz_cache_unlock();
+      if (res == SZ_ERROR_READ)
+         RARCH_ERR("Could not open %s as 7z archive\n.",archive_path);
+      else
+         sz_report_error(res);
+      return -1;
+   }
 
-   /* These are the allocation routines - currently using 
-    * the non-standard 7zip choices. */
-   allocImp.Alloc     = SzAlloc;
-   allocImp.Free      = SzFree;
-   allocTempImp.Alloc = SzAllocTemp;
-   allocTempImp.Free  = SzFreeTemp;
+   RARCH_LOG_OUTPUT("Openend archive %s. Now trying to extract %s\n",
+         archive_path,relative_path);
 
-   if (InFile_Open(&archiveStream.file, path))
+   if ((index = sz_archive_find(archive, relative_path)) < 0)
    {
-      RARCH_ERR("Could not open %s as 7z archive.\n",path);
-      goto error;
+      sz_cache_unlock();
+      RARCH_ERR("File %s not found in %s\n",relative_path,archive_path);
+      return -1;
    }
 
-   FileInStream_CreateVTable(&archiveStream);
-   LookToRead_CreateVTable(&lookStream, False);
-   lookStream.realStream = &archiveStream.s;
-   LookToRead_Init(&lookStream);
-   CrcGenerateTable();
-   SzArEx_Init(&db);
-   res = SzArEx_Open(&db, &lookStream.s, &allocImp, &allocTempImp);
+   res = sz_archive_extract(archive, (uint32_t)index, &data, &size, &owned);
 
    if (res == SZ_OK)
    {
-      uint32_t i;
-      uint32_t blockIndex  = 0xFFFFFFFF;
-      uint8_t *outBuffer   = 0;
-      size_t outBufferSize = 0;
-
-      (void)blockIndex;
-      (void)outBufferSize;
-      (void)outBuffer;
+      outsize = size;
 
-      for (i = 0; i < db.db.NumFiles; i++)
+      if (optional_outfile != NULL)
       {
-         union string_list_elem_attr attr;
-         const char *file_ext         = NULL;
-         char infile[PATH_MAX_LENGTH] = {0};
-         size_t offset                = 0;
-         size_t outSizeProcessed      = 0;
-         size_t                   len = 0;
-         bool supported_by_core       = false;
-         const CSzFileItem         *f = db.db.Files + i;
-
-         (void)offset;
-         (void)outSizeProcessed;
-
-         if (f->IsDir)
+         FILE* outsink = fopen(optional_outfile,"wb");
+
+         if (outsink == NULL)
          {
-            /* we skip over everything, which is a directory. */
-            continue;
+            RARCH_ERR("Could not open outfilepath %s.\n",
+                  optional_outfile);
+            outsize = -1;
          }
-         len = SzArEx_GetFileNameUtf16(&db, i, NULL);
-         if (len > tempSize)
+         else
          {
-            free(temp);
-            tempSize = len;
-            temp     = (uint16_t *)malloc(tempSize * sizeof(temp[0]));
-
-            if (temp == 0)
+            if (fwrite(data, 1, size, outsink) != size)
             {
-               res = SZ_ERROR_MEM;
-               break;
+               RARCH_ERR("Error writing to %s.\n", optional_outfile);
+               outsize = -1;
             }
+            fclose(outsink);
+         }
+      }
+      else
+      {
+         /* RetroArch expects a \0 at the end, therefore we
+          * allocate new and copy out of the decoded block. */
+         *buf = malloc(size + 1);
+         if (*buf)
+         {
+            ((char*)(*buf))[size] = '\0';
+            if (size)
+               memcpy(*buf, data, size);
          }
-         SzArEx_GetFileNameUtf16(&db, i, temp);
-         res      = ConvertUtf16toCharString(temp, infile);
-         file_ext = path_get_extension(infile);
+         else
+            outsize = -1;
+      }
+   }
 
-         if (string_list_find_elem_prefix(ext_list, ".", file_ext))
-            supported_by_core = true;
+   IAlloc_Free(&sz_alloc, owned);
+   sz_cache_unlock();
 
-         /*
-          * Currently we only support files without subdirs in the archives.
-          * Folders are not supported (differences between win and lin.
-          * Archives within archives should imho never be supported.
-          */
+   if (res != SZ_OK)
+   {
+      sz_report_error(res);
+      return -1;
+   }
+
+   return outsize;
+}
 
-         if (!supported_by_core)
-            continue;
+struct string_list *compressed_7zip_file_list_new(const char *path,
+      const char* ext)
+{
+   SRes res;
+   uint32_t i;
+   struct sz_archive *archive   = NULL;
+   struct string_list *ext_list = NULL;
+   struct string_list     *list = string_list_new();
 
-         attr.i = RARCH_COMPRESSED_FILE_IN_ARCHIVE;
+   if (!list)
+      return NULL;
 
-         if (!string_list_append(list, infile, attr))
-            goto error;
+   if (ext)
+      ext_list = string_split(ext, "|");
 
-      }
-   }
-   SzArEx_Free(&db, &allocImp);
-   free(temp);
-   File_Close(&archiveStream.file);
+   sz_cache_lock();
 
-   if (res != SZ_OK)
+   if (!(archive = sz_archive_get(path, &res)))
    {
-      /* Error handling */
-      if (res == SZ_ERROR_UNSUPPORTED)
-         RARCH_ERR("7Zip decoder doesn't support this archive. \n");
-      else if (res == SZ_ERROR_MEM)
-         RARCH_ERR("7Zip decoder could not allocate memory. \n");
-      else if (res == SZ_ERROR_CRC)
-         RARCH_ERR("7Zip decoder encountered a CRC error in the archive. \n");
+      if (res == SZ_ERROR_READ)
+         RARCH_ERR("Could not open %s as 7z archive.\n",path);
       else
-         RARCH_ERR(
-               "\nUnspecified error in 7-ZIP archive, error number was: #%d. \n",
-               res);
+         sz_report_error(res);
       goto error;
    }
 
+   for (i = 0; i < archive->db.db.NumFiles; i++)
+   {
+      union string_list_elem_attr attr;
+      const char *infile     = archive->names[i];
+      const char *file_ext   = NULL;
+
+      /* Directories have no name in the cache. */
+      if (!infile)
+         continue;
+
+      file_ext = path_get_extension(infile);
+
+      /*
+       * Currently we only support files without subdirs in the archives.
+       * Folders are not supported (differences between win and lin.
+       * Archives within archives should imho never be supported.
+       */
+
+      if (!string_list_find_elem_prefix(ext_list, ".", file_ext))
+         continue;
+
+      attr.i = RARCH_COMPRESSED_FILE_IN_ARCHIVE;
+
+      if (!string_list_append(list, infile, attr))
+         goto error;
+   }
+
+   sz_cache_unlock();
    string_list_free(ext_list);
    return list;
 
 error:
+   sz_cache_unlock();
    RARCH_ERR("Failed to open compressed_file: \"%s\"\n", path);
-   SzArEx_Free(&db, &allocImp);
-   free(temp);
-   File_Close(&archiveStream.file);
    string_list_free(list);
    string_list_free(ext_list);
    return NULL;
 }
 
+/* Looks up the size and CRC of relative_path in the
+ * archive database without decompressing anything. */
+bool read_7zip_file_info(const char *archive_path,
+      const char *relative_path, uint32_t *crc, uint64_t *size)
+{
+   SRes res;
+   int64_t index;
+   bool ret                   = false;
+   struct sz_archive *archive = NULL;
+
+   sz_cache_lock();
+
+   archive = sz_archive_get(archive_path, &res);
+   index   = archive ? sz_archive_find(archive, relative_path) : -1;
+
+   /* Without a stored CRC the size alone is too weak a key. */
+   if (index >= 0 && archive->db.db.Files[index].CrcDefined)
+   {
+      *crc  = archive->db.db.Files[index].Crc;
+      *size = archive->db.db.Files[index].Size;
+      ret   = true;
+   }
+
+   sz_cache_unlock();
+   return ret;
+}
+
+#ifdef HAVE_THREADS
+struct sz_prefetch
+{
+   const struct sz_archive *archive;
+   uint32_t index;
+   uint32_t folder;
+   uint8_t *data;
+   size_t size;
+   SRes res;
+   sthread_t *thread;
+};
+
+static void sz_prefetch_thread(void *data)
+{
+   struct sz_stream stream;
+   struct sz_prefetch *job = (struct sz_prefetch*)data;
+   uint32_t blockIndex     = 0xFFFFFFFF;
+   size_t offset           = 0;
+   size_t outSizeProcessed = 0;
+
+   /* Each decoder needs its own stream, the database is shared. */
+   if (!sz_stream_open(&stream, job->archive->path))
+   {
+      job->res = SZ_ERROR_READ;
+      return;
+   }
+
+   job->res = SzArEx_Extract(&job->archive->db, &stream.lookStream.s,
+         job->index, &blockIndex, &job->data, &job->size, &offset,
+         &outSizeProcessed, &sz_alloc, &sz_alloc_temp);
+   sz_stream_close(&stream);
+}
+#endif
+
+/**
+ * compressed_7zip_prefetch:
+ * @archive_path              : Path of the 7z archive.
+ * @members                   : Files that are about to be read.
+ *
+ * Decodes the solid blocks holding @members in parallel into
+ * the block cache, as far as they fit. Does nothing unless
+ * there are several blocks to decode.
+ **/
+void compressed_7zip_prefetch(const char *archive_path,
+      const struct string_list *members)
+{
+#ifdef HAVE_THREADS
+   SRes res;
+   size_t i, j, count = 0;
+   size_t total                = sz_block_total;
+   struct sz_prefetch *jobs    = NULL;
+   struct sz_archive *archive  = NULL;
+
+   if (!members || members->size < 2)
+      return;
+
+   sz_cache_lock();
+
+   if (!(archive = sz_archive_get(archive_path, &res)))
+      goto end;
+
+   if (!(jobs = (struct sz_prefetch*)calloc(members->size, sizeof(*jobs))))
+      goto end;
+
+   for (i = 0; i < members->size; i++)
+   {
+      uint32_t folder;
+      uint64_t unpack_size;
+      int64_t index = sz_archive_find(archive, members->elems[i].data);
+
+      if (index < 0)
+         continue;
+
+      folder = archive->db.FileIndexToFolderIndexMap[index];
+      if (folder == (uint32_t)-1 || sz_block_find(archive, folder))
+         continue;
+
+      for (j = 0; j < count; j++)
+      {
+         if (jobs[j].folder == folder)
+            break;
+      }
+      if (j < count)
+         continue;
+
+      /* Only what fits next to the blocks cached so far. */
+      unpack_size = SzFolder_GetUnpackSize(archive->db.db.Folders + folder);
+      if (total + unpack_size > SZ_BLOCK_CACHE_MAX)
+         continue;
+      total += unpack_size;
+
+      jobs[count].archive = archive;
+      jobs[count].index   = (uint32_t)index;
+      jobs[count].folder  = folder;
+      count++;
+   }
+
+   if (count < 2)
+      goto end;
+
+   RARCH_LOG("Decoding %u 7z blocks of %s in parallel.\n",
+         (unsigned)count, archive_path);
+
+   for (i = 0; i < count; i += SZ_PREFETCH_THREADS)
+   {
+      size_t last = min(i + SZ_PREFETCH_THREADS, count);
+
+      for (j = i; j < last; j++)
+      {
+         jobs[j].thread = sthread_create(sz_prefetch_thread, &jobs[j]);
+         if (!jobs[j].thread)
+            sz_prefetch_thread(&jobs[j]);
+      }
+
+      for (j = i; j < last; j++)
+      {
+         if (jobs[j].thread)
+            sthread_join(jobs[j].thread);
+      }
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      if (jobs[i].res != SZ_OK
+            || !sz_block_insert(archive, jobs[i].folder,
+               jobs[i].data, jobs[i].size))
+         IAlloc_Free(&sz_alloc, jobs[i].data);
+   }
+
+end:
+   free(jobs);
+   sz_cache_unlock();
+#else
+   (void)archive_path;
+   (void)members;
+#endif
+}
+
+/**
+ * compressed_7zip_cache_free:
+ *
+ * Releases cached archives and decoded blocks.
+ **/
+void compressed_7zip_cache_free(void)
+{
+   size_t i;
+
+   sz_cache_lock();
+   for (i = 0; i < SZ_ARCHIVE_CACHE_SIZE; i++)
+      sz_archive_close(&sz_archives[i]);
+   sz_cache_unlock();
+}
+
 #undef RARCH_ZIP_SUPPORT_BUFFER_SIZE_MAX
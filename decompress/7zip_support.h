@@ -17,6 +17,10 @@
 #ifndef __RARCH_7ZIP_SUPPORT_H
 #define __RARCH_7ZIP_SUPPORT_H
 
+#include <stdint.h>
+#include <boolean.h>
+#include <string/string_list.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -27,6 +31,14 @@ int read_7zip_file(const char * archive_path,
 struct string_list *compressed_7zip_file_list_new(const char *path,
       const char* ext);
 
+bool read_7zip_file_info(const char *archive_path,
+      const char *relative_path, uint32_t *crc, uint64_t *size);
+
+void compressed_7zip_prefetch(const char *archive_path,
+      const struct string_list *members);
+
+void compressed_7zip_cache_free(void);
+
 #ifdef __cplusplus
 }
 #endif
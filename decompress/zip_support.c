@@ -191,4 +191,29 @@ error:
    return -1;
 }
 
+/* Looks up the size and CRC of relative_path in the central
+ * directory of archive_path without decompressing anything. */
+bool read_zip_file_info(const char *archive_path,
+      const char *relative_path, uint32_t *crc, uint64_t *size)
+{
+   unz_file_info file_info;
+   bool ret        = false;
+   unzFile zipfile = unzOpen(archive_path);
+
+   if (!zipfile)
+      return false;
+
+   if (unzLocateFile(zipfile, relative_path, 1) == UNZ_OK
+         && unzGetCurrentFileInfo(zipfile, &file_info,
+            NULL, 0, NULL, 0, NULL, 0) == UNZ_OK)
+   {
+      *crc  = file_info.crc;
+      *size = file_info.uncompressed_size;
+      ret   = true;
+   }
+
+   unzClose(zipfile);
+   return ret;
+}
+
 #undef RARCH_ZIP_SUPPORT_BUFFER_SIZE_MAX
@@ -17,6 +17,9 @@
 #ifndef __RARCH_ZIP_SUPPORT_H
 #define __RARCH_ZIP_SUPPORT_H
 
+#include <stdint.h>
+#include <boolean.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,6 +27,9 @@ extern "C" {
 int read_zip_file(const char * archive_path,
       const char *relative_path, void **buf, const char* optional_outfile);
 
+bool read_zip_file_info(const char *archive_path,
+      const char *relative_path, uint32_t *crc, uint64_t *size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,383 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <file/file_path.h>
+#include <compat/strl.h>
+#include <rhash.h>
+
+#include "extract_cache.h"
+#include "file_ops.h"
+#include "general.h"
+
+#define EXTRACT_CACHE_INDEX  "extract_cache.idx"
+#define EXTRACT_CACHE_HEADER "# RetroArch extraction cache 1"
+
+/* One extracted archive member. The key is everything
+ * before last_used; last_used is an LRU clock, not a time. */
+struct extract_cache_entry
+{
+   uint64_t archive_size;
+   uint64_t archive_mtime;
+   uint64_t size;
+   uint32_t crc;
+   uint64_t last_used;
+   char *file;
+   char *source;
+};
+
+typedef struct extract_cache
+{
+   struct extract_cache_entry *entries;
+   size_t count;
+   size_t capacity;
+   uint64_t clock;
+   uint64_t total;
+   char dir[PATH_MAX_LENGTH];
+   char index_path[PATH_MAX_LENGTH];
+} extract_cache_t;
+
+static bool extract_cache_stat(const char *path,
+      uint64_t *mtime, uint64_t *size)
+{
+   struct stat buf;
+
+   if (stat(path, &buf) < 0)
+      return false;
+
+   if (mtime)
+      *mtime = buf.st_mtime;
+   *size = buf.st_size;
+   return true;
+}
+
+static struct extract_cache_entry *extract_cache_append(
+      extract_cache_t *cache)
+{
+   struct extract_cache_entry *entry = NULL;
+
+   if (cache->count == cache->capacity)
+   {
+      size_t capacity = cache->capacity ? cache->capacity * 2 : 16;
+      struct extract_cache_entry *entries = (struct extract_cache_entry*)
+         realloc(cache->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         return NULL;
+
+      cache->entries  = entries;
+      cache->capacity = capacity;
+   }
+
+   entry = &cache->entries[cache->count++];
+   memset(entry, 0, sizeof(*entry));
+   return entry;
+}
+
+static void extract_cache_remove(extract_cache_t *cache, size_t i)
+{
+   struct extract_cache_entry *entry = &cache->entries[i];
+
+   cache->total -= entry->size;
+   free(entry->file);
+   free(entry->source);
+   *entry = cache->entries[--cache->count];
+}
+
+static void extract_cache_free(extract_cache_t *cache)
+{
+   while (cache->count)
+      extract_cache_remove(cache, cache->count - 1);
+   free(cache->entries);
+}
+
+/* Parses "archive_size mtime crc size last_used\tfile\tsource". */
+static bool extract_cache_parse(extract_cache_t *cache, char *line)
+{
+   unsigned long long archive_size, archive_mtime, size, last_used;
+   unsigned crc;
+   struct extract_cache_entry *entry = NULL;
+   char *file                        = strchr(line, '\t');
+   char *source                      = file ? strchr(file + 1, '\t') : NULL;
+   char *end                         = NULL;
+
+   if (!source)
+      return false;
+
+   *file++   = '\0';
+   *source++ = '\0';
+   if ((end = strpbrk(source, "\r\n")))
+      *end = '\0';
+
+   if (!*file || !*source || strchr(file, '/') || strchr(file, '\\'))
+      return false;
+
+   if (sscanf(line, "%llu %llu %x %llu %llu", &archive_size,
+            &archive_mtime, &crc, &size, &last_used) != 5)
+      return false;
+
+   if (!(entry = extract_cache_append(cache)))
+      return false;
+
+   entry->archive_size  = archive_size;
+   entry->archive_mtime = archive_mtime;
+   entry->crc           = crc;
+   entry->size          = size;
+   entry->last_used     = last_used;
+   entry->file          = strdup(file);
+   entry->source        = strdup(source);
+
+   if (!entry->file || !entry->source)
+   {
+      extract_cache_remove(cache, cache->count - 1);
+      return false;
+   }
+
+   cache->total += size;
+   if (last_used >= cache->clock)
+      cache->clock = last_used + 1;
+   return true;
+}
+
+static void extract_cache_load(extract_cache_t *cache)
+{
+   char line[PATH_MAX_LENGTH * 2 + 128];
+   FILE *file = fopen(cache->index_path, "r");
+
+   if (!file)
+      return;
+
+   if (fgets(line, sizeof(line), file)
+         && !strncmp(line, EXTRACT_CACHE_HEADER,
+            strlen(EXTRACT_CACHE_HEADER)))
+   {
+      while (fgets(line, sizeof(line), file))
+      {
+         if (!extract_cache_parse(cache, line))
+            RARCH_WARN("Skipping bad extraction cache entry.\n");
+      }
+   }
+
+   fclose(file);
+}
+
+static bool extract_cache_save(const extract_cache_t *cache)
+{
+   size_t i;
+   bool ret                       = true;
+   char tmp_path[PATH_MAX_LENGTH + 4] = {0};
+   FILE *file                     = NULL;
+
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", cache->index_path);
+
+   if (!(file = fopen(tmp_path, "w")))
+      return false;
+
+   fprintf(file, "%s\n", EXTRACT_CACHE_HEADER);
+
+   for (i = 0; i < cache->count; i++)
+   {
+      const struct extract_cache_entry *entry = &cache->entries[i];
+
+      fprintf(file, "%llu %llu %08x %llu %llu\t%s\t%s\n",
+            (unsigned long long)entry->archive_size,
+            (unsigned long long)entry->archive_mtime,
+            (unsigned)entry->crc,
+            (unsigned long long)entry->size,
+            (unsigned long long)entry->last_used,
+            entry->file, entry->source);
+   }
+
+   ret = !ferror(file);
+   ret = (fclose(file) == 0) && ret;
+
+   /* rename() won't replace an existing file on Windows. */
+#ifdef _WIN32
+   if (ret)
+      remove(cache->index_path);
+#endif
+   if (ret && rename(tmp_path, cache->index_path) != 0)
+      ret = false;
+   if (!ret)
+      remove(tmp_path);
+
+   return ret;
+}
+
+static void extract_cache_delete(extract_cache_t *cache, size_t i)
+{
+   char path[PATH_MAX_LENGTH] = {0};
+
+   fill_pathname_join(path, cache->dir,
+         cache->entries[i].file, sizeof(path));
+   remove(path);
+   extract_cache_remove(cache, i);
+}
+
+/* Evicts least recently used entries until @need more bytes fit. */
+static void extract_cache_evict(extract_cache_t *cache,
+      uint64_t max_size, uint64_t need)
+{
+   while (cache->count && cache->total + need > max_size)
+   {
+      size_t i, oldest = 0;
+
+      for (i = 1; i < cache->count; i++)
+      {
+         if (cache->entries[i].last_used < cache->entries[oldest].last_used)
+            oldest = i;
+      }
+
+      RARCH_LOG("Evicting \"%s\" from extraction cache.\n",
+            cache->entries[oldest].source);
+      extract_cache_delete(cache, oldest);
+   }
+}
+
+bool extract_cache_fetch(const char *path, const char *cache_dir,
+      uint64_t max_size, char *out_path, size_t size)
+{
+   size_t i;
+   ssize_t len;
+   uint32_t crc;
+   uint64_t member_size, archive_size, archive_mtime, file_size;
+   extract_cache_t cache;
+   struct extract_cache_entry *entry      = NULL;
+   char archive_path[PATH_MAX_LENGTH]     = {0};
+   char file[PATH_MAX_LENGTH]             = {0};
+   char tmp_path[PATH_MAX_LENGTH]         = {0};
+   char *hash                             = NULL;
+   bool ret                               = false;
+
+   /* The index is line and tab separated. */
+   if (strpbrk(path, "\t\r\n"))
+      return false;
+
+   strlcpy(archive_path, path, sizeof(archive_path));
+   if (!(hash = strchr(archive_path, '#')))
+      return false;
+   *hash = '\0';
+
+   if (!extract_cache_stat(archive_path, &archive_mtime, &archive_size))
+      return false;
+   if (!read_compressed_file_info(path, &crc, &member_size))
+      return false;
+   if (member_size > max_size)
+      return false;
+
+   memset(&cache, 0, sizeof(cache));
+   strlcpy(cache.dir, cache_dir, sizeof(cache.dir));
+   fill_pathname_join(cache.index_path, cache_dir,
+         EXTRACT_CACHE_INDEX, sizeof(cache.index_path));
+   extract_cache_load(&cache);
+
+   for (i = 0; i < cache.count; i++)
+   {
+      if (!strcmp(cache.entries[i].source, path))
+         break;
+   }
+
+   if (i < cache.count)
+   {
+      entry = &cache.entries[i];
+      fill_pathname_join(out_path, cache_dir, entry->file, size);
+
+      if (entry->archive_size == archive_size
+            && entry->archive_mtime == archive_mtime
+            && entry->crc == crc && entry->size == member_size
+            && extract_cache_stat(out_path, NULL, &file_size)
+            && file_size == member_size)
+      {
+         RARCH_LOG("Using \"%s\" from extraction cache.\n", out_path);
+         entry->last_used = cache.clock++;
+         extract_cache_save(&cache);
+         extract_cache_free(&cache);
+         return true;
+      }
+
+      RARCH_LOG("Extraction cache entry for \"%s\" is stale.\n", path);
+      extract_cache_delete(&cache, i);
+   }
+
+   /* Member CRC and source hash keep names unique while
+    * preserving the extension cores look at. */
+   snprintf(file, sizeof(file), "%08x-%08x-%s", (unsigned)crc,
+         (unsigned)djb2_calculate(path), path_basename(path));
+
+   for (i = 0; i < cache.count; i++)
+   {
+      if (!strcmp(cache.entries[i].file, file))
+      {
+         extract_cache_delete(&cache, i);
+         break;
+      }
+   }
+
+   extract_cache_evict(&cache, max_size, member_size);
+
+   fill_pathname_join(out_path, cache_dir, file, size);
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", out_path);
+   remove(tmp_path);
+
+   RARCH_LOG("Extracting \"%s\" into extraction cache.\n", path);
+
+   if (!read_compressed_file(path, NULL, tmp_path, &len) || len < 0
+         || !extract_cache_stat(tmp_path, NULL, &file_size)
+         || file_size != member_size)
+   {
+      RARCH_ERR("Could not extract \"%s\" into extraction cache.\n", path);
+      remove(tmp_path);
+      goto end;
+   }
+
+   remove(out_path);
+   if (rename(tmp_path, out_path) != 0)
+   {
+      remove(tmp_path);
+      goto end;
+   }
+
+   if (!(entry = extract_cache_append(&cache)))
+      goto end;
+
+   entry->archive_size  = archive_size;
+   entry->archive_mtime = archive_mtime;
+   entry->crc           = crc;
+   entry->size          = member_size;
+   entry->last_used     = cache.clock++;
+   entry->file          = strdup(file);
+   entry->source        = strdup(path);
+   cache.total         += member_size;
+
+   if (!entry->file || !entry->source)
+   {
+      remove(out_path);
+      extract_cache_remove(&cache, cache.count - 1);
+      goto end;
+   }
+
+   ret = extract_cache_save(&cache);
+   if (!ret)
+      remove(out_path);
+
+end:
+   extract_cache_free(&cache);
+   return ret;
+}
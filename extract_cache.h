@@ -0,0 +1,54 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_EXTRACT_CACHE_H
+#define __RARCH_EXTRACT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * extract_cache_fetch:
+ * @path                      : Archive member to extract (archive#member).
+ * @cache_dir                 : Directory holding the cache.
+ * @max_size                  : Size cap of the cache in bytes.
+ * @out_path                  : Path of the extracted file.
+ * @size                      : Size of @out_path.
+ *
+ * Looks up @path in the extraction cache, keyed by archive path,
+ * member name, archive size and mtime, and the member size and
+ * CRC from the archive directory. On a miss the member is
+ * extracted into the cache, evicting least recently used
+ * entries to stay below @max_size.
+ *
+ * Files returned from the cache must not be deleted by the caller.
+ *
+ * Returns: true (1) if @out_path holds the extracted file,
+ * otherwise false (0).
+ **/
+bool extract_cache_fetch(const char *path, const char *cache_dir,
+      uint64_t max_size, char *out_path, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -223,6 +223,122 @@ int read_compressed_file(const char * path, void **buf,
 #endif
    return 0;
 }
+
+/**
+ * read_compressed_file_info:
+ * @path             : path to a file inside an archive
+ *                     (archive#member).
+ * @crc              : CRC32 of the member.
+ * @size             : uncompressed size of the member.
+ *
+ * Reads the size and CRC of a member from the archive
+ * directory without extracting it.
+ *
+ * Returns: true if found, false on error.
+ */
+bool read_compressed_file_info(const char *path,
+      uint32_t *crc, uint64_t *size)
+{
+   const char *file_ext               = NULL;
+   char *archive_found                = NULL;
+   char archive_path[PATH_MAX_LENGTH] = {0};
+
+   strlcpy(archive_path, path, sizeof(archive_path));
+
+   archive_found = strchr(archive_path, '#');
+   if (!archive_found || !archive_found[1])
+      return false;
+
+   *archive_found  = '\0';
+   archive_found  += 1;
+   file_ext        = path_get_extension(archive_path);
+
+   (void)file_ext;
+
+#ifdef HAVE_7ZIP
+   if (strcasecmp(file_ext, "7z") == 0)
+      return read_7zip_file_info(archive_path, archive_found, crc, size);
+#endif
+#ifdef HAVE_ZLIB
+   if (strcasecmp(file_ext, "zip") == 0)
+      return read_zip_file_info(archive_path, archive_found, crc, size);
+#endif
+   return false;
+}
+
+/**
+ * compressed_files_prefetch:
+ * @paths            : paths that are about to be read, entries
+ *                     outside of archives are ignored.
+ *
+ * Decodes what several of @paths need from the same archive
+ * in parallel ahead of reading them, where the format allows.
+ */
+void compressed_files_prefetch(const struct string_list *paths)
+{
+#ifdef HAVE_7ZIP
+   size_t i, j;
+
+   for (i = 0; i < paths->size; i++)
+   {
+      union string_list_elem_attr attr;
+      size_t archive_len;
+      struct string_list *members = NULL;
+      const char *path            = paths->elems[i].data;
+      const char *member          = strchr(path, '#');
+      bool seen                   = false;
+
+      if (!member)
+         continue;
+
+      archive_len = member - path;
+
+      /* Every archive once, from its first occurrence. */
+      for (j = 0; j < i && !seen; j++)
+         seen = !strncmp(paths->elems[j].data, path, archive_len + 1);
+      if (seen)
+         continue;
+
+      if (!(members = string_list_new()))
+         return;
+
+      attr.i = 0;
+      for (j = i; j < paths->size; j++)
+      {
+         if (!strncmp(paths->elems[j].data, path, archive_len + 1))
+            string_list_append(members,
+                  paths->elems[j].data + archive_len + 1, attr);
+      }
+
+      if (members->size > 1)
+      {
+         char archive_path[PATH_MAX_LENGTH] = {0};
+
+         strlcpy(archive_path, path,
+               min(archive_len + 1, sizeof(archive_path)));
+
+         if (strcasecmp(path_get_extension(archive_path), "7z") == 0)
+            compressed_7zip_prefetch(archive_path, members);
+      }
+
+      string_list_free(members);
+   }
+#else
+   (void)paths;
+#endif
+}
+
+/**
+ * compressed_file_cache_free:
+ *
+ * Releases archives and decoded data kept between reads.
+ */
+void compressed_file_cache_free(void)
+{
+#ifdef HAVE_7ZIP
+   compressed_7zip_cache_free();
+#endif
+}
 #endif
 
 /**
@@ -289,7 +405,8 @@ static void print_rzip_progress(const uint64_t current, const uint64_t total,
       snprintf(msg, sizeof(msg), "%s %u%%", msg_prefix,
                (unsigned)((100 * current) / total));
 
-      rarch_main_msg_queue_push(msg, 1, 1, true);
+      rarch_main_msg_queue_push_id(RARCH_MSG_QUEUE_ID_PROGRESS,
+            msg, 1, 1, true);
       video_driver_cached_frame();
 
       prev_usec = now_usec;
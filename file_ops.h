@@ -35,6 +35,38 @@ extern "C" {
  */
 int read_compressed_file(const char * path, void **buf,
       const char* optional_filename, ssize_t *length);
+
+/**
+ * read_compressed_file_info:
+ * @path             : path to a file inside an archive
+ *                     (archive#member).
+ * @crc              : CRC32 of the member.
+ * @size             : uncompressed size of the member.
+ *
+ * Reads the size and CRC of a member from the archive
+ * directory without extracting it.
+ *
+ * Returns: true if found, false on error.
+ */
+bool read_compressed_file_info(const char *path,
+      uint32_t *crc, uint64_t *size);
+
+/**
+ * compressed_files_prefetch:
+ * @paths            : paths that are about to be read, entries
+ *                     outside of archives are ignored.
+ *
+ * Decodes what several of @paths need from the same archive
+ * in parallel ahead of reading them, where the format allows.
+ */
+void compressed_files_prefetch(const struct string_list *paths);
+
+/**
+ * compressed_file_cache_free:
+ *
+ * Releases archives and decoded data kept between reads.
+ */
+void compressed_file_cache_free(void);
 #endif
 
 /**
@@ -1296,9 +1296,228 @@ static void gl_init_textures(gl_t *gl, const video_info_t *video)
    glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
 }
 
+#ifdef HAVE_GL_PBO_UPLOAD
+static void gl_init_pbo_upload(gl_t *gl)
+{
+   unsigned i;
+   settings_t *settings = config_get_ptr();
+
+   if (!settings->video.pbo_upload)
+      return;
+   if (gl->hw_render_use || gl->egl_images || !glMapBufferRange)
+      return;
+
+#ifndef HAVE_OPENGLES
+   if (!gl->core_context && (!gl_query_extension(gl, "ARB_pixel_buffer_object")
+            || !gl_query_extension(gl, "ARB_map_buffer_range")))
+      return;
+#endif
+
+   /* Large enough for a full texture after 16 to 32-bit conversion. */
+   gl->pbo_upload_size  = gl->tex_w * gl->tex_h * sizeof(uint32_t);
+   gl->pbo_upload_index = 0;
+
+#if !defined(HAVE_OPENGLES) && defined(HAVE_GL_SYNC) && defined(GL_MAP_PERSISTENT_BIT)
+   /* Map once and keep writing into it. Fences tell us when
+    * the GPU is done with a slot. */
+   if (gl->have_sync && glBufferStorage
+         && gl_query_extension(gl, "ARB_buffer_storage"))
+   {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+         | GL_MAP_COHERENT_BIT;
+
+      glGenBuffers(1, gl->pbo_upload);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo_upload[0]);
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER,
+            gl->pbo_upload_size * PBO_UPLOAD_SLOTS, NULL, flags);
+      gl->pbo_upload_map = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+            0, gl->pbo_upload_size * PBO_UPLOAD_SLOTS, flags);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      if (gl->pbo_upload_map)
+      {
+         RARCH_LOG("[GL]: Uploading frames through persistently mapped buffer.\n");
+         gl->pbo_upload_enable = true;
+         return;
+      }
+
+      glDeleteBuffers(1, gl->pbo_upload);
+      gl->pbo_upload[0] = 0;
+   }
+#endif
+
+   glGenBuffers(PBO_UPLOAD_SLOTS, gl->pbo_upload);
+   for (i = 0; i < PBO_UPLOAD_SLOTS; i++)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo_upload[i]);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, gl->pbo_upload_size,
+            NULL, GL_STREAM_DRAW);
+   }
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   RARCH_LOG("[GL]: Uploading frames through %u PBOs.\n", PBO_UPLOAD_SLOTS);
+   gl->pbo_upload_enable = true;
+}
+
+static void gl_deinit_pbo_upload(gl_t *gl)
+{
+   if (!gl->pbo_upload_enable)
+      return;
+
+   if (gl->pbo_upload_map)
+   {
+#ifdef HAVE_GL_SYNC
+      unsigned i;
+
+      for (i = 0; i < PBO_UPLOAD_SLOTS; i++)
+      {
+         if (!gl->pbo_upload_fences[i])
+            continue;
+
+         glDeleteSync(gl->pbo_upload_fences[i]);
+         gl->pbo_upload_fences[i] = NULL;
+      }
+#endif
+
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo_upload[0]);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers(1, gl->pbo_upload);
+      gl->pbo_upload_map = NULL;
+   }
+   else
+      glDeleteBuffers(PBO_UPLOAD_SLOTS, gl->pbo_upload);
+
+   memset(gl->pbo_upload, 0, sizeof(gl->pbo_upload));
+   gl->pbo_upload_enable = false;
+}
+
+/**
+ * gl_pbo_upload_frame:
+ * @gl                 : GL handle.
+ * @frame              : Software rendered frame.
+ * @width              : Width of @frame.
+ * @height             : Height of @frame.
+ * @pitch              : Pitch of @frame in bytes.
+ *
+ * Writes @frame into the next PBO slot, converting it on the
+ * way if the texture format needs that, and updates the bound
+ * texture from there. The driver can then copy from the PBO
+ * while the CPU goes on, instead of either stalling or making
+ * its own copy of client memory.
+ *
+ * Returns: true (1) if the frame was uploaded, otherwise false (0).
+ **/
+static bool gl_pbo_upload_frame(gl_t *gl, const void *frame,
+      unsigned width, unsigned height, unsigned pitch)
+{
+   unsigned h;
+   size_t out_pitch    = 0;
+   uint8_t *dst        = NULL;
+   GLintptr offset     = 0;
+   unsigned slot       = gl->pbo_upload_index;
+   unsigned out_size   = gl->base_size;
+   bool convert        = false;
+#ifdef HAVE_OPENGLES2
+   driver_t *driver    = driver_get_ptr();
+
+   /* GLES devices without GL_BGRA_EXT. */
+   convert             = gl->base_size == 4 && driver->gfx_use_rgba;
+#else
+   /* Desktop GL without GL_RGB565 gets 32-bit textures. */
+   convert             = gl->base_size == 2 && !gl->have_es2_compat;
+   if (convert)
+      out_size         = sizeof(uint32_t);
+#endif
+
+   out_pitch           = width * out_size;
+   if (out_pitch * height > gl->pbo_upload_size)
+      return false;
+
+   if (gl->pbo_upload_map)
+   {
+#ifdef HAVE_GL_SYNC
+      if (gl->pbo_upload_fences[slot])
+      {
+         glClientWaitSync(gl->pbo_upload_fences[slot],
+               GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+         glDeleteSync(gl->pbo_upload_fences[slot]);
+         gl->pbo_upload_fences[slot] = NULL;
+      }
+#endif
+
+      offset = slot * gl->pbo_upload_size;
+      dst    = gl->pbo_upload_map + offset;
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo_upload[0]);
+   }
+   else
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo_upload[slot]);
+
+      /* Invalidating lets the driver hand out fresh storage
+       * rather than wait for the GPU to finish with this slot. */
+      dst = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+            0, out_pitch * height,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+      if (!dst)
+      {
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+         return false;
+      }
+   }
+
+   if (convert)
+   {
+#ifdef HAVE_OPENGLES2
+      gl_convert_frame_argb8888_abgr8888(gl, dst,
+            frame, width, height, pitch);
+#else
+      gl_convert_frame_rgb16_32(gl, dst,
+            frame, width, height, pitch);
+#endif
+   }
+   else if (pitch == out_pitch)
+      memcpy(dst, frame, out_pitch * height);
+   else
+   {
+      const uint8_t *src = (const uint8_t*)frame;
+
+      for (h = 0; h < height; h++, src += pitch, dst += out_pitch)
+         memcpy(dst, src, out_pitch);
+   }
+
+   if (!gl->pbo_upload_map)
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, video_pixel_get_alignment(out_pitch));
+   glTexSubImage2D(GL_TEXTURE_2D,
+         0, 0, 0, width, height, gl->texture_type,
+         gl->texture_fmt, (const GLvoid*)offset);
+
+#ifdef HAVE_GL_SYNC
+   if (gl->pbo_upload_map)
+      gl->pbo_upload_fences[slot] = glFenceSync(
+            GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+
+   /* Other texture uploads read from client memory. */
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   gl->pbo_upload_index = (slot + 1) % PBO_UPLOAD_SLOTS;
+   return true;
+}
+#endif
+
 static INLINE void gl_copy_frame(gl_t *gl, const void *frame,
       unsigned width, unsigned height, unsigned pitch)
 {
+#ifdef HAVE_GL_PBO_UPLOAD
+   if (gl->pbo_upload_enable
+         && gl_pbo_upload_frame(gl, frame, width, height, pitch))
+      return;
+#endif
+
 #if defined(HAVE_OPENGLES2)
 #if defined(HAVE_EGL)
    if (gl->egl_images)
@@ -1580,8 +1799,13 @@ static bool gl_frame(void *data, const void *frame,
       if (!gl->hw_render_fbo_init)
 #endif
       {
+         RARCH_PERFORMANCE_INIT(copy_frame);
+
          gl_update_input_size(gl, frame_width, frame_height, pitch, true);
+
+         RARCH_PERFORMANCE_START(copy_frame);
          gl_copy_frame(gl, frame, frame_width, frame_height, pitch);
+         RARCH_PERFORMANCE_STOP(copy_frame);
       }
 
       /* No point regenerating mipmaps 
@@ -1828,6 +2052,10 @@ static void gl_free(void *data)
 
    scaler_ctx_gen_reset(&gl->scaler);
 
+#ifdef HAVE_GL_PBO_UPLOAD
+   gl_deinit_pbo_upload(gl);
+#endif
+
 #ifdef HAVE_GL_ASYNC_READBACK
    if (gl->pbo_readback_enable)
    {
@@ -2492,6 +2720,10 @@ static void *gl_init(const video_info_t *video, const input_driver_t **input, vo
    gl_init_pbo_readback(gl);
 #endif
 
+#ifdef HAVE_GL_PBO_UPLOAD
+   gl_init_pbo_upload(gl);
+#endif
+
    if (!gl_check_error())
       goto error;
 
@@ -3175,6 +3407,67 @@ static void gl_set_texture_frame(void *data,
          width, height, frame,
          base_size);
 
+   gl->menu_texture_alpha  = alpha;
+   gl->menu_texture_width  = width;
+   gl->menu_texture_height = height;
+   gl->menu_texture_rgb32  = rgb32;
+   glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+
+   context_bind_hw_render(gl, true);
+}
+
+static void gl_set_texture_frame_rect(void *data,
+      const void *frame, bool rgb32, unsigned width, unsigned height,
+      unsigned x, unsigned y, unsigned rect_width, unsigned rect_height,
+      float alpha)
+{
+   unsigned base_size = rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+   driver_t *driver   = driver_get_ptr();
+   const uint8_t *src = (const uint8_t*)frame;
+   bool row_length    = true;
+   gl_t *gl           = (gl_t*)data;
+   if (!gl)
+      return;
+
+#if defined(HAVE_OPENGLES2)
+   row_length = gl->support_unpack_row_length;
+#elif defined(HAVE_PSGL)
+   row_length = false;
+#endif
+
+   /* Storage has to be (re)created with a full upload. */
+   if (!gl->menu_texture || gl->menu_texture_width != width
+         || gl->menu_texture_height != height
+         || gl->menu_texture_rgb32 != rgb32
+         || x + rect_width > width || y + rect_height > height)
+   {
+      gl_set_texture_frame(gl, frame, rgb32, width, height, alpha);
+      return;
+   }
+
+   /* Without GL_UNPACK_ROW_LENGTH, upload whole rows. */
+   if (!row_length)
+   {
+      x          = 0;
+      rect_width = width;
+   }
+
+   context_bind_hw_render(gl, false);
+
+   glBindTexture(GL_TEXTURE_2D, gl->menu_texture);
+   glPixelStorei(GL_UNPACK_ALIGNMENT,
+         video_pixel_get_alignment(width * base_size));
+   if (row_length)
+      glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, rect_width, rect_height,
+         (driver->gfx_use_rgba || !rgb32) ? GL_RGBA : RARCH_GL_TEXTURE_TYPE32,
+         rgb32 ? RARCH_GL_FORMAT32 : GL_UNSIGNED_SHORT_4_4_4_4,
+         src + (y * width + x) * base_size);
+
+   if (row_length)
+      glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
    gl->menu_texture_alpha = alpha;
    glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
 
@@ -3277,6 +3570,9 @@ static const video_poke_interface_t gl_poke_interface = {
    gl_show_mouse,
    NULL,
    gl_get_current_shader,
+#if defined(HAVE_MENU)
+   gl_set_texture_frame_rect,
+#endif
 };
 
 static void gl_get_poke_interface(void *data,
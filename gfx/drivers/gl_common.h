@@ -46,6 +46,12 @@
 #endif
 #endif
 
+#if (!defined(HAVE_OPENGLES) || defined(HAVE_OPENGLES3)) && !defined(HAVE_PSGL)
+#ifdef GL_PIXEL_UNPACK_BUFFER
+#define HAVE_GL_PBO_UPLOAD
+#endif
+#endif
+
 #if defined(HAVE_PSGL)
 #define RARCH_GL_FRAMEBUFFER GL_FRAMEBUFFER_OES
 #define RARCH_GL_FRAMEBUFFER_COMPLETE GL_FRAMEBUFFER_COMPLETE_OES
@@ -342,11 +348,28 @@ typedef struct gl
 #endif
    void *readback_buffer_screenshot;
 
+#ifdef HAVE_GL_PBO_UPLOAD
+#define PBO_UPLOAD_SLOTS 3
+   /* Ring of PBOs for uploading software rendered frames.
+    * With a persistent mapping, all slots live in pbo_upload[0]. */
+   GLuint pbo_upload[PBO_UPLOAD_SLOTS];
+   uint8_t *pbo_upload_map;
+   size_t pbo_upload_size; /* Per slot. */
+   unsigned pbo_upload_index;
+   bool pbo_upload_enable;
+#ifdef HAVE_GL_SYNC
+   GLsync pbo_upload_fences[PBO_UPLOAD_SLOTS];
+#endif
+#endif
+
 #if defined(HAVE_MENU)
    GLuint menu_texture;
    bool menu_texture_enable;
    bool menu_texture_full_screen;
    GLfloat menu_texture_alpha;
+   unsigned menu_texture_width;
+   unsigned menu_texture_height;
+   bool menu_texture_rgb32;
 #endif
 
 #ifdef HAVE_GL_SYNC
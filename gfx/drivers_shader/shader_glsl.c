@@ -63,6 +63,15 @@ struct glsl_attrib
 
 static gfx_ctx_proc_t (*glsl_get_proc_address)(const char*);
 
+/* Location of a float uniform and the value it was last
+ * set to, so unchanged values aren't uploaded again. */
+struct shader_uniform_value
+{
+   int location;
+   bool uploaded;
+   float value;
+};
+
 struct shader_uniforms_frame
 {
    int texture;
@@ -92,6 +101,9 @@ struct shader_uniforms
    struct shader_uniforms_frame orig;
    struct shader_uniforms_frame pass[GFX_MAX_SHADERS];
    struct shader_uniforms_frame prev[PREV_TEXTURES];
+
+   struct shader_uniform_value parameters[GFX_MAX_PARAMETERS];
+   struct shader_uniform_value variables[GFX_MAX_VARIABLES];
 };
 
 
@@ -215,6 +227,10 @@ typedef struct glsl_shader_data
    GLuint gl_teximage[GFX_MAX_TEXTURES];
    GLint gl_attribs[PREV_TEXTURES + 1 + 4 + GFX_MAX_SHADERS];
    state_tracker_t *gl_state_tracker;
+
+   /* Parameter and state tracker uniform uploads. */
+   uint64_t uniform_calls;
+   uint64_t frames;
 } glsl_shader_data_t;
 
 static bool glsl_core;
@@ -657,6 +673,24 @@ static void find_uniforms(glsl_shader_data_t *glsl,
       find_uniforms_frame(glsl, prog, &uni->prev[i], frame_base);
    }
 
+   /* Parameter and state tracker uniforms are looked up once
+    * here, the values are set every frame. The stock program
+    * shares its uniforms between several indices, but has
+    * neither kind. */
+   for (i = 0; i < glsl->glsl_shader->num_parameters; i++)
+   {
+      uni->parameters[i].location = glGetUniformLocation(prog,
+            glsl->glsl_shader->parameters[i].id);
+      uni->parameters[i].uploaded = false;
+   }
+
+   for (i = 0; i < glsl->glsl_shader->variables; i++)
+   {
+      uni->variables[i].location = glGetUniformLocation(prog,
+            glsl->glsl_shader->variable[i].id);
+      uni->variables[i].uploaded = false;
+   }
+
    glUseProgram(0);
 }
 
@@ -687,6 +721,12 @@ static void gl_glsl_destroy_resources(glsl_shader_data_t *glsl)
    
    current_idx = 0;
 
+   if (glsl->frames)
+      RARCH_LOG("[GLSL]: %.2f parameter and state uniform uploads per frame.\n",
+            (double)glsl->uniform_calls / glsl->frames);
+   glsl->uniform_calls = 0;
+   glsl->frames        = 0;
+
    glUseProgram(0);
    for (i = 0; i < GFX_MAX_SHADERS; i++)
    {
@@ -960,6 +1000,19 @@ error:
    return false;
 }
 
+static void gl_glsl_set_uniform_value(glsl_shader_data_t *glsl,
+      struct shader_uniform_value *uni, float value)
+{
+   if (uni->location < 0 || (uni->uploaded && uni->value == value))
+      return;
+
+   glUniform1f(uni->location, value);
+   glsl->uniform_calls++;
+
+   uni->uploaded = true;
+   uni->value    = value;
+}
+
 static void gl_glsl_set_params(void *data, unsigned width, unsigned height, 
       unsigned tex_width, unsigned tex_height, 
       unsigned out_width, unsigned out_height,
@@ -972,7 +1025,7 @@ static void gl_glsl_set_params(void *data, unsigned width, unsigned height,
    struct glsl_attrib attribs[32];
    float input_size[2], output_size[2], texture_size[2];
    unsigned i, texunit = 1;
-   const struct shader_uniforms *uni = NULL;
+   struct shader_uniforms *uni = NULL;
    size_t size = 0, attribs_size = 0;
    const struct gl_tex_info *info = (const struct gl_tex_info*)_info;
    const struct gl_tex_info *prev_info = (const struct gl_tex_info*)_prev_info;
@@ -985,13 +1038,16 @@ static void gl_glsl_set_params(void *data, unsigned width, unsigned height,
    if (!glsl)
       return;
 
-   uni = (const struct shader_uniforms*)&glsl->gl_uniforms[glsl->glsl_active_index];
+   uni = &glsl->gl_uniforms[glsl->glsl_active_index];
 
    (void)data;
 
    if (glsl->gl_program[glsl->glsl_active_index] == 0)
       return;
 
+   if (glsl->glsl_active_index == 1)
+      glsl->frames++;
+
    input_size [0]  = (float)width;
    input_size [1]  = (float)height;
    output_size[0]  = (float)out_width;
@@ -1159,12 +1215,8 @@ static void gl_glsl_set_params(void *data, unsigned width, unsigned height,
 
    /* #pragma parameters. */
    for (i = 0; i < glsl->glsl_shader->num_parameters; i++)
-   {
-      int location = glGetUniformLocation(
-            glsl->gl_program[glsl->glsl_active_index],
-            glsl->glsl_shader->parameters[i].id);
-      glUniform1f(location, glsl->glsl_shader->parameters[i].current);
-   }
+      gl_glsl_set_uniform_value(glsl, &uni->parameters[i],
+            glsl->glsl_shader->parameters[i].current);
 
    /* Set state parameters. */
    if (glsl->gl_state_tracker)
@@ -1177,12 +1229,8 @@ static void gl_glsl_set_params(void *data, unsigned width, unsigned height,
                GFX_MAX_VARIABLES, frame_count);
 
       for (i = 0; i < cnt; i++)
-      {
-         int location = glGetUniformLocation(
-               glsl->gl_program[glsl->glsl_active_index],
-               state_info[i].id);
-         glUniform1f(location, state_info[i].value);
-      }
+         gl_glsl_set_uniform_value(glsl, &uni->variables[i],
+               state_info[i].value);
    }
 }
 
@@ -0,0 +1,345 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Uploads software frames the three ways the GL driver can
+// (client memory, a ring of stream PBOs and one persistently mapped
+// buffer, see gl_pbo_upload_frame) and reports the CPU cost per frame.
+// Runs headless on a surfaceless Mesa EGL context, so it also works
+// under llvmpipe:
+//
+//   LIBGL_ALWAYS_SOFTWARE=1 EGL_PLATFORM=surfaceless ./pbo-bench
+
+#define GL_GLEXT_PROTOTYPES
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_WIDTH 640
+#define BENCH_HEIGHT 480
+#define BENCH_PITCH_PAD 64
+#define BENCH_TEX_SIZE 1024
+#define BENCH_FRAMES 600
+#define BENCH_SLOTS 3
+
+enum upload_mode
+{
+   UPLOAD_CLIENT = 0,
+   UPLOAD_PBO_RING,
+   UPLOAD_PERSISTENT
+};
+
+enum upload_format
+{
+   FORMAT_RGB565_CONVERTED = 0,
+   FORMAT_RGB565_NATIVE,
+   FORMAT_XRGB8888
+};
+
+static const char *mode_names[] = { "client", "PBO ring", "persistent" };
+static const char *format_names[] = { "565->8888", "565 native", "XRGB8888" };
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+// Same expansion as the GL driver's 565 to 8888 conversion.
+static void convert_rgb565_to_argb8888(uint32_t *out, const uint16_t *in,
+      unsigned width, unsigned height, size_t in_pitch)
+{
+   unsigned x, y;
+   for (y = 0; y < height; y++, out += width,
+         in = (const uint16_t*)((const uint8_t*)in + in_pitch))
+   {
+      for (x = 0; x < width; x++)
+      {
+         uint32_t col = in[x];
+         uint32_t r   = (col >> 11) & 0x1f;
+         uint32_t g   = (col >>  5) & 0x3f;
+         uint32_t b   = (col >>  0) & 0x1f;
+         r = (r << 3) | (r >> 2);
+         g = (g << 2) | (g >> 4);
+         b = (b << 3) | (b >> 2);
+         out[x] = (0xffu << 24) | (r << 16) | (g << 8) | (b << 0);
+      }
+   }
+}
+
+static bool init_context(void)
+{
+   EGLConfig config;
+   EGLint num_configs = 0;
+   EGLContext ctx;
+   static const EGLint attribs[] = {
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_NONE
+   };
+   PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+      eglGetProcAddress("eglGetPlatformDisplayEXT");
+   EGLDisplay dpy;
+
+   if (!get_platform_display)
+      return false;
+
+   dpy = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+         EGL_DEFAULT_DISPLAY, NULL);
+   if (!eglInitialize(dpy, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API))
+      return false;
+
+   eglChooseConfig(dpy, attribs, &config, 1, &num_configs);
+   ctx = eglCreateContext(dpy, num_configs ? config : NULL,
+         EGL_NO_CONTEXT, NULL);
+
+   return ctx != EGL_NO_CONTEXT
+      && eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx);
+}
+
+// Draws the frame texture into an offscreen target, so the
+// driver has to finish every upload like it would for a real frame.
+static void draw_frame(void)
+{
+   float u = (float)BENCH_WIDTH / BENCH_TEX_SIZE;
+   float v = (float)BENCH_HEIGHT / BENCH_TEX_SIZE;
+
+   glBegin(GL_TRIANGLE_STRIP);
+   glTexCoord2f(0.0f, 0.0f);
+   glVertex2f(-1.0f, -1.0f);
+   glTexCoord2f(u, 0.0f);
+   glVertex2f(1.0f, -1.0f);
+   glTexCoord2f(0.0f, v);
+   glVertex2f(-1.0f, 1.0f);
+   glTexCoord2f(u, v);
+   glVertex2f(1.0f, 1.0f);
+   glEnd();
+   glFlush();
+}
+
+static int bench_upload(enum upload_mode mode, enum upload_format format)
+{
+   unsigned i, y;
+   GLuint target, fbo, tex;
+   GLuint pbo[BENCH_SLOTS];
+   GLsync fence[BENCH_SLOTS] = { 0 };
+   uint8_t *mapped     = NULL;
+   double upload_time  = 0.0;
+   double start;
+   bool rgb565         = format != FORMAT_XRGB8888;
+   bool native         = format == FORMAT_RGB565_NATIVE;
+   unsigned in_bpp     = rgb565 ? 2 : 4;
+   unsigned out_bpp    = native ? 2 : 4;
+   size_t in_pitch     = BENCH_WIDTH * in_bpp + BENCH_PITCH_PAD;
+   size_t slot_size    = BENCH_TEX_SIZE * BENCH_TEX_SIZE * 4;
+   GLenum internal_fmt = native ? GL_RGB565 : GL_RGBA8;
+   GLenum fmt          = native ? GL_RGB : GL_BGRA;
+   GLenum type         = native ? GL_UNSIGNED_SHORT_5_6_5 : GL_UNSIGNED_INT_8_8_8_8_REV;
+   uint8_t *frame      = (uint8_t*)malloc(in_pitch * BENCH_HEIGHT);
+   uint32_t *conv      = (uint32_t*)malloc(slot_size);
+   GLenum err;
+
+   if (!frame || !conv)
+      return 1;
+
+   srand(0);
+   for (i = 0; i < in_pitch * BENCH_HEIGHT; i++)
+      frame[i] = rand();
+
+   glGenTextures(1, &target);
+   glBindTexture(GL_TEXTURE_2D, target);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, BENCH_WIDTH * 2, BENCH_HEIGHT * 2,
+         0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+   glGenFramebuffers(1, &fbo);
+   glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+         GL_TEXTURE_2D, target, 0);
+   glViewport(0, 0, BENCH_WIDTH * 2, BENCH_HEIGHT * 2);
+
+   glGenTextures(1, &tex);
+   glBindTexture(GL_TEXTURE_2D, tex);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+   glTexImage2D(GL_TEXTURE_2D, 0, internal_fmt, BENCH_TEX_SIZE, BENCH_TEX_SIZE,
+         0, fmt, type, NULL);
+   glEnable(GL_TEXTURE_2D);
+
+   if (mode == UPLOAD_PBO_RING)
+   {
+      glGenBuffers(BENCH_SLOTS, pbo);
+      for (i = 0; i < BENCH_SLOTS; i++)
+      {
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[i]);
+         glBufferData(GL_PIXEL_UNPACK_BUFFER, slot_size, NULL, GL_STREAM_DRAW);
+      }
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   }
+   else if (mode == UPLOAD_PERSISTENT)
+   {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+         | GL_MAP_COHERENT_BIT;
+
+      glGenBuffers(1, pbo);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[0]);
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slot_size * BENCH_SLOTS,
+            NULL, flags);
+      mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+            slot_size * BENCH_SLOTS, flags);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      if (!mapped)
+      {
+         fprintf(stderr, "Persistent mapping is not supported.\n");
+         return 1;
+      }
+   }
+
+   start = get_time();
+
+   for (i = 0; i < BENCH_FRAMES; i++)
+   {
+      double upload_start;
+
+      // Touch the frame so no driver can skip an unchanged upload.
+      frame[i % 1000] ^= 1;
+
+      upload_start = get_time();
+      glBindTexture(GL_TEXTURE_2D, tex);
+
+      if (mode == UPLOAD_CLIENT)
+      {
+         const void *src = frame;
+
+         if (rgb565 && !native)
+         {
+            convert_rgb565_to_argb8888(conv, (const uint16_t*)frame,
+                  BENCH_WIDTH, BENCH_HEIGHT, in_pitch);
+            src = conv;
+         }
+         else
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, in_pitch / in_bpp);
+
+         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, BENCH_WIDTH, BENCH_HEIGHT,
+               fmt, type, src);
+         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+      }
+      else
+      {
+         unsigned slot  = i % BENCH_SLOTS;
+         GLintptr offset = 0;
+         uint8_t *dst;
+
+         if (mode == UPLOAD_PERSISTENT)
+         {
+            if (fence[slot])
+            {
+               glClientWaitSync(fence[slot], GL_SYNC_FLUSH_COMMANDS_BIT,
+                     1000000000);
+               glDeleteSync(fence[slot]);
+               fence[slot] = 0;
+            }
+
+            offset = slot * slot_size;
+            dst    = mapped + offset;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[0]);
+         }
+         else
+         {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[slot]);
+            dst = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                  BENCH_WIDTH * out_bpp * BENCH_HEIGHT,
+                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+         }
+
+         if (rgb565 && !native)
+            convert_rgb565_to_argb8888((uint32_t*)dst, (const uint16_t*)frame,
+                  BENCH_WIDTH, BENCH_HEIGHT, in_pitch);
+         else
+            for (y = 0; y < BENCH_HEIGHT; y++)
+               memcpy(dst + y * BENCH_WIDTH * out_bpp, frame + y * in_pitch,
+                     BENCH_WIDTH * out_bpp);
+
+         if (mode == UPLOAD_PBO_RING)
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, BENCH_WIDTH, BENCH_HEIGHT,
+               fmt, type, (const void*)offset);
+
+         if (mode == UPLOAD_PERSISTENT)
+            fence[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      }
+
+      upload_time += get_time() - upload_start;
+      draw_frame();
+   }
+
+   glFinish();
+   err = glGetError();
+
+   printf("%-12s %-12s upload %7.0f us/frame, total %7.0f us/frame%s\n",
+         format_names[format], mode_names[mode],
+         1e6 * upload_time / BENCH_FRAMES,
+         1e6 * (get_time() - start) / BENCH_FRAMES,
+         err != GL_NO_ERROR ? ", GL error" : "");
+
+   for (i = 0; i < BENCH_SLOTS; i++)
+      if (fence[i])
+         glDeleteSync(fence[i]);
+   if (mode == UPLOAD_PBO_RING)
+      glDeleteBuffers(BENCH_SLOTS, pbo);
+   else if (mode == UPLOAD_PERSISTENT)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[0]);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers(1, pbo);
+   }
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   glDeleteFramebuffers(1, &fbo);
+   glDeleteTextures(1, &tex);
+   glDeleteTextures(1, &target);
+
+   free(frame);
+   free(conv);
+   return err != GL_NO_ERROR;
+}
+
+int main(void)
+{
+   unsigned mode, format;
+   int ret = 0;
+
+   if (!init_context())
+   {
+      fprintf(stderr, "Failed to create a surfaceless EGL context.\n");
+      return 1;
+   }
+
+   printf("GL renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+
+   for (format = FORMAT_RGB565_CONVERTED; format <= FORMAT_XRGB8888; format++)
+      for (mode = UPLOAD_CLIENT; mode <= UPLOAD_PERSISTENT; mode++)
+         ret |= bench_upload((enum upload_mode)mode, (enum upload_format)format);
+
+   return ret;
+}
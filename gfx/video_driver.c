@@ -32,6 +32,7 @@
 typedef struct video_driver_state
 {
    retro_time_t frame_time_samples[MEASURE_FRAME_TIME_SAMPLES_COUNT];
+   uint32_t frame_time_histogram[FRAME_TIME_HISTOGRAM_BINS];
    struct retro_hw_render_callback hw_render_callback;
    uint64_t frame_time_samples_count;
    enum retro_pixel_format pix_fmt;
@@ -763,6 +764,27 @@ void video_driver_set_texture_frame(const void *frame, bool rgb32,
 #endif
 }
 
+void video_driver_set_texture_frame_rect(const void *frame, bool rgb32,
+      unsigned width, unsigned height, unsigned x, unsigned y,
+      unsigned rect_width, unsigned rect_height, float alpha)
+{
+#ifdef HAVE_MENU
+   driver_t                   *driver = driver_get_ptr();
+   const video_poke_interface_t *poke = video_driver_get_poke_ptr();
+
+   if (!poke)
+      return;
+
+   if (poke->set_texture_frame_rect)
+      poke->set_texture_frame_rect(driver->video_data,
+            frame, rgb32, width, height,
+            x, y, rect_width, rect_height, alpha);
+   else if (poke->set_texture_frame)
+      poke->set_texture_frame(driver->video_data,
+            frame, rgb32, width, height, alpha);
+#endif
+}
+
 bool video_driver_viewport_info(struct video_viewport *vp)
 {
    driver_t            *driver = driver_get_ptr();
@@ -1012,6 +1034,24 @@ void video_monitor_set_refresh_rate(float hz)
    settings->video.refresh_rate = hz;
 }
 
+/* Upper edge of the histogram bin holding the @permille'th
+ * frame time, in microseconds. */
+static unsigned video_monitor_frame_time_percentile(const uint32_t *bins,
+      uint64_t total, unsigned permille)
+{
+   unsigned i;
+   uint64_t accum = 0;
+
+   for (i = 0; i < FRAME_TIME_HISTOGRAM_BINS - 1; i++)
+   {
+      accum += bins[i];
+      if (accum * 1000 >= total * permille)
+         break;
+   }
+
+   return (i + 1) * FRAME_TIME_HISTOGRAM_USEC;
+}
+
 /**
  * video_monitor_compute_fps_statistics:
  *
@@ -1019,10 +1059,21 @@ void video_monitor_set_refresh_rate(float hz)
  **/
 void video_monitor_compute_fps_statistics(void)
 {
+   uint32_t bins[FRAME_TIME_HISTOGRAM_BINS];
+   uint64_t total = 0;
    double avg_fps = 0.0, stddev = 0.0;
    unsigned samples = 0;
    settings_t *settings = config_get_ptr();
 
+   if ((total = video_monitor_frame_time_histogram(bins, FRAME_TIME_HISTOGRAM_BINS)))
+   {
+      RARCH_LOG("Frame time: 50%% < %u usec, 99%% < %u usec, 99.9%% < %u usec (%u usec buckets, %llu frames).\n",
+            video_monitor_frame_time_percentile(bins, total, 500),
+            video_monitor_frame_time_percentile(bins, total, 990),
+            video_monitor_frame_time_percentile(bins, total, 999),
+            FRAME_TIME_HISTOGRAM_USEC, (unsigned long long)total);
+   }
+
    if (settings->video.threaded)
    {
       RARCH_LOG("Monitor FPS estimation is disabled for threaded video.\n");
@@ -1099,6 +1150,35 @@ bool video_monitor_fps_statistics(double *refresh_rate,
    return true;
 }
 
+/**
+ * video_monitor_frame_time_histogram
+ * @bins               : Frame time counts. Bin i counts frame
+ *                       times from i * FRAME_TIME_HISTOGRAM_USEC
+ *                       up to the next bin.
+ * @count              : Number of elements in @bins, at most
+ *                       FRAME_TIME_HISTOGRAM_BINS are written.
+ *
+ * Gets the distribution of all frame times since the last
+ * video_monitor_reset().
+ *
+ * Returns: number of frame times counted.
+ **/
+uint64_t video_monitor_frame_time_histogram(uint32_t *bins,
+      unsigned count)
+{
+   unsigned i;
+   uint64_t total = 0;
+
+   for (i = 0; i < FRAME_TIME_HISTOGRAM_BINS; i++)
+   {
+      total += video_state.frame_time_histogram[i];
+      if (i < count)
+         bins[i] = video_state.frame_time_histogram[i];
+   }
+
+   return total;
+}
+
 #ifndef TIME_TO_FPS
 #define TIME_TO_FPS(last_time, new_time, frames) ((1000000.0f * (frames)) / ((new_time) - (last_time)))
 #endif
@@ -1145,16 +1225,29 @@ bool video_monitor_get_fps(char *buf, size_t size,
       unsigned write_index = video_state.frame_time_samples_count++ &
          (MEASURE_FRAME_TIME_SAMPLES_COUNT - 1);
 
-      video_state.frame_time_samples[write_index] = new_time - fps_time;
+      retro_time_t frame_time = new_time - fps_time;
+      unsigned bin           = frame_time / FRAME_TIME_HISTOGRAM_USEC;
+
+      video_state.frame_time_samples[write_index] = frame_time;
+      video_state.frame_time_histogram[min(bin,
+            FRAME_TIME_HISTOGRAM_BINS - 1)]++;
       fps_time = new_time;
 
       if ((frame_count % FPS_UPDATE_INTERVAL) == 0)
       {
+         retro_time_t input_age = input_driver_get_input_age();
+
          last_fps = TIME_TO_FPS(curr_time, new_time, FPS_UPDATE_INTERVAL);
          curr_time = new_time;
 
-         snprintf(buf, size, "%s || FPS: %6.1f || Frames: " U64_SIGN,
-               global->title_buf, last_fps, (unsigned long long)frame_count);
+         if (input_age > 0)
+            snprintf(buf, size, "%s || FPS: %6.1f || Frames: " U64_SIGN
+                  " || Input age: %.1f ms",
+                  global->title_buf, last_fps, (unsigned long long)frame_count,
+                  input_age / 1000.0);
+         else
+            snprintf(buf, size, "%s || FPS: %6.1f || Frames: " U64_SIGN,
+                  global->title_buf, last_fps, (unsigned long long)frame_count);
          ret = true;
       }
 
@@ -1181,6 +1274,8 @@ bool video_monitor_get_fps(char *buf, size_t size,
 void video_monitor_reset(void)
 {
    video_state.frame_time_samples_count = 0;
+   memset(video_state.frame_time_histogram, 0,
+         sizeof(video_state.frame_time_histogram));
 }
 
 float video_driver_get_aspect_ratio(void)
@@ -127,6 +127,16 @@ typedef struct video_poke_interface
    void (*grab_mouse_toggle)(void *data);
 
    struct video_shader *(*get_current_shader)(void *data);
+
+#ifdef HAVE_MENU
+   /* Update part of the texture set with set_texture_frame.
+    * @frame is the whole frame, only the rectangle at
+    * x, y changed. */
+   void (*set_texture_frame_rect)(void *data, const void *frame,
+         bool rgb32, unsigned width, unsigned height,
+         unsigned x, unsigned y,
+         unsigned rect_width, unsigned rect_height, float alpha);
+#endif
 } video_poke_interface_t;
 
 typedef struct video_driver
@@ -307,6 +317,26 @@ void video_driver_set_texture_enable(bool enable, bool full_screen);
 void video_driver_set_texture_frame(const void *frame, bool rgb32,
       unsigned width, unsigned height, float alpha);
 
+/**
+ * video_driver_set_texture_frame_rect:
+ * @frame                     : Whole menu frame.
+ * @rgb32                     : 32-bit pixels instead of RGBA4444.
+ * @width                     : Width of @frame.
+ * @height                    : Height of @frame.
+ * @x                         : Left edge of the changed rectangle.
+ * @y                         : Top edge of the changed rectangle.
+ * @rect_width                : Width of the changed rectangle.
+ * @rect_height               : Height of the changed rectangle.
+ * @alpha                     : Alpha of the menu texture.
+ *
+ * Like video_driver_set_texture_frame(), but only the given
+ * rectangle of @frame differs from the last upload. Drivers
+ * without partial updates get the whole frame.
+ **/
+void video_driver_set_texture_frame_rect(const void *frame, bool rgb32,
+      unsigned width, unsigned height, unsigned x, unsigned y,
+      unsigned rect_width, unsigned rect_height, float alpha);
+
 bool video_driver_viewport_info(struct video_viewport *vp);
 
 bool video_driver_read_viewport(uint8_t *buffer);
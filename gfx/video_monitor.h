@@ -19,6 +19,12 @@
 
 #include <boolean.h>
 #include <stddef.h>
+#include <stdint.h>
+
+/* Frame time histogram resolution. Frame times past the
+ * last bin are counted in it. */
+#define FRAME_TIME_HISTOGRAM_BINS 512
+#define FRAME_TIME_HISTOGRAM_USEC 100
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +65,23 @@ void video_monitor_compute_fps_statistics(void);
 bool video_monitor_fps_statistics(double *refresh_rate,
       double *deviation, unsigned *sample_points);
 
+/**
+ * video_monitor_frame_time_histogram
+ * @bins               : Frame time counts. Bin i counts frame
+ *                       times from i * FRAME_TIME_HISTOGRAM_USEC
+ *                       up to the next bin.
+ * @count              : Number of elements in @bins, at most
+ *                       FRAME_TIME_HISTOGRAM_BINS are written.
+ *
+ * Gets the distribution of all frame times since the last
+ * video_monitor_reset(), unlike video_monitor_fps_statistics()
+ * which only sees the most recent ones.
+ *
+ * Returns: number of frame times counted.
+ **/
+uint64_t video_monitor_frame_time_histogram(uint32_t *bins,
+      unsigned count);
+
 /**
  * video_monitor_get_fps:
  * @buf           : string suitable for Window title
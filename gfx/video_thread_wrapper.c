@@ -93,6 +93,23 @@ static void thread_update_driver_state(thread_video_t *thr)
                thr->texture.width, thr->texture.height,
                thr->texture.alpha);
       thr->texture.frame_updated = false;
+      thr->texture.rect_updated  = false;
+   }
+   else if (thr->texture.rect_updated)
+   {
+      if (thr->poke && thr->poke->set_texture_frame_rect)
+         thr->poke->set_texture_frame_rect(thr->driver_data,
+               thr->texture.frame, thr->texture.rgb32,
+               thr->texture.width, thr->texture.height,
+               thr->texture.rect_x, thr->texture.rect_y,
+               thr->texture.rect_width, thr->texture.rect_height,
+               thr->texture.alpha);
+      else if (thr->poke && thr->poke->set_texture_frame)
+         thr->poke->set_texture_frame(thr->driver_data,
+               thr->texture.frame, thr->texture.rgb32,
+               thr->texture.width, thr->texture.height,
+               thr->texture.alpha);
+      thr->texture.rect_updated  = false;
    }
 
    if (thr->poke && thr->poke->set_texture_enable)
@@ -939,6 +956,58 @@ static void thread_set_texture_frame(void *data, const void *frame,
    slock_unlock(thr->frame.lock);
 }
 
+static void thread_set_texture_frame_rect(void *data, const void *frame,
+      bool rgb32, unsigned width, unsigned height,
+      unsigned x, unsigned y, unsigned rect_width, unsigned rect_height,
+      float alpha)
+{
+   unsigned i, right, bottom;
+   size_t base_size    = rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+   thread_video_t *thr = (thread_video_t*)data;
+
+   slock_lock(thr->frame.lock);
+
+   if (!thr->texture.frame || thr->texture.rgb32 != rgb32
+         || thr->texture.width != width || thr->texture.height != height
+         || x + rect_width > width || y + rect_height > height)
+   {
+      slock_unlock(thr->frame.lock);
+      thread_set_texture_frame(data, frame, rgb32, width, height, alpha);
+      return;
+   }
+
+   for (i = y; i < y + rect_height; i++)
+   {
+      size_t offset = (i * width + x) * base_size;
+      memcpy((uint8_t*)thr->texture.frame + offset,
+            (const uint8_t*)frame + offset, rect_width * base_size);
+   }
+
+   thr->texture.alpha = alpha;
+
+   if (!thr->texture.frame_updated)
+   {
+      if (thr->texture.rect_updated)
+      {
+         right  = max(x + rect_width,
+               thr->texture.rect_x + thr->texture.rect_width);
+         bottom = max(y + rect_height,
+               thr->texture.rect_y + thr->texture.rect_height);
+         x      = min(x, thr->texture.rect_x);
+         y      = min(y, thr->texture.rect_y);
+         rect_width  = right - x;
+         rect_height = bottom - y;
+      }
+
+      thr->texture.rect_updated = true;
+      thr->texture.rect_x       = x;
+      thr->texture.rect_y       = y;
+      thr->texture.rect_width   = rect_width;
+      thr->texture.rect_height  = rect_height;
+   }
+   slock_unlock(thr->frame.lock);
+}
+
 static void thread_set_texture_enable(void *data, bool state, bool full_screen)
 {
    thread_video_t *thr = (thread_video_t*)data;
@@ -1022,6 +1091,9 @@ static const video_poke_interface_t thread_poke = {
    NULL,
 
    thread_get_current_shader,
+#if defined(HAVE_MENU)
+   thread_set_texture_frame_rect,
+#endif
 };
 
 static void thread_get_poke_interface(void *data,
@@ -172,6 +172,9 @@ typedef struct thread_video
       unsigned height;
       float alpha;
       bool frame_updated;
+      /* Union of partial updates not yet sent to the driver. */
+      bool rect_updated;
+      unsigned rect_x, rect_y, rect_width, rect_height;
       bool rgb32;
       bool enable;
       bool full_screen;
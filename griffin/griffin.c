@@ -81,6 +81,7 @@ CONFIG FILE
 CHEATS
 ============================================================ */
 #include "../cheats.c"
+#include "../cheat_search.c"
 #include "../libretro-common/hash/rhash.c"
 
 /*============================================================
@@ -567,6 +568,9 @@ FILE
 #include "../libretro-common/string/string_list.c"
 #include "../libretro-common/string/stdstring.c"
 #include "../file_ops.c"
+#ifdef HAVE_COMPRESSION
+#include "../extract_cache.c"
+#endif
 #include "../libretro-common/file/nbio/nbio_stdio.c"
 #include "../libretro-common/file/file_list.c"
 
@@ -590,6 +594,12 @@ REWIND
 ============================================================ */
 #include "../rewind.c"
 
+/*============================================================
+INPUT LOG / BENCHMARK
+============================================================ */
+#include "../movie.c"
+#include "../benchmark.c"
+
 /*============================================================
 FRONTEND
 ============================================================ */
@@ -699,6 +709,7 @@ PREEMPTIVE FRAMES
 DATA RUNLOOP
 ============================================================ */
 #include "../tasks/task_file_transfer.c"
+#include "../tasks/task_image_decode.c"
 
 /*============================================================
 SCREENSHOTS
@@ -30,17 +30,25 @@
 #include <termios.h>
 #include <signal.h>
 #include <unistd.h>
+#include <time.h>
 
 #include <file/file_path.h>
 
 #include "../input_joypad.h"
 #include "../input_keymaps.h"
 #include "../../general.h"
+#include "../../performance.h"
 
 #ifdef HAVE_CONFIG_H
 #include "../../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <sys/eventfd.h>
+#include <rthreads/rthreads.h>
+#include <queues/fifo_buffer.h>
+#endif
+
 #ifdef HAVE_XKBCOMMON
 /* We need libxkbcommon to translate raw evdev events to characters
  * which can be passed to keyboard callback in a sensible way. */
@@ -80,6 +88,28 @@ struct input_device
    } state;
 };
 
+/* State as accumulated from evdev events. Mouse motion and wheel
+ * clicks are running totals, so a reader can derive per-poll deltas
+ * from two copies without resetting anything the writer owns. */
+struct udev_input_live
+{
+   uint8_t key_state[(KEY_MAX + 7) / 8];
+   int32_t mouse_x, mouse_y;
+   uint32_t mouse_wu, mouse_wd, mouse_whu, mouse_whd;
+   bool mouse_l, mouse_r, mouse_m, mouse_b4, mouse_b5;
+
+   /* Monotonic timestamp of the newest event, from evdev. */
+   retro_time_t last_event_usec;
+};
+
+#ifdef HAVE_THREADS
+struct udev_key_event
+{
+   uint16_t code;
+   int32_t value;
+};
+#endif
+
 struct udev_input
 {
    bool blocked;
@@ -95,15 +125,35 @@ struct udev_input
 #endif
 
    const input_device_driver_t *joypad;
-   uint8_t key_state[(KEY_MAX + 7) / 8];
 
    int epfd;
    struct input_device **devices;
    unsigned num_devices;
 
+   /* Written while draining evdev. */
+   struct udev_input_live live;
+   /* Copy of live as of the previous poll, for deltas. */
+   struct udev_input_live prev;
+
+#ifdef HAVE_THREADS
+   /* Optional input thread. It blocks in epoll, handles hotplug
+    * and owns live, which it publishes through live_seq. */
+   sthread_t *thread;
+   volatile bool thread_alive;
+   volatile unsigned live_seq;
+   int wake_fd;
+
+   /* Keyboard events to be translated by xkb on the main thread. */
+   slock_t *key_lock;
+   fifo_buffer_t *key_fifo;
+#endif
+
+   /* Per-poll state read by udev_input_state(). */
+   uint8_t key_state[(KEY_MAX + 7) / 8];
    int16_t mouse_x;
    int16_t mouse_y;
    bool mouse_l, mouse_r, mouse_m, mouse_b4, mouse_b5, mouse_wu, mouse_wd, mouse_whu, mouse_whd;
+   retro_time_t input_age_usec;
 };
 
 #ifdef HAVE_XKBCOMMON
@@ -121,11 +171,27 @@ static void udev_handle_keyboard(udev_input_t *udev,
    {
       case EV_KEY:
          if (event->value)
-            BIT_SET(udev->key_state, event->code);
+            BIT_SET(udev->live.key_state, event->code);
          else
-            BIT_CLEAR(udev->key_state, event->code);
+            BIT_CLEAR(udev->live.key_state, event->code);
 
 #ifdef HAVE_XKBCOMMON
+#ifdef HAVE_THREADS
+         /* Keyboard callbacks must fire on the main thread. */
+         if (udev->thread)
+         {
+            struct udev_key_event key_event;
+
+            key_event.code  = event->code;
+            key_event.value = event->value;
+
+            slock_lock(udev->key_lock);
+            if (fifo_write_avail(udev->key_fifo) >= sizeof(key_event))
+               fifo_write(udev->key_fifo, &key_event, sizeof(key_event));
+            slock_unlock(udev->key_lock);
+            break;
+         }
+#endif
          handle_xkb(udev->xkb_state, udev->mod_map_idx, udev->mod_map_bit, event->code, event->value);
 #endif
          break;
@@ -152,7 +218,7 @@ static void udev_handle_touchpad(udev_input_t *udev,
                float rel_x  = x_norm - dev->state.touchpad.x;
 
                if (dev->state.touchpad.touch)
-                  udev->mouse_x += (int16_t)
+                  udev->live.mouse_x += (int16_t)
                      roundf(dev->state.touchpad.mod_x * rel_x);
 
                dev->state.touchpad.x = x_norm;
@@ -170,7 +236,7 @@ static void udev_handle_touchpad(udev_input_t *udev,
                float rel_y  = y_norm - dev->state.touchpad.y;
 
                if (dev->state.touchpad.touch)
-                  udev->mouse_y += (int16_t)roundf(dev->state.touchpad.mod_y * rel_y);
+                  udev->live.mouse_y += (int16_t)roundf(dev->state.touchpad.mod_y * rel_y);
 
                dev->state.touchpad.y = y_norm;
 
@@ -209,23 +275,23 @@ static void udev_handle_mouse(udev_input_t *udev,
          switch (event->code)
          {
             case BTN_LEFT:
-               udev->mouse_l = event->value;
+               udev->live.mouse_l = event->value;
                break;
 
             case BTN_RIGHT:
-               udev->mouse_r = event->value;
+               udev->live.mouse_r = event->value;
                break;
 
             case BTN_MIDDLE:
-               udev->mouse_m = event->value;
+               udev->live.mouse_m = event->value;
                break;
 
             case BTN_BACK:
-               udev->mouse_b4 = event->value;
+               udev->live.mouse_b4 = event->value;
                break;
 
             case BTN_FORWARD:
-               udev->mouse_b5 = event->value;
+               udev->live.mouse_b5 = event->value;
                break;
             default:
                break;
@@ -236,23 +302,23 @@ static void udev_handle_mouse(udev_input_t *udev,
          switch (event->code)
          {
             case REL_X:
-               udev->mouse_x += event->value;
+               udev->live.mouse_x += event->value;
                break;
 
             case REL_Y:
-               udev->mouse_y += event->value;
+               udev->live.mouse_y += event->value;
                break;
             case REL_WHEEL:
                if (event->value == 1)
-                  udev->mouse_wu = 1;
+                  udev->live.mouse_wu++;
                else if (event->value == -1)
-                  udev->mouse_wd = 1;
+                  udev->live.mouse_wd++;
                break;
             case REL_HWHEEL:
                if (event->value == 1)
-                  udev->mouse_whu = 1;
+                  udev->live.mouse_whu++;
                else if (event->value == -1)
-                  udev->mouse_whd = 1;
+                  udev->live.mouse_whd++;
                break;
                break;
             default:
@@ -282,6 +348,7 @@ static bool add_device(udev_input_t *udev,
       const char *devnode, device_handle_cb cb)
 {
    int fd;
+   int clock_id                = CLOCK_MONOTONIC;
    struct input_device **tmp;
    struct input_device *device = NULL;
    struct stat st              = {0};
@@ -305,6 +372,9 @@ static bool add_device(udev_input_t *udev,
    device->dev       = st.st_dev;
    device->handle_cb = cb;
 
+   /* Timestamp events on the same clock as rarch_get_time_usec(). */
+   ioctl(fd, EVIOCSCLOCKID, &clock_id);
+
    strlcpy(device->devnode, devnode, sizeof(device->devnode));
 
    // Touchpads report in absolute coords.
@@ -417,15 +487,236 @@ end:
    udev_device_unref(dev);
 }
 
+static void udev_input_drain_device(udev_input_t *udev,
+      struct input_device *device)
+{
+   int j, len;
+   struct input_event input_events[32];
+
+   while ((len = read(device->fd, input_events, sizeof(input_events))) > 0)
+   {
+      len /= sizeof(*input_events);
+      for (j = 0; j < len; j++)
+         device->handle_cb(udev, &input_events[j], device);
+
+      udev->live.last_event_usec =
+         (retro_time_t)input_events[len - 1].time.tv_sec * 1000000 +
+         input_events[len - 1].time.tv_usec;
+   }
+}
+
+/**
+ * udev_input_publish:
+ * @udev                  : udev input handle.
+ * @cur                   : Consistent copy of the live state.
+ *
+ * Derives the per-poll state read by udev_input_state() from @cur
+ * and the copy taken at the previous poll.
+ **/
+static void udev_input_publish(udev_input_t *udev,
+      const struct udev_input_live *cur)
+{
+   memcpy(udev->key_state, cur->key_state, sizeof(udev->key_state));
+
+   udev->mouse_x   = (int16_t)(cur->mouse_x - udev->prev.mouse_x);
+   udev->mouse_y   = (int16_t)(cur->mouse_y - udev->prev.mouse_y);
+   udev->mouse_wu  = cur->mouse_wu  != udev->prev.mouse_wu;
+   udev->mouse_wd  = cur->mouse_wd  != udev->prev.mouse_wd;
+   udev->mouse_whu = cur->mouse_whu != udev->prev.mouse_whu;
+   udev->mouse_whd = cur->mouse_whd != udev->prev.mouse_whd;
+   udev->mouse_l   = cur->mouse_l;
+   udev->mouse_r   = cur->mouse_r;
+   udev->mouse_m   = cur->mouse_m;
+   udev->mouse_b4  = cur->mouse_b4;
+   udev->mouse_b5  = cur->mouse_b5;
+
+   udev->input_age_usec = cur->last_event_usec ?
+      rarch_get_time_usec() - cur->last_event_usec : -1;
+
+   udev->prev = *cur;
+}
+
+#ifdef HAVE_THREADS
+static void udev_input_thread(void *data)
+{
+   int i, ret;
+   struct epoll_event events[32];
+   udev_input_t *udev = (udev_input_t*)data;
+
+   while (udev->thread_alive)
+   {
+      bool hotplug = false;
+
+      ret = epoll_wait(udev->epfd, events, ARRAY_SIZE(events), -1);
+
+      /* Odd sequence number while live is being modified. */
+      udev->live_seq++;
+      __sync_synchronize();
+
+      for (i = 0; i < ret; i++)
+      {
+         if (!(events[i].events & EPOLLIN))
+            continue;
+
+         if (events[i].data.ptr == &udev->wake_fd)
+            continue;
+
+         if (events[i].data.ptr == &udev->monitor)
+         {
+            hotplug = true;
+            continue;
+         }
+
+         udev_input_drain_device(udev,
+               (struct input_device*)events[i].data.ptr);
+      }
+
+      __sync_synchronize();
+      udev->live_seq++;
+
+      /* After draining, so no pending event refers to a removed device. */
+      if (hotplug)
+         while (udev_input_hotplug_available(udev))
+            udev_input_handle_hotplug(udev);
+   }
+}
+
+/**
+ * udev_input_read_live:
+ * @udev                  : udev input handle.
+ * @out                   : Copy of the live state.
+ *
+ * Seqlock read side. Retries until a copy is taken which the
+ * input thread did not modify in the middle of.
+ **/
+static void udev_input_read_live(udev_input_t *udev,
+      struct udev_input_live *out)
+{
+   unsigned seq;
+
+   for (;;)
+   {
+      seq = udev->live_seq;
+      if (seq & 1)
+         continue;
+
+      __sync_synchronize();
+      memcpy(out, (const void*)&udev->live, sizeof(*out));
+      __sync_synchronize();
+
+      if (seq == udev->live_seq)
+         break;
+   }
+}
+
+static void udev_input_drain_key_events(udev_input_t *udev)
+{
+#ifdef HAVE_XKBCOMMON
+   struct udev_key_event key_event;
+
+   slock_lock(udev->key_lock);
+   while (fifo_read_avail(udev->key_fifo) >= sizeof(key_event))
+   {
+      fifo_read(udev->key_fifo, &key_event, sizeof(key_event));
+      handle_xkb(udev->xkb_state, udev->mod_map_idx, udev->mod_map_bit,
+            key_event.code, key_event.value);
+   }
+   slock_unlock(udev->key_lock);
+#endif
+}
+
+static bool udev_input_start_thread(udev_input_t *udev)
+{
+   struct epoll_event event = {0};
+
+   udev->wake_fd = eventfd(0, EFD_NONBLOCK);
+   if (udev->wake_fd < 0)
+      return false;
+
+   event.events   = EPOLLIN;
+   event.data.ptr = &udev->wake_fd;
+   if (epoll_ctl(udev->epfd, EPOLL_CTL_ADD, udev->wake_fd, &event) < 0)
+      return false;
+
+   if (udev->monitor)
+   {
+      event.data.ptr = &udev->monitor;
+      if (epoll_ctl(udev->epfd, EPOLL_CTL_ADD,
+               udev_monitor_get_fd(udev->monitor), &event) < 0)
+         return false;
+   }
+
+   udev->key_lock = slock_new();
+   udev->key_fifo = fifo_new(256 * sizeof(struct udev_key_event));
+   if (!udev->key_lock || !udev->key_fifo)
+      return false;
+
+   udev->thread_alive = true;
+   udev->thread       = sthread_create(udev_input_thread, udev);
+   if (!udev->thread)
+      return false;
+
+   RARCH_LOG("[udev]: Reading input on a separate thread.\n");
+   return true;
+}
+
+static void udev_input_stop_thread(udev_input_t *udev)
+{
+   if (udev->thread)
+   {
+      uint64_t wake = 1;
+
+      udev->thread_alive = false;
+      if (write(udev->wake_fd, &wake, sizeof(wake)) != sizeof(wake))
+         RARCH_ERR("[udev]: Failed to wake input thread.\n");
+      sthread_join(udev->thread);
+      udev->thread = NULL;
+   }
+
+   /* The synchronous poll treats every epoll event as a device,
+    * so the wakeup and monitor registrations must go even if
+    * the thread never started. Removing an fd which was never
+    * added fails harmlessly. */
+   if (udev->monitor)
+      epoll_ctl(udev->epfd, EPOLL_CTL_DEL,
+            udev_monitor_get_fd(udev->monitor), NULL);
+
+   if (udev->wake_fd >= 0)
+   {
+      epoll_ctl(udev->epfd, EPOLL_CTL_DEL, udev->wake_fd, NULL);
+      close(udev->wake_fd);
+   }
+   udev->wake_fd = -1;
+
+   if (udev->key_fifo)
+      fifo_free(udev->key_fifo);
+   if (udev->key_lock)
+      slock_free(udev->key_lock);
+   udev->key_fifo = NULL;
+   udev->key_lock = NULL;
+}
+#endif
+
 static void udev_input_poll(void *data)
 {
    int i, ret;
    struct epoll_event events[32];
    udev_input_t *udev = (udev_input_t*)data;
 
-   udev->mouse_x   = udev->mouse_y   = 0;
-   udev->mouse_wu  = udev->mouse_wd  = 0;
-   udev->mouse_whu = udev->mouse_whd = 0;
+#ifdef HAVE_THREADS
+   if (udev->thread)
+   {
+      struct udev_input_live live;
+
+      udev_input_read_live(udev, &live);
+      udev_input_publish(udev, &live);
+      udev_input_drain_key_events(udev);
+
+      if (udev->joypad)
+         udev->joypad->poll();
+      return;
+   }
+#endif
 
    while (udev_input_hotplug_available(udev))
       udev_input_handle_hotplug(udev);
@@ -435,24 +726,24 @@ static void udev_input_poll(void *data)
    for (i = 0; i < ret; i++)
    {
       if (events[i].events & EPOLLIN)
-      {
-         int j, len;
-         struct input_event input_events[32];
-         struct input_device *device = (struct input_device*)events[i].data.ptr;
-
-         while ((len = read(device->fd, input_events, sizeof(input_events))) > 0)
-         {
-            len /= sizeof(*input_events);
-            for (j = 0; j < len; j++)
-               device->handle_cb(udev, &input_events[j], device);
-         }
-      }
+         udev_input_drain_device(udev,
+               (struct input_device*)events[i].data.ptr);
    }
 
+   udev_input_publish(udev, &udev->live);
+
    if (udev->joypad)
       udev->joypad->poll();
 }
 
+static retro_time_t udev_input_get_input_age(void *data)
+{
+   udev_input_t *udev = (udev_input_t*)data;
+   if (!udev)
+      return -1;
+   return udev->input_age_usec;
+}
+
 static int16_t udev_mouse_state(udev_input_t *udev, unsigned id)
 {
    switch (id)
@@ -586,6 +877,10 @@ static void udev_input_free(void *data)
    if (!data || !udev)
       return;
 
+#ifdef HAVE_THREADS
+   udev_input_stop_thread(udev);
+#endif
+
    if (udev->joypad)
       udev->joypad->destroy();
 
@@ -727,6 +1022,12 @@ static void *udev_input_init(void)
    if (!udev)
       return NULL;
 
+   udev->epfd           = -1;
+   udev->input_age_usec = -1;
+#ifdef HAVE_THREADS
+   udev->wake_fd        = -1;
+#endif
+
    udev->udev = udev_new();
    if (!udev->udev)
    {
@@ -834,6 +1135,14 @@ static void *udev_input_init(void)
    udev->joypad = input_joypad_init_driver(settings->input.joypad_driver, udev);
    input_keymaps_init_keyboard_lut(rarch_key_map_linux);
 
+#ifdef HAVE_THREADS
+   if (settings->input.udev_thread && !udev_input_start_thread(udev))
+   {
+      RARCH_WARN("[udev]: Failed to start input thread, polling instead.\n");
+      udev_input_stop_thread(udev);
+   }
+#endif
+
    disable_terminal_input();
    return udev;
 
@@ -909,5 +1218,6 @@ input_driver_t input_udev = {
    udev_input_get_joypad_driver,
    udev_input_keyboard_mapping_is_blocked,
    udev_input_keyboard_mapping_set_block,
-   NULL // overlay_haptic_feedback
+   NULL, // overlay_haptic_feedback
+   udev_input_get_input_age
 };
@@ -343,3 +343,15 @@ void input_driver_keyboard_mapping_set_block(bool value)
    if (input->keyboard_mapping_set_block)
       input->keyboard_mapping_set_block(driver->input_data, value);
 }
+
+retro_time_t input_driver_get_input_age(void)
+{
+   driver_t *driver               = driver_get_ptr();
+   const input_driver_t *input = input_get_ptr(driver);
+
+   if (!driver || !input)
+      return 0;
+   if (input->get_input_age)
+      return input->get_input_age(driver->input_data);
+   return -1;
+}
@@ -76,6 +76,9 @@ typedef struct input_driver
    bool (*keyboard_mapping_is_blocked)(void *data);
    void (*keyboard_mapping_set_block)(void *data, bool value);
    void (*overlay_haptic_feedback) (void);
+   /* Age in microseconds of the newest input event as of the
+    * last poll, or -1 if unknown. Optional. */
+   retro_time_t (*get_input_age)(void *data);
 } input_driver_t;
 
 extern input_driver_t input_android;
@@ -162,6 +165,15 @@ bool input_driver_keyboard_mapping_is_blocked(void);
 
 void input_driver_keyboard_mapping_set_block(bool value);
 
+/**
+ * input_driver_get_input_age:
+ *
+ * Returns: age in microseconds of the newest input event as of
+ * the last poll, 0 if no input driver is loaded, or -1 if the
+ * input driver cannot tell.
+ **/
+retro_time_t input_driver_get_input_age(void);
+
 #ifdef __cplusplus
 }
 #endif
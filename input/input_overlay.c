@@ -28,6 +28,7 @@
 
 #include "input_overlay.h"
 #include "input_common.h"
+#include "../tasks/tasks.h"
 #include "input_keymaps.h"
 #include "../dynamic.h"
 #include "../performance.h"
@@ -40,6 +41,8 @@
 
 #define MAX_TOUCH 16
 
+#define OVERLAY_HIT_GRID_MAX_DIM 32
+
 static bool overlay_lightgun_active;
 static bool overlay_mouse_active;
 static bool overlay_adjust_needed;
@@ -542,23 +545,184 @@ static void input_overlay_set_vertex_geom(input_overlay_t *ol)
    }
 }
 
-static void input_overlay_update_aspect_and_shift(struct overlay *ol)
+static void input_overlay_free_hit_grid(struct overlay *ol)
+{
+   free(ol->hit_grid.offsets);
+   free(ol->hit_grid.descs);
+   memset(&ol->hit_grid, 0, sizeof(ol->hit_grid));
+}
+
+/**
+ * input_overlay_desc_hit_bounds:
+ * @desc                  : Overlay descriptor handle.
+ *
+ * Gets the largest area @desc can respond to, which includes
+ * the hitbox expansion from range_mod while pressed.
+ **/
+static void input_overlay_desc_hit_bounds(const struct overlay_desc *desc,
+      float *x0, float *y0, float *x1, float *y1)
+{
+   float mod     = desc->range_mod > 1.0f ? desc->range_mod : 1.0f;
+   float range_x = desc->range_x_hitbox * mod;
+   float range_y = desc->range_y_hitbox * mod;
+
+   *x0 = desc->x_hitbox - range_x;
+   *x1 = desc->x_hitbox + range_x;
+   *y0 = desc->y_hitbox - range_y;
+   *y1 = desc->y_hitbox + range_y;
+}
+
+static INLINE unsigned input_overlay_hit_grid_col(
+      const struct overlay_hit_grid *grid, float x)
+{
+   int col = (int)((x - grid->x) / grid->cell_w);
+
+   if (col < 0)
+      return 0;
+   if (col >= (int)grid->cols)
+      return grid->cols - 1;
+   return col;
+}
+
+static INLINE unsigned input_overlay_hit_grid_row(
+      const struct overlay_hit_grid *grid, float y)
+{
+   int row = (int)((y - grid->y) / grid->cell_h);
+
+   if (row < 0)
+      return 0;
+   if (row >= (int)grid->rows)
+      return grid->rows - 1;
+   return row;
+}
+
+/**
+ * input_overlay_build_hit_grid:
+ * @ol                    : Overlay handle.
+ *
+ * Buckets every desc of @ol into the grid cells its hitbox
+ * touches. Must be rebuilt whenever desc hitboxes change.
+ * On failure, the grid is left empty and polling falls back
+ * to testing every desc.
+ **/
+static void input_overlay_build_hit_grid(struct overlay *ol)
 {
-   struct overlay_desc* desc;
    size_t i;
+   unsigned dim, cells, col, row;
+   unsigned *cursor               = NULL;
+   float min_x, min_y, max_x, max_y;
+   struct overlay_hit_grid *grid  = &ol->hit_grid;
 
-   if (!ol || ol->fullscreen_image || driver_get_ptr()->osk_enable)
+   input_overlay_free_hit_grid(ol);
+
+   if (!ol->size || !ol->descs)
       return;
 
-   input_overlay_update_aspect_ratio_vals(ol);
+   input_overlay_desc_hit_bounds(&ol->descs[0],
+         &min_x, &min_y, &max_x, &max_y);
+
+   for (i = 1; i < ol->size; i++)
+   {
+      float x0, y0, x1, y1;
+      input_overlay_desc_hit_bounds(&ol->descs[i], &x0, &y0, &x1, &y1);
+      min_x = min(min_x, x0);
+      min_y = min(min_y, y0);
+      max_x = max(max_x, x1);
+      max_y = max(max_y, y1);
+   }
+
+   /* Pad a little so points exactly on an edge still land in a cell. */
+   min_x -= 0.001f;
+   min_y -= 0.001f;
+   max_x += 0.001f;
+   max_y += 0.001f;
+
+   /* Aim for about one desc per cell. */
+   dim = (unsigned)ceil(sqrt((double)ol->size));
+   if (dim > OVERLAY_HIT_GRID_MAX_DIM)
+      dim = OVERLAY_HIT_GRID_MAX_DIM;
+
+   grid->x      = min_x;
+   grid->y      = min_y;
+   grid->cols   = dim;
+   grid->rows   = dim;
+   grid->cell_w = (max_x - min_x) / dim;
+   grid->cell_h = (max_y - min_y) / dim;
+   cells        = dim * dim;
+
+   grid->offsets = (unsigned*)calloc(cells + 1, sizeof(unsigned));
+   cursor        = (unsigned*)malloc(cells * sizeof(unsigned));
+   if (!grid->offsets || !cursor)
+      goto error;
 
+   /* Count descs per cell, then turn counts into start offsets. */
    for (i = 0; i < ol->size; i++)
    {
-      desc = &ol->descs[i];
-      input_overlay_desc_adjust_aspect_and_shift(desc);
-      input_overlay_desc_init_imagebox(desc);
-      input_overlay_desc_init_hitbox(desc);
+      float x0, y0, x1, y1;
+      input_overlay_desc_hit_bounds(&ol->descs[i], &x0, &y0, &x1, &y1);
+
+      for (row = input_overlay_hit_grid_row(grid, y0);
+            row <= input_overlay_hit_grid_row(grid, y1); row++)
+         for (col = input_overlay_hit_grid_col(grid, x0);
+               col <= input_overlay_hit_grid_col(grid, x1); col++)
+            grid->offsets[row * dim + col + 1]++;
    }
+
+   for (i = 0; i < cells; i++)
+   {
+      grid->offsets[i + 1] += grid->offsets[i];
+      cursor[i]             = grid->offsets[i];
+   }
+
+   grid->descs = (unsigned*)malloc(
+         max(grid->offsets[cells], 1) * sizeof(unsigned));
+   if (!grid->descs)
+      goto error;
+
+   /* Descs are visited in order, so each cell's list stays sorted
+    * and polling order matches a linear scan. */
+   for (i = 0; i < ol->size; i++)
+   {
+      float x0, y0, x1, y1;
+      input_overlay_desc_hit_bounds(&ol->descs[i], &x0, &y0, &x1, &y1);
+
+      for (row = input_overlay_hit_grid_row(grid, y0);
+            row <= input_overlay_hit_grid_row(grid, y1); row++)
+         for (col = input_overlay_hit_grid_col(grid, x0);
+               col <= input_overlay_hit_grid_col(grid, x1); col++)
+            grid->descs[cursor[row * dim + col]++] = i;
+   }
+
+   free(cursor);
+   return;
+
+error:
+   free(cursor);
+   input_overlay_free_hit_grid(ol);
+}
+
+static void input_overlay_update_aspect_and_shift(struct overlay *ol)
+{
+   struct overlay_desc* desc;
+   size_t i;
+
+   if (!ol)
+      return;
+
+   if (!ol->fullscreen_image && !driver_get_ptr()->osk_enable)
+   {
+      input_overlay_update_aspect_ratio_vals(ol);
+
+      for (i = 0; i < ol->size; i++)
+      {
+         desc = &ol->descs[i];
+         input_overlay_desc_adjust_aspect_and_shift(desc);
+         input_overlay_desc_init_imagebox(desc);
+         input_overlay_desc_init_hitbox(desc);
+      }
+   }
+
+   input_overlay_build_hit_grid(ol);
 }
 
 void input_overlays_update_aspect_shift_scale(input_overlay_t *ol)
@@ -592,9 +756,20 @@ static void input_overlay_free_overlay(struct overlay *overlay)
          free(overlay->descs[i].eightway_vals);
    }
 
+   for (i = 0; i < overlay->image_requests_size; i++)
+   {
+      struct overlay_image_request *req = &overlay->image_requests[i];
+
+      if (!req->taken)
+         texture_image_free(&req->image);
+      free(req->path);
+   }
+   free(overlay->image_requests);
+
    free(overlay->load_images);
    free(overlay->descs);
    texture_image_free(&overlay->image);
+   input_overlay_free_hit_grid(overlay);
 }
 
 static void input_overlay_free_overlays(input_overlay_t *ol)
@@ -610,13 +785,115 @@ static void input_overlay_free_overlays(input_overlay_t *ol)
    free(ol->overlays);
 }
 
+#if defined(HAVE_RPNG) && defined(HAVE_THREADS)
+static void input_overlay_image_decoded(struct texture_image *ti,
+      bool success, void *data)
+{
+   struct overlay_image_request *req = (struct overlay_image_request*)data;
+
+   req->image   = *ti;
+   req->success = success;
+   req->done    = true;
+   req->ol->pending_images--;
+}
+
+static void input_overlay_request_image(input_overlay_t *ol,
+      struct overlay *overlay, const char *image_path)
+{
+   char path[PATH_MAX_LENGTH] = {0};
+   struct overlay_image_request *req =
+      &overlay->image_requests[overlay->image_requests_size];
+
+   fill_pathname_resolve_relative(path, ol->overlay_path,
+         image_path, sizeof(path));
+
+   req->path = strdup(path);
+   req->ol   = ol;
+   if (!req->path)
+      return;
+
+   if (!rarch_main_data_image_decode_push(path, ol,
+            input_overlay_image_decoded, req))
+   {
+      free(req->path);
+      req->path = NULL;
+      return;
+   }
+
+   overlay->image_requests_size++;
+   ol->pending_images++;
+}
+
+/**
+ * input_overlay_request_images:
+ * @ol                    : Overlay handle.
+ * @overlay               : Overlay whose config has just been read.
+ * @ol_idx                : Index of @overlay.
+ *
+ * Queues the main image and every desc image of @overlay for
+ * background decoding, so the later load steps find them ready.
+ **/
+static void input_overlay_request_images(input_overlay_t *ol,
+      struct overlay *overlay, unsigned ol_idx)
+{
+   unsigned i;
+
+   overlay->image_requests = (struct overlay_image_request*)
+      calloc(1 + overlay->size, sizeof(*overlay->image_requests));
+
+   if (!overlay->image_requests)
+      return;
+
+   if (overlay->config.paths.path[0] != '\0')
+      input_overlay_request_image(ol, overlay, overlay->config.paths.path);
+
+   for (i = 0; i < overlay->size; i++)
+   {
+      char key[64]                     = {0};
+      char image_path[PATH_MAX_LENGTH] = {0};
+
+      snprintf(key, sizeof(key), "overlay%u_desc%u_overlay", ol_idx, i);
+
+      if (config_get_path(ol->conf, key, image_path, sizeof(image_path)))
+         input_overlay_request_image(ol, overlay, image_path);
+   }
+}
+#endif
+
+static bool input_overlay_take_image(struct overlay *overlay,
+      struct texture_image *image, const char *path, bool *found)
+{
+   unsigned i;
+
+   *found = false;
+
+   for (i = 0; i < overlay->image_requests_size; i++)
+   {
+      struct overlay_image_request *req = &overlay->image_requests[i];
+
+      if (!req->done || req->taken || strcmp(req->path, path))
+         continue;
+
+      *found     = true;
+      req->taken = true;
+      *image     = req->image;
+      return req->success;
+   }
+
+   return false;
+}
+
 static bool input_overlay_load_texture_image(struct overlay *overlay,
       struct texture_image *image, const char *path)
 {
+   bool found               = false;
    struct texture_image img = {0};
 
-   if (!texture_image_load(&img, path))
-      return false;
+   if (!input_overlay_take_image(overlay, &img, path, &found))
+   {
+      if (found || !texture_image_load(&img, path))
+         return false;
+   }
 
    *image = img;
    overlay->load_images[overlay->load_images_size++] = *image;
@@ -980,8 +1257,25 @@ error:
 }
 
 
-static bool input_overlay_load_overlay_image_done(struct overlay *overlay)
+static bool input_overlay_load_overlay_image_done(input_overlay_t *ol,
+      struct overlay *overlay)
 {
+   if (overlay->config.paths.path[0] != '\0')
+   {
+      char overlay_resolved_path[PATH_MAX_LENGTH] = {0};
+
+      fill_pathname_resolve_relative(overlay_resolved_path, ol->overlay_path,
+            overlay->config.paths.path, sizeof(overlay_resolved_path));
+
+      if (!input_overlay_load_texture_image(overlay, &overlay->image,
+               overlay_resolved_path))
+      {
+         RARCH_ERR("[Overlay]: Failed to load image: %s.\n",
+               overlay_resolved_path);
+         return false;
+      }
+   }
+
    overlay->pos = 0;
    /* Divide iteration steps by half of total descs if size is even,
     * otherwise default to 8 (arbitrary value for now to speed things up). */
@@ -1017,10 +1311,15 @@ bool input_overlay_load_overlays_iterate(input_overlay_t *ol)
    {
       case OVERLAY_IMAGE_TRANSFER_NONE:
       case OVERLAY_IMAGE_TRANSFER_BUSY:
-         ol->loading_status = OVERLAY_IMAGE_TRANSFER_DONE;
+         /* Wait for the background decodes requested at load time. */
+         if (ol->pending_images)
+            ol->loading_status = OVERLAY_IMAGE_TRANSFER_BUSY;
+         else
+            ol->loading_status = OVERLAY_IMAGE_TRANSFER_DONE;
          break;
       case OVERLAY_IMAGE_TRANSFER_DONE:
-         input_overlay_load_overlay_image_done(&ol->overlays[ol->pos]);
+         if (!input_overlay_load_overlay_image_done(ol, &ol->overlays[ol->pos]))
+            goto error;
          ol->loading_status = OVERLAY_IMAGE_TRANSFER_DESC_IMAGE_ITERATE;
          ol->overlays[ol->pos].pos = 0;
          break;
@@ -1178,22 +1477,9 @@ bool input_overlay_load_overlays(input_overlay_t *ol)
       config_get_path(ol->conf, overlay->config.paths.key,
                overlay->config.paths.path, sizeof(overlay->config.paths.path));
 
-      if (overlay->config.paths.path[0] != '\0')
-      {
-         char overlay_resolved_path[PATH_MAX_LENGTH] = {0};
-
-         fill_pathname_resolve_relative(overlay_resolved_path, ol->overlay_path,
-               overlay->config.paths.path, sizeof(overlay_resolved_path));
-
-         if (!input_overlay_load_texture_image(overlay, &overlay->image, overlay_resolved_path))
-         {
-            RARCH_ERR("[Overlay]: Failed to load image: %s.\n",
-                  overlay_resolved_path);
-            ol->loading_status = OVERLAY_IMAGE_TRANSFER_ERROR;
-            goto error;
-         }
-
-      }
+#if defined(HAVE_RPNG) && defined(HAVE_THREADS)
+      input_overlay_request_images(ol, overlay, ol->pos);
+#endif
 
       snprintf(overlay->config.names.key, sizeof(overlay->config.names.key),
             "overlay%u_name", ol->pos);
@@ -1826,11 +2112,14 @@ static INLINE bool input_overlay_poll_descs(
       input_overlay_t *ol, input_overlay_state_t *out,
       const uint8_t ptr_idx, int16_t norm_x, int16_t norm_y)
 {
-   size_t i, j;
+   size_t i, j, k;
    float x, y;
-   struct overlay_desc *descs = ol->active->descs;
-   bool exclusive_desc_hit    = false;
-   bool any_desc_hit          = false;
+   struct overlay_desc *descs          = ol->active->descs;
+   const struct overlay_hit_grid *grid = &ol->active->hit_grid;
+   const unsigned *candidates          = NULL;
+   size_t num_candidates               = ol->active->size;
+   bool exclusive_desc_hit             = false;
+   bool any_desc_hit                   = false;
 
    memset(out, 0, sizeof(*out));
 
@@ -1852,9 +2141,29 @@ static INLINE bool input_overlay_poll_descs(
    x /= ol->active->scale_w;
    y /= ol->active->scale_h;
 
-   for (i = 0; i < ol->active->size && !exclusive_desc_hit; i++)
+   /* Only descs sharing the pointer's grid cell can be hit. */
+   if (grid->offsets)
    {
-      struct overlay_desc *desc = &descs[i];
+      if (x < grid->x || y < grid->y
+            || x > grid->x + grid->cols * grid->cell_w
+            || y > grid->y + grid->rows * grid->cell_h)
+         num_candidates = 0;
+      else
+      {
+         unsigned cell = input_overlay_hit_grid_row(grid, y) * grid->cols
+            + input_overlay_hit_grid_col(grid, x);
+
+         candidates     = grid->descs + grid->offsets[cell];
+         num_candidates = grid->offsets[cell + 1] - grid->offsets[cell];
+      }
+   }
+
+   for (k = 0; k < num_candidates && !exclusive_desc_hit; k++)
+   {
+      struct overlay_desc *desc;
+
+      i    = candidates ? candidates[k] : k;
+      desc = &descs[i];
 
       if (!inside_hitbox(desc, x, y))
          continue;
@@ -2450,6 +2759,9 @@ void input_overlay_free(input_overlay_t *ol)
    if (!ol)
       return;
 
+#if defined(HAVE_RPNG) && defined(HAVE_THREADS)
+   rarch_main_data_image_decode_cancel(ol);
+#endif
    input_overlay_free_overlays(ol);
 
    if (ol->conf)
@@ -181,6 +181,33 @@ struct overlay_desc
    struct overlay_eightway_vals *eightway_vals;
 };
 
+/* Uniform grid over the hitboxes of an overlay's descs,
+ * so polling only tests descs near each pointer. */
+struct overlay_hit_grid
+{
+   float x, y;
+   float cell_w, cell_h;
+   unsigned cols, rows;
+
+   /* Start of each cell's list in @descs. cols * rows + 1 entries. */
+   unsigned *offsets;
+   /* Desc indices touching each cell, in ascending order. */
+   unsigned *descs;
+};
+
+struct input_overlay;
+
+/* An image decoded in the background while the overlay config loads. */
+struct overlay_image_request
+{
+   char *path;
+   struct texture_image image;
+   bool done;
+   bool success;
+   bool taken;
+   struct input_overlay *ol;
+};
+
 struct overlay
 {
    struct overlay_desc *descs;
@@ -236,6 +263,11 @@ struct overlay
 
    struct texture_image *load_images;
    unsigned load_images_size;
+
+   struct overlay_image_request *image_requests;
+   unsigned image_requests_size;
+
+   struct overlay_hit_grid hit_grid;
 };
 
 struct input_overlay
@@ -247,6 +279,9 @@ struct input_overlay
    enum overlay_image_transfer_status loading_status;
    bool blocked;
 
+   /* Image requests across all overlays not yet delivered. */
+   unsigned pending_images;
+
    struct overlay *overlays;
    const struct overlay *active;
    size_t index;
@@ -31,7 +31,6 @@
 #include <compat/msvc.h>
 #include <file/file_path.h>
 #include <retro_miscellaneous.h>
-#include <string/string_list.h>
 #include <rhash.h>
 
 #if !defined(_WIN32) && !defined(__CELLOS_LV2__) && !defined(_XBOX)
@@ -44,45 +43,12 @@
 #endif
 
 #define MAX_INCLUDE_DEPTH 16
+#define CONFIG_INDEX_MIN_SIZE 64
 
 
 static config_file_t *config_file_new_internal(const char *path, unsigned depth);
 void config_file_free(config_file_t *conf);
 
-static char *getaline(FILE *file)
-{
-   char* newline = (char*)malloc(9);
-   char* newline_tmp = NULL;
-   size_t cur_size   = 8;
-   size_t idx        = 0;
-   int in            = getc(file);
-
-   if (!newline)
-      return NULL;
-
-   while (in != EOF && in != '\n')
-   {
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         newline_tmp = (char*)realloc(newline, cur_size + 1);
-
-         if (!newline_tmp)
-         {
-            free(newline);
-            return NULL;
-         }
-
-         newline = newline_tmp;
-      }
-
-      newline[idx++] = in;
-      in = getc(file);
-   }
-   newline[idx] = '\0';
-   return newline; 
-}
-
 static char *extract_value(char *line, bool is_value)
 {
    char *save = NULL;
@@ -132,9 +98,98 @@ static void set_list_readonly(struct config_entry_list *list)
    }
 }
 
+/**
+ * config_index_put:
+ * @conf                 : config file.
+ * @entry                : entry to index.
+ *
+ * Inserts @entry into the index unless an entry with the same
+ * key is already present. Entries must be put in list order
+ * so that the first occurrence of a key wins, like it does
+ * when walking the list. The index must have a free slot.
+ **/
+static void config_index_put(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t mask = conf->index_size - 1;
+   size_t i    = entry->key_hash & mask;
+
+   while (conf->index[i])
+   {
+      const struct config_entry_list *slot = conf->index[i];
+
+      if (slot->key_hash == entry->key_hash && !strcmp(slot->key, entry->key))
+         return;
+
+      i = (i + 1) & mask;
+   }
+
+   conf->index[i] = entry;
+   conf->index_count++;
+}
+
+/**
+ * config_index_rebuild:
+ * @conf                 : config file.
+ * @size                 : minimum number of slots, power of two.
+ *
+ * Rebuilds the index from the entry list. If allocation fails
+ * the index is dropped and lookups fall back to walking the list.
+ **/
+static void config_index_rebuild(config_file_t *conf, size_t size)
+{
+   size_t count = 0;
+   struct config_entry_list *entry = NULL;
+
+   for (entry = conf->entries; entry; entry = entry->next)
+      count++;
+
+   /* Keep the load factor at or below 3/4. */
+   while (count * 4 > size * 3)
+      size *= 2;
+
+   free(conf->index);
+   conf->index_count = 0;
+   conf->index_size  = size;
+   conf->index       = (struct config_entry_list**)
+      calloc(size, sizeof(*conf->index));
+
+   if (!conf->index)
+   {
+      conf->index_size = 0;
+      return;
+   }
+
+   for (entry = conf->entries; entry; entry = entry->next)
+      config_index_put(conf, entry);
+}
+
+/**
+ * config_index_add:
+ * @conf                 : config file.
+ * @entry                : entry which has just been linked
+ *                         at the end of the list.
+ *
+ * Adds @entry to the index, growing it as needed.
+ **/
+static void config_index_add(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   if (!conf->index || (conf->index_count + 1) * 4 > conf->index_size * 3)
+   {
+      config_index_rebuild(conf, conf->index_size
+            ? conf->index_size * 2 : CONFIG_INDEX_MIN_SIZE);
+      return;
+   }
+
+   config_index_put(conf, entry);
+}
+
 /* Move semantics? */
 static void add_child_list(config_file_t *parent, config_file_t *child)
 {
+   struct config_entry_list *entry = child->entries;
+
    if (parent->entries)
    {
       struct config_entry_list *head = parent->entries;
@@ -164,6 +219,10 @@ static void add_child_list(config_file_t *parent, config_file_t *child)
    }
    else
       parent->tail = NULL;
+
+   /* Included entries come after everything parsed so far. */
+   for (; entry; entry = entry->next)
+      config_index_add(parent, entry);
 }
 
 static void add_include_list(config_file_t *conf, const char *path)
@@ -272,19 +331,11 @@ static bool parse_line(config_file_t *conf,
       struct config_entry_list *list, char *line)
 {
    char *comment   = NULL;
-   char *key       = (char*)malloc(9);
-   char *key_tmp   = NULL;
-   size_t cur_size = 8;
-   size_t idx      = 0;
-
-   if (!key)
-      return false;
+   char *key       = NULL;
+   char *key_start = NULL;
 
    if (!line || !*line)
-   {
-      free(key);
       return false;
-   }
 
    comment = strip_comment(line);
 
@@ -295,7 +346,6 @@ static bool parse_line(config_file_t *conf,
       if (strstr(comment, "include ") == comment)
       {
          add_sub_conf(conf, comment + strlen("include "));
-         free(key);
          return false;
       }
    }
@@ -308,25 +358,16 @@ static bool parse_line(config_file_t *conf,
    while (isspace(*line))
       line++;
 
+   key_start = line;
    while (isgraph(*line))
-   {
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         key_tmp = (char*)realloc(key, cur_size + 1);
-
-         if (!key_tmp)
-         {
-            free(key);
-            return false;
-         }
+      line++;
 
-         key = key_tmp;
-      }
+   key = (char*)malloc(line - key_start + 1);
+   if (!key)
+      return false;
 
-      key[idx++] = *line++;
-   }
-   key[idx] = '\0';
+   memcpy(key, key_start, line - key_start);
+   key[line - key_start] = '\0';
    list->key = key;
    list->key_hash = djb2_calculate(key);
 
@@ -341,6 +382,54 @@ static bool parse_line(config_file_t *conf,
    return true;
 }
 
+/**
+ * config_file_parse_buffer:
+ * @conf                 : config file.
+ * @buf                  : NUL-terminated contents of the file,
+ *                         split into lines in place.
+ *
+ * Parses every line of @buf and appends the entries to @conf.
+ *
+ * Returns: false if an entry could not be allocated.
+ **/
+static bool config_file_parse_buffer(config_file_t *conf, char *buf)
+{
+   char *line = buf;
+
+   while (line)
+   {
+      struct config_entry_list *list = NULL;
+      char *next = strchr(line, '\n');
+
+      if (next)
+         *next++ = '\0';
+
+      if (*line)
+      {
+         list = (struct config_entry_list*)calloc(1, sizeof(*list));
+         if (!list)
+            return false;
+
+         if (parse_line(conf, list, line))
+         {
+            if (conf->entries)
+               conf->tail->next = list;
+            else
+               conf->entries = list;
+
+            conf->tail = list;
+            config_index_add(conf, list);
+         }
+         else
+            free(list);
+      }
+
+      line = next;
+   }
+
+   return true;
+}
+
 bool config_append_file(config_file_t *conf, const char *path)
 {
    config_file_t *new_conf = config_file_new(path);
@@ -350,17 +439,76 @@ bool config_append_file(config_file_t *conf, const char *path)
    if (new_conf->tail)
    {
       new_conf->tail->next = conf->entries;
+      if (!conf->entries)
+         conf->tail        = new_conf->tail;
       conf->entries        = new_conf->entries; /* Pilfer. */
       new_conf->entries    = NULL;
+
+      /* Appended entries now take precedence. */
+      config_index_rebuild(conf, CONFIG_INDEX_MIN_SIZE);
    }
 
    config_file_free(new_conf);
    return true;
 }
 
+/* Reads all of @file into a NUL terminated buffer. The file size
+ * is only used as a hint, since FIFOs cannot seek and some virtual
+ * files report a size of zero. */
+static char *config_file_read_all(FILE *file)
+{
+   long hint  = -1;
+   size_t len = 0;
+   size_t cap;
+   char *buf  = NULL;
+
+   if (fseek(file, 0, SEEK_END) == 0)
+   {
+      hint = ftell(file);
+      if (fseek(file, 0, SEEK_SET) != 0)
+         return NULL;
+   }
+
+   /* One spare byte so reading an exact hint ends in a short read. */
+   cap = (hint > 0 ? (size_t)hint : 4096) + 2;
+   buf = (char*)malloc(cap);
+   if (!buf)
+      return NULL;
+
+   for (;;)
+   {
+      char *new_buf;
+      size_t want = cap - len - 1;
+      size_t got  = fread(buf + len, 1, want, file);
+
+      len += got;
+      if (got < want)
+         break;
+
+      new_buf = (char*)realloc(buf, cap * 2);
+      if (!new_buf)
+      {
+         free(buf);
+         return NULL;
+      }
+      buf  = new_buf;
+      cap *= 2;
+   }
+
+   if (ferror(file))
+   {
+      free(buf);
+      return NULL;
+   }
+
+   buf[len] = '\0';
+   return buf;
+}
+
 static config_file_t *config_file_new_internal(
       const char *path, unsigned depth)
 {
+   char *buf  = NULL;
    FILE *file = NULL;
    struct config_file *conf = (struct config_file*)calloc(1, sizeof(*conf));
    if (!conf)
@@ -384,7 +532,7 @@ static config_file_t *config_file_new_internal(
    }
 
    conf->include_depth = depth;
-   file = fopen(path, "r");
+   file = fopen(path, "rb");
 
    if (!file)
    {
@@ -393,53 +541,30 @@ static config_file_t *config_file_new_internal(
       return NULL;
    }
 
-   while (!feof(file))
-   {
-      struct config_entry_list *list = (struct config_entry_list*)
-         calloc(1, sizeof(*list));
-      char *line = NULL;
-
-      if (!list)
-      {
-         config_file_free(conf);
-         fclose(file);
-         return NULL;
-      }
-
-      line = getaline(file);
-
-      if (line)
-      {
-         if (parse_line(conf, list, line))
-         {
-            if (conf->entries)
-               conf->tail->next = list;
-            else
-               conf->entries = list;
-
-            conf->tail = list;
-         }
+   /* Read the whole file once and parse it in place. */
+   buf = config_file_read_all(file);
+   fclose(file);
 
-         free(line);
-      }
-      else
-      {
-         free(list);
-         continue;
-      }
+   if (!buf)
+   {
+      config_file_free(conf);
+      return NULL;
+   }
 
-      if (list != conf->tail)
-         free(list);
+   if (!config_file_parse_buffer(conf, buf))
+   {
+      free(buf);
+      config_file_free(conf);
+      return NULL;
    }
-   fclose(file);
 
+   free(buf);
    return conf;
 }
 
 config_file_t *config_file_new_from_string(const char *from_string)
 {
-   size_t i;
-   struct string_list *lines = NULL;
+   char *buf = NULL;
    struct config_file *conf = (struct config_file*)calloc(1, sizeof(*conf));
    if (!conf)
       return NULL;
@@ -449,43 +574,19 @@ config_file_t *config_file_new_from_string(const char *from_string)
 
    conf->path = NULL;
    conf->include_depth = 0;
-   
-   lines = string_split(from_string, "\n");
-   if (!lines)
+
+   buf = strdup(from_string);
+   if (!buf)
       return conf;
 
-   for (i = 0; i < lines->size; i++)
+   if (!config_file_parse_buffer(conf, buf))
    {
-      struct config_entry_list *list = (struct config_entry_list*)
-         calloc(1, sizeof(*list));
-      char* line = lines->elems[i].data;
-
-      if (!list)
-      {
-         string_list_free(lines);
-         config_file_free(conf);
-         return NULL;
-      }
-
-      if (line)
-      {
-         if (parse_line(conf, list, line))
-         {
-            if (conf->entries)
-               conf->tail->next = list;
-            else
-               conf->entries = list;
-
-            conf->tail = list;
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
+      free(buf);
+      config_file_free(conf);
+      return NULL;
    }
 
-   string_list_free(lines);
-
+   free(buf);
    return conf;
 }
 
@@ -522,38 +623,43 @@ void config_file_free(config_file_t *conf)
       free(hold);
    }
 
+   free(conf->index);
    free(conf->path);
    free(conf);
 }
 
 static struct config_entry_list *config_get_entry(const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
+      const char *key)
 {
    struct config_entry_list *entry;
-   struct config_entry_list *previous = NULL;
-
    uint32_t hash = djb2_calculate(key);
 
-   if (prev)
-      previous = *prev;
+   if (conf->index)
+   {
+      size_t mask = conf->index_size - 1;
+      size_t i    = hash & mask;
+
+      for (; (entry = conf->index[i]); i = (i + 1) & mask)
+      {
+         if (hash == entry->key_hash && !strcmp(key, entry->key))
+            return entry;
+      }
+
+      return NULL;
+   }
 
    for (entry = conf->entries; entry; entry = entry->next)
    {
       if (hash == entry->key_hash && !strcmp(key, entry->key))
          return entry;
-
-      previous = entry;
    }
 
-   if (prev)
-      *prev = previous;
-
    return NULL;
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       *in = strtod(entry->value, NULL);
@@ -563,7 +669,7 @@ bool config_get_double(config_file_t *conf, const char *key, double *in)
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -576,7 +682,7 @@ bool config_get_float(config_file_t *conf, const char *key, float *in)
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -592,7 +698,7 @@ bool config_get_int(config_file_t *conf, const char *key, int *in)
 
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -608,7 +714,7 @@ bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -624,7 +730,7 @@ bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -640,7 +746,7 @@ bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -655,7 +761,7 @@ bool config_get_char(config_file_t *conf, const char *key, char *in)
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       *str = strdup(entry->value);
@@ -666,7 +772,7 @@ bool config_get_string(config_file_t *conf, const char *key, char **str)
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       return strlcpy(buf, entry->value, size) < size;
@@ -680,7 +786,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 #if defined(RARCH_CONSOLE)
    return config_get_array(conf, key, buf, size);
 #else
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       fill_pathname_expand_special(buf, entry->value, size);
@@ -691,7 +797,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -712,8 +818,7 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry && !entry->readonly)
    {
@@ -727,15 +832,17 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
    if (!entry)
       return;
 
-   entry->key   = strdup(key);
-   entry->value = strdup(val);
-   if (!entry->key_hash)
-      entry->key_hash = djb2_calculate(key);
+   entry->key      = strdup(key);
+   entry->value    = strdup(val);
+   entry->key_hash = djb2_calculate(key);
 
-   if (last)
-      last->next = entry;
+   if (conf->tail)
+      conf->tail->next = entry;
    else
       conf->entries = entry;
+
+   conf->tail = entry;
+   config_index_add(conf, entry);
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -847,16 +954,7 @@ void config_file_dump(config_file_t *conf, FILE *file)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (!strcmp(entry, list->key))
-         return true;
-      list = list->next; 
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
@@ -899,10 +997,17 @@ void config_remove_entry(config_file_t *conf, const char *entry)
             prev->next = list->next;
          else
             conf->entries = list->next;
+
+         if (conf->tail == list)
+            conf->tail = prev;
          
          free(list->key);
          free(list->value);
          free(list);
+
+         /* A later entry with the same key may now be the first. */
+         if (conf->index)
+            config_index_rebuild(conf, conf->index_size);
          break;
       }
       else
@@ -0,0 +1,109 @@
+/* Copyright  (C) 2010-2015 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (config_file_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Benchmarks loading a config file the way the frontend does:
+ * the main config, then every override appended on top of it,
+ * then a lookup of every key.
+ *
+ * Usage: config_file_test retroarch.cfg [override.cfg ...] */
+
+#include <file/config_file.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ITERATIONS 200
+
+static double elapsed_ms(clock_t start)
+{
+   return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   int j;
+   size_t keys       = 0;
+   size_t found      = 0;
+   double load_ms    = 0.0;
+   double lookup_ms  = 0.0;
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "Usage: %s <config> [override ...]\n", argv[0]);
+      return 1;
+   }
+
+   for (i = 0; i < ITERATIONS; i++)
+   {
+      struct config_file_entry entry;
+      char buf[4096];
+      clock_t start      = clock();
+      config_file_t *conf = config_file_new(argv[1]);
+
+      if (!conf)
+      {
+         fprintf(stderr, "Failed to load %s.\n", argv[1]);
+         return 1;
+      }
+
+      for (j = 2; j < argc; j++)
+         config_append_file(conf, argv[j]);
+
+      load_ms += elapsed_ms(start);
+
+      /* The frontend queries every key it knows about,
+       * present or not. Approximate that with the keys
+       * of the file plus as many misses. */
+      start = clock();
+      keys  = 0;
+      found = 0;
+
+      if (config_get_entry_list_head(conf, &entry))
+      {
+         do
+         {
+            char missing[256];
+
+            snprintf(missing, sizeof(missing), "%s_missing", entry.key);
+
+            if (config_get_array(conf, entry.key, buf, sizeof(buf)))
+               found++;
+            if (config_get_array(conf, missing, buf, sizeof(buf)))
+               found++;
+            keys += 2;
+         } while (config_get_entry_list_next(&entry));
+      }
+
+      lookup_ms += elapsed_ms(start);
+      config_file_free(conf);
+   }
+
+   printf("%u iterations, %u override(s)\n", ITERATIONS, (unsigned)(argc - 2));
+   printf("load:   %.3f ms per config\n", load_ms / ITERATIONS);
+   printf("lookup: %.1f ns per key (%u keys, %u hits)\n",
+         keys ? lookup_ms * 1000000.0 / ((double)keys * ITERATIONS) : 0.0,
+         (unsigned)keys, (unsigned)found);
+
+   return 0;
+}
@@ -436,6 +436,19 @@ uint32_t zlib_crc32_calculate(const uint8_t *data, size_t length)
    return crc32(0, data, length);
 }
 
+uint32_t zlib_crc32_continue(uint32_t crc, const uint8_t *data, size_t length)
+{
+   /* crc32() takes a 32-bit length. */
+   while (length > 0x40000000)
+   {
+      crc     = crc32(crc, data, 0x40000000);
+      data   += 0x40000000;
+      length -= 0x40000000;
+   }
+
+   return crc32(crc, data, length);
+}
+
 uint32_t zlib_crc32_adjust(uint32_t crc, uint8_t data)
 {
    /* zlib and nall have different assumptions on "sign" for this 
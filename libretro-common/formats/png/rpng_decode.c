@@ -33,6 +33,10 @@
 #include <malloc.h>
 #endif
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 enum png_chunk_type png_chunk_type(const struct png_chunk *chunk)
 {
    unsigned i;
@@ -131,6 +135,14 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 {
    unsigned i;
 
+   if (bpp == 8)
+   {
+      for (i = 0; i < width; i++, decoded += 3)
+         data[i] = (0xffu << 24) | ((uint32_t)decoded[0] << 16)
+            | ((uint32_t)decoded[1] << 8) | decoded[2];
+      return;
+   }
+
    bpp /= 8;
 
    for (i = 0; i < width; i++)
@@ -150,7 +162,30 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 static void png_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
+
+   if (bpp == 8)
+   {
+#ifdef __SSE2__
+      /* Swap R and B of four pixels at a time. */
+      const __m128i ga_mask = _mm_set1_epi32(0xff00ff00);
+
+      for (; i + 4 <= width; i += 4, decoded += 16)
+      {
+         __m128i px = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i ga = _mm_and_si128(px, ga_mask);
+         __m128i rb = _mm_andnot_si128(ga_mask, px);
+
+         rb = _mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+         rb = _mm_shufflehi_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+         _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(ga, rb));
+      }
+#endif
+      for (; i < width; i++, decoded += 4)
+         data[i] = ((uint32_t)decoded[3] << 24) | ((uint32_t)decoded[0] << 16)
+            | ((uint32_t)decoded[1] << 8) | decoded[2];
+      return;
+   }
 
    bpp /= 8;
 
@@ -229,6 +264,13 @@ static void png_reverse_filter_copy_line_plt(uint32_t *data,
    unsigned i, bit;
    unsigned mask = (1 << depth) - 1;
 
+   if (depth == 8)
+   {
+      for (i = 0; i < width; i++)
+         data[i] = palette[decoded[i]];
+      return;
+   }
+
    bit = 0;
 
    for (i = 0; i < width; i++, bit += depth)
@@ -392,11 +434,141 @@ error:
    return -1;
 }
 
+#ifdef __SSE2__
+/* Unfiltering Sub, Average and Paeth depends on the pixel to the
+ * left, so only the channels of one pixel are done in parallel.
+ * This covers 8-bit RGB and RGBA, which nearly every image uses. */
+
+static INLINE __m128i png_load_pixel(const uint8_t *src, unsigned bpp)
+{
+   uint32_t val = 0;
+   memcpy(&val, src, bpp);
+   return _mm_cvtsi32_si128(val);
+}
+
+static INLINE void png_store_pixel(uint8_t *dst, __m128i px, unsigned bpp)
+{
+   uint32_t val = _mm_cvtsi128_si32(px);
+   memcpy(dst, &val, bpp);
+}
+
+static void png_unfilter_sub_sse2(uint8_t *out, const uint8_t *in,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, png_load_pixel(in + i, bpp));
+      png_store_pixel(out + i, a, bpp);
+   }
+}
+
+static void png_unfilter_avg_sse2(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i one = _mm_set1_epi8(1);
+   __m128i a         = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b   = png_load_pixel(prev + i, bpp);
+      /* _mm_avg_epu8 rounds up, PNG rounds down. */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+
+      a = _mm_add_epi8(avg, png_load_pixel(in + i, bpp));
+      png_store_pixel(out + i, a, bpp);
+   }
+}
+
+static INLINE __m128i png_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __m128i png_select(__m128i mask, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static void png_unfilter_paeth_sse2(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a          = zero;
+   __m128i c          = zero;
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i pa, pb, pc, smallest, nearest, x;
+      __m128i b = _mm_unpacklo_epi8(png_load_pixel(prev + i, bpp), zero);
+
+      pa = _mm_sub_epi16(b, c);
+      pb = _mm_sub_epi16(a, c);
+      pc = png_abs_epi16(_mm_add_epi16(pa, pb));
+      pa = png_abs_epi16(pa);
+      pb = png_abs_epi16(pb);
+
+      smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      nearest  = png_select(_mm_cmpeq_epi16(smallest, pa), a,
+            png_select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+      x = _mm_add_epi8(png_load_pixel(in + i, bpp),
+            _mm_packus_epi16(nearest, nearest));
+      png_store_pixel(out + i, x, bpp);
+
+      a = _mm_unpacklo_epi8(x, zero);
+      c = b;
+   }
+}
+#endif
+
+static void png_unfilter_up(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch)
+{
+   unsigned i = 0;
+
+#ifdef __SSE2__
+   for (; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(in + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+#endif
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
 static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
       struct rpng_process_t *pngp, unsigned filter)
 {
    unsigned i;
 
+#ifdef __SSE2__
+   if (pngp->bpp == 3 || pngp->bpp == 4)
+   {
+      switch (filter)
+      {
+         case PNG_FILTER_SUB:
+            png_unfilter_sub_sse2(pngp->decoded_scanline, pngp->inflate_buf,
+                  pngp->pitch, pngp->bpp);
+            goto copy;
+         case PNG_FILTER_AVERAGE:
+            png_unfilter_avg_sse2(pngp->decoded_scanline, pngp->inflate_buf,
+                  pngp->prev_scanline, pngp->pitch, pngp->bpp);
+            goto copy;
+         case PNG_FILTER_PAETH:
+            png_unfilter_paeth_sse2(pngp->decoded_scanline, pngp->inflate_buf,
+                  pngp->prev_scanline, pngp->pitch, pngp->bpp);
+            goto copy;
+      }
+   }
+#endif
+
    switch (filter)
    {
       case PNG_FILTER_NONE:
@@ -409,8 +581,8 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
             pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
          break;
       case PNG_FILTER_UP:
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+         png_unfilter_up(pngp->decoded_scanline, pngp->inflate_buf,
+               pngp->prev_scanline, pngp->pitch);
          break;
       case PNG_FILTER_AVERAGE:
          for (i = 0; i < pngp->bpp; i++)
@@ -436,6 +608,9 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          return PNG_PROCESS_ERROR_END;
    }
 
+#ifdef __SSE2__
+copy:
+#endif
    switch (ihdr->color_type)
    {
       case PNG_IHDR_COLOR_GRAY:
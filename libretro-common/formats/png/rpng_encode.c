@@ -26,6 +26,14 @@
 
 #include "rpng_common.h"
 
+#ifdef HAVE_ZLIB_DEFLATE
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #undef GOTO_END_ERROR
 #define GOTO_END_ERROR() do { \
    fprintf(stderr, "[RPNG]: Error in line %d.\n", __LINE__); \
@@ -192,145 +200,306 @@ static unsigned filter_paeth(uint8_t *target,
    return count_sad(target, width);
 }
 
-static bool rpng_save_image(const char *path,
-      const uint8_t *data,
-      unsigned width, unsigned height, unsigned pitch, unsigned bpp)
+/* A band of rows which is filtered and deflated on its own.
+ * Filtering only looks at the source row above, so strips do
+ * not depend on each other. Each strip is a raw deflate stream
+ * ended with a sync flush, so the strips can be joined into
+ * a single zlib stream. */
+struct rpng_strip
 {
-   unsigned h;
-   bool ret = true;
-   struct png_ihdr ihdr = {0};
+   const uint8_t *data;
+   const uint8_t *prev;
+   unsigned width;
+   unsigned rows;
+   unsigned pitch;
+   unsigned bpp;
+   bool fast;
+   bool last;
+
+   uint8_t *out;
+   size_t out_size;
+   size_t filtered_size;
+   uint32_t adler;
+   bool ok;
+
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+#endif
+};
+
+static void copy_line(uint8_t *dst, const uint8_t *src,
+      unsigned width, unsigned bpp)
+{
+   if (bpp == sizeof(uint32_t))
+      copy_argb_line(dst, (const uint32_t*)src, width);
+   else
+      copy_bgr24_line(dst, src, width);
+}
 
-   size_t encode_buf_size  = 0;
-   uint8_t *encode_buf     = NULL;
-   uint8_t *deflate_buf    = NULL;
-   uint8_t *rgba_line      = NULL;
-   uint8_t *up_filtered    = NULL;
-   uint8_t *sub_filtered   = NULL;
-   uint8_t *avg_filtered   = NULL;
-   uint8_t *paeth_filtered = NULL;
-   uint8_t *prev_encoded   = NULL;
-   uint8_t *encode_target  = NULL;
-   void *stream            = NULL;
+/**
+ * filter_line:
+ * @target           : filter type followed by the filtered line.
+ * @line             : line to filter.
+ * @prev             : line above @line, zeroes for the first one.
+ * @scratch          : four lines of scratch space.
+ * @width            : width of @line in pixels.
+ * @bpp              : bytes per pixel.
+ * @fast             : always use the up filter.
+ *
+ * Filters @line with the filter that leaves the smallest
+ * sum of absolute differences, which usually deflates best.
+ **/
+static void filter_line(uint8_t *target, const uint8_t *line,
+      const uint8_t *prev, uint8_t *scratch,
+      unsigned width, unsigned bpp, bool fast)
+{
+   size_t size                    = width * bpp;
+   uint8_t *up_filtered           = scratch;
+   uint8_t *sub_filtered          = scratch + size;
+   uint8_t *avg_filtered          = scratch + size * 2;
+   uint8_t *paeth_filtered        = scratch + size * 3;
+   uint8_t filter                 = PNG_FILTER_NONE;
+   const uint8_t *chosen_filtered = line;
+   unsigned min_sad, up_score, sub_score, avg_score, paeth_score;
+
+   if (fast)
+   {
+      /* Up is the cheapest filter that still
+       * pays off on most game frames. */
+      target[0] = PNG_FILTER_UP;
+      filter_up(target + 1, line, prev, width, bpp);
+      return;
+   }
 
-   FILE *file = fopen(path, "wb");
-   if (!file)
+   /* Try every filtering method, and choose the method
+    * which has most entries as zero.
+    *
+    * This is probably not very optimal, but it's very 
+    * simple to implement.
+    */
+   min_sad     = count_sad(line, size);
+   up_score    = filter_up(up_filtered, line, prev, width, bpp);
+   sub_score   = filter_sub(sub_filtered, line, width, bpp);
+   avg_score   = filter_avg(avg_filtered, line, prev, width, bpp);
+   paeth_score = filter_paeth(paeth_filtered, line, prev, width, bpp);
+
+   if (sub_score < min_sad)
+   {
+      filter = PNG_FILTER_SUB;
+      chosen_filtered = sub_filtered;
+      min_sad = sub_score;
+   }
+
+   if (up_score < min_sad)
+   {
+      filter = PNG_FILTER_UP;
+      chosen_filtered = up_filtered;
+      min_sad = up_score;
+   }
+
+   if (avg_score < min_sad)
+   {
+      filter = PNG_FILTER_AVERAGE;
+      chosen_filtered = avg_filtered;
+      min_sad = avg_score;
+   }
+
+   if (paeth_score < min_sad)
+   {
+      filter = PNG_FILTER_PAETH;
+      chosen_filtered = paeth_filtered;
+      min_sad = paeth_score;
+   }
+
+   target[0] = filter;
+   memcpy(target + 1, chosen_filtered, size);
+}
+
+static void rpng_encode_strip(void *data)
+{
+   unsigned h;
+   z_stream z;
+   struct rpng_strip *strip = (struct rpng_strip*)data;
+   size_t line_size         = strip->width * strip->bpp;
+   const uint8_t *src       = strip->data;
+   uint8_t *filtered        = NULL;
+   uint8_t *lines           = NULL;
+   uint8_t *scratch         = NULL;
+   uint8_t *line            = NULL;
+   uint8_t *prev            = NULL;
+   bool ret                 = true;
+
+   memset(&z, 0, sizeof(z));
+
+   strip->filtered_size = (line_size + 1) * strip->rows;
+   filtered = (uint8_t*)malloc(strip->filtered_size);
+   lines    = (uint8_t*)calloc(2, line_size);
+   scratch  = (uint8_t*)malloc(line_size * 4);
+   if (!filtered || !lines || !scratch)
       GOTO_END_ERROR();
 
-   if (fwrite(png_magic, 1, sizeof(png_magic), file) != sizeof(png_magic))
+   line = lines;
+   prev = lines + line_size;
+
+   if (strip->prev)
+      copy_line(prev, strip->prev, strip->width, strip->bpp);
+
+   for (h = 0; h < strip->rows; h++, src += strip->pitch)
+   {
+      uint8_t *tmp = NULL;
+
+      copy_line(line, src, strip->width, strip->bpp);
+      filter_line(filtered + h * (line_size + 1), line, prev, scratch,
+            strip->width, strip->bpp, strip->fast);
+
+      tmp  = prev;
+      prev = line;
+      line = tmp;
+   }
+
+   strip->adler = adler32(adler32(0, NULL, 0),
+         filtered, strip->filtered_size);
+
+   if (deflateInit2(&z, strip->fast ? Z_BEST_SPEED : Z_BEST_COMPRESSION,
+            Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
       GOTO_END_ERROR();
 
-   ihdr.width = width;
-   ihdr.height = height;
-   ihdr.depth = 8;
-   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
-   if (!png_write_ihdr(file, &ihdr))
+   /* A sync flush adds at most a few bytes over deflateBound(). */
+   strip->out_size = deflateBound(&z, strip->filtered_size) + 16;
+   strip->out      = (uint8_t*)malloc(strip->out_size);
+   if (!strip->out)
+   {
+      deflateEnd(&z);
       GOTO_END_ERROR();
+   }
 
-   encode_buf_size = (width * bpp + 1) * height;
-   encode_buf = (uint8_t*)malloc(encode_buf_size);
-   if (!encode_buf)
+   z.next_in   = filtered;
+   z.avail_in  = strip->filtered_size;
+   z.next_out  = strip->out;
+   z.avail_out = strip->out_size;
+
+   if (deflate(&z, strip->last ? Z_FINISH : Z_SYNC_FLUSH)
+         != (strip->last ? Z_STREAM_END : Z_OK) || z.avail_in)
+   {
+      deflateEnd(&z);
       GOTO_END_ERROR();
+   }
+
+   strip->out_size = z.total_out;
+   deflateEnd(&z);
+
+end:
+   strip->ok = ret;
+   free(filtered);
+   free(lines);
+   free(scratch);
+}
+
+static bool rpng_save_image(const char *path,
+      const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned bpp,
+      unsigned num_strips, bool fast)
+{
+   unsigned i;
+   bool ret = true;
+   struct png_ihdr ihdr = {0};
+   size_t idat_size          = 0;
+   uint32_t adler            = 0;
+   uint8_t *idat             = NULL;
+   uint8_t *idat_target      = NULL;
+   struct rpng_strip *strips = NULL;
 
-   prev_encoded = (uint8_t*)calloc(1, width * bpp);
-   if (!prev_encoded)
+   FILE *file = fopen(path, "wb");
+   if (!file)
       GOTO_END_ERROR();
 
-   rgba_line      = (uint8_t*)malloc(width * bpp);
-   up_filtered    = (uint8_t*)malloc(width * bpp);
-   sub_filtered   = (uint8_t*)malloc(width * bpp);
-   avg_filtered   = (uint8_t*)malloc(width * bpp);
-   paeth_filtered = (uint8_t*)malloc(width * bpp);
-   if (!rgba_line || !up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
+   if (num_strips > height)
+      num_strips = height;
+   if (num_strips < 1)
+      num_strips = 1;
+
+   strips = (struct rpng_strip*)calloc(num_strips, sizeof(*strips));
+   if (!strips)
       GOTO_END_ERROR();
 
-   encode_target = encode_buf;
-   for (h = 0; h < height;
-         h++, encode_target += width * bpp, data += pitch)
+   for (i = 0; i < num_strips; i++)
    {
-      if (bpp == sizeof(uint32_t))
-         copy_argb_line(rgba_line, (const uint32_t*)data, width);
-      else
-         copy_bgr24_line(rgba_line, data, width);
-
-      /* Try every filtering method, and choose the method
-       * which has most entries as zero.
-       *
-       * This is probably not very optimal, but it's very 
-       * simple to implement.
-       */
-      unsigned none_score  = count_sad(rgba_line, width * bpp);
-      unsigned up_score    = filter_up(up_filtered, rgba_line, prev_encoded, width, bpp);
-      unsigned sub_score   = filter_sub(sub_filtered, rgba_line, width, bpp);
-      unsigned avg_score   = filter_avg(avg_filtered, rgba_line, prev_encoded, width, bpp);
-      unsigned paeth_score = filter_paeth(paeth_filtered, rgba_line, prev_encoded, width, bpp);
-
-      uint8_t filter       = 0;
-      unsigned min_sad     = none_score;
-      const uint8_t *chosen_filtered = rgba_line;
-
-      if (sub_score < min_sad)
-      {
-         filter = 1;
-         chosen_filtered = sub_filtered;
-         min_sad = sub_score;
-      }
+      unsigned first  = (unsigned)((uint64_t)height * i / num_strips);
+      unsigned end    = (unsigned)((uint64_t)height * (i + 1) / num_strips);
+
+      strips[i].data  = data + (size_t)first * pitch;
+      strips[i].prev  = first ? strips[i].data - pitch : NULL;
+      strips[i].width = width;
+      strips[i].rows  = end - first;
+      strips[i].pitch = pitch;
+      strips[i].bpp   = bpp;
+      strips[i].fast  = fast;
+      strips[i].last  = i == num_strips - 1;
+   }
 
-      if (up_score < min_sad)
-      {
-         filter = 2;
-         chosen_filtered = up_filtered;
-         min_sad = up_score;
-      }
+#ifdef HAVE_THREADS
+   for (i = 1; i < num_strips; i++)
+      strips[i].thread = sthread_create(rpng_encode_strip, &strips[i]);
+#endif
 
-      if (avg_score < min_sad)
-      {
-         filter = 3;
-         chosen_filtered = avg_filtered;
-         min_sad = avg_score;
-      }
+   rpng_encode_strip(&strips[0]);
 
-      if (paeth_score < min_sad)
+   for (i = 1; i < num_strips; i++)
+   {
+#ifdef HAVE_THREADS
+      if (strips[i].thread)
       {
-         filter = 4;
-         chosen_filtered = paeth_filtered;
-         min_sad = paeth_score;
+         sthread_join(strips[i].thread);
+         continue;
       }
+#endif
+      rpng_encode_strip(&strips[i]);
+   }
 
-      *encode_target++ = filter;
-      memcpy(encode_target, chosen_filtered, width * bpp);
+   /* Chunk header, zlib header, strips, Adler-32. */
+   idat_size = 8 + 2 + 4;
+   adler     = adler32(0, NULL, 0);
 
-      memcpy(prev_encoded, rgba_line, width * bpp);
+   for (i = 0; i < num_strips; i++)
+   {
+      if (!strips[i].ok)
+         GOTO_END_ERROR();
+
+      idat_size += strips[i].out_size;
+      adler      = adler32_combine(adler, strips[i].adler,
+            strips[i].filtered_size);
    }
 
-   deflate_buf = (uint8_t*)malloc(encode_buf_size * 2); /* Just to be sure. */
-   if (!deflate_buf)
+   idat = (uint8_t*)malloc(idat_size);
+   if (!idat)
       GOTO_END_ERROR();
 
-   stream = zlib_stream_new();
+   if (fwrite(png_magic, 1, sizeof(png_magic), file) != sizeof(png_magic))
+      GOTO_END_ERROR();
 
-   if (!stream)
+   ihdr.width = width;
+   ihdr.height = height;
+   ihdr.depth = 8;
+   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
+   if (!png_write_ihdr(file, &ihdr))
       GOTO_END_ERROR();
 
-   zlib_set_stream(
-         stream,
-         encode_buf_size,
-         encode_buf_size * 2,
-         encode_buf,
-         deflate_buf + 8);
+   dword_write_be(idat + 0, idat_size - 8);
+   memcpy(idat + 4, "IDAT", 4);
 
-   zlib_deflate_init(stream, 9);
+   /* 32K window, deflate, level hint. Both are multiples of 31. */
+   idat[8] = 0x78;
+   idat[9] = fast ? 0x01 : 0xda;
 
-   if (zlib_deflate(stream) != 1)
+   idat_target = idat + 10;
+   for (i = 0; i < num_strips; i++)
    {
-      zlib_stream_deflate_free(stream);
-      GOTO_END_ERROR();
+      memcpy(idat_target, strips[i].out, strips[i].out_size);
+      idat_target += strips[i].out_size;
    }
+   dword_write_be(idat_target, adler);
 
-   zlib_stream_deflate_free(stream);
-
-   memcpy(deflate_buf + 4, "IDAT", 4);
-   dword_write_be(deflate_buf + 0, zlib_stream_get_total_out(stream));
-   if (!png_write_idat(file, deflate_buf, zlib_stream_get_total_out(stream) + 8))
+   if (!png_write_idat(file, idat, idat_size))
       GOTO_END_ERROR();
 
    if (!png_write_iend(file))
@@ -339,16 +508,13 @@ static bool rpng_save_image(const char *path,
 end:
    if (file)
       fclose(file);
-   free(encode_buf);
-   free(deflate_buf);
-   free(rgba_line);
-   free(prev_encoded);
-   free(up_filtered);
-   free(sub_filtered);
-   free(avg_filtered);
-   free(paeth_filtered);
-
-   zlib_stream_inflate_free(stream);
+   if (strips)
+   {
+      for (i = 0; i < num_strips; i++)
+         free(strips[i].out);
+   }
+   free(strips);
+   free(idat);
    return ret;
 }
 
@@ -356,14 +522,30 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, sizeof(uint32_t));
+         width, height, pitch, sizeof(uint32_t), 1, false);
 }
 
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, 3);
+         width, height, pitch, 3, 1, false);
+}
+
+bool rpng_save_image_argb_ex(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      unsigned strips, bool fast)
+{
+   return rpng_save_image(path, (const uint8_t*)data,
+         width, height, pitch, sizeof(uint32_t), strips, fast);
+}
+
+bool rpng_save_image_bgr24_ex(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      unsigned strips, bool fast)
+{
+   return rpng_save_image(path, (const uint8_t*)data,
+         width, height, pitch, 3, strips, fast);
 }
 
 #endif
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <zlib.h>
 #ifdef HAVE_IMLIB2
 #include <Imlib2.h>
 #endif
@@ -280,6 +281,225 @@ static int test_blocking_rpng(const char *in_path)
    return 0;
 }
 
+static void write_be32(uint8_t *buf, uint32_t val)
+{
+   buf[0] = (uint8_t)(val >> 24);
+   buf[1] = (uint8_t)(val >> 16);
+   buf[2] = (uint8_t)(val >>  8);
+   buf[3] = (uint8_t)(val >>  0);
+}
+
+static bool write_chunk(FILE *file, const char *type,
+      const uint8_t *data, uint32_t size)
+{
+   uint8_t dword[4];
+   uint32_t crc = crc32(crc32(0, (const uint8_t*)type, 4), data, size);
+
+   write_be32(dword, size);
+   if (fwrite(dword, 1, 4, file) != 4 || fwrite(type, 1, 4, file) != 4)
+      return false;
+   if (size && fwrite(data, 1, size, file) != size)
+      return false;
+   write_be32(dword, crc);
+   return fwrite(dword, 1, 4, file) == 4;
+}
+
+static int paeth_ref(int a, int b, int c)
+{
+   int p  = a + b - c;
+   int pa = abs(p - a);
+   int pb = abs(p - b);
+   int pc = abs(p - c);
+
+   if (pa <= pb && pa <= pc)
+      return a;
+   else if (pb <= pc)
+      return b;
+   return c;
+}
+
+static int test_filters_rpng(void)
+{
+   unsigned bpp;
+
+   /* Rows cycle through every filter type over random bytes,
+    * checked against a straightforward unfilter. */
+   for (bpp = 3; bpp <= 4; bpp++)
+   {
+      unsigned x, y, i;
+      const unsigned width  = 37;
+      const unsigned height = 20;
+      const unsigned pitch  = width * bpp;
+      uint8_t raw[20 * (37 * 4 + 1)];
+      uint8_t rows[20][37 * 4];
+      uint8_t ihdr[13]      = {0};
+      uint8_t packed[4096];
+      uLongf packed_size    = sizeof(packed);
+      uint32_t *data        = NULL;
+      unsigned out_width    = 0;
+      unsigned out_height   = 0;
+      FILE *file            = NULL;
+
+      srand(bpp);
+
+      for (y = 0; y < height; y++)
+      {
+         uint8_t *line      = raw + y * (pitch + 1);
+         const uint8_t *up  = y ? rows[y - 1] : NULL;
+
+         line[0] = y % 5;
+         for (i = 0; i < pitch; i++)
+            line[i + 1] = rand();
+
+         for (i = 0; i < pitch; i++)
+         {
+            int a = i >= bpp ? rows[y][i - bpp] : 0;
+            int b = up ? up[i] : 0;
+            int c = (up && i >= bpp) ? up[i - bpp] : 0;
+            int pred = 0;
+
+            switch (line[0])
+            {
+               case 1: pred = a; break;
+               case 2: pred = b; break;
+               case 3: pred = (a + b) >> 1; break;
+               case 4: pred = paeth_ref(a, b, c); break;
+            }
+
+            rows[y][i] = (uint8_t)(line[i + 1] + pred);
+         }
+      }
+
+      write_be32(ihdr + 0, width);
+      write_be32(ihdr + 4, height);
+      ihdr[8] = 8;
+      ihdr[9] = bpp == 4 ? 6 : 2;
+
+      if (compress2(packed, &packed_size, raw,
+               height * (pitch + 1), 9) != Z_OK)
+         return 1;
+
+      if (!(file = fopen("/tmp/test_filters.png", "wb")))
+         return 1;
+
+      fwrite("\x89PNG\r\n\x1a\n", 1, 8, file);
+      if (!write_chunk(file, "IHDR", ihdr, sizeof(ihdr))
+            || !write_chunk(file, "IDAT", packed, packed_size)
+            || !write_chunk(file, "IEND", NULL, 0))
+      {
+         fclose(file);
+         return 1;
+      }
+      fclose(file);
+
+      if (!rpng_load_image_argb("/tmp/test_filters.png",
+               &data, &out_width, &out_height))
+         return 2;
+
+      for (y = 0; y < height; y++)
+      {
+         for (x = 0; x < width; x++)
+         {
+            const uint8_t *px = rows[y] + x * bpp;
+            uint32_t expected = ((bpp == 4 ? px[3] : 0xffu) << 24)
+               | (px[0] << 16) | (px[1] << 8) | px[2];
+
+            if (data[y * width + x] != expected)
+            {
+               fprintf(stderr, "Filter %u differs at (%u, %u), bpp %u.\n",
+                     y % 5, x, y, bpp);
+               free(data);
+               return 3;
+            }
+         }
+      }
+
+      free(data);
+   }
+
+   fprintf(stderr, "All filters decode correctly!\n");
+   return 0;
+}
+
+static int test_strip_rpng(void)
+{
+   unsigned x, y, strips;
+   uint32_t test_data[61 * 47];
+
+   uint8_t bgr_data[61 * 47 * 3];
+
+   /* Smooth gradients with some noise, so every filter gets picked. */
+   for (y = 0; y < 47; y++)
+      for (x = 0; x < 61; x++)
+      {
+         uint32_t noise = (x * 7919 + y * 104729) % 23;
+         uint32_t pixel = ((((x * y + noise) * 3) & 0xff) << 24)
+            | ((x * 4) << 16) | ((y * 5 + noise) << 8) | ((x * y) & 0xff);
+
+         test_data[y * 61 + x]        = pixel;
+         bgr_data[(y * 61 + x) * 3 + 0] = (uint8_t)(pixel >>  0);
+         bgr_data[(y * 61 + x) * 3 + 1] = (uint8_t)(pixel >>  8);
+         bgr_data[(y * 61 + x) * 3 + 2] = (uint8_t)(pixel >> 16);
+      }
+
+   /* Strips must decode to the same image, whichever
+    * filters and deflate blocks they were encoded with. */
+   for (strips = 1; strips <= 8; strips++)
+   {
+      unsigned fast;
+
+      for (fast = 0; fast < 2; fast++)
+      {
+         uint32_t *data  = NULL;
+         unsigned width  = 0;
+         unsigned height = 0;
+
+         if (!rpng_save_image_argb_ex("/tmp/test_strip.png", test_data,
+                  61, 47, 61 * sizeof(uint32_t), strips, fast))
+            return 1;
+
+         if (!rpng_load_image_argb("/tmp/test_strip.png",
+                  &data, &width, &height))
+            return 2;
+
+         if (width != 61 || height != 47
+               || memcmp(data, test_data, sizeof(test_data)) != 0)
+         {
+            fprintf(stderr, "Strip encode differs (%u strips, fast %u).\n",
+                  strips, fast);
+            free(data);
+            return 3;
+         }
+
+         free(data);
+
+         if (!rpng_save_image_bgr24_ex("/tmp/test_strip.png", bgr_data,
+                  61, 47, 61 * 3, strips, fast))
+            return 1;
+
+         if (!rpng_load_image_argb("/tmp/test_strip.png",
+                  &data, &width, &height))
+            return 2;
+
+         for (y = 0; y < 61 * 47; y++)
+         {
+            if (data[y] != (test_data[y] | 0xff000000))
+            {
+               fprintf(stderr, "RGB strip encode differs (%u strips, fast %u).\n",
+                     strips, fast);
+               free(data);
+               return 3;
+            }
+         }
+
+         free(data);
+      }
+   }
+
+   fprintf(stderr, "Strip encodes are equivalent!\n");
+   return 0;
+}
+
 int main(int argc, char *argv[])
 {
    const char *in_path = "/tmp/test.png";
@@ -301,6 +521,22 @@ int main(int argc, char *argv[])
       return -1;
    }
 
+   fprintf(stderr, "Doing filter tests...\n");
+
+   if (test_filters_rpng() != 0)
+   {
+      fprintf(stderr, "Filter test failed.\n");
+      return -1;
+   }
+
+   fprintf(stderr, "Doing strip tests...\n");
+
+   if (test_strip_rpng() != 0)
+   {
+      fprintf(stderr, "Strip test failed.\n");
+      return -1;
+   }
+
    fprintf(stderr, "Doing blocking tests...\n");
 
    return test_blocking_rpng(in_path);
@@ -59,6 +59,13 @@ struct config_file
    unsigned include_depth;
 
    struct config_include_list *includes;
+
+   /* Open-addressed index into entries, keyed by key_hash.
+    * Holds the first entry in list order for every key,
+    * which is the one lookups must return. */
+   struct config_entry_list **index;
+   size_t index_size;
+   size_t index_count;
 };
 
 typedef struct config_file config_file_t;
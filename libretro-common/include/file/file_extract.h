@@ -63,6 +63,18 @@ uint32_t zlib_crc32_calculate(const uint8_t *data, size_t length);
 
 uint32_t zlib_crc32_adjust(uint32_t crc, uint8_t data);
 
+/**
+ * zlib_crc32_continue:
+ * @crc                         : CRC32 of the data so far, 0 to start.
+ * @data                        : Next block of data.
+ * @length                      : Length of @data.
+ *
+ * Extends a zlib_crc32_calculate() result with more data.
+ *
+ * Returns: CRC32 of all data so far.
+ */
+uint32_t zlib_crc32_continue(uint32_t crc, const uint8_t *data, size_t length);
+
 /**
  * zlib_parse_file:
  * @file                        : filename path of archive
@@ -124,6 +124,16 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch);
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
+
+/* Splits the image into @strips bands of rows which are filtered
+ * and deflated in parallel when threads are available.
+ * @fast uses a fixed filter and the fastest deflate level. */
+bool rpng_save_image_argb_ex(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      unsigned strips, bool fast);
+bool rpng_save_image_bgr24_ex(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      unsigned strips, bool fast);
 #endif
 
 #ifdef __cplusplus
@@ -40,6 +40,7 @@
 #include "intl/intl.h"
 #include "input/input_common.h"
 #include "preempt.h"
+#include "benchmark.h"
 
 #ifdef HAVE_NETPLAY
 #include "netplay.h"
@@ -90,9 +91,16 @@ static void video_frame(const void *data, unsigned width,
    global_t  *global    = global_get_ptr();
    settings_t *settings = config_get_ptr();
 
+   retro_time_t start   = 0;
+
    if (!driver->video_active)
       return;
 
+   start = benchmark_stage_begin();
+
+   if (settings->video.frame_delay_auto)
+      rarch_main_get_ptr()->frames.delay.submit_time = rarch_get_time_usec();
+
    video_driver_cached_frame_set(data, width, height, pitch);
 
    if (video_frame_scale(data, width, height, pitch))
@@ -129,39 +137,46 @@ static void video_frame(const void *data, unsigned width,
 
    if (!video_driver_frame(data, width, height, pitch, driver->current_msg))
       driver->video_active = false;
+
+   benchmark_stage_end(BENCHMARK_STAGE_VIDEO, start);
 }
 
+/* Joypad state is only updated by input_poll, so the digital buttons
+ * of each port are resolved once per poll and every later joypad query
+ * is served from this table. */
+static int16_t input_joypad_snapshot[MAX_USERS];
+static uint32_t input_joypad_snapshot_valid;
+
+/* The same for the two axes of both analog sticks. Each axis is
+ * resolved on its own, as most cores only read the left stick. */
+#define INPUT_ANALOG_AXES 4
+static int16_t input_analog_snapshot[MAX_USERS][INPUT_ANALOG_AXES];
+static uint64_t input_analog_snapshot_valid;
+
+/* Number of input_state queries since the last poll, for the perf log. */
+static unsigned input_state_queries;
+static unsigned input_state_queries_max;
+static uint64_t input_state_queries_total;
+static uint64_t input_state_polls;
+
 /**
- * input_state:
+ * input_state_uncached:
  * @port                 : user number.
  * @device               : device identifier of user.
  * @idx                  : index value of user.
  * @id                   : identifier of key pressed by user.
  *
- * Input state callback function.
+ * Queries remapping, the input driver and the overlay for
+ * a single input.
  *
- * Returns: Non-zero if the given key (identified by @id) was pressed by the user
- * (assigned to @port).
+ * Returns: state of the input, not accounting for flushing_input.
  **/
-static int16_t input_state(unsigned port, unsigned device,
+static int16_t input_state_uncached(unsigned port, unsigned device,
       unsigned idx, unsigned id)
 {
    int16_t res                    = 0;
    settings_t *settings           = config_get_ptr();
    driver_t *driver               = driver_get_ptr();
-   
-   device &= RETRO_DEVICE_MASK;
-   
-   if (id == RETRO_DEVICE_ID_JOYPAD_MASK
-       && device == RETRO_DEVICE_JOYPAD)
-   {
-      unsigned i;
-
-      for (i = 0; i < RARCH_FIRST_CUSTOM_BIND; i++)
-         if (input_state(port, device, idx, i))
-            res |= (1 << i);
-      return res;
-   }
 
    if (settings->input.remap_binds_enable)
       input_remapping_state(port, &device, &idx, &id);
@@ -180,6 +195,96 @@ static int16_t input_state(unsigned port, unsigned device,
 #endif
    }
 
+   return res;
+}
+
+/**
+ * input_state_joypad_snapshot:
+ * @port                 : user number.
+ * @idx                  : index value of user.
+ *
+ * Returns: bitmask of the digital joypad buttons of @port,
+ * resolved at most once per poll.
+ **/
+static int16_t input_state_joypad_snapshot(unsigned port, unsigned idx)
+{
+   unsigned i;
+   int16_t res = 0;
+
+   if (input_joypad_snapshot_valid & (1 << port))
+      return input_joypad_snapshot[port];
+
+   for (i = 0; i < RARCH_FIRST_CUSTOM_BIND; i++)
+      if (input_state_uncached(port, RETRO_DEVICE_JOYPAD, idx, i))
+         res |= (1 << i);
+
+   input_joypad_snapshot[port]  = res;
+   input_joypad_snapshot_valid |= (1 << port);
+
+   return res;
+}
+
+/**
+ * input_state_analog_snapshot:
+ * @port                 : user number.
+ * @idx                  : analog stick, left or right.
+ * @id                   : analog axis, X or Y.
+ *
+ * Returns: value of the given analog axis of @port,
+ * resolved at most once per poll.
+ **/
+static int16_t input_state_analog_snapshot(unsigned port,
+      unsigned idx, unsigned id)
+{
+   int16_t res;
+   unsigned axis = idx * 2 + id;
+   uint64_t bit  = (uint64_t)1 << (port * INPUT_ANALOG_AXES + axis);
+
+   if (input_analog_snapshot_valid & bit)
+      return input_analog_snapshot[port][axis];
+
+   res = input_state_uncached(port, RETRO_DEVICE_ANALOG, idx, id);
+
+   input_analog_snapshot[port][axis] = res;
+   input_analog_snapshot_valid      |= bit;
+
+   return res;
+}
+
+/**
+ * input_state_live:
+ * @port                 : user number.
+ * @device               : device identifier of user.
+ * @idx                  : index value of user.
+ * @id                   : identifier of key pressed by user.
+ *
+ * Returns: state of the input as seen by the core,
+ * ignoring input log playback.
+ **/
+static int16_t input_state_live(unsigned port, unsigned device,
+      unsigned idx, unsigned id)
+{
+   int16_t res                    = 0;
+   driver_t *driver               = driver_get_ptr();
+
+   device &= RETRO_DEVICE_MASK;
+
+   if (device == RETRO_DEVICE_JOYPAD && port < MAX_USERS)
+   {
+      if (id == RETRO_DEVICE_ID_JOYPAD_MASK)
+         res = input_state_joypad_snapshot(port, idx);
+      else if (id < RARCH_FIRST_CUSTOM_BIND)
+         res = (input_state_joypad_snapshot(port, idx) >> id) & 1;
+      else
+         res = input_state_uncached(port, device, idx, id);
+   }
+   else if (device == RETRO_DEVICE_ANALOG && port < MAX_USERS
+         && idx <= RETRO_DEVICE_INDEX_ANALOG_RIGHT
+         && id <= RETRO_DEVICE_ID_ANALOG_Y)
+      res = input_state_analog_snapshot(port, idx, id);
+   else
+      res = input_state_uncached(port, device, idx, id);
+
    /* flushing_input will be cleared in rarch_main_iterate. */
    if (driver->flushing_input)
       res = 0;
@@ -187,6 +292,50 @@ static int16_t input_state(unsigned port, unsigned device,
    return res;
 }
 
+/**
+ * input_state:
+ * @port                 : user number.
+ * @device               : device identifier of user.
+ * @idx                  : index value of user.
+ * @id                   : identifier of key pressed by user.
+ *
+ * Input state callback function.
+ *
+ * Returns: Non-zero if the given key (identified by @id) was pressed by the user
+ * (assigned to @port).
+ **/
+static int16_t input_state(unsigned port, unsigned device,
+      unsigned idx, unsigned id)
+{
+   int16_t res                    = 0;
+   global_t *global               = global_get_ptr();
+
+   input_state_queries++;
+
+   if (global->movie.handle && movie_get_input(global->movie.handle,
+            port, device & RETRO_DEVICE_MASK, idx, id, &res))
+      return res;
+
+   return input_state_live(port, device, idx, id);
+}
+
+/**
+ * input_state_perf_log:
+ *
+ * Logs how many input_state queries were made per poll.
+ **/
+void input_state_perf_log(void)
+{
+   global_t *global = global_get_ptr();
+
+   if (!global->perfcnt_enable || !input_state_polls)
+      return;
+
+   RARCH_LOG("[PERF]: Input state queries per poll: avg %.1f, max %u.\n",
+         (double)input_state_queries_total / input_state_polls,
+         input_state_queries_max);
+}
+
 /**
  * input_poll:
  *
@@ -195,6 +344,15 @@ static int16_t input_state(unsigned port, unsigned device,
 static void input_poll(void)
 {
    driver_t *driver               = driver_get_ptr();
+   global_t *global               = global_get_ptr();
+
+   input_state_queries_total += input_state_queries;
+   if (input_state_queries > input_state_queries_max)
+      input_state_queries_max = input_state_queries;
+   input_state_queries          = 0;
+   input_state_polls++;
+   input_joypad_snapshot_valid  = 0;
+   input_analog_snapshot_valid  = 0;
 
    input_driver_poll();
 
@@ -209,6 +367,9 @@ static void input_poll(void)
    if (driver->command)
       rarch_cmd_poll(driver->command);
 #endif
+
+   if (global->movie.handle)
+      movie_poll(global->movie.handle, input_state_live);
 }
 
 /**
@@ -73,6 +73,13 @@ void retro_set_rewind_callbacks(void);
  **/
 bool retro_flush_audio(const int16_t *data, size_t samples);
 
+/**
+ * input_state_perf_log:
+ *
+ * Logs how many input_state queries were made per poll.
+ **/
+void input_state_perf_log(void);
+
 #ifdef __cplusplus
 }
 #endif
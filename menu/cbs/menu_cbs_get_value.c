@@ -52,6 +52,40 @@ static void menu_action_setting_disp_set_label_cheat_num_passes(
    snprintf(s, len, "%u", global->cheat->buf_size);
 }
 
+static void menu_action_setting_disp_set_label_cheat_search_type(
+      file_list_t* list,
+      unsigned *w, unsigned type, unsigned i,
+      const char *label,
+      char *s, size_t len,
+      const char *entry_label,
+      const char *path,
+      char *s2, size_t len2)
+{
+   global_t *global = global_get_ptr();
+
+   *w = 19;
+   strlcpy(s2, path, len2);
+   strlcpy(s, cheat_search_type_str(
+            cheat_search_get_type(global->cheat_search)), len);
+}
+
+static void menu_action_setting_disp_set_label_cheat_search_count(
+      file_list_t* list,
+      unsigned *w, unsigned type, unsigned i,
+      const char *label,
+      char *s, size_t len,
+      const char *entry_label,
+      const char *path,
+      char *s2, size_t len2)
+{
+   global_t *global = global_get_ptr();
+
+   *w = 19;
+   strlcpy(s2, path, len2);
+   snprintf(s, len, "%u",
+         (unsigned)cheat_search_count(global->cheat_search));
+}
+
 static void menu_action_setting_disp_set_label_core_options_scope(
       file_list_t* list,
       unsigned *w, unsigned type, unsigned i,
@@ -914,6 +948,14 @@ static int menu_cbs_init_bind_get_string_representation_compare_label(
          cbs->action_get_value =
             menu_action_setting_disp_set_label_cheat_num_passes;
          break;
+      case MENU_LABEL_CHEAT_SEARCH_TYPE:
+         cbs->action_get_value =
+            menu_action_setting_disp_set_label_cheat_search_type;
+         break;
+      case MENU_LABEL_CHEAT_SEARCH_COUNT:
+         cbs->action_get_value =
+            menu_action_setting_disp_set_label_cheat_search_count;
+         break;
       case MENU_LABEL_OPTIONS_SCOPE:
          cbs->action_get_value =
             menu_action_setting_disp_set_label_core_options_scope;
@@ -346,6 +346,22 @@ static int action_left_cheat_num_passes(unsigned type, const char *label,
    return 0;
 }
 
+static int action_left_cheat_search_type(unsigned type, const char *label,
+      bool wraparound)
+{
+   global_t *global = global_get_ptr();
+   unsigned current = cheat_search_get_type(global->cheat_search);
+
+   if (!global->cheat_search)
+      return -1;
+
+   cheat_search_set_type(global->cheat_search, (enum cheat_search_type)
+         ((current + CHEAT_SEARCH_TYPE_LAST - 1) % CHEAT_SEARCH_TYPE_LAST));
+   menu_entries_set_refresh();
+
+   return 0;
+}
+
 static int action_l_cheat_num_passes(unsigned type, const char *label)
 {
    global_t *global       = global_get_ptr();
@@ -605,6 +621,9 @@ static int menu_cbs_init_bind_left_compare_label(menu_file_list_cbs_t *cbs,
          cbs->action_left = action_left_cheat_num_passes;
          cbs->action_l = action_l_cheat_num_passes;
          break;
+      case MENU_LABEL_CHEAT_SEARCH_TYPE:
+         cbs->action_left = action_left_cheat_search_type;
+         break;
       case MENU_LABEL_INFO:
          cbs->action_left = action_left_scroll;
          break;
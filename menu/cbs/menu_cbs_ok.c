@@ -152,6 +152,46 @@ static int action_ok_cheat_apply_changes(const char *path,
    return 0;
 }
 
+static int action_ok_cheat_search(const char *path,
+      const char *label, unsigned type, size_t idx, size_t entry_idx)
+{
+   char msg[64]           = {0};
+   bool ret               = false;
+   global_t *global       = global_get_ptr();
+   cheat_search_t *search = global->cheat_search;
+
+   if (!search)
+      return -1;
+
+   switch (menu_hash_calculate(label))
+   {
+      case MENU_LABEL_CHEAT_SEARCH_START:
+         ret = cheat_search_start(search, cheat_search_get_type(search));
+         break;
+      case MENU_LABEL_CHEAT_SEARCH_EQ:
+         ret = cheat_search_filter(search, CHEAT_SEARCH_CMP_EQ, false, 0);
+         break;
+      case MENU_LABEL_CHEAT_SEARCH_NEQ:
+         ret = cheat_search_filter(search, CHEAT_SEARCH_CMP_NEQ, false, 0);
+         break;
+      case MENU_LABEL_CHEAT_SEARCH_GT:
+         ret = cheat_search_filter(search, CHEAT_SEARCH_CMP_GT, false, 0);
+         break;
+      case MENU_LABEL_CHEAT_SEARCH_LT:
+         ret = cheat_search_filter(search, CHEAT_SEARCH_CMP_LT, false, 0);
+         break;
+   }
+
+   if (!ret)
+      return -1;
+
+   snprintf(msg, sizeof(msg), "Cheat search: %u results.",
+         (unsigned)cheat_search_count(search));
+   rarch_main_msg_queue_push(msg, 1, 180, true);
+   menu_entries_set_refresh();
+
+   return 0;
+}
 
 static int action_ok_shader_pass_load(const char *path,
       const char *label, unsigned type, size_t idx, size_t entry_idx)
@@ -1267,6 +1307,13 @@ static int menu_cbs_init_bind_ok_compare_label(menu_file_list_cbs_t *cbs,
       case MENU_LABEL_CHEAT_APPLY_CHANGES:
          cbs->action_ok = action_ok_cheat_apply_changes;
          break;
+      case MENU_LABEL_CHEAT_SEARCH_START:
+      case MENU_LABEL_CHEAT_SEARCH_EQ:
+      case MENU_LABEL_CHEAT_SEARCH_NEQ:
+      case MENU_LABEL_CHEAT_SEARCH_GT:
+      case MENU_LABEL_CHEAT_SEARCH_LT:
+         cbs->action_ok = action_ok_cheat_search;
+         break;
       case MENU_LABEL_VIDEO_SHADER_PRESET_SAVE_AS:
          cbs->action_ok = action_ok_shader_preset_save_as;
          break;
@@ -342,6 +342,22 @@ static int action_right_cheat_num_passes(unsigned type, const char *label,
    return 0;
 }
 
+static int action_right_cheat_search_type(unsigned type, const char *label,
+      bool wraparound)
+{
+   global_t *global = global_get_ptr();
+   unsigned current = cheat_search_get_type(global->cheat_search);
+
+   if (!global->cheat_search)
+      return -1;
+
+   cheat_search_set_type(global->cheat_search, (enum cheat_search_type)
+         ((current + 1) % CHEAT_SEARCH_TYPE_LAST));
+   menu_entries_set_refresh();
+
+   return 0;
+}
+
 static int action_right_shader_num_passes(unsigned type, const char *label,
       bool wraparound)
 {
@@ -657,6 +673,9 @@ static int menu_cbs_init_bind_right_compare_label(menu_file_list_cbs_t *cbs,
       case MENU_LABEL_CHEAT_NUM_PASSES:
          cbs->action_right = action_right_cheat_num_passes;
          break;
+      case MENU_LABEL_CHEAT_SEARCH_TYPE:
+         cbs->action_right = action_right_cheat_search_type;
+         break;
       case MENU_LABEL_INFO:
          cbs->action_right = action_right_scroll;
          break;
@@ -49,6 +49,13 @@
 
 #define NUM_PARTICLES 256
 
+/* Damage tracking limits, sized for the fixed
+ * RENDER_WIDTH x RENDER_HEIGHT layout. */
+#define RGUI_MAX_ROWS     32
+#define RGUI_MAX_SEGMENTS 4
+#define RGUI_SEGMENT_LEN  64
+#define RGUI_MAX_DAMAGE   8
+
 /* A 'particle' is just 4 float variables that can
  * be used for any purpose - e.g.:
  * > a = x pos
@@ -72,6 +79,33 @@ typedef struct
    uint16_t data[RENDER_WIDTH * RENDER_HEIGHT];
 } wallpaper_t;
 
+/* One blit_line() call, queued so it can be compared
+ * with what the same row showed last time. */
+typedef struct
+{
+   char text[RGUI_SEGMENT_LEN];
+   unsigned len;
+   int x;
+   int offset;
+   uint16_t color;
+} rgui_segment_t;
+
+/* All text drawn at one y position. */
+typedef struct
+{
+   int y;
+   unsigned count;
+   rgui_segment_t segments[RGUI_MAX_SEGMENTS];
+} rgui_row_t;
+
+typedef struct
+{
+   unsigned x;
+   unsigned y;
+   unsigned width;
+   unsigned height;
+} rgui_rect_t;
+
 struct enum_lut rgui_particle_effect_lut[NUM_RGUI_PARTICLE_EFFECTS] = {
    { "OFF", RGUI_PARTICLE_EFFECT_NONE },
    { "Snow (Light)", RGUI_PARTICLE_EFFECT_SNOW },
@@ -113,6 +147,17 @@ static unsigned particle_effect;
 static rgui_particle_t particles[NUM_PARTICLES] = {{ 0.0f }};
 static float particle_effect_speed;
 
+/* Rows of the previous and the current render. */
+static rgui_row_t rgui_rows[2][RGUI_MAX_ROWS];
+static unsigned rgui_row_count[2];
+static unsigned rgui_row_set;
+/* Repaint everything on the next render. */
+static bool rgui_full_redraw = true;
+/* Regions of the framebuffer not uploaded yet. */
+static rgui_rect_t rgui_damage[RGUI_MAX_DAMAGE];
+static unsigned rgui_damage_count;
+static bool rgui_damage_full = true;
+
 static INLINE uint16_t argb32_to_rgba4444(uint32_t col)
 {
    unsigned a = ((col >> 24) & 0xff) >> 4;
@@ -660,6 +705,8 @@ static INLINE void rgui_check_update(settings_t *settings,
       particle_effect_speed = settings->menu.rgui_particle_effect_speed_factor;
 
       global->menu.theme_update_flag = false;
+      rgui_full_redraw = true;
+      menu_display_fb_set_dirty();
    }
 }
 
@@ -856,6 +903,312 @@ static void rgui_render_background(void)
    }
 }
 
+/**
+ * rgui_damage_add:
+ * @frame_buf                 : Menu framebuffer.
+ * @x                         : Left edge, may be off screen.
+ * @y                         : Top edge, may be off screen.
+ * @width                     : Width of the region.
+ * @height                    : Height of the region.
+ *
+ * Marks a region of the framebuffer as changed so that
+ * rgui_set_texture() uploads it. Regions sharing rows are
+ * merged.
+ **/
+static void rgui_damage_add(menu_framebuf_t *frame_buf,
+      int x, int y, int width, int height)
+{
+   unsigned i;
+   rgui_rect_t rect;
+   int right  = min(x + width, (int)frame_buf->width);
+   int bottom = min(y + height, (int)frame_buf->height);
+
+   x = max(x, 0);
+   y = max(y, 0);
+
+   if (rgui_damage_full || right <= x || bottom <= y)
+      return;
+
+   rect.x      = x;
+   rect.y      = y;
+   rect.width  = right - x;
+   rect.height = bottom - y;
+
+   if (rgui_damage_count == RGUI_MAX_DAMAGE)
+   {
+      for (i = 1; i < rgui_damage_count; i++)
+      {
+         rgui_rect_t *first = &rgui_damage[0];
+         unsigned r = max(first->x + first->width,
+               rgui_damage[i].x + rgui_damage[i].width);
+         unsigned b = max(first->y + first->height,
+               rgui_damage[i].y + rgui_damage[i].height);
+
+         first->x      = min(first->x, rgui_damage[i].x);
+         first->y      = min(first->y, rgui_damage[i].y);
+         first->width  = r - first->x;
+         first->height = b - first->y;
+      }
+      rgui_damage_count = 1;
+   }
+
+   for (i = 0; i < rgui_damage_count; i++)
+   {
+      rgui_rect_t *cur = &rgui_damage[i];
+      unsigned r, b;
+
+      if (rect.y > cur->y + cur->height || cur->y > rect.y + rect.height)
+         continue;
+
+      r = max(cur->x + cur->width, rect.x + rect.width);
+      b = max(cur->y + cur->height, rect.y + rect.height);
+      cur->x      = min(cur->x, rect.x);
+      cur->y      = min(cur->y, rect.y);
+      cur->width  = r - cur->x;
+      cur->height = b - cur->y;
+      return;
+   }
+
+   rgui_damage[rgui_damage_count++] = rect;
+}
+
+static void rgui_damage_set_full(void)
+{
+   rgui_damage_full  = true;
+   rgui_damage_count = 0;
+}
+
+/**
+ * rgui_queue_line:
+ *
+ * Same arguments as blit_line(). Records the line for the
+ * row at @y instead of drawing it; rgui_flush_rows() draws
+ * the rows that changed.
+ **/
+static void rgui_queue_line(const char *message, unsigned message_len,
+      int x, int y, int x_offset, uint16_t color)
+{
+   unsigned i;
+   size_t len;
+   rgui_segment_t *segment = NULL;
+   rgui_row_t *rows        = rgui_rows[rgui_row_set];
+   unsigned *count         = &rgui_row_count[rgui_row_set];
+   rgui_row_t *row         = NULL;
+
+   for (i = 0; i < *count; i++)
+   {
+      if (rows[i].y == y)
+      {
+         row = &rows[i];
+         break;
+      }
+   }
+
+   if (!row)
+   {
+      if (*count == RGUI_MAX_ROWS)
+         return;
+      row = &rows[(*count)++];
+      memset(row, 0, sizeof(*row));
+      row->y = y;
+   }
+
+   if (row->count == RGUI_MAX_SEGMENTS)
+      return;
+
+   /* blit_line() clips to message_len glyphs and the ticker
+    * offset is under one glyph, so later characters never
+    * show up on screen. */
+   len = min(strlen(message), (size_t)message_len + 2);
+   len = min(len, (size_t)RGUI_SEGMENT_LEN - 1);
+
+   segment         = &row->segments[row->count++];
+   memcpy(segment->text, message, len);
+   segment->len    = message_len;
+   segment->x      = x;
+   segment->offset = x_offset;
+   segment->color  = color;
+}
+
+static void rgui_draw_row(const rgui_row_t *row)
+{
+   unsigned i;
+
+   for (i = 0; i < row->count; i++)
+   {
+      const rgui_segment_t *segment = &row->segments[i];
+      blit_line(segment->text, segment->len, segment->x, row->y,
+            segment->offset, segment->color);
+   }
+}
+
+/* Horizontal span blit_line() may touch for @row. */
+static void rgui_row_extent(const rgui_row_t *row, int *left, int *right)
+{
+   unsigned i;
+
+   for (i = 0; i < row->count; i++)
+   {
+      const rgui_segment_t *segment = &row->segments[i];
+      *left  = min(*left, segment->x);
+      *right = max(*right, segment->x +
+            (int)(segment->len * FONT_WIDTH_STRIDE) + 1);
+   }
+}
+
+static const rgui_row_t *rgui_find_row(const rgui_row_t *rows,
+      unsigned count, int y)
+{
+   unsigned i;
+
+   for (i = 0; i < count; i++)
+   {
+      if (rows[i].y == y)
+         return &rows[i];
+   }
+
+   return NULL;
+}
+
+static void rgui_restore_background(menu_framebuf_t *frame_buf,
+      const rgui_rect_t *rect)
+{
+   unsigned j;
+   size_t pitch_in_pixels = frame_buf->pitch >> 1;
+
+   for (j = rect->y; j < rect->y + rect->height; j++)
+   {
+      /* The checkered pattern repeats every 4 lines and is
+       * cached below the visible framebuffer. */
+      const uint16_t *src = rgui_wallpaper_valid ?
+         rgui_wallpaper.data + j * RENDER_WIDTH :
+         frame_buf->data + (frame_buf->height + (j & 3)) * pitch_in_pixels;
+
+      memcpy(frame_buf->data + j * pitch_in_pixels + rect->x,
+            src + rect->x, rect->width * sizeof(uint16_t));
+   }
+}
+
+/**
+ * rgui_changed_rows:
+ * @frame_buf                 : Menu framebuffer.
+ * @bands                     : Regions to repaint.
+ * @y                         : Row of each region.
+ *
+ * Compares the rows queued for this render with the
+ * previous ones.
+ *
+ * Returns: number of regions, or -1 if they can't be
+ * repainted on their own.
+ **/
+static int rgui_changed_rows(menu_framebuf_t *frame_buf,
+      rgui_rect_t *bands, int *y)
+{
+   unsigned i, j, count = 0;
+   const rgui_row_t *rows = rgui_rows[rgui_row_set];
+   const rgui_row_t *prev = rgui_rows[!rgui_row_set];
+   unsigned rows_count    = rgui_row_count[rgui_row_set];
+   unsigned prev_count    = rgui_row_count[!rgui_row_set];
+   /* Text never covers the pattern border. */
+   int border             = rgui_wallpaper_valid ? 0 : 10;
+
+   for (i = 0; i < rows_count + prev_count; i++)
+   {
+      int left              = INT_MAX;
+      int right             = INT_MIN;
+      const rgui_row_t *cur = NULL;
+      const rgui_row_t *old = NULL;
+
+      if (i < rows_count)
+      {
+         cur = &rows[i];
+         old = rgui_find_row(prev, prev_count, cur->y);
+         if (old && !memcmp(cur, old, sizeof(*cur)))
+            continue;
+      }
+      else
+      {
+         old = &prev[i - rows_count];
+         if (rgui_find_row(rows, rows_count, old->y))
+            continue;
+      }
+
+      if (cur)
+         rgui_row_extent(cur, &left, &right);
+      if (old)
+         rgui_row_extent(old, &left, &right);
+
+      y[count] = cur ? cur->y : old->y;
+
+      if (left >= right)
+         continue;
+
+      if (left < border || right > (int)frame_buf->width - border
+            || y[count] < border
+            || y[count] + FONT_HEIGHT > (int)frame_buf->height - border)
+         return -1;
+
+      /* Repainting a row must not wipe a neighbouring one. */
+      for (j = 0; j < rows_count; j++)
+      {
+         if (rows[j].y != y[count]
+               && abs(rows[j].y - y[count]) < FONT_HEIGHT)
+            return -1;
+      }
+
+      bands[count].x      = left;
+      bands[count].y      = y[count];
+      bands[count].width  = right - left;
+      bands[count].height = FONT_HEIGHT;
+      count++;
+   }
+
+   return count;
+}
+
+/**
+ * rgui_flush_rows:
+ * @frame_buf                 : Menu framebuffer.
+ *
+ * Draws the rows queued with rgui_queue_line(). Only rows
+ * that differ from the previous render are repainted,
+ * unless the whole menu has to be redrawn.
+ **/
+static void rgui_flush_rows(menu_framebuf_t *frame_buf)
+{
+   int i, count = -1;
+   rgui_rect_t bands[RGUI_MAX_ROWS * 2];
+   int y[RGUI_MAX_ROWS * 2];
+   const rgui_row_t *rows = rgui_rows[rgui_row_set];
+   unsigned rows_count    = rgui_row_count[rgui_row_set];
+
+   if (!rgui_full_redraw && particle_effect == RGUI_PARTICLE_EFFECT_NONE)
+      count = rgui_changed_rows(frame_buf, bands, y);
+
+   if (count < 0)
+   {
+      rgui_render_background();
+      for (i = 0; i < (int)rows_count; i++)
+         rgui_draw_row(&rows[i]);
+      rgui_damage_set_full();
+   }
+   else
+   {
+      for (i = 0; i < count; i++)
+      {
+         const rgui_row_t *row = rgui_find_row(rows, rows_count, y[i]);
+
+         rgui_restore_background(frame_buf, &bands[i]);
+         if (row)
+            rgui_draw_row(row);
+         rgui_damage_add(frame_buf, bands[i].x, bands[i].y,
+               bands[i].width, bands[i].height);
+      }
+   }
+
+   rgui_full_redraw = false;
+}
+
 static void rgui_render_messagebox(const char *message)
 {
    size_t i, num_lines;
@@ -917,6 +1270,10 @@ static void rgui_render_messagebox(const char *message)
    fill_rect(frame_buf, x, y + 5, 5,
          height - 5, rgui_border_filler);
 
+   /* The box covers rows that don't know about it. */
+   rgui_damage_add(frame_buf, x, y, width, height);
+   rgui_full_redraw = true;
+
    for (i = 0; i < num_lines; i++)
    {
       const char *msg = list->elems[i].data;
@@ -940,6 +1297,9 @@ static void rgui_blit_cursor(menu_handle_t *menu)
 
    color_rect(menu, x, y - 5, 1, 11, 0xFFFF);
    color_rect(menu, x - 5, y, 11, 1, 0xFFFF);
+
+   rgui_damage_add(menu_display_fb_get_ptr(), x - 5, y - 5, 11, 11);
+   rgui_full_redraw = true;
 }
 
 static void rgui_render(void)
@@ -1019,7 +1379,8 @@ static void rgui_render(void)
    end = ((menu_entries_get_start() + RGUI_TERM_HEIGHT) <= (menu_entries_get_end())) ?
       menu_entries_get_start() + RGUI_TERM_HEIGHT : menu_entries_get_end();
 
-   rgui_render_background();
+   rgui_row_set = !rgui_row_set;
+   rgui_row_count[rgui_row_set] = 0;
 
    menu_entries_get_title(title, sizeof(title));
 
@@ -1028,10 +1389,10 @@ static void rgui_render(void)
          frame_count, title, true);
 
    if (menu_entries_show_back())
-      blit_line("BACK", 4, RGUI_TERM_START_X, RGUI_TERM_START_X,
+      rgui_queue_line("BACK", 4, RGUI_TERM_START_X, RGUI_TERM_START_X,
             0, rgui_title_16b);
 
-   blit_line(title_buf, title_w,
+   rgui_queue_line(title_buf, title_w,
          RGUI_TERM_START_X + (RGUI_TERM_WIDTH - strlen(title_buf)) * FONT_WIDTH_STRIDE / 2,
          RGUI_TERM_START_X,
          FONT_WIDTH_STRIDE * offset, rgui_title_16b);
@@ -1039,7 +1400,7 @@ static void rgui_render(void)
    if (settings->menu.core_enable)
    {
       menu_entries_get_core_title(title_msg, sizeof(title_msg));
-      blit_line(title_msg, 42,
+      rgui_queue_line(title_msg, 42,
             RGUI_TERM_START_X,
             (RGUI_TERM_HEIGHT * FONT_HEIGHT_STRIDE) + RGUI_TERM_START_Y + 2,
             0, rgui_hover_16b);
@@ -1048,7 +1409,7 @@ static void rgui_render(void)
    if (settings->menu.timedate_enable)
    {
       menu_display_timedate(timedate, sizeof(timedate), 3);
-      blit_line(timedate, 5,
+      rgui_queue_line(timedate, 5,
             RGUI_TERM_WIDTH * FONT_WIDTH_STRIDE - RGUI_TERM_START_X,
             (RGUI_TERM_HEIGHT * FONT_HEIGHT_STRIDE) + RGUI_TERM_START_Y + 2,
             0, rgui_hover_16b);
@@ -1082,7 +1443,7 @@ static void rgui_render(void)
       if (entry_selected)
       {
          color = rgui_hover_16b;
-         blit_line(">", 1, RGUI_TERM_START_X, y, 0, color);
+         rgui_queue_line(">", 1, RGUI_TERM_START_X, y, 0, color);
       }
       else
          color = rgui_normal_16b;
@@ -1095,7 +1456,7 @@ static void rgui_render(void)
       snprintf(message, sizeof(message), "%-*.*s",
             title_w, title_w, entry_title_buf);
 
-      blit_line(message, title_w, title_x, y,
+      rgui_queue_line(message, title_w, title_x, y,
             FONT_WIDTH_STRIDE * offset, color);
 
       /* entry value */
@@ -1105,11 +1466,13 @@ static void rgui_render(void)
       snprintf(message, sizeof(message), "%-*s",
             entry_spacing, type_str_buf);
 
-      blit_line(message, entry_spacing,
+      rgui_queue_line(message, entry_spacing,
             title_x + FONT_WIDTH_STRIDE * (title_w + 1), y,
             FONT_WIDTH_STRIDE * offset, color);
    }
 
+   rgui_flush_rows(frame_buf);
+
 #ifdef GEKKO
    const char *message_queue;
 
@@ -1167,6 +1530,11 @@ static void *rgui_init(void)
 
    menu_entries_set_start(0);
 
+   rgui_row_count[0] = 0;
+   rgui_row_count[1] = 0;
+   rgui_full_redraw  = true;
+   rgui_damage_set_full();
+
    ret = rguidisp_init_font(menu);
 
    if (!ret)
@@ -1229,6 +1597,7 @@ static void rgui_free(void *data)
 
 static void rgui_set_texture(void)
 {
+   unsigned i;
    global_t* global = global_get_ptr();
    menu_handle_t *menu = menu_driver_get_ptr();
    menu_framebuf_t *frame_buf = menu_display_fb_get_ptr();
@@ -1240,12 +1609,44 @@ static void rgui_set_texture(void)
        && particle_effect == RGUI_PARTICLE_EFFECT_NONE)
       menu_display_fb_unset_dirty();
 
-   video_driver_set_texture_frame(
-         frame_buf->data,
-         false,
-         frame_buf->width,
-         frame_buf->height,
-         1.0f);
+   /* The driver keeps the last texture, only send what changed. */
+   if (rgui_damage_full)
+      video_driver_set_texture_frame(
+            frame_buf->data,
+            false,
+            frame_buf->width,
+            frame_buf->height,
+            1.0f);
+   else
+   {
+      for (i = 0; i < rgui_damage_count; i++)
+         video_driver_set_texture_frame_rect(
+               frame_buf->data,
+               false,
+               frame_buf->width,
+               frame_buf->height,
+               rgui_damage[i].x,
+               rgui_damage[i].y,
+               rgui_damage[i].width,
+               rgui_damage[i].height,
+               1.0f);
+   }
+
+   rgui_damage_full  = false;
+   rgui_damage_count = 0;
+}
+
+static void rgui_context_reset(void)
+{
+   /* A new video driver has no menu texture yet. */
+   rgui_damage_set_full();
+}
+
+static void rgui_toggle(bool menu_on)
+{
+   /* Some drivers drop the menu texture while it is hidden. */
+   if (menu_on)
+      rgui_damage_set_full();
 }
 
 static void rgui_navigation_clear(bool pending_push)
@@ -1332,6 +1733,7 @@ static void process_wallpaper(struct texture_image *image)
 
    rgui_adjust_wallpaper_alpha();
    rgui_wallpaper_valid = true;
+   rgui_full_redraw = true;
    menu_display_fb_set_dirty();
    menu_entries_set_refresh();
 }
@@ -1363,10 +1765,10 @@ menu_ctx_driver_t menu_ctx_rgui = {
    NULL,
    rgui_init,
    rgui_free,
-   NULL,
+   rgui_context_reset,
    NULL,
    rgui_populate_entries,
-   NULL,
+   rgui_toggle,
    rgui_navigation_clear,
    NULL,
    NULL,
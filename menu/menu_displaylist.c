@@ -174,7 +174,7 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info)
    global_t *global          = global_get_ptr();
    core_info_t *core_info    = global ? (core_info_t*)global->core_info_current : NULL;
 
-   if (!core_info || !core_info->data)
+   if (!core_info || !core_info->has_info)
    {
       menu_list_push(info->list,
             menu_hash_to_str(MENU_LABEL_VALUE_NO_CORE_INFORMATION_AVAILABLE),
@@ -850,6 +850,51 @@ static int menu_displaylist_parse_settings(menu_handle_t *menu,
    return 0;
 }
 
+static void menu_displaylist_parse_cheat_search(
+      menu_displaylist_info_t *info)
+{
+   size_t i, count;
+   struct cheat_search_result results[16];
+   global_t *global = global_get_ptr();
+
+   if (!global->cheat_search)
+      global->cheat_search = cheat_search_new();
+   if (!global->cheat_search)
+      return;
+
+   menu_list_push(info->list, "Cheat Search Type",
+         "cheat_search_type", 0, 0, 0);
+   menu_list_push(info->list, "Start Cheat Search",
+         "cheat_search_start", MENU_SETTING_ACTION, 0, 0);
+
+   if (!cheat_search_active(global->cheat_search))
+      return;
+
+   menu_list_push(info->list, "Search: Equal",
+         "cheat_search_eq", MENU_SETTING_ACTION, 0, 0);
+   menu_list_push(info->list, "Search: Not Equal",
+         "cheat_search_neq", MENU_SETTING_ACTION, 0, 0);
+   menu_list_push(info->list, "Search: Greater",
+         "cheat_search_gt", MENU_SETTING_ACTION, 0, 0);
+   menu_list_push(info->list, "Search: Less",
+         "cheat_search_lt", MENU_SETTING_ACTION, 0, 0);
+   menu_list_push(info->list, "Search Results",
+         "cheat_search_count", 0, 0, 0);
+
+   count = cheat_search_results(global->cheat_search, 0,
+         results, ARRAY_SIZE(results));
+
+   for (i = 0; i < count; i++)
+   {
+      char result_label[64] = {0};
+
+      snprintf(result_label, sizeof(result_label),
+            "0x%06X: %u (was %u)", (unsigned)results[i].address,
+            (unsigned)results[i].value, (unsigned)results[i].prev);
+      menu_list_push(info->list, result_label, "", 0, 0, 0);
+   }
+}
+
 static int menu_displaylist_parse_options_cheats(menu_displaylist_info_t *info)
 {
    unsigned i;
@@ -882,6 +927,9 @@ static int menu_displaylist_parse_options_cheats(menu_displaylist_info_t *info)
          "cheat_apply_changes",
          MENU_SETTING_ACTION, 0, 0);
 
+   if (global->main_is_init)
+      menu_displaylist_parse_cheat_search(info);
+
    for (i = 0; i < cheat->size; i++)
    {
       char cheat_label[64] = {0};
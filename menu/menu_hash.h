@@ -366,6 +366,13 @@ extern "C" {
 #define MENU_LABEL_VALUE_SAVE_NEW_CONFIG                                       0xd49f2c94U
 #define MENU_LABEL_ONSCREEN_DISPLAY_SETTINGS                                   0x67571029U
 #define MENU_LABEL_CHEAT_APPLY_CHANGES                                         0xde88aa27U
+#define MENU_LABEL_CHEAT_SEARCH_TYPE                                           0xce985340U
+#define MENU_LABEL_CHEAT_SEARCH_START                                          0xa18da72cU
+#define MENU_LABEL_CHEAT_SEARCH_EQ                                             0x60562bb4U
+#define MENU_LABEL_CHEAT_SEARCH_NEQ                                            0x6b1bc762U
+#define MENU_LABEL_CHEAT_SEARCH_GT                                             0x60562bf9U
+#define MENU_LABEL_CHEAT_SEARCH_LT                                             0x60562c9eU
+#define MENU_LABEL_CHEAT_SEARCH_COUNT                                          0xa069b5c7U
 #define MENU_LABEL_CUSTOM_BIND                                                 0x1e84b3fcU
 #define MENU_LABEL_CUSTOM_BIND_ALL                                             0x79ac14f4U
 #define MENU_LABEL_CUSTOM_BIND_DEFAULTS                                        0xe88f7b13U
@@ -1736,6 +1736,27 @@ static void setting_get_string_representation_millisec(void *data,
    }
 }
 
+static void setting_get_string_representation_frame_delay(void *data,
+      char *s, size_t len)
+{
+   settings_t *settings     = config_get_ptr();
+   runloop_t *runloop       = rarch_main_get_ptr();
+   rarch_setting_t *setting = (rarch_setting_t*)data;
+
+   if (!setting)
+      return;
+
+   if (!settings->video.frame_delay_auto)
+   {
+      setting_get_string_representation_millisec(data, s, len);
+      return;
+   }
+
+   snprintf(s, len, "Auto: %.1f ms (%u overruns)",
+         runloop->frames.delay.current / 1000.0,
+         runloop->frames.delay.overruns);
+}
+
 static void setting_get_string_representation_preemptive_frames(void *data,
       char *s, size_t len)
 {
@@ -4658,6 +4679,19 @@ static bool setting_append_list_frame_throttling_options(
       menu_settings_list_current_add_range(list, list_info, 1, 10, 1.0, true, true);
    }
 
+   CONFIG_UINT(
+         settings->frame_throttle_spin,
+         "frame_throttle_spin",
+         "Throttle Spin Margin (us)",
+         frame_throttle_spin,
+         group_info.name,
+         subgroup_info.name,
+         parent_group,
+         general_write_handler,
+         general_read_handler);
+   menu_settings_list_current_add_range(list, list_info, 0, 10000, 100, true, true);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
    END_SUB_GROUP(list, list_info, parent_group);
    END_GROUP(list, list_info, parent_group);
 
@@ -5257,6 +5291,21 @@ static bool setting_append_list_video_options(
       &setting_get_string_representation_uint_scope_index;
    settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 #endif
+
+   CONFIG_BOOL(
+         settings->video.pbo_upload,
+         "video_pbo_upload",
+         "PBO Frame Upload",
+         video_pbo_upload,
+         menu_hash_to_str(MENU_VALUE_OFF),
+         menu_hash_to_str(MENU_VALUE_ON),
+         group_info.name,
+         subgroup_info.name,
+         parent_group,
+         general_write_handler,
+         general_read_handler);
+   menu_settings_list_current_add_cmd(list, list_info, EVENT_CMD_REINIT);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
    
    END_SUB_GROUP(list, list_info, parent_group);
    
@@ -5927,7 +5976,20 @@ static bool setting_append_list_latency_options(
             general_read_handler);
       menu_settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
       (*list)[list_info->index - 1].get_string_representation = 
-         &setting_get_string_representation_millisec;
+         &setting_get_string_representation_frame_delay;
+
+      CONFIG_BOOL(
+            settings->video.frame_delay_auto,
+            "video_frame_delay_auto",
+            "  Automatic",
+            frame_delay_auto,
+            menu_hash_to_str(MENU_VALUE_OFF),
+            menu_hash_to_str(MENU_VALUE_ON),
+            group_info.name,
+            subgroup_info.name,
+            parent_group,
+            general_write_handler,
+            general_read_handler);
 
       CONFIG_UINT(
             settings->video.frame_delay_scope,
@@ -8153,6 +8215,19 @@ CONFIG_DIR(
          list_info,
          SD_FLAG_ALLOW_EMPTY | SD_FLAG_PATH_DIR | SD_FLAG_BROWSER_ACTION);
    settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
+   CONFIG_UINT(
+         settings->extraction_cache_size,
+         "extraction_cache_size",
+         "Extraction Cache Size (MB)",
+         extraction_cache_size,
+         group_info.name,
+         subgroup_info.name,
+         parent_group,
+         general_write_handler,
+         general_read_handler);
+   menu_settings_list_current_add_range(list, list_info, 0, 65536, 256, true, false);
+   settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
    
    CONFIG_DIR(
          settings->menu.theme_dir,
@@ -0,0 +1,1134 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Input log format. All values are little endian.
+ *
+ * Header:
+ *    char     magic[4]   "RAMV"
+ *    uint32_t version
+ *    uint32_t ports
+ *    uint32_t content_crc
+ *
+ * Followed by records, one tag byte each:
+ *    MOVIE_TAG_FRAME       state of every port:
+ *                          uint16_t buttons, int16_t analog[4]
+ *    MOVIE_TAG_DELTA       uint16_t mask of changed ports, then for
+ *                          each of them a uint8_t mask of changed
+ *                          fields followed by those fields.
+ *    MOVIE_TAG_REPEAT      uint32_t count: the previous frame
+ *                          repeats @count more times.
+ *    MOVIE_TAG_CHECKPOINT  uint64_t frame, uint8_t keyframe,
+ *                          uint32_t state size, uint32_t encoded size,
+ *                          encoded savestate. The next frame record
+ *                          is always a full frame.
+ *    MOVIE_TAG_INDEX       uint32_t count, then per checkpoint
+ *                          uint64_t frame, uint64_t offset, uint8_t keyframe.
+ *
+ * The file ends with a uint64_t offset of the index record and
+ * MOVIE_INDEX_MAGIC, so playback can seek without scanning the
+ * log. Logs cut short by a crash have no index and are scanned.
+ *
+ * Savestates are encoded against the previous checkpoint, or against
+ * zeros for keyframes, as alternating runs of unchanged and changed
+ * bytes. Most of a savestate is unchanged between checkpoints, which
+ * keeps hour-long logs small. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_endianness.h>
+
+#include "movie.h"
+#include "dynamic.h"
+#include "general.h"
+#include "runloop.h"
+#include "retroarch_logger.h"
+
+#define MOVIE_MAGIC       "RAMV"
+#define MOVIE_INDEX_MAGIC "RAMI"
+#define MOVIE_VERSION     2
+
+#define MOVIE_TAG_FRAME      'F'
+#define MOVIE_TAG_DELTA      'D'
+#define MOVIE_TAG_REPEAT     'R'
+#define MOVIE_TAG_CHECKPOINT 'C'
+#define MOVIE_TAG_INDEX      'I'
+
+/* Left X, left Y, right X, right Y. */
+#define MOVIE_ANALOGS   4
+
+/* Every Nth checkpoint is encoded on its own, which bounds
+ * how many checkpoints a seek has to decode. */
+#define MOVIE_KEYFRAME_INTERVAL 8
+
+/* Shorter runs of unchanged bytes are kept inside
+ * a literal run; a new run costs more than they save. */
+#define MOVIE_MIN_SKIP 8
+
+struct movie_port
+{
+   uint16_t buttons;
+   int16_t analog[MOVIE_ANALOGS];
+};
+
+struct movie_checkpoint
+{
+   uint64_t frame;
+   uint64_t offset;
+   bool keyframe;
+};
+
+struct movie
+{
+   FILE *file;
+   enum movie_mode mode;
+   unsigned version;
+   unsigned ports;
+
+   struct movie_port state[MAX_USERS];
+   bool has_state;
+
+   /* Frames left to repeat (playback) or not yet
+    * written (recording) for the current state. */
+   uint32_t repeat;
+
+   /* Number of polls so far. */
+   uint64_t frame;
+   bool end;
+
+   unsigned interval;
+   uint64_t next_checkpoint;
+   unsigned since_keyframe;
+
+   /* Last checkpoint, and scratch space to serialize
+    * and encode the next one. */
+   size_t state_size;
+   uint8_t *state_buf;
+   uint8_t *prev_buf;
+   uint8_t *enc_buf;
+
+   struct movie_checkpoint *checkpoints;
+   size_t num_checkpoints;
+   size_t cap_checkpoints;
+
+   bool seek_pending;
+   bool seeking;
+   uint64_t seek_target;
+};
+
+static bool movie_write_u32(FILE *file, uint32_t val)
+{
+   val = swap_if_big32(val);
+   return fwrite(&val, sizeof(val), 1, file) == 1;
+}
+
+static bool movie_read_u32(FILE *file, uint32_t *val)
+{
+   if (fread(val, sizeof(*val), 1, file) != 1)
+      return false;
+   *val = swap_if_big32(*val);
+   return true;
+}
+
+static bool movie_write_u64(FILE *file, uint64_t val)
+{
+   return movie_write_u32(file, (uint32_t)val)
+      && movie_write_u32(file, (uint32_t)(val >> 32));
+}
+
+static bool movie_read_u64(FILE *file, uint64_t *val)
+{
+   uint32_t lo, hi;
+
+   if (!movie_read_u32(file, &lo) || !movie_read_u32(file, &hi))
+      return false;
+   *val = ((uint64_t)hi << 32) | lo;
+   return true;
+}
+
+static void movie_write_u16(FILE *file, uint16_t val)
+{
+   val = swap_if_big16(val);
+   fwrite(&val, sizeof(val), 1, file);
+}
+
+static bool movie_read_u16(FILE *file, uint16_t *val)
+{
+   if (fread(val, sizeof(*val), 1, file) != 1)
+      return false;
+   *val = swap_if_big16(*val);
+   return true;
+}
+
+static size_t movie_put_varint(uint8_t *out, size_t val)
+{
+   size_t len = 0;
+
+   while (val >= 0x80)
+   {
+      out[len++] = (uint8_t)(val | 0x80);
+      val >>= 7;
+   }
+   out[len++] = (uint8_t)val;
+   return len;
+}
+
+static bool movie_get_varint(const uint8_t **in, const uint8_t *end,
+      size_t *val)
+{
+   unsigned shift = 0;
+
+   *val = 0;
+
+   while (*in < end && shift < sizeof(size_t) * 8)
+   {
+      uint8_t byte = *(*in)++;
+
+      *val |= (size_t)(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+         return true;
+      shift += 7;
+   }
+
+   return false;
+}
+
+/**
+ * movie_encode_state:
+ * @out                  : output buffer, at least
+ *                         movie_encode_bound(@size) bytes.
+ * @in                   : savestate to encode.
+ * @prev                 : savestate to encode against.
+ * @size                 : size of both savestates.
+ *
+ * Returns: size of the encoded savestate.
+ **/
+static size_t movie_encode_state(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, size_t size)
+{
+   size_t i = 0, len = 0;
+
+   while (i < size)
+   {
+      size_t skip = 0, literal = 0;
+
+      while (i < size && in[i] == prev[i])
+      {
+         skip++;
+         i++;
+      }
+
+      literal = i;
+
+      while (i < size)
+      {
+         size_t same = i;
+
+         while (same < size && same - i < MOVIE_MIN_SKIP
+               && in[same] == prev[same])
+            same++;
+
+         if (same == size || same - i >= MOVIE_MIN_SKIP)
+            break;
+
+         i = (same == i) ? i + 1 : same;
+      }
+
+      len += movie_put_varint(out + len, skip);
+      len += movie_put_varint(out + len, i - literal);
+      memcpy(out + len, in + literal, i - literal);
+      len += i - literal;
+   }
+
+   return len;
+}
+
+static size_t movie_encode_bound(size_t size)
+{
+   /* Every run but the first skips at least MOVIE_MIN_SKIP bytes,
+    * and the two varints of a run take at most 20 bytes. */
+   return size + (size / MOVIE_MIN_SKIP + 1) * 20;
+}
+
+/**
+ * movie_decode_state:
+ * @state                : previous savestate, updated in place.
+ * @size                 : size of @state.
+ * @in                   : encoded savestate.
+ * @len                  : size of @in.
+ *
+ * Returns: true if @in was valid for a savestate of @size.
+ **/
+static bool movie_decode_state(uint8_t *state, size_t size,
+      const uint8_t *in, size_t len)
+{
+   size_t pos         = 0;
+   const uint8_t *end = in + len;
+
+   while (in < end)
+   {
+      size_t skip, literal;
+
+      if (!movie_get_varint(&in, end, &skip)
+            || !movie_get_varint(&in, end, &literal))
+         return false;
+
+      if (skip > size - pos || literal > size - pos - skip
+            || literal > (size_t)(end - in))
+         return false;
+
+      pos += skip;
+      memcpy(state + pos, in, literal);
+      pos += literal;
+      in  += literal;
+   }
+
+   return pos == size;
+}
+
+static bool movie_alloc_state(movie_t *handle, size_t size)
+{
+   if (size == handle->state_size)
+      return true;
+
+   free(handle->state_buf);
+   free(handle->prev_buf);
+   free(handle->enc_buf);
+
+   handle->state_size = size;
+   handle->state_buf  = (uint8_t*)malloc(size);
+   handle->prev_buf   = (uint8_t*)calloc(1, size);
+   handle->enc_buf    = (uint8_t*)malloc(movie_encode_bound(size));
+
+   if (handle->state_buf && handle->prev_buf && handle->enc_buf)
+      return true;
+
+   free(handle->state_buf);
+   free(handle->prev_buf);
+   free(handle->enc_buf);
+   handle->state_buf  = NULL;
+   handle->prev_buf   = NULL;
+   handle->enc_buf    = NULL;
+   handle->state_size = 0;
+   return false;
+}
+
+static bool movie_add_checkpoint(movie_t *handle, uint64_t frame,
+      uint64_t offset, bool keyframe)
+{
+   struct movie_checkpoint *cp = NULL;
+
+   if (handle->num_checkpoints == handle->cap_checkpoints)
+   {
+      size_t cap = handle->cap_checkpoints ? handle->cap_checkpoints * 2 : 64;
+      struct movie_checkpoint *checkpoints = (struct movie_checkpoint*)
+         realloc(handle->checkpoints, cap * sizeof(*checkpoints));
+
+      if (!checkpoints)
+         return false;
+
+      handle->checkpoints     = checkpoints;
+      handle->cap_checkpoints = cap;
+   }
+
+   cp           = &handle->checkpoints[handle->num_checkpoints++];
+   cp->frame    = frame;
+   cp->offset   = offset;
+   cp->keyframe = keyframe;
+   return true;
+}
+
+static void movie_write_repeat(movie_t *handle)
+{
+   if (!handle->repeat)
+      return;
+
+   fputc(MOVIE_TAG_REPEAT, handle->file);
+   movie_write_u32(handle->file, handle->repeat);
+   handle->repeat = 0;
+}
+
+static void movie_write_frame(movie_t *handle,
+      const struct movie_port *state)
+{
+   unsigned i, j;
+
+   fputc(MOVIE_TAG_FRAME, handle->file);
+
+   for (i = 0; i < handle->ports; i++)
+   {
+      movie_write_u16(handle->file, state[i].buttons);
+      for (j = 0; j < MOVIE_ANALOGS; j++)
+         movie_write_u16(handle->file, (uint16_t)state[i].analog[j]);
+   }
+}
+
+static void movie_write_delta(movie_t *handle,
+      const struct movie_port *state)
+{
+   unsigned i, j;
+   uint16_t ports = 0;
+
+   for (i = 0; i < handle->ports; i++)
+      if (memcmp(&state[i], &handle->state[i], sizeof(*state)))
+         ports |= 1 << i;
+
+   fputc(MOVIE_TAG_DELTA, handle->file);
+   movie_write_u16(handle->file, ports);
+
+   for (i = 0; i < handle->ports; i++)
+   {
+      uint8_t fields = 0;
+
+      if (!(ports & (1 << i)))
+         continue;
+
+      if (state[i].buttons != handle->state[i].buttons)
+         fields |= 1;
+      for (j = 0; j < MOVIE_ANALOGS; j++)
+         if (state[i].analog[j] != handle->state[i].analog[j])
+            fields |= 2 << j;
+
+      fputc(fields, handle->file);
+
+      if (fields & 1)
+         movie_write_u16(handle->file, state[i].buttons);
+      for (j = 0; j < MOVIE_ANALOGS; j++)
+         if (fields & (2 << j))
+            movie_write_u16(handle->file, (uint16_t)state[i].analog[j]);
+   }
+}
+
+static bool movie_read_frame(movie_t *handle, struct movie_port *state)
+{
+   unsigned i, j;
+
+   for (i = 0; i < handle->ports; i++)
+   {
+      uint16_t val;
+
+      if (!movie_read_u16(handle->file, &state[i].buttons))
+         return false;
+
+      for (j = 0; j < MOVIE_ANALOGS; j++)
+      {
+         if (!movie_read_u16(handle->file, &val))
+            return false;
+         state[i].analog[j] = (int16_t)val;
+      }
+   }
+
+   return true;
+}
+
+static bool movie_read_delta(movie_t *handle, struct movie_port *state)
+{
+   unsigned i, j;
+   uint16_t ports;
+
+   if (!movie_read_u16(handle->file, &ports))
+      return false;
+
+   for (i = 0; i < handle->ports; i++)
+   {
+      int fields;
+      uint16_t val;
+
+      if (!(ports & (1 << i)))
+         continue;
+
+      if ((fields = fgetc(handle->file)) == EOF)
+         return false;
+
+      if ((fields & 1) && !movie_read_u16(handle->file, &state[i].buttons))
+         return false;
+
+      for (j = 0; j < MOVIE_ANALOGS; j++)
+      {
+         if (!(fields & (2 << j)))
+            continue;
+         if (!movie_read_u16(handle->file, &val))
+            return false;
+         state[i].analog[j] = (int16_t)val;
+      }
+   }
+
+   return true;
+}
+
+/**
+ * movie_read_checkpoint_header:
+ * @handle               : movie handle.
+ * @frame                : frame of the checkpoint.
+ * @keyframe             : whether the checkpoint is a keyframe.
+ * @size                 : size of the savestate.
+ * @len                  : size of the encoded savestate which follows.
+ *
+ * Reads the header of a checkpoint record, after its tag.
+ **/
+static bool movie_read_checkpoint_header(movie_t *handle, uint64_t *frame,
+      bool *keyframe, uint32_t *size, uint32_t *len)
+{
+   int flag;
+
+   if (!movie_read_u64(handle->file, frame))
+      return false;
+   if ((flag = fgetc(handle->file)) == EOF)
+      return false;
+   *keyframe = flag != 0;
+
+   return movie_read_u32(handle->file, size)
+      && movie_read_u32(handle->file, len)
+      && *len <= movie_encode_bound(*size);
+}
+
+/**
+ * movie_write_checkpoint:
+ * @handle               : movie handle.
+ *
+ * Serializes the core and appends the state as a checkpoint
+ * for the current frame.
+ **/
+static void movie_write_checkpoint(movie_t *handle)
+{
+   long offset;
+   size_t len;
+   bool keyframe = handle->since_keyframe == 0;
+   size_t size   = pretro_serialize_size();
+
+   if (!size)
+      return;
+
+   if (size != handle->state_size)
+   {
+      if (!movie_alloc_state(handle, size))
+         return;
+      keyframe = true;
+   }
+
+   if (!pretro_serialize(handle->state_buf, size))
+      return;
+
+   if (keyframe)
+   {
+      memset(handle->prev_buf, 0, size);
+      handle->since_keyframe = 0;
+   }
+
+   len = movie_encode_state(handle->enc_buf,
+         handle->state_buf, handle->prev_buf, size);
+
+   movie_write_repeat(handle);
+
+   offset = ftell(handle->file);
+   if (offset < 0 || !movie_add_checkpoint(handle,
+            handle->frame, offset, keyframe))
+      return;
+
+   fputc(MOVIE_TAG_CHECKPOINT, handle->file);
+   movie_write_u64(handle->file, handle->frame);
+   fputc(keyframe, handle->file);
+   movie_write_u32(handle->file, size);
+   movie_write_u32(handle->file, len);
+   fwrite(handle->enc_buf, 1, len, handle->file);
+
+   memcpy(handle->prev_buf, handle->state_buf, size);
+   handle->since_keyframe = (handle->since_keyframe + 1)
+      % MOVIE_KEYFRAME_INTERVAL;
+
+   /* Playback may start here, so the next frame must be complete. */
+   handle->has_state = false;
+}
+
+static void movie_write_index(movie_t *handle)
+{
+   size_t i;
+   long offset = ftell(handle->file);
+
+   if (offset < 0)
+      return;
+
+   fputc(MOVIE_TAG_INDEX, handle->file);
+   movie_write_u32(handle->file, handle->num_checkpoints);
+
+   for (i = 0; i < handle->num_checkpoints; i++)
+   {
+      movie_write_u64(handle->file, handle->checkpoints[i].frame);
+      movie_write_u64(handle->file, handle->checkpoints[i].offset);
+      fputc(handle->checkpoints[i].keyframe, handle->file);
+   }
+
+   movie_write_u64(handle->file, offset);
+   fwrite(MOVIE_INDEX_MAGIC, 1, 4, handle->file);
+}
+
+/**
+ * movie_read_index:
+ * @handle               : movie handle.
+ *
+ * Loads the checkpoint index from the end of the log.
+ *
+ * Returns: false if the log has no valid index.
+ **/
+static bool movie_read_index(movie_t *handle)
+{
+   char magic[4];
+   uint32_t i, count;
+   uint64_t offset;
+
+   if (fseek(handle->file, -12, SEEK_END) != 0
+         || !movie_read_u64(handle->file, &offset)
+         || fread(magic, 1, 4, handle->file) != 4
+         || memcmp(magic, MOVIE_INDEX_MAGIC, 4))
+      return false;
+
+   if (fseek(handle->file, (long)offset, SEEK_SET) != 0
+         || fgetc(handle->file) != MOVIE_TAG_INDEX
+         || !movie_read_u32(handle->file, &count))
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      uint64_t frame, cp_offset;
+      int keyframe;
+
+      if (!movie_read_u64(handle->file, &frame)
+            || !movie_read_u64(handle->file, &cp_offset)
+            || (keyframe = fgetc(handle->file)) == EOF
+            || !movie_add_checkpoint(handle, frame, cp_offset, keyframe != 0))
+      {
+         handle->num_checkpoints = 0;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+/**
+ * movie_scan_index:
+ * @handle               : movie handle.
+ *
+ * Builds the checkpoint index by reading the whole log,
+ * for logs which were not closed cleanly.
+ **/
+static void movie_scan_index(movie_t *handle)
+{
+   struct movie_port state[MAX_USERS];
+
+   for (;;)
+   {
+      uint64_t frame;
+      uint32_t size, len;
+      bool keyframe;
+      long offset = ftell(handle->file);
+
+      switch (fgetc(handle->file))
+      {
+         case MOVIE_TAG_FRAME:
+            if (!movie_read_frame(handle, state))
+               return;
+            break;
+         case MOVIE_TAG_DELTA:
+            if (!movie_read_delta(handle, state))
+               return;
+            break;
+         case MOVIE_TAG_REPEAT:
+            if (!movie_read_u32(handle->file, &size))
+               return;
+            break;
+         case MOVIE_TAG_CHECKPOINT:
+            if (!movie_read_checkpoint_header(handle,
+                     &frame, &keyframe, &size, &len)
+                  || fseek(handle->file, len, SEEK_CUR) != 0
+                  || !movie_add_checkpoint(handle, frame, offset, keyframe))
+               return;
+            break;
+         default:
+            return;
+      }
+   }
+}
+
+/**
+ * movie_load_checkpoint:
+ * @handle               : movie handle.
+ * @idx                  : index of the checkpoint.
+ *
+ * Decodes checkpoint @idx, starting from the keyframe before it,
+ * loads it into the core and continues playback after it.
+ *
+ * Returns: true on success.
+ **/
+static bool movie_load_checkpoint(movie_t *handle, size_t idx)
+{
+   size_t i     = idx;
+   uint64_t frame = 0;
+
+   while (i > 0 && !handle->checkpoints[i].keyframe)
+      i--;
+
+   for (; i <= idx; i++)
+   {
+      uint32_t size, len;
+      bool keyframe;
+
+      if (fseek(handle->file, (long)handle->checkpoints[i].offset,
+               SEEK_SET) != 0
+            || fgetc(handle->file) != MOVIE_TAG_CHECKPOINT
+            || !movie_read_checkpoint_header(handle,
+               &frame, &keyframe, &size, &len)
+            || !movie_alloc_state(handle, size))
+         return false;
+
+      if (keyframe)
+         memset(handle->prev_buf, 0, size);
+
+      if (fread(handle->enc_buf, 1, len, handle->file) != len
+            || !movie_decode_state(handle->prev_buf, size,
+               handle->enc_buf, len))
+         return false;
+   }
+
+   if (!pretro_unserialize(handle->prev_buf, handle->state_size))
+      return false;
+
+   memset(handle->state, 0, sizeof(handle->state));
+   handle->frame  = frame;
+   handle->repeat = 0;
+   handle->end    = false;
+   return true;
+}
+
+static void movie_record(movie_t *handle, retro_input_state_t state_cb)
+{
+   unsigned i, j;
+   struct movie_port state[MAX_USERS];
+
+   memset(state, 0, sizeof(state));
+
+   for (i = 0; i < handle->ports; i++)
+   {
+      state[i].buttons = state_cb(i, RETRO_DEVICE_JOYPAD, 0,
+            RETRO_DEVICE_ID_JOYPAD_MASK);
+
+      for (j = 0; j < MOVIE_ANALOGS; j++)
+         state[i].analog[j] = state_cb(i, RETRO_DEVICE_ANALOG,
+               j >> 1, j & 1);
+   }
+
+   handle->frame++;
+
+   if (handle->has_state && !memcmp(state, handle->state, sizeof(state)))
+   {
+      handle->repeat++;
+      return;
+   }
+
+   movie_write_repeat(handle);
+
+   if (handle->has_state)
+      movie_write_delta(handle, state);
+   else
+      movie_write_frame(handle, state);
+
+   memcpy(handle->state, state, sizeof(state));
+   handle->has_state = true;
+}
+
+static void movie_play(movie_t *handle)
+{
+   uint32_t count;
+
+   if (handle->end)
+      return;
+
+   handle->frame++;
+
+   if (handle->repeat)
+   {
+      handle->repeat--;
+      return;
+   }
+
+   for (;;)
+   {
+      uint64_t frame;
+      uint32_t size, len;
+      bool keyframe;
+
+      switch (fgetc(handle->file))
+      {
+         case MOVIE_TAG_FRAME:
+            if (movie_read_frame(handle, handle->state))
+               return;
+            break;
+         case MOVIE_TAG_DELTA:
+            if (movie_read_delta(handle, handle->state))
+               return;
+            break;
+         case MOVIE_TAG_REPEAT:
+            if (movie_read_u32(handle->file, &count) && count)
+            {
+               handle->repeat = count - 1;
+               return;
+            }
+            break;
+         case MOVIE_TAG_CHECKPOINT:
+            /* Only needed when seeking. */
+            if (movie_read_checkpoint_header(handle,
+                     &frame, &keyframe, &size, &len)
+                  && fseek(handle->file, len, SEEK_CUR) == 0)
+               continue;
+            break;
+         case MOVIE_TAG_INDEX:
+         case EOF:
+            break;
+         default:
+            RARCH_ERR("Input log is corrupt.\n");
+            break;
+      }
+
+      break;
+   }
+
+   RARCH_LOG("Input log playback ended.\n");
+   memset(handle->state, 0, sizeof(handle->state));
+   handle->end     = true;
+   handle->seeking = false;
+}
+
+/**
+ * movie_new:
+ * @path                 : path of the input log.
+ * @mode                 : whether to record to or play back from @path.
+ * @ports                : number of ports to record. Ignored on playback.
+ * @interval             : frames between checkpoints when recording,
+ *                         0 to disable. Ignored on playback.
+ *
+ * Opens an input log. Each input poll of the core is one frame
+ * in the log, holding the joypad buttons and both analog sticks
+ * of every port.
+ *
+ * Returns: new movie handle, or NULL on failure.
+ **/
+movie_t *movie_new(const char *path, enum movie_mode mode,
+      unsigned ports, unsigned interval)
+{
+   char magic[4];
+   long data_offset;
+   uint32_t version = 0, crc = 0, num_ports = 0;
+   global_t *global = global_get_ptr();
+   movie_t  *handle = (movie_t*)calloc(1, sizeof(*handle));
+
+   if (!handle)
+      return NULL;
+
+   handle->mode = mode;
+   handle->file = fopen(path, mode == MOVIE_RECORD ? "wb" : "rb");
+   if (!handle->file)
+      goto error;
+
+   if (mode == MOVIE_RECORD)
+   {
+      handle->ports    = ports > MAX_USERS ? MAX_USERS : ports;
+      handle->version  = MOVIE_VERSION;
+      handle->interval = interval;
+
+      if (fwrite(MOVIE_MAGIC, 1, 4, handle->file) != 4
+            || !movie_write_u32(handle->file, MOVIE_VERSION)
+            || !movie_write_u32(handle->file, handle->ports)
+            || !movie_write_u32(handle->file, global->content_crc))
+         goto error;
+
+      return handle;
+   }
+
+   if (fread(magic, 1, 4, handle->file) != 4
+         || memcmp(magic, MOVIE_MAGIC, 4)
+         || !movie_read_u32(handle->file, &version)
+         || !movie_read_u32(handle->file, &num_ports)
+         || !movie_read_u32(handle->file, &crc))
+   {
+      RARCH_ERR("\"%s\" is not an input log.\n", path);
+      goto error;
+   }
+
+   if (version < 1 || version > MOVIE_VERSION || num_ports > MAX_USERS)
+   {
+      RARCH_ERR("Unsupported input log version %u.\n", version);
+      goto error;
+   }
+
+   if (crc != global->content_crc)
+      RARCH_WARN("Input log was recorded with different content, "
+            "playback will likely desync.\n");
+
+   handle->ports   = num_ports;
+   handle->version = version;
+
+   data_offset = ftell(handle->file);
+
+   if (!movie_read_index(handle))
+   {
+      fseek(handle->file, data_offset, SEEK_SET);
+      movie_scan_index(handle);
+   }
+
+   if (fseek(handle->file, data_offset, SEEK_SET) != 0)
+      goto error;
+
+   return handle;
+
+error:
+   movie_free(handle);
+   return NULL;
+}
+
+void movie_free(movie_t *handle)
+{
+   if (!handle)
+      return;
+
+   if (handle->file)
+   {
+      if (handle->mode == MOVIE_RECORD)
+      {
+         movie_write_repeat(handle);
+         movie_write_index(handle);
+      }
+      fclose(handle->file);
+   }
+
+   free(handle->checkpoints);
+   free(handle->state_buf);
+   free(handle->prev_buf);
+   free(handle->enc_buf);
+   free(handle);
+}
+
+/**
+ * movie_pre_frame:
+ * @handle               : movie handle.
+ *
+ * Writes a checkpoint when one is due while recording,
+ * and carries out a pending seek while playing back.
+ * Call this before running retro_run().
+ **/
+void movie_pre_frame(movie_t *handle)
+{
+   if (handle->mode == MOVIE_RECORD)
+   {
+      if (handle->interval && handle->frame >= handle->next_checkpoint)
+      {
+         movie_write_checkpoint(handle);
+         handle->next_checkpoint = handle->frame + handle->interval;
+      }
+      return;
+   }
+
+   if (handle->seek_pending)
+   {
+      size_t lo = 0, hi = handle->num_checkpoints;
+      uint64_t target = handle->seek_target;
+
+      handle->seek_pending = false;
+
+      /* Last checkpoint at or before the target. */
+      while (lo < hi)
+      {
+         size_t mid = lo + (hi - lo) / 2;
+         if (handle->checkpoints[mid].frame <= target)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+
+      /* Loading is only worth it when it gets closer than
+       * fast-forwarding from the current frame. */
+      if (lo && (target < handle->frame
+               || handle->checkpoints[lo - 1].frame > handle->frame))
+      {
+         if (!movie_load_checkpoint(handle, lo - 1))
+            RARCH_ERR("Failed to load input log checkpoint.\n");
+      }
+
+      if (target < handle->frame)
+         RARCH_WARN("No checkpoint before frame %llu, "
+               "cannot seek back.\n", (unsigned long long)target);
+      else
+         handle->seeking = true;
+   }
+
+   if (handle->seeking && handle->frame >= handle->seek_target)
+   {
+      RARCH_LOG("Input log seeked to frame %llu.\n",
+            (unsigned long long)handle->frame);
+      handle->seeking = false;
+   }
+}
+
+/**
+ * movie_seek:
+ * @handle               : movie handle.
+ * @frame                : frame to seek to.
+ *
+ * Seeks playback to @frame on the next movie_pre_frame(),
+ * loading the nearest checkpoint before it and running
+ * the remaining frames unthrottled.
+ **/
+void movie_seek(movie_t *handle, uint64_t frame)
+{
+   if (handle->mode != MOVIE_PLAYBACK)
+      return;
+
+   handle->seek_pending = true;
+   handle->seek_target  = frame;
+}
+
+/**
+ * movie_is_seeking:
+ * @handle               : movie handle.
+ *
+ * Returns: true while frames are run to reach a seek target.
+ **/
+bool movie_is_seeking(movie_t *handle)
+{
+   return handle && (handle->seeking || handle->seek_pending);
+}
+
+/**
+ * movie_poll:
+ * @handle               : movie handle.
+ * @state_cb             : input state callback to record from.
+ *
+ * Advances the log by one frame. When recording, the state of
+ * every port is read through @state_cb and appended. When playing
+ * back, the next frame is read.
+ **/
+void movie_poll(movie_t *handle, retro_input_state_t state_cb)
+{
+   if (handle->mode == MOVIE_RECORD)
+      movie_record(handle, state_cb);
+   else
+      movie_play(handle);
+}
+
+/**
+ * movie_get_input:
+ * @handle               : movie handle.
+ * @port                 : user number.
+ * @device               : device identifier of user.
+ * @idx                  : index value of user.
+ * @id                   : identifier of input.
+ * @res                  : input state for the current frame.
+ *
+ * Returns: true if @handle is playing back and @res holds the
+ * logged state, false if live input should be used.
+ **/
+bool movie_get_input(movie_t *handle, unsigned port, unsigned device,
+      unsigned idx, unsigned id, int16_t *res)
+{
+   const struct movie_port *state = NULL;
+
+   if (handle->mode != MOVIE_PLAYBACK)
+      return false;
+
+   *res = 0;
+
+   if (port >= handle->ports)
+      return true;
+
+   state = &handle->state[port];
+
+   switch (device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         if (id == RETRO_DEVICE_ID_JOYPAD_MASK)
+            *res = state->buttons;
+         else if (id < 16)
+            *res = (state->buttons >> id) & 1;
+         break;
+      case RETRO_DEVICE_ANALOG:
+         if (idx <= RETRO_DEVICE_INDEX_ANALOG_RIGHT
+               && id <= RETRO_DEVICE_ID_ANALOG_Y)
+            *res = state->analog[(idx << 1) | id];
+         break;
+   }
+
+   return true;
+}
+
+/**
+ * movie_end:
+ * @handle               : movie handle.
+ *
+ * Returns: true if playback reached the end of the log.
+ **/
+bool movie_end(movie_t *handle)
+{
+   return handle && handle->end;
+}
+
+/**
+ * init_movie:
+ *
+ * Starts playback or recording of the input log given
+ * on the command line, if any.
+ **/
+void init_movie(void)
+{
+   global_t   *global   = global_get_ptr();
+   settings_t *settings = config_get_ptr();
+
+   deinit_movie();
+
+   if (*global->movie.play_path)
+   {
+      global->movie.handle = movie_new(global->movie.play_path,
+            MOVIE_PLAYBACK, 0, 0);
+      if (global->movie.handle)
+      {
+         RARCH_LOG("Playing back input log \"%s\".\n",
+               global->movie.play_path);
+         if (global->movie.seek_frame)
+            movie_seek(global->movie.handle, global->movie.seek_frame);
+      }
+   }
+   else if (*global->movie.record_path)
+   {
+      global->movie.handle = movie_new(global->movie.record_path,
+            MOVIE_RECORD, settings->input.max_users,
+            global->movie.checkpoint_interval);
+      if (global->movie.handle)
+         RARCH_LOG("Recording input log to \"%s\".\n",
+               global->movie.record_path);
+   }
+   else
+      return;
+
+   if (!global->movie.handle)
+      RARCH_ERR("Failed to open input log.\n");
+}
+
+void deinit_movie(void)
+{
+   global_t *global = global_get_ptr();
+
+   movie_free(global->movie.handle);
+   global->movie.handle = NULL;
+}
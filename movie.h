@@ -0,0 +1,129 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_MOVIE_H
+#define __RARCH_MOVIE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <boolean.h>
+#include "libretro.h"
+
+/* Frames between savestate checkpoints when recording. */
+#define MOVIE_DEFAULT_CHECKPOINT_INTERVAL 600
+
+typedef struct movie movie_t;
+
+enum movie_mode
+{
+   MOVIE_PLAYBACK = 0,
+   MOVIE_RECORD
+};
+
+/**
+ * movie_new:
+ * @path                 : path of the input log.
+ * @mode                 : whether to record to or play back from @path.
+ * @ports                : number of ports to record. Ignored on playback.
+ * @interval             : frames between checkpoints when recording,
+ *                         0 to disable. Ignored on playback.
+ *
+ * Opens an input log. Each input poll of the core is one frame
+ * in the log, holding the joypad buttons and both analog sticks
+ * of every port.
+ *
+ * Returns: new movie handle, or NULL on failure.
+ **/
+movie_t *movie_new(const char *path, enum movie_mode mode,
+      unsigned ports, unsigned interval);
+
+void movie_free(movie_t *handle);
+
+/**
+ * movie_pre_frame:
+ * @handle               : movie handle.
+ *
+ * Writes a checkpoint when one is due while recording,
+ * and carries out a pending seek while playing back.
+ * Call this before running retro_run().
+ **/
+void movie_pre_frame(movie_t *handle);
+
+/**
+ * movie_seek:
+ * @handle               : movie handle.
+ * @frame                : frame to seek to.
+ *
+ * Seeks playback to @frame on the next movie_pre_frame(),
+ * loading the nearest checkpoint before it and running
+ * the remaining frames unthrottled.
+ **/
+void movie_seek(movie_t *handle, uint64_t frame);
+
+/**
+ * movie_is_seeking:
+ * @handle               : movie handle.
+ *
+ * Returns: true while frames are run to reach a seek target.
+ **/
+bool movie_is_seeking(movie_t *handle);
+
+/**
+ * movie_poll:
+ * @handle               : movie handle.
+ * @state_cb             : input state callback to record from.
+ *
+ * Advances the log by one frame. When recording, the state of
+ * every port is read through @state_cb and appended. When playing
+ * back, the next frame is read.
+ **/
+void movie_poll(movie_t *handle, retro_input_state_t state_cb);
+
+/**
+ * movie_get_input:
+ * @handle               : movie handle.
+ * @port                 : user number.
+ * @device               : device identifier of user.
+ * @idx                  : index value of user.
+ * @id                   : identifier of input.
+ * @res                  : input state for the current frame.
+ *
+ * Returns: true if @handle is playing back and @res holds the
+ * logged state, false if live input should be used.
+ **/
+bool movie_get_input(movie_t *handle, unsigned port, unsigned device,
+      unsigned idx, unsigned id, int16_t *res);
+
+/**
+ * movie_end:
+ * @handle               : movie handle.
+ *
+ * Returns: true if playback reached the end of the log.
+ **/
+bool movie_end(movie_t *handle);
+
+void init_movie(void);
+
+void deinit_movie(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
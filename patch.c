@@ -20,6 +20,8 @@
 #include <file/file_path.h>
 #include <boolean.h>
 #include <compat/msvc.h>
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <stdint.h>
 #include <string.h>
 #include "patch.h"
@@ -28,6 +30,166 @@
 #include "general.h"
 #include "retroarch_logger.h"
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Target bytes to accumulate before waking the checksum thread. */
+#define PATCH_CRC_STEP (1 << 20)
+
+/* Checksums the source and patch data up front and the target as it is
+ * written, on a thread of its own so it overlaps patch application.
+ * Target bytes before the published offset must not change anymore. */
+struct patch_crc
+{
+   const uint8_t *source;
+   const uint8_t *patch;
+   const uint8_t *target;
+   size_t source_length;
+   size_t patch_length;
+
+   uint32_t source_crc;
+   uint32_t patch_crc;
+   uint32_t target_crc;
+
+   size_t target_done;
+   size_t target_written;
+   size_t target_published;
+   bool finished;
+
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+#endif
+};
+
+static uint32_t patch_crc_calculate(uint32_t crc,
+      const uint8_t *data, size_t length)
+{
+#ifdef HAVE_ZLIB
+   return zlib_crc32_continue(crc, data, length);
+#else
+   return 0;
+#endif
+}
+
+#ifdef HAVE_THREADS
+static void patch_crc_thread(void *data)
+{
+   struct patch_crc *crc = (struct patch_crc*)data;
+
+   crc->source_crc = patch_crc_calculate(0, crc->source, crc->source_length);
+   crc->patch_crc  = patch_crc_calculate(0, crc->patch, crc->patch_length);
+
+   for (;;)
+   {
+      size_t written;
+      bool finished;
+
+      slock_lock(crc->lock);
+      while (!crc->finished && crc->target_written == crc->target_done)
+         scond_wait(crc->cond, crc->lock);
+      written  = crc->target_written;
+      finished = crc->finished;
+      slock_unlock(crc->lock);
+
+      crc->target_crc  = patch_crc_calculate(crc->target_crc,
+            crc->target + crc->target_done, written - crc->target_done);
+      crc->target_done = written;
+
+      if (finished)
+         break;
+   }
+}
+#endif
+
+static void patch_crc_start(struct patch_crc *crc,
+      const uint8_t *source, size_t source_length,
+      const uint8_t *patch, size_t patch_length,
+      const uint8_t *target)
+{
+   memset(crc, 0, sizeof(*crc));
+
+   crc->source        = source;
+   crc->source_length = source_length;
+   crc->patch         = patch;
+   crc->patch_length  = patch_length;
+   crc->target        = target;
+
+#ifdef HAVE_THREADS
+   crc->lock = slock_new();
+   crc->cond = scond_new();
+
+   if (crc->lock && crc->cond)
+      crc->thread = sthread_create(patch_crc_thread, crc);
+
+   if (!crc->thread)
+   {
+      /* Checksum everything in patch_crc_finish() instead. */
+      if (crc->lock)
+         slock_free(crc->lock);
+      if (crc->cond)
+         scond_free(crc->cond);
+      crc->lock = NULL;
+      crc->cond = NULL;
+   }
+#endif
+}
+
+/**
+ * patch_crc_progress:
+ * @crc                  : Checksum state.
+ * @written              : Target bytes that are final.
+ *
+ * Lets the checksum thread catch up, at most once per PATCH_CRC_STEP.
+ **/
+static INLINE void patch_crc_progress(struct patch_crc *crc, size_t written)
+{
+#ifdef HAVE_THREADS
+   if (!crc->thread || written - crc->target_published < PATCH_CRC_STEP)
+      return;
+
+   crc->target_published = written;
+
+   slock_lock(crc->lock);
+   crc->target_written = written;
+   scond_signal(crc->cond);
+   slock_unlock(crc->lock);
+#endif
+}
+
+static void patch_crc_finish(struct patch_crc *crc, size_t written)
+{
+#ifdef HAVE_THREADS
+   if (crc->thread)
+   {
+      slock_lock(crc->lock);
+      crc->target_written = written;
+      crc->finished       = true;
+      scond_signal(crc->cond);
+      slock_unlock(crc->lock);
+
+      sthread_join(crc->thread);
+      slock_free(crc->lock);
+      scond_free(crc->cond);
+      crc->thread = NULL;
+      return;
+   }
+#endif
+
+   crc->source_crc = patch_crc_calculate(0, crc->source, crc->source_length);
+   crc->patch_crc  = patch_crc_calculate(0, crc->patch, crc->patch_length);
+   crc->target_crc = patch_crc_calculate(0, crc->target, written);
+}
+
 enum bps_mode
 {
    SOURCE_READ = 0,
@@ -42,18 +204,15 @@ struct bps_data
    uint8_t *target_data;
    size_t modify_length, source_length, target_length;
    size_t modify_offset, source_offset, target_offset;
-   uint32_t modify_checksum, source_checksum, target_checksum;
 
-   size_t source_relative_offset, target_relative_offset, output_offset;
+   size_t output_offset;
 };
 
 static uint8_t bps_read(struct bps_data *bps)
 {
-   uint8_t data = bps->modify_data[bps->modify_offset++];
-#ifdef HAVE_ZLIB
-   bps->modify_checksum = zlib_crc32_adjust(bps->modify_checksum, data);
-#endif
-   return data;
+   if (bps->modify_offset >= bps->modify_length)
+      return 0x80;
+   return bps->modify_data[bps->modify_offset++];
 }
 
 static uint64_t bps_decode(struct bps_data *bps)
@@ -73,15 +232,35 @@ static uint64_t bps_decode(struct bps_data *bps)
    return data;
 }
 
-static void bps_write(struct bps_data *bps, uint8_t data)
+/**
+ * bps_relative:
+ * @bps                  : BPS state.
+ * @offset               : Offset to move, updated in place.
+ * @limit                : Exclusive upper bound for the new offset.
+ *
+ * Applies a signed relative offset from the patch stream.
+ *
+ * Returns: true if the new offset is within [0, @limit).
+ **/
+static bool bps_relative(struct bps_data *bps, size_t *offset, size_t limit)
 {
-   if (!bps)
-      return;
+   uint64_t value = bps_decode(bps);
+   uint64_t delta = value >> 1;
 
-   bps->target_data[bps->output_offset++] = data;
-#ifdef HAVE_ZLIB
-   bps->target_checksum = zlib_crc32_adjust(bps->target_checksum, data);
-#endif
+   if (value & 1)
+   {
+      if (delta > *offset)
+         return false;
+      *offset -= delta;
+   }
+   else
+   {
+      if (delta >= limit || *offset >= limit - delta)
+         return false;
+      *offset += delta;
+   }
+
+   return true;
 }
 
 patch_error_t bps_apply_patch(
@@ -91,10 +270,12 @@ patch_error_t bps_apply_patch(
 {
    size_t i;
    size_t modify_source_size, modify_target_size,
-          modify_markup_size;
+          modify_markup_size, modify_end;
+   struct patch_crc crc;
    struct bps_data bps = {0};
+   patch_error_t err   = PATCH_SUCCESS;
    uint32_t modify_source_checksum = 0, modify_target_checksum = 0,
-            modify_modify_checksum = 0, checksum;
+            modify_modify_checksum = 0;
 
    if (modify_length < 19)
       return PATCH_PATCH_TOO_SMALL;
@@ -105,8 +286,7 @@ patch_error_t bps_apply_patch(
    bps.target_length = *target_length;
    bps.source_data = source_data;
    bps.source_length = source_length;
-   bps.modify_checksum = ~0;
-   bps.target_checksum = ~0;
+   modify_end = modify_length - 12;
 
    if ((bps_read(&bps) != 'B') || (bps_read(&bps) != 'P') ||
          (bps_read(&bps) != 'S') || (bps_read(&bps) != '1'))
@@ -115,83 +295,121 @@ patch_error_t bps_apply_patch(
    modify_source_size = bps_decode(&bps);
    modify_target_size = bps_decode(&bps);
    modify_markup_size = bps_decode(&bps);
-   for (i = 0; i < modify_markup_size; i++)
-      bps_read(&bps);
+
+   if (bps.modify_offset > modify_end
+         || modify_markup_size > modify_end - bps.modify_offset)
+      return PATCH_PATCH_INVALID;
+   bps.modify_offset += modify_markup_size;
 
    if (modify_source_size > bps.source_length)
       return PATCH_SOURCE_TOO_SMALL;
    if (modify_target_size > bps.target_length)
       return PATCH_TARGET_TOO_SMALL;
 
-   while (bps.modify_offset < bps.modify_length - 12)
+   patch_crc_start(&crc, source_data, source_length,
+         modify_data, modify_length - 4, target_data);
+
+   while (bps.modify_offset < modify_end)
    {
-      size_t length = bps_decode(&bps);
-      unsigned mode = length & 3;
+      uint64_t length = bps_decode(&bps);
+      unsigned mode   = length & 3;
+      uint8_t *output = bps.target_data + bps.output_offset;
 
       length = (length >> 2) + 1;
 
+      if (length > bps.target_length - bps.output_offset)
+      {
+         err = PATCH_TARGET_TOO_SMALL;
+         goto end;
+      }
+
       switch (mode)
       {
          case SOURCE_READ:
-            while (length--)
-               bps_write(&bps, bps.source_data[bps.output_offset]);
+            if (bps.output_offset >= bps.source_length
+                  || length > bps.source_length - bps.output_offset)
+            {
+               err = PATCH_PATCH_INVALID;
+               goto end;
+            }
+            memcpy(output, bps.source_data + bps.output_offset, length);
             break;
 
          case TARGET_READ:
-            while (length--)
-               bps_write(&bps, bps_read(&bps));
+            if (bps.modify_offset > modify_end
+                  || length > modify_end - bps.modify_offset)
+            {
+               err = PATCH_PATCH_INVALID;
+               goto end;
+            }
+            memcpy(output, bps.modify_data + bps.modify_offset, length);
+            bps.modify_offset += length;
             break;
 
          case SOURCE_COPY:
-         case TARGET_COPY:
-         {
-            int offset = bps_decode(&bps);
-            bool negative = offset & 1;
-            offset >>= 1;
-            if (negative)
-               offset = -offset;
+            if (!bps_relative(&bps, &bps.source_offset, bps.source_length)
+                  || length > bps.source_length - bps.source_offset)
+            {
+               err = PATCH_PATCH_INVALID;
+               goto end;
+            }
+            memcpy(output, bps.source_data + bps.source_offset, length);
+            bps.source_offset += length;
+            break;
 
-            if (mode == SOURCE_COPY)
+         case TARGET_COPY:
+            /* May overlap the bytes being written, which repeats them. */
+            if (!bps_relative(&bps, &bps.target_offset, bps.output_offset))
             {
-               bps.source_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.source_data[bps.source_offset++]);
+               err = PATCH_PATCH_INVALID;
+               goto end;
             }
+
+            if (length <= bps.output_offset - bps.target_offset)
+               memcpy(output, bps.target_data + bps.target_offset, length);
             else
             {
-               bps.target_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.target_data[bps.target_offset++]);
-               break;
+               const uint8_t *input = bps.target_data + bps.target_offset;
+
+               for (i = 0; i < length; i++)
+                  output[i] = input[i];
             }
+            bps.target_offset += length;
             break;
-         }
       }
+
+      bps.output_offset += length;
+      patch_crc_progress(&crc, bps.output_offset);
    }
 
+   if (bps.modify_offset != modify_end)
+   {
+      err = PATCH_PATCH_INVALID;
+      goto end;
+   }
 
    for (i = 0; i < 32; i += 8)
       modify_source_checksum |= bps_read(&bps) << i;
    for (i = 0; i < 32; i += 8)
       modify_target_checksum |= bps_read(&bps) << i;
-
-   checksum = ~bps.modify_checksum;
    for (i = 0; i < 32; i += 8)
       modify_modify_checksum |= bps_read(&bps) << i;
 
-#ifdef HAVE_ZLIB
-   bps.source_checksum = zlib_crc32_calculate(bps.source_data, bps.source_length);
-#else
+end:
+   patch_crc_finish(&crc, bps.output_offset);
+
+   if (err != PATCH_SUCCESS)
+      return err;
+
+#ifndef HAVE_ZLIB
    return PATCH_PATCH_CHECKSUM_INVALID;
 #endif
 
-   bps.target_checksum = ~bps.target_checksum;
-
-   if (bps.source_checksum != modify_source_checksum)
+   if (crc.source_crc != modify_source_checksum)
       return PATCH_SOURCE_CHECKSUM_INVALID;
-   if (bps.target_checksum != modify_target_checksum)
+   if (crc.target_crc != modify_target_checksum)
       return PATCH_TARGET_CHECKSUM_INVALID;
-   if (checksum != modify_modify_checksum)
+   if (crc.patch_crc != modify_modify_checksum)
       return PATCH_PATCH_CHECKSUM_INVALID;
 
    *target_length = modify_target_size;
@@ -205,44 +423,26 @@ struct ups_data
    uint8_t *target_data;
    unsigned patch_length, source_length, target_length;
    unsigned patch_offset, source_offset, target_offset;
-   unsigned patch_checksum, source_checksum, target_checksum;
 };
 
 static uint8_t ups_patch_read(struct ups_data *data) 
 {
    if (data && data->patch_offset < data->patch_length) 
-   {
-      uint8_t n = data->patch_data[data->patch_offset++];
-#ifdef HAVE_ZLIB
-      data->patch_checksum = zlib_crc32_adjust(data->patch_checksum, n);
-#endif
-      return n;
-   }
+      return data->patch_data[data->patch_offset++];
    return 0x00;
 }
 
 static uint8_t ups_source_read(struct ups_data *data) 
 {
    if (data && data->source_offset < data->source_length) 
-   {
-      uint8_t n = data->source_data[data->source_offset++];
-#ifdef HAVE_ZLIB
-      data->source_checksum = zlib_crc32_adjust(data->source_checksum, n);
-#endif
-      return n;
-   }
+      return data->source_data[data->source_offset++];
    return 0x00;
 }
 
 static void ups_target_write(struct ups_data *data, uint8_t n) 
 {
    if (data && data->target_offset < data->target_length) 
-   {
       data->target_data[data->target_offset] = n;
-#ifdef HAVE_ZLIB
-      data->target_checksum = zlib_crc32_adjust(data->target_checksum, n);
-#endif
-   }
 
    if (data)
       data->target_offset++;
@@ -263,13 +463,83 @@ static uint64_t ups_decode(struct ups_data *data)
    return offset;
 }
 
+/**
+ * ups_copy:
+ * @data                 : UPS state.
+ * @length               : Bytes to copy.
+ *
+ * Same as @length rounds of ups_target_write(ups_source_read()):
+ * source bytes past the end read as zero, target bytes past the
+ * end are dropped.
+ **/
+static void ups_copy(struct ups_data *data, unsigned length)
+{
+   unsigned source_left = data->source_length > data->source_offset ?
+      data->source_length - data->source_offset : 0;
+   unsigned target_left = data->target_length > data->target_offset ?
+      data->target_length - data->target_offset : 0;
+   unsigned written     = min(length, target_left);
+   unsigned copied      = min(written, source_left);
+
+   memcpy(data->target_data + data->target_offset,
+         data->source_data + data->source_offset, copied);
+   memset(data->target_data + data->target_offset + copied, 0,
+         written - copied);
+
+   data->source_offset += min(length, source_left);
+   data->target_offset += length;
+}
+
+/**
+ * ups_xor:
+ * @data                 : UPS state.
+ *
+ * Applies one XOR run, up to and including its terminating zero.
+ **/
+static void ups_xor(struct ups_data *data)
+{
+   const uint8_t *patch = data->patch_data + data->patch_offset;
+   const uint8_t *end   = (const uint8_t*)memchr(patch, 0,
+         data->patch_length - data->patch_offset);
+   unsigned length      = end ? (unsigned)(end - patch) + 1 : 0;
+
+   if (length
+         && data->source_length - data->source_offset >= length
+         && data->target_length - data->target_offset >= length
+         && data->source_offset <= data->source_length
+         && data->target_offset <= data->target_length)
+   {
+      unsigned i;
+      const uint8_t *source = data->source_data + data->source_offset;
+      uint8_t *target       = data->target_data + data->target_offset;
+
+      for (i = 0; i < length; i++)
+         target[i] = patch[i] ^ source[i];
+
+      data->patch_offset  += length;
+      data->source_offset += length;
+      data->target_offset += length;
+      return;
+   }
+
+   /* Runs up against the end of a buffer. */
+   while (true) 
+   {
+      uint8_t patch_xor = ups_patch_read(data);
+      ups_target_write(data, patch_xor ^ ups_source_read(data));
+      if (patch_xor == 0)
+         break;
+   }
+}
+
 patch_error_t ups_apply_patch(
       const uint8_t *patchdata, size_t patchlength,
       const uint8_t *sourcedata, size_t sourcelength,
       uint8_t *targetdata, size_t *targetlength)
 {
    size_t i;
-   unsigned source_read_length, target_read_length;
+   struct patch_crc crc;
+   unsigned source_read_length, target_read_length, patch_checked;
    uint32_t patch_read_checksum = 0, source_read_checksum = 0,
             target_read_checksum = 0, patch_result_checksum;
    struct ups_data data = {0};
@@ -280,9 +550,6 @@ patch_error_t ups_apply_patch(
    data.patch_length    = patchlength;
    data.source_length   = sourcelength;
    data.target_length   = *targetlength;
-   data.patch_checksum  = ~0;
-   data.source_checksum = ~0;
-   data.target_checksum = ~0;
 
    if (data.patch_length < 18) 
       return PATCH_PATCH_INVALID;
@@ -307,53 +574,51 @@ patch_error_t ups_apply_patch(
       return PATCH_TARGET_TOO_SMALL;
    data.target_length = *targetlength;
 
+   patch_crc_start(&crc, sourcedata, sourcelength,
+         patchdata, patchlength - 4, targetdata);
+
    while (data.patch_offset < data.patch_length - 12) 
    {
-      unsigned length = ups_decode(&data);
-      while (length--) 
-         ups_target_write(&data, ups_source_read(&data));
-      while (true) 
-      {
-         uint8_t patch_xor = ups_patch_read(&data);
-         ups_target_write(&data, patch_xor ^ ups_source_read(&data));
-         if (patch_xor == 0)
-            break;
-      }
+      ups_copy(&data, ups_decode(&data));
+      ups_xor(&data);
+      patch_crc_progress(&crc, min(data.target_offset, data.target_length));
    }
 
-   while (data.source_offset < data.source_length) 
-      ups_target_write(&data, ups_source_read(&data));
-   while (data.target_offset < data.target_length) 
-      ups_target_write(&data, ups_source_read(&data));
-
+   ups_copy(&data, data.source_length - data.source_offset);
+   if (data.target_offset < data.target_length)
+      ups_copy(&data, data.target_length - data.target_offset);
 
    for (i = 0; i < 4; i++) 
       source_read_checksum |= ups_patch_read(&data) << (i * 8);
    for (i = 0; i < 4; i++) 
       target_read_checksum |= ups_patch_read(&data) << (i * 8);
 
-   patch_result_checksum = ~data.patch_checksum;
-   data.source_checksum  = ~data.source_checksum;
-   data.target_checksum  = ~data.target_checksum;
+   patch_checked = data.patch_offset;
 
    for (i = 0; i < 4; i++) 
       patch_read_checksum |= ups_patch_read(&data) << (i * 8);
 
+   patch_crc_finish(&crc, min(data.target_offset, data.target_length));
+
+   /* Malformed patches end early or late, check what was read. */
+   patch_result_checksum = patch_checked == patchlength - 4 ? crc.patch_crc
+      : patch_crc_calculate(0, patchdata, patch_checked);
+
    if (patch_result_checksum != patch_read_checksum) 
       return PATCH_PATCH_INVALID;
 
-   if (data.source_checksum == source_read_checksum
+   if (crc.source_crc == source_read_checksum
          && data.source_length == source_read_length) 
    {
-      if (data.target_checksum == target_read_checksum
+      if (crc.target_crc == target_read_checksum
             && data.target_length == target_read_length) 
          return PATCH_SUCCESS;
       return PATCH_TARGET_INVALID;
    } 
-   else if (data.source_checksum == target_read_checksum
+   else if (crc.source_crc == target_read_checksum
          && data.source_length == target_read_length) 
    {
-      if (data.target_checksum == source_read_checksum
+      if (crc.target_crc == source_read_checksum
             && data.target_length == source_read_length) 
          return PATCH_SUCCESS;
       return PATCH_TARGET_INVALID;
@@ -368,6 +633,7 @@ patch_error_t ips_apply_patch(
       uint8_t *targetdata, size_t *targetlength)
 {
    uint32_t offset = 5;
+   size_t capacity = *targetlength;
 
    if (patchlen < 8 ||
          patchdata[0] != 'P' ||
@@ -377,6 +643,9 @@ patch_error_t ips_apply_patch(
          patchdata[4] != 'H')
       return PATCH_PATCH_INVALID;
 
+   if (sourcelength > capacity)
+      return PATCH_TARGET_TOO_SMALL;
+
    memcpy(targetdata, sourcedata, sourcelength);
 
    *targetlength = sourcelength;
@@ -417,9 +686,12 @@ patch_error_t ips_apply_patch(
       {
          if (offset > patchlen - length)
             break;
+         if (address + length > capacity)
+            return PATCH_TARGET_TOO_SMALL;
 
-         while (length--)
-            targetdata[address++] = patchdata[offset++];
+         memcpy(targetdata + address, patchdata + offset, length);
+         address += length;
+         offset  += length;
       }
       else /* RLE */
       {
@@ -431,9 +703,11 @@ patch_error_t ips_apply_patch(
 
          if (length == 0) /* Illegal */
             break;
+         if (address + length > capacity)
+            return PATCH_TARGET_TOO_SMALL;
 
-         while (length--)
-            targetdata[address++] = patchdata[offset];
+         memset(targetdata + address, patchdata[offset], length);
+         address += length;
 
          offset++;
       }
@@ -445,6 +719,58 @@ patch_error_t ips_apply_patch(
    return PATCH_PATCH_INVALID;
 }
 
+/**
+ * patch_file_open:
+ * @path                 : Path to the patch file.
+ * @data                 : Contents of the file.
+ * @size                 : Size of the file.
+ *
+ * Maps the patch file into memory, or reads it where
+ * mmap() is unavailable. Release with patch_file_close().
+ *
+ * Returns: true on success, otherwise false.
+ **/
+static bool patch_file_open(const char *path, void **data, ssize_t *size)
+{
+#ifdef HAVE_MMAP
+   struct stat buf;
+   void *map = MAP_FAILED;
+   int fd    = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return false;
+
+   if (fstat(fd, &buf) == 0 && buf.st_size > 0)
+      map = mmap(NULL, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+
+   if (map == MAP_FAILED)
+      return false;
+
+   *data = map;
+   *size = buf.st_size;
+   return true;
+#else
+   if (!read_file(path, data, size))
+      return false;
+   if (*size < 0)
+   {
+      free(*data);
+      return false;
+   }
+   return true;
+#endif
+}
+
+static void patch_file_close(void *data, ssize_t size)
+{
+#ifdef HAVE_MMAP
+   munmap(data, size);
+#else
+   free(data);
+#endif
+}
+
 static bool apply_patch_content(uint8_t **buf,
       ssize_t *size, const char *patch_desc, const char *patch_path,
       patch_func_t func)
@@ -458,12 +784,7 @@ static bool apply_patch_content(uint8_t **buf,
    ssize_t ret_size         = *size;
    uint8_t *ret_buf         = *buf;
    
-   if (!read_file(patch_path, &patch_data, &patch_size))
-      return false;
-   if (patch_size < 0)
-      return false;
-
-   if (!path_file_exists(patch_path))
+   if (!patch_file_open(patch_path, &patch_data, &patch_size))
       return false;
 
    RARCH_LOG("Found %s file in \"%s\", attempting to patch ...\n",
@@ -491,20 +812,22 @@ static bool apply_patch_content(uint8_t **buf,
       RARCH_ERR("Failed to patch %s: Error #%u\n", patch_desc,
             (unsigned)err);
 
+   /* The caller owns the source buffer, it may be mapped. */
    if (success)
    {
-      free(ret_buf);
       *buf = patched_content;
       *size = target_size;
    }
+   else
+      free(patched_content);
 
-   free(patch_data);
+   patch_file_close(patch_data, patch_size);
    return true;
 
 error:
    *buf = ret_buf;
    *size = ret_size;
-   free(patch_data);
+   patch_file_close(patch_data, patch_size);
 
    return false;
 }
@@ -556,21 +879,27 @@ static bool try_ips_patch(uint8_t **buf, ssize_t *size)
  * @buf          : buffer of the content file.
  * @size         : size   of the content file.
  *
- * Apply patch to the content file in-memory.
+ * Apply patch to the content file in-memory. On success @buf
+ * points to a newly allocated buffer; the original one is left
+ * alone for the caller to release.
  *
+ * Returns: true if @buf was replaced by patched content.
  **/
-void patch_content(uint8_t **buf, ssize_t *size)
+bool patch_content(uint8_t **buf, ssize_t *size)
 {
    global_t *global = global_get_ptr();
+   uint8_t *source  = *buf;
 
    if (global->ips_pref + global->bps_pref + global->ups_pref > 1)
    {
       RARCH_WARN("Several patches are explicitly defined, ignoring all ...\n");
-      return;
+      return false;
    }
 
    if (!try_ips_patch(buf, size) && !try_bps_patch(buf, size) && !try_ups_patch(buf, size))
    {
       RARCH_LOG("Did not find a valid content patch.\n");
    }
+
+   return *buf != source;
 }
@@ -19,6 +19,8 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/types.h>
+#include <boolean.h>
 
 /* BPS/UPS/IPS implementation from bSNES (nall::).
  * Modified for RetroArch. */
@@ -63,9 +65,12 @@ patch_error_t ips_apply_patch(
  * @buf          : buffer of the content file.
  * @size         : size   of the content file.
  *
- * Apply patch to the content file in-memory.
+ * Apply patch to the content file in-memory. On success @buf
+ * points to a newly allocated buffer; the original one is left
+ * alone for the caller to release.
  *
+ * Returns: true if @buf was replaced by patched content.
  **/
-void patch_content(uint8_t **buf, ssize_t *size);
+bool patch_content(uint8_t **buf, ssize_t *size);
 
 #endif
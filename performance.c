@@ -28,6 +28,17 @@
 #include <unistd.h>
 #endif
 
+#include <retro_miscellaneous.h>
+
+#if defined(_POSIX_PRIORITY_SCHEDULING) && (_POSIX_PRIORITY_SCHEDULING > 0)
+#include <sched.h>
+#endif
+
+#if defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0)
+#include <errno.h>
+#include <time.h>
+#endif
+
 #if defined(_WIN32) && !defined(_XBOX)
 #include <windows.h>
 #include <intrin.h>
@@ -264,6 +275,55 @@ retro_time_t rarch_get_time_usec(void)
 #endif
 }
 
+#if defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0) && defined(_POSIX_MONOTONIC_CLOCK) && !defined(__MACH__)
+#define HAVE_CLOCK_NANOSLEEP
+#endif
+
+/**
+ * rarch_wait_until_usec:
+ * @deadline           : Time to wait for, as returned
+ *                       by rarch_get_time_usec().
+ * @spin_usec          : How long before @deadline to stop
+ *                       sleeping and start spinning.
+ *
+ * Sleeps until @spin_usec before @deadline, then yields
+ * the CPU until @deadline has passed. Timer sleeps wake up
+ * late by a variable amount; spinning through the last
+ * stretch trades some CPU time for wake-up precision.
+ **/
+void rarch_wait_until_usec(retro_time_t deadline, unsigned spin_usec)
+{
+   retro_time_t wake = deadline - spin_usec;
+   retro_time_t now  = rarch_get_time_usec();
+
+   if (wake > now)
+   {
+#ifdef HAVE_CLOCK_NANOSLEEP
+      /* Absolute deadlines don't accumulate error when a
+       * signal interrupts the sleep and it has to restart. */
+      struct timespec tv;
+      tv.tv_sec  = wake / 1000000;
+      tv.tv_nsec = (wake % 1000000) * 1000;
+
+      while (clock_nanosleep(CLOCK_MONOTONIC,
+               TIMER_ABSTIME, &tv, NULL) == EINTR);
+#else
+      /* Round down, rarch_sleep() has millisecond granularity. */
+      if ((wake - now) >= 1000)
+         rarch_sleep((unsigned)((wake - now) / 1000));
+#endif
+   }
+
+   while (rarch_get_time_usec() < deadline)
+   {
+#if defined(_WIN32) && !defined(_XBOX)
+      SwitchToThread();
+#elif defined(_POSIX_PRIORITY_SCHEDULING) && (_POSIX_PRIORITY_SCHEDULING > 0)
+      sched_yield();
+#endif
+   }
+}
+
 #if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
 #define CPU_X86
 #endif
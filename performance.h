@@ -71,6 +71,17 @@ retro_perf_tick_t rarch_get_perf_counter(void);
  **/
 retro_time_t rarch_get_time_usec(void);
 
+/**
+ * rarch_wait_until_usec:
+ * @deadline           : Time to wait for, as returned
+ *                       by rarch_get_time_usec().
+ * @spin_usec          : How long before @deadline to stop
+ *                       sleeping and start spinning.
+ *
+ * Waits until @deadline with better than timer precision.
+ **/
+void rarch_wait_until_usec(retro_time_t deadline, unsigned spin_usec);
+
 void rarch_perf_register(struct retro_perf_counter *perf);
 
 /* Same as rarch_perf_register, just for libretro cores. */
@@ -50,6 +50,7 @@ extern "C" {
 #include <gfx/scaler/scaler.h>
 #include <file/config_file.h>
 #include "../../audio/audio_utils.h"
+#include "../../performance.h"
 #include "../record_driver.h"
 #include <assert.h>
 
@@ -62,13 +63,24 @@ extern "C" {
 #define av_frame_free avcodec_free_frame
 #endif
 
+/* Number of scaled frames which can be in flight between
+ * the scale stage and the video encoder stage. */
+#define FF_CONV_FRAMES 4
+
 struct ff_video_info
 {
    AVCodecContext *codec;
    AVCodec *encoder;
 
-   AVFrame *conv_frame;
-   uint8_t *conv_frame_buf;
+   /* Ring of scaled frames. Written by the scale stage,
+    * consumed in order by the video encoder stage. */
+   AVFrame *conv_frames[FF_CONV_FRAMES];
+   uint8_t *conv_frame_bufs[FF_CONV_FRAMES];
+   unsigned conv_read;
+   unsigned conv_write;
+   unsigned conv_count;
+   /* Last slot written by the scale stage, -1 if none. */
+   int conv_last;
    int64_t frame_cnt;
 
    uint8_t *outbuf;
@@ -138,6 +150,16 @@ struct ff_muxer_info
    AVStream *vstream;
 };
 
+/* Per-stage pipeline statistics, logged when recording is finalized. */
+struct ff_stage_stats
+{
+   const char *ident;
+   retro_time_t busy_usec;
+   uint64_t runs;
+   uint64_t depth_accum;
+   unsigned depth_max;
+};
+
 struct ff_config_param
 {
    config_file_t *conf;
@@ -172,16 +194,30 @@ typedef struct ffmpeg
    
    struct ffemu_params params;
 
-   scond_t *cond;
-   slock_t *cond_lock;
+   struct ff_stage_stats scale_stats;
+   struct ff_stage_stats video_stats;
+   struct ff_stage_stats audio_stats;
+
+   /* Protects the input FIFOs. cond is broadcast whenever
+    * one of them is written to or read from. */
    slock_t *lock;
+   scond_t *cond;
    fifo_buffer_t *audio_fifo;
    fifo_buffer_t *video_fifo;
    fifo_buffer_t *attr_fifo;
-   sthread_t *thread;
+
+   /* Protects the scaled frame ring. */
+   slock_t *conv_lock;
+   scond_t *conv_cond;
+
+   /* Serializes access to the muxer between encoder stages. */
+   slock_t *mux_lock;
+
+   sthread_t *scale_thread;
+   sthread_t *video_thread;
+   sthread_t *audio_thread;
 
    volatile bool alive;
-   volatile bool can_sleep;
 } ffmpeg_t;
 
 static bool ffmpeg_codec_has_sample_format(enum AVSampleFormat fmt,
@@ -357,6 +393,7 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
 
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
+   unsigned i;
    struct ff_config_param *params = &handle->config;
    struct ff_video_info *video    = &handle->video;
    struct ffemu_params *param     = &handle->params;
@@ -454,7 +491,10 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
          param->aspect_ratio * param->out_height / param->out_width, 255);
    video->codec->pix_fmt             = video->pix_fmt;
 
+   /* Let the encoder spread work over frames or slices,
+    * whichever it supports. threads = 0 lets libavcodec decide. */
    video->codec->thread_count = params->threads;
+   video->codec->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
    if (params->video_qscale)
    {
@@ -480,10 +520,19 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
 
    size_t size = avpicture_get_size(video->pix_fmt, param->out_width,
          param->out_height);
-   video->conv_frame_buf = (uint8_t*)av_malloc(size);
-   video->conv_frame = av_frame_alloc();
-   avpicture_fill((AVPicture*)video->conv_frame, video->conv_frame_buf,
-         video->pix_fmt, param->out_width, param->out_height);
+
+   for (i = 0; i < FF_CONV_FRAMES; i++)
+   {
+      video->conv_frame_bufs[i] = (uint8_t*)av_malloc(size);
+      video->conv_frames[i]     = av_frame_alloc();
+      if (!video->conv_frame_bufs[i] || !video->conv_frames[i])
+         return false;
+
+      avpicture_fill((AVPicture*)video->conv_frames[i],
+            video->conv_frame_bufs[i], video->pix_fmt,
+            param->out_width, param->out_height);
+   }
+   video->conv_last = -1;
 
    return true;
 }
@@ -495,7 +544,7 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
 
    params->out_pix_fmt = PIX_FMT_NONE;
    params->scale_factor = 1;
-   params->threads = 1;
+   params->threads = 0;
    params->frame_drop_ratio = 1;
 
    if (!config)
@@ -615,48 +664,68 @@ static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
 
 #define MAX_FRAMES 32
 
-static void ffmpeg_thread(void *data);
+static void ffmpeg_scale_thread(void *data);
+static void ffmpeg_video_thread(void *data);
+static void ffmpeg_audio_thread(void *data);
 
 static bool init_thread(ffmpeg_t *handle)
 {
-   handle->lock = slock_new();
-   handle->cond_lock = slock_new();
-   handle->cond = scond_new();
+   handle->lock      = slock_new();
+   handle->cond      = scond_new();
+   handle->conv_lock = slock_new();
+   handle->conv_cond = scond_new();
+   handle->mux_lock  = slock_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
    handle->attr_fifo = fifo_new(sizeof(struct ffemu_video_data) * MAX_FRAMES);
    handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
             handle->video.pix_size * MAX_FRAMES);
 
+   handle->scale_stats.ident = "scale";
+   handle->video_stats.ident = "video encode";
+   handle->audio_stats.ident = "audio encode";
+
    handle->alive = true;
-   handle->can_sleep = true;
-   handle->thread = sthread_create(ffmpeg_thread, handle);
 
-   assert(handle->lock && handle->cond_lock &&
-      handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+   /* Scaling, video encoding and audio encoding run as separate
+    * stages, so a slow encoder does not hold back scaling of the
+    * next frame and vice versa. Both encoders meet at the muxer. */
+   handle->scale_thread = sthread_create(ffmpeg_scale_thread, handle);
+   handle->video_thread = sthread_create(ffmpeg_video_thread, handle);
+   if (handle->config.audio_enable)
+      handle->audio_thread = sthread_create(ffmpeg_audio_thread, handle);
+
+   assert(handle->lock && handle->cond &&
+      handle->conv_lock && handle->conv_cond && handle->mux_lock &&
+      handle->audio_fifo && handle->attr_fifo && handle->video_fifo &&
+      handle->scale_thread && handle->video_thread &&
+      (handle->audio_thread || !handle->config.audio_enable));
 
    return true;
 }
 
 static void deinit_thread(ffmpeg_t *handle)
 {
-   if (!handle->thread)
+   if (!handle->scale_thread)
       return;
 
-   slock_lock(handle->cond_lock);
+   slock_lock(handle->lock);
+   slock_lock(handle->conv_lock);
    handle->alive = false;
-   handle->can_sleep = false;
-   slock_unlock(handle->cond_lock);
+   slock_unlock(handle->conv_lock);
+   slock_unlock(handle->lock);
 
-   scond_signal(handle->cond);
-   sthread_join(handle->thread);
+   scond_broadcast(handle->cond);
+   scond_broadcast(handle->conv_cond);
 
-   slock_free(handle->lock);
-   slock_free(handle->cond_lock);
-   scond_free(handle->cond);
+   sthread_join(handle->scale_thread);
+   sthread_join(handle->video_thread);
+   if (handle->audio_thread)
+      sthread_join(handle->audio_thread);
 
-   handle->thread = NULL;
+   handle->scale_thread = NULL;
+   handle->video_thread = NULL;
+   handle->audio_thread = NULL;
 }
 
 static void deinit_thread_buf(ffmpeg_t *handle)
@@ -678,10 +747,28 @@ static void deinit_thread_buf(ffmpeg_t *handle)
       fifo_free(handle->video_fifo);
       handle->video_fifo = NULL;
    }
+
+   if (handle->lock)
+      slock_free(handle->lock);
+   if (handle->cond)
+      scond_free(handle->cond);
+   if (handle->conv_lock)
+      slock_free(handle->conv_lock);
+   if (handle->conv_cond)
+      scond_free(handle->conv_cond);
+   if (handle->mux_lock)
+      slock_free(handle->mux_lock);
+
+   handle->lock      = NULL;
+   handle->cond      = NULL;
+   handle->conv_lock = NULL;
+   handle->conv_cond = NULL;
+   handle->mux_lock  = NULL;
 }
 
 static void ffmpeg_free(void *data)
 {
+   unsigned i;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    if (!handle)
       return;
@@ -703,8 +790,11 @@ static void ffmpeg_free(void *data)
       av_free(handle->video.codec);
    }
 
-   av_frame_free(&handle->video.conv_frame);
-   av_free(handle->video.conv_frame_buf);
+   for (i = 0; i < FF_CONV_FRAMES; i++)
+   {
+      av_frame_free(&handle->video.conv_frames[i]);
+      av_free(handle->video.conv_frame_bufs[i]);
+   }
 
    scaler_ctx_gen_reset(&handle->video.scaler);
 
@@ -767,6 +857,35 @@ error:
    return NULL;
 }
 
+static void ffmpeg_stage_begin(struct ff_stage_stats *stats,
+      unsigned depth, retro_time_t *start)
+{
+   stats->depth_accum += depth;
+   if (depth > stats->depth_max)
+      stats->depth_max = depth;
+   *start = rarch_get_time_usec();
+}
+
+static void ffmpeg_stage_end(struct ff_stage_stats *stats,
+      retro_time_t start)
+{
+   stats->busy_usec += rarch_get_time_usec() - start;
+   stats->runs++;
+}
+
+static void ffmpeg_stage_log(const struct ff_stage_stats *stats)
+{
+   if (!stats->runs)
+      return;
+
+   RARCH_LOG("[FFmpeg]: Stage %s: %llu runs, avg %.1f us, "
+         "avg queue depth %.2f, max queue depth %u.\n",
+         stats->ident, (unsigned long long)stats->runs,
+         (double)stats->busy_usec / stats->runs,
+         (double)stats->depth_accum / stats->runs,
+         stats->depth_max);
+}
+
 static bool ffmpeg_push_video(void *data,
       const struct ffemu_video_data *video_data)
 {
@@ -786,34 +905,17 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
-   for (;;)
+   slock_lock(handle->lock);
+   while (handle->alive &&
+         fifo_write_avail(handle->attr_fifo) < sizeof(*video_data))
+      scond_wait(handle->cond, handle->lock);
+
+   if (!handle->alive)
    {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->attr_fifo);
       slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
-
-      if (avail >= sizeof(*video_data))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
-
-      slock_unlock(handle->cond_lock);
+      return false;
    }
 
-   slock_lock(handle->lock);
-
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
     */
@@ -832,7 +934,7 @@ static bool ffmpeg_push_video(void *data,
             (const uint8_t*)video_data->data + offset, attr_data.pitch);
 
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+   scond_broadcast(handle->cond);
 
    return true;
 }
@@ -848,42 +950,38 @@ static bool ffmpeg_push_audio(void *data,
    if (!handle->config.audio_enable)
       return true;
 
-   for (;;)
+   slock_lock(handle->lock);
+   while (handle->alive && fifo_write_avail(handle->audio_fifo) <
+         audio_data->frames * handle->params.channels * sizeof(int16_t))
+      scond_wait(handle->cond, handle->lock);
+
+   if (!handle->alive)
    {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->audio_fifo);
       slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
-
-      if (avail >= audio_data->frames * handle->params.channels
-            * sizeof(int16_t))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
-
-      slock_unlock(handle->cond_lock);
+      return false;
    }
 
-   slock_lock(handle->lock);
    fifo_write(handle->audio_fifo, audio_data->data,
          audio_data->frames * handle->params.channels * sizeof(int16_t));
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+   scond_broadcast(handle->cond);
 
    return true;
 }
 
+static bool ffmpeg_mux_packet(ffmpeg_t *handle, AVPacket *pkt)
+{
+   int ret;
+
+   if (handle->mux_lock)
+      slock_lock(handle->mux_lock);
+   ret = av_interleaved_write_frame(handle->muxer.ctx, pkt);
+   if (handle->mux_lock)
+      slock_unlock(handle->mux_lock);
+
+   return ret >= 0;
+}
+
 static bool encode_video(ffmpeg_t *handle, AVPacket *pkt, AVFrame *frame)
 {
    int got_packet = 0;
@@ -919,7 +1017,7 @@ static bool encode_video(ffmpeg_t *handle, AVPacket *pkt, AVFrame *frame)
    return true;
 }
 
-static void ffmpeg_scale_input(ffmpeg_t *handle,
+static void ffmpeg_scale_input(ffmpeg_t *handle, AVFrame *out,
       const struct ffemu_video_data *data)
 {
    /* Attempt to preserve more information if we scale down. */
@@ -936,8 +1034,7 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
 
       int linesize = data->pitch;
       sws_scale(handle->video.sws, (const uint8_t* const*)&data->data,
-            &linesize, 0, data->height, handle->video.conv_frame->data,
-            handle->video.conv_frame->linesize);
+            &linesize, 0, data->height, out->data, out->linesize);
    }
    else
    {
@@ -953,33 +1050,59 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
 
          handle->video.scaler.out_width  = handle->params.out_width;
          handle->video.scaler.out_height = handle->params.out_height;
-         handle->video.scaler.out_stride = 
-            handle->video.conv_frame->linesize[0];
+         handle->video.scaler.out_stride = out->linesize[0];
 
          scaler_ctx_gen_filter(&handle->video.scaler);
       }
 
-      scaler_ctx_scale(&handle->video.scaler,
-            handle->video.conv_frame->data[0], data->data);
+      scaler_ctx_scale(&handle->video.scaler, out->data[0], data->data);
    }
 }
 
-static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
+/**
+ * ffmpeg_scale_frame:
+ * @handle             : FFmpeg handle.
+ * @data               : Packed input frame.
+ *
+ * Scales @data into the next free slot of the scaled frame ring.
+ * The caller must ensure there is a free slot. Duplicate frames
+ * repeat the previously scaled frame.
+ *
+ * Returns: true if the slot was written, false for a duplicate
+ * frame with no previous frame to repeat.
+ **/
+static bool ffmpeg_scale_frame(ffmpeg_t *handle,
       const struct ffemu_video_data *data)
 {
-   AVPacket pkt;
+   struct ff_video_info *video = &handle->video;
+   AVFrame *out                = video->conv_frames[video->conv_write];
 
    if (!data->is_dupe)
-      ffmpeg_scale_input(handle, data);
+      ffmpeg_scale_input(handle, out, data);
+   else if (video->conv_last >= 0)
+      av_picture_copy((AVPicture*)out,
+            (const AVPicture*)video->conv_frames[video->conv_last],
+            video->pix_fmt, handle->params.out_width,
+            handle->params.out_height);
+   else
+      return false;
 
-   handle->video.conv_frame->pts = handle->video.frame_cnt;
+   video->conv_last = video->conv_write;
+   return true;
+}
 
-   if (!encode_video(handle, &pkt, handle->video.conv_frame))
+static bool ffmpeg_encode_video_frame(ffmpeg_t *handle, AVFrame *frame)
+{
+   AVPacket pkt;
+
+   frame->pts = handle->video.frame_cnt;
+
+   if (!encode_video(handle, &pkt, frame))
       return false;
 
    if (pkt.size)
    {
-      if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+      if (!ffmpeg_mux_packet(handle, &pkt))
          return false;
    }
 
@@ -1208,7 +1331,7 @@ static bool ffmpeg_push_audio_thread(ffmpeg_t *handle,
 
       if (pkt.size)
       {
-         if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+         if (!ffmpeg_mux_packet(handle, &pkt))
             return false;
       }
    }
@@ -1236,7 +1359,7 @@ static void ffmpeg_flush_audio(ffmpeg_t *handle, void *audio_buf,
    {
       AVPacket pkt;
       if (!encode_audio(handle, &pkt, true) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_mux_packet(handle, &pkt))
          break;
    }
 }
@@ -1247,14 +1370,16 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
    {
       AVPacket pkt;
       if (!encode_video(handle, &pkt, NULL) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_mux_packet(handle, &pkt))
          break;
    }
 }
 
+/* Called with all pipeline threads stopped. */
 static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
    bool did_work;
+   struct ff_video_info *video = &handle->video;
    void *video_buf = av_malloc(2 * handle->params.fb_width * 
          handle->params.fb_height * handle->video.pix_size);
    size_t audio_buf_size = handle->config.audio_enable ? 
@@ -1264,6 +1389,15 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    if (audio_buf_size)
       audio_buf = av_malloc(audio_buf_size);
+
+   /* Frames already scaled come before anything left in the FIFOs. */
+   while (video->conv_count)
+   {
+      ffmpeg_encode_video_frame(handle, video->conv_frames[video->conv_read]);
+      video->conv_read = (video->conv_read + 1) % FF_CONV_FRAMES;
+      video->conv_count--;
+   }
+
    /* Try pushing data in an interleaving pattern to 
     * ease the work of the muxer a bit. */
 
@@ -1294,7 +1428,13 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          fifo_read(handle->video_fifo, video_buf, 
                attr_buf.height * attr_buf.pitch);
          attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
+
+         if (ffmpeg_scale_frame(handle, &attr_buf))
+         {
+            ffmpeg_encode_video_frame(handle,
+                  video->conv_frames[video->conv_write]);
+            video->conv_write = (video->conv_write + 1) % FF_CONV_FRAMES;
+         }
 
          did_work = true;
       }
@@ -1328,12 +1468,19 @@ static bool ffmpeg_finalize(void *data)
    /* Write final data. */
    av_write_trailer(handle->muxer.ctx);
 
+   ffmpeg_stage_log(&handle->scale_stats);
+   ffmpeg_stage_log(&handle->video_stats);
+   ffmpeg_stage_log(&handle->audio_stats);
+
    return true;
 }
 
-static void ffmpeg_thread(void *data)
+/* Scale stage. Reads packed frames from the input FIFO and
+ * converts them into the scaled frame ring. */
+static void ffmpeg_scale_thread(void *data)
 {
    ffmpeg_t *ff = (ffmpeg_t*)data;
+   struct ff_video_info *video = &ff->video;
 
    /* For some reason, FFmpeg has a tendency to crash 
     * if we don't overallocate a bit. */
@@ -1341,70 +1488,131 @@ static void ffmpeg_thread(void *data)
          ff->params.fb_height * ff->video.pix_size);
    assert(video_buf);
 
-   size_t audio_buf_size = ff->config.audio_enable ? 
-      (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
-   void *audio_buf = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
-
-   while (ff->alive)
+   for (;;)
    {
+      retro_time_t start;
+      unsigned depth;
+      bool scaled;
       struct ffemu_video_data attr_buf;
 
-      bool avail_video = false;
-      bool avail_audio = false;
+      /* Only the scale stage fills the ring, so once a slot
+       * is free it stays free until we commit it. */
+      slock_lock(ff->conv_lock);
+      while (ff->alive && video->conv_count == FF_CONV_FRAMES)
+         scond_wait(ff->conv_cond, ff->conv_lock);
+      slock_unlock(ff->conv_lock);
 
       slock_lock(ff->lock);
-      if (fifo_read_avail(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
+      while (ff->alive && fifo_read_avail(ff->attr_fifo) < sizeof(attr_buf))
+         scond_wait(ff->cond, ff->lock);
 
-      if (ff->config.audio_enable)
-         if (fifo_read_avail(ff->audio_fifo) >= audio_buf_size)
-            avail_audio = true;
+      if (!ff->alive)
+      {
+         slock_unlock(ff->lock);
+         break;
+      }
+
+      depth = fifo_read_avail(ff->attr_fifo) / sizeof(attr_buf);
+      fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
+      fifo_read(ff->video_fifo, video_buf,
+            attr_buf.height * attr_buf.pitch);
       slock_unlock(ff->lock);
+      scond_broadcast(ff->cond);
 
-      if (!avail_video && !avail_audio)
-      {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
+      attr_buf.data = video_buf;
 
-         slock_unlock(ff->cond_lock);
-      }
+      ffmpeg_stage_begin(&ff->scale_stats, depth, &start);
+      scaled = ffmpeg_scale_frame(ff, &attr_buf);
+      ffmpeg_stage_end(&ff->scale_stats, start);
 
-      if (avail_video)
-      {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+      if (!scaled)
+         continue;
 
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
+      slock_lock(ff->conv_lock);
+      video->conv_write = (video->conv_write + 1) % FF_CONV_FRAMES;
+      video->conv_count++;
+      slock_unlock(ff->conv_lock);
+      scond_broadcast(ff->conv_cond);
+   }
+
+   av_free(video_buf);
+}
+
+/* Video encoder stage. Encodes scaled frames in order and
+ * hands packets to the muxer. */
+static void ffmpeg_video_thread(void *data)
+{
+   ffmpeg_t *ff = (ffmpeg_t*)data;
+   struct ff_video_info *video = &ff->video;
+
+   for (;;)
+   {
+      retro_time_t start;
+      unsigned depth;
+
+      slock_lock(ff->conv_lock);
+      while (ff->alive && !video->conv_count)
+         scond_wait(ff->conv_cond, ff->conv_lock);
+
+      if (!ff->alive)
+      {
+         slock_unlock(ff->conv_lock);
+         break;
       }
+      depth = video->conv_count;
+      slock_unlock(ff->conv_lock);
+
+      ffmpeg_stage_begin(&ff->video_stats, depth, &start);
+      ffmpeg_encode_video_frame(ff, video->conv_frames[video->conv_read]);
+      ffmpeg_stage_end(&ff->video_stats, start);
+
+      slock_lock(ff->conv_lock);
+      video->conv_read = (video->conv_read + 1) % FF_CONV_FRAMES;
+      video->conv_count--;
+      slock_unlock(ff->conv_lock);
+      scond_broadcast(ff->conv_cond);
+   }
+}
+
+/* Audio encoder stage. Resamples and encodes whole codec
+ * frames and hands packets to the muxer. */
+static void ffmpeg_audio_thread(void *data)
+{
+   ffmpeg_t *ff = (ffmpeg_t*)data;
+   size_t audio_buf_size = ff->audio.codec->frame_size *
+      ff->params.channels * sizeof(int16_t);
+   void *audio_buf = av_malloc(audio_buf_size);
+   assert(audio_buf);
+
+   for (;;)
+   {
+      retro_time_t start;
+      unsigned depth;
+      struct ffemu_audio_data aud = {0};
 
-      if (avail_audio)
+      slock_lock(ff->lock);
+      while (ff->alive && fifo_read_avail(ff->audio_fifo) < audio_buf_size)
+         scond_wait(ff->cond, ff->lock);
+
+      if (!ff->alive)
       {
-         slock_lock(ff->lock);
-         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
          slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+         break;
+      }
 
-         struct ffemu_audio_data aud = {0};
-         aud.frames = ff->audio.codec->frame_size;
-         aud.data = audio_buf;
+      depth = fifo_read_avail(ff->audio_fifo) / audio_buf_size;
+      fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
+      slock_unlock(ff->lock);
+      scond_broadcast(ff->cond);
 
-         ffmpeg_push_audio_thread(ff, &aud, true);
-      }
+      aud.frames = ff->audio.codec->frame_size;
+      aud.data   = audio_buf;
+
+      ffmpeg_stage_begin(&ff->audio_stats, depth, &start);
+      ffmpeg_push_audio_thread(ff, &aud, true);
+      ffmpeg_stage_end(&ff->audio_stats, start);
    }
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -46,6 +46,8 @@
 #include "runloop_data.h"
 #include "performance.h"
 #include "cheats.h"
+#include "benchmark.h"
+#include "screenshot.h"
 #include "input/input_remapping.h"
 
 #include "git_version.h"
@@ -78,7 +80,12 @@ enum {
    RA_OPT_VERSION,
    RA_OPT_EOF_EXIT,
    RA_OPT_LOG_FILE,
-   RA_OPT_MAX_FRAMES
+   RA_OPT_MAX_FRAMES,
+   RA_OPT_PLAY_INPUT,
+   RA_OPT_RECORD_INPUT,
+   RA_OPT_BENCHMARK,
+   RA_OPT_SEEK,
+   RA_OPT_CHECKPOINT_INTERVAL
 };
 
 #include "config.features.h"
@@ -224,7 +231,18 @@ static void print_help(const char *arg0)
    puts("      --no-patch        Disables all forms of content patching.");
    puts("  -D, --detach          Detach " RETRO_FRONTEND " from the running console. Not relevant for all platforms.");
    puts("      --max-frames=NUMBER\n"
-        "                        Runs for the specified number of frames, then exits.\n");
+        "                        Runs for the specified number of frames, then exits.");
+   puts("      --play-input=FILE Plays back an input log recorded with --record-input.");
+   puts("      --record-input=FILE\n"
+        "                        Records the input of every port to an input log.");
+   puts("      --seek=FRAME      Starts input log playback at FRAME, loading the nearest\n"
+        "                        checkpoint and running the frames after it unthrottled.");
+   puts("      --checkpoint-interval=FRAMES\n"
+        "                        Frames between savestate checkpoints in recorded input\n"
+        "                        logs (default 600, 0 disables).");
+   puts("      --eof-exit        Exits when input log playback reaches the end.");
+   puts("      --benchmark=FILE  Runs unthrottled and writes per-frame timings as JSON\n"
+        "                        to FILE ('-' for stdout) on exit. Implies --eof-exit.\n");
 }
 
 static void set_basename(const char *path)
@@ -477,6 +495,13 @@ static void parse_input(int argc, char *argv[])
    *global->ips_name                     = '\0';
    *global->subsystem                    = '\0';
 
+   *global->movie.play_path              = '\0';
+   *global->movie.record_path            = '\0';
+   global->movie.eof_exit                = false;
+   global->movie.seek_frame              = 0;
+   global->movie.checkpoint_interval     = MOVIE_DEFAULT_CHECKPOINT_INTERVAL;
+   global->benchmark.enable              = false;
+
    if (argc < 2)
    {
       global->libretro_dummy             = true;
@@ -526,6 +551,11 @@ static void parse_input(int argc, char *argv[])
       { "subsystem",    1, &val, RA_OPT_SUBSYSTEM },
       { "max-frames",   1, &val, RA_OPT_MAX_FRAMES },
       { "eof-exit",     0, &val, RA_OPT_EOF_EXIT },
+      { "play-input",   1, &val, RA_OPT_PLAY_INPUT },
+      { "record-input", 1, &val, RA_OPT_RECORD_INPUT },
+      { "benchmark",    1, &val, RA_OPT_BENCHMARK },
+      { "seek",         1, &val, RA_OPT_SEEK },
+      { "checkpoint-interval", 1, &val, RA_OPT_CHECKPOINT_INTERVAL },
       { "version",      0, &val, RA_OPT_VERSION },
 #ifdef HAVE_FILE_LOGGER
       { "log-file",     1, &val, RA_OPT_LOG_FILE },
@@ -801,6 +831,33 @@ static void parse_input(int argc, char *argv[])
                   exit(0);
 
                case RA_OPT_EOF_EXIT:
+                  global->movie.eof_exit = true;
+                  break;
+
+               case RA_OPT_PLAY_INPUT:
+                  strlcpy(global->movie.play_path, optarg,
+                        sizeof(global->movie.play_path));
+                  break;
+
+               case RA_OPT_RECORD_INPUT:
+                  strlcpy(global->movie.record_path, optarg,
+                        sizeof(global->movie.record_path));
+                  break;
+
+               case RA_OPT_SEEK:
+                  global->movie.seek_frame = strtoull(optarg, NULL, 10);
+                  break;
+
+               case RA_OPT_CHECKPOINT_INTERVAL:
+                  global->movie.checkpoint_interval =
+                     strtoul(optarg, NULL, 10);
+                  break;
+
+               case RA_OPT_BENCHMARK:
+                  global->benchmark.enable = true;
+                  global->movie.eof_exit   = true;
+                  strlcpy(global->benchmark.report_path, optarg,
+                        sizeof(global->benchmark.report_path));
                   break;
 
                case RA_OPT_VERSION:
@@ -1187,6 +1244,15 @@ int rarch_main_init(int argc, char *argv[])
    validate_cpu_features();
    config_load();
 
+   if (global->benchmark.enable)
+   {
+      settings_t *settings = config_get_ptr();
+
+      /* Never block on the drivers, frames are timed as fast as they run. */
+      settings->video.vsync = false;
+      settings->audio.sync  = false;
+   }
+
    init_libretro_sym(global->libretro_dummy);
    init_system_info();
 
@@ -1206,6 +1272,7 @@ int rarch_main_init(int argc, char *argv[])
    event_command(EVENT_CMD_CHEATS_INIT);
 
    event_command(EVENT_CMD_SAVEFILES_INIT);
+   init_benchmark();
 #if defined(GEKKO) && defined(HW_RVL)
    {
       settings_t *settings = config_get_ptr();
@@ -1388,6 +1455,10 @@ void rarch_main_deinit(void)
 {
    global_t *global = global_get_ptr();
 
+   deinit_benchmark();
+   deinit_screenshot();
+
+   event_command(EVENT_CMD_MOVIE_DEINIT);
    event_command(EVENT_CMD_NETPLAY_DEINIT);
    event_command(EVENT_CMD_COMMAND_DEINIT);
 
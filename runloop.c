@@ -16,6 +16,8 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <file/file_path.h>
 #include <retro_inline.h>
 
@@ -29,7 +31,9 @@
 #include "retroarch.h"
 #include "runloop.h"
 #include "runloop_data.h"
+#include "file_ops.h"
 #include "preempt.h"
+#include "benchmark.h"
 
 #include "input/keyboard_line.h"
 #include "input/input_common.h"
@@ -42,13 +46,99 @@
 #include "netplay.h"
 #endif
 
+#if defined(HAVE_THREADS) && defined(_MSC_VER)
+#include <windows.h>
+#endif
+
 static struct runloop *g_runloop = NULL;
 static struct global *g_extern   = NULL;
 
-#ifdef HAVE_THREADS
-static slock_t *mq_lock = NULL;
+#if !defined(HAVE_THREADS)
+#define MSG_QUEUE_LOAD(ptr) (*(ptr))
+#define MSG_QUEUE_STORE(ptr, val) (*(ptr) = (val))
+#define MSG_QUEUE_CAS(ptr, old, val) \
+   ((*(ptr) == (old)) ? ((*(ptr) = (val)), true) : false)
+#elif defined(_MSC_VER)
+#define MSG_QUEUE_LOAD(ptr) msg_queue_load_msvc(ptr)
+#define MSG_QUEUE_STORE(ptr, val) (MemoryBarrier(), *(ptr) = (val))
+#define MSG_QUEUE_CAS(ptr, old, val) \
+   (InterlockedCompareExchange((volatile LONG*)(ptr), \
+      (LONG)(val), (LONG)(old)) == (LONG)(old))
+static INLINE unsigned msg_queue_load_msvc(volatile unsigned *ptr)
+{
+   unsigned val = *ptr;
+   MemoryBarrier();
+   return val;
+}
+#elif defined(__ATOMIC_ACQUIRE)
+#define MSG_QUEUE_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define MSG_QUEUE_STORE(ptr, val) \
+   __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define MSG_QUEUE_CAS(ptr, old, val) \
+   __sync_bool_compare_and_swap((ptr), (old), (val))
+#else
+#define MSG_QUEUE_LOAD(ptr) msg_queue_load_sync(ptr)
+#define MSG_QUEUE_STORE(ptr, val) (__sync_synchronize(), *(ptr) = (val))
+#define MSG_QUEUE_CAS(ptr, old, val) \
+   __sync_bool_compare_and_swap((ptr), (old), (val))
+static INLINE unsigned msg_queue_load_sync(volatile unsigned *ptr)
+{
+   unsigned val = *ptr;
+   __sync_synchronize();
+   return val;
+}
 #endif
 
+/* OSD messages are handed from any thread to the main thread
+ * through a bounded lock-free ring of preallocated slots. Each
+ * slot's sequence number says whether it is free for the producer
+ * at that position or filled for the consumer. The main thread
+ * drains the ring into a small table of active messages, where
+ * pushes with the same id replace each other. */
+#define MSG_QUEUE_SLOTS   64
+#define MSG_QUEUE_ACTIVE  8
+#define MSG_QUEUE_MSG_LEN 512
+
+/* Set on ids derived from message text, keeps them
+ * apart from enum rarch_msg_queue_id. */
+#define MSG_QUEUE_ID_TEXT 0x80000000U
+
+struct msg_queue_slot
+{
+   volatile unsigned seq;
+   uint32_t id;
+   unsigned prio;
+   unsigned duration;
+   bool flush;
+   size_t len;
+   char msg[MSG_QUEUE_MSG_LEN];
+};
+
+struct msg_queue_active
+{
+   uint32_t id;
+   unsigned prio;
+   unsigned duration;
+   unsigned order;
+   size_t len;
+   char msg[MSG_QUEUE_MSG_LEN];
+};
+
+static struct
+{
+   struct msg_queue_slot slots[MSG_QUEUE_SLOTS];
+   volatile unsigned head;
+   volatile bool alive;
+   bool ready;
+
+   /* Main thread only. */
+   unsigned tail;
+   unsigned order;
+   unsigned active_count;
+   struct msg_queue_active active[MSG_QUEUE_ACTIVE];
+   char current[MSG_QUEUE_MSG_LEN];
+} mq;
+
 /**
  * check_pause:
  * @pressed              : was libretro pause key pressed?
@@ -81,7 +171,8 @@ static bool check_pause(bool pause_pressed, bool frameadvance_pressed)
          pause_pressed |= !old_is_paused;
          frame_count = video_driver_get_frame_count() + (pause_pressed ? 1:0);
          snprintf(msg, sizeof(msg), "Frame %lu", frame_count);
-         rarch_main_msg_queue_push(msg, 1, 0, true);
+         rarch_main_msg_queue_push_id(RARCH_MSG_QUEUE_ID_FRAME,
+               msg, 1, 0, true);
       }
 
       if (pause_pressed)
@@ -119,7 +210,8 @@ static bool check_pause(bool pause_pressed, bool frameadvance_pressed)
 static void check_fast_forward_button(bool fastforward_pressed,
       bool hold_pressed, bool old_hold_pressed)
 {
-   driver_t *driver = driver_get_ptr();
+   driver_t *driver   = driver_get_ptr();
+   runloop_t *runloop = rarch_main_get_ptr();
 
    /* To avoid continous switching if we hold the button down, we require
     * that the button must go from pressed to unpressed back to pressed 
@@ -132,13 +224,34 @@ static void check_fast_forward_button(bool fastforward_pressed,
    else
       return;
 
-   driver_set_nonblock_state(driver->nonblock_state);
+   /* A seek keeps the drivers unblocked until it is done. */
+   driver_set_nonblock_state(driver->nonblock_state || runloop->is_seeking);
    if (driver->nonblock_state)
       rarch_main_msg_queue_push("Fast forward", 0, 0, true);
    else
       rarch_main_msg_queue_push("", 0, 1, true);
 }
 
+/**
+ * check_movie_seek:
+ * @seeking              : is the input log seeking?
+ *
+ * Unblocks audio and video while an input log seeks, so the
+ * frames up to the seek target run as fast as possible, and
+ * restores the fast forward state once the target is reached.
+ **/
+static void check_movie_seek(bool seeking)
+{
+   driver_t *driver   = driver_get_ptr();
+   runloop_t *runloop = rarch_main_get_ptr();
+
+   if (seeking == runloop->is_seeking)
+      return;
+
+   runloop->is_seeking = seeking;
+   driver_set_nonblock_state(seeking || driver->nonblock_state);
+}
+
 /**
  * check_stateslots:
  * @pressed_increase     : is state slot increase key pressed?
@@ -429,6 +542,7 @@ static int do_pause_state_checks(
  **/
 static int do_state_checks(event_cmd_state_t *cmd)
 {
+   retro_time_t rewind_start = 0;
    driver_t  *driver         = driver_get_ptr();
    runloop_t *runloop        = rarch_main_get_ptr();
    global_t  *global         = global_get_ptr();
@@ -481,7 +595,10 @@ static int do_state_checks(event_cmd_state_t *cmd)
    else if (cmd->load_state_pressed)
       event_command(EVENT_CMD_LOAD_STATE);
 
+   rewind_start = global->rewind.state ? benchmark_stage_begin() : 0;
    check_rewind(cmd->rewind_pressed);
+   benchmark_stage_end(BENCHMARK_STAGE_REWIND, rewind_start);
+
    check_slowmotion(cmd->slowmotion_pressed);
 
    check_shader_dir(cmd->shader_next_pressed, cmd->shader_prev_pressed);
@@ -520,6 +637,7 @@ static int do_state_checks(event_cmd_state_t *cmd)
  * b) Quit key was pressed.
  * c) Frame count exceeds or equals maximum amount of frames to run.
  * d) Video driver no longer alive.
+ * e) Input log playback ended and --eof-exit was given.
  *
  * Returns: 1 if any of the above conditions are true, otherwise 0.
  **/
@@ -529,12 +647,17 @@ static INLINE int time_to_exit(event_cmd_state_t *cmd)
    global_t  *global             = global_get_ptr();
    bool shutdown_pressed         = global->system.shutdown;
    bool video_alive              = video_driver_is_alive();
-   uint64_t frame_count          = video_driver_get_frame_count();
+   /* Not every video driver counts frames, so benchmark
+    * mode counts the frames it timed instead. */
+   uint64_t frame_count          = global->benchmark.enable ?
+         benchmark_get_frame_count() : video_driver_get_frame_count();
    bool frame_count_end          = (runloop->frames.video.max && 
          frame_count >= runloop->frames.video.max);
+   bool movie_end_exit           = global->movie.eof_exit &&
+         movie_end(global->movie.handle);
 
    if (shutdown_pressed || cmd->quit_key_pressed || frame_count_end
-         || !video_alive)
+         || !video_alive || movie_end_exit)
    {
       global->system.shutdown = true;
       return 1;
@@ -582,7 +705,6 @@ static void rarch_update_frame_time(void)
 static void rarch_limit_frame_time()
 {
    retro_time_t target                  = 0;
-   retro_time_t to_sleep_ms             = 0;
    runloop_t *runloop                   = rarch_main_get_ptr();
    settings_t *settings                 = config_get_ptr();
    driver_t *driver                     = driver_get_ptr();
@@ -613,16 +735,19 @@ static void rarch_limit_frame_time()
 
    target        = runloop->frames.limit.last_time
                    + runloop->frames.limit.minimum_time;
-   to_sleep_ms   = (target - current) / 1000;
 
-   if (to_sleep_ms <= 0)
+   /* Deadlines are absolute, so a frame that runs a little late
+    * is made up for by the next ones instead of shifting the
+    * schedule. Only resync once we're a whole frame behind. */
+   if (current - target >= runloop->frames.limit.minimum_time)
    {
-      runloop->frames.limit.last_time = rarch_get_time_usec();
+      runloop->frames.limit.last_time = current;
       return;
    }
-   
-   rarch_sleep((unsigned int)to_sleep_ms);
-   
+
+   if (target > current)
+      rarch_wait_until_usec(target, settings->frame_throttle_spin);
+
    runloop->frames.limit.last_time = target;
 }
 
@@ -766,86 +891,180 @@ static void rarch_main_iterate_linefeed_overlay(void)
 }
 #endif
 
-const char *rarch_main_msg_queue_pull(void)
+static void rarch_main_msg_queue_insert(const struct msg_queue_slot *slot)
 {
-   runloop_t *runloop = rarch_main_get_ptr();
-   const char *ret = NULL;
+   unsigned i;
+   struct msg_queue_active *entry = NULL;
 
-   if (!runloop)
-      return NULL;
+   if (slot->flush)
+      mq.active_count = 0;
 
-#ifdef HAVE_THREADS
-   slock_lock(mq_lock);
-#endif
+   for (i = 0; i < mq.active_count; i++)
+   {
+      if (mq.active[i].id == slot->id)
+      {
+         entry = &mq.active[i];
+         break;
+      }
+   }
 
-   ret = msg_queue_pull(runloop->msg_queue);
+   if (!entry)
+   {
+      /* Full, same as the old priority heap. */
+      if (mq.active_count >= MSG_QUEUE_ACTIVE)
+         return;
 
-#ifdef HAVE_THREADS
-   slock_unlock(mq_lock);
-#endif
+      entry        = &mq.active[mq.active_count++];
+      entry->id    = slot->id;
+      entry->order = mq.order++;
+   }
 
-   return ret;
+   entry->prio     = slot->prio;
+   entry->duration = slot->duration;
+   entry->len      = slot->len;
+   memcpy(entry->msg, slot->msg, slot->len + 1);
 }
 
-void rarch_main_msg_queue_push(const char *msg, unsigned prio, unsigned duration,
-      bool flush)
+/* Moves everything pushed so far into the active table. */
+static void rarch_main_msg_queue_drain(void)
 {
-   runloop_t *runloop = rarch_main_get_ptr();
-   if (!runloop->msg_queue)
-      return;
+   for (;;)
+   {
+      struct msg_queue_slot *slot =
+         &mq.slots[mq.tail & (MSG_QUEUE_SLOTS - 1)];
 
-#ifdef HAVE_THREADS
-   slock_lock(mq_lock);
-#endif
+      if ((int)(MSG_QUEUE_LOAD(&slot->seq) - (mq.tail + 1)) < 0)
+         break;
 
-   if (flush)
-      msg_queue_clear(runloop->msg_queue);
-   msg_queue_push(runloop->msg_queue, msg, prio, duration);
+      rarch_main_msg_queue_insert(slot);
 
-#ifdef HAVE_THREADS
-   slock_unlock(mq_lock);
-#endif
+      MSG_QUEUE_STORE(&slot->seq, mq.tail + MSG_QUEUE_SLOTS);
+      mq.tail++;
+   }
 }
 
-void rarch_main_msg_queue_free(void)
+/**
+ * rarch_main_msg_queue_pull:
+ *
+ * Pulls the highest priority message to show this frame.
+ * Main thread only.
+ *
+ * Returns: the message, valid until the next pull,
+ * or NULL if there is none.
+ **/
+const char *rarch_main_msg_queue_pull(void)
 {
-   runloop_t *runloop = rarch_main_get_ptr();
-   if (!runloop)
+   unsigned i;
+   struct msg_queue_active *best = NULL;
+
+   if (!mq.alive)
+      return NULL;
+
+   rarch_main_msg_queue_drain();
+
+   for (i = 0; i < mq.active_count; i++)
+   {
+      struct msg_queue_active *entry = &mq.active[i];
+
+      if (!best || entry->prio > best->prio
+            || (entry->prio == best->prio && entry->order < best->order))
+         best = entry;
+   }
+
+   if (!best)
+      return NULL;
+
+   /* A duration of 0 stays up until flushed or replaced.
+    * The active table only changes in here, so the entry
+    * itself can be returned unless it expires. */
+   if (!best->duration || --best->duration != 0)
+      return best->msg;
+
+   memcpy(mq.current, best->msg, best->len + 1);
+   *best = mq.active[--mq.active_count];
+
+   return mq.current;
+}
+
+/**
+ * rarch_main_msg_queue_push_id:
+ * @id                   : Messages with the same id replace
+ *                         each other, see enum rarch_msg_queue_id.
+ * @msg                  : Message text.
+ * @prio                 : Priority, higher is shown first.
+ * @duration             : Frames to show the message for.
+ * @flush                : Clear all other messages first.
+ *
+ * Queues an OSD message. Safe to call from any thread,
+ * does not block and does not allocate. The message is
+ * dropped if the main thread is too far behind.
+ **/
+void rarch_main_msg_queue_push_id(uint32_t id, const char *msg,
+      unsigned prio, unsigned duration, bool flush)
+{
+   unsigned pos;
+   struct msg_queue_slot *slot = NULL;
+
+   if (!mq.alive)
       return;
 
-   if (runloop->msg_queue)
+   for (;;)
    {
-#ifdef HAVE_THREADS
-   slock_lock(mq_lock);
-#endif
+      int diff;
 
-      msg_queue_free(runloop->msg_queue);
+      pos  = mq.head;
+      slot = &mq.slots[pos & (MSG_QUEUE_SLOTS - 1)];
+      diff = (int)(MSG_QUEUE_LOAD(&slot->seq) - pos);
 
-#ifdef HAVE_THREADS
-      slock_unlock(mq_lock);
-      slock_free(mq_lock);
-#endif
+      if (diff < 0)
+         return;
+      if (diff == 0 && MSG_QUEUE_CAS(&mq.head, pos, pos + 1))
+         break;
    }
 
-   runloop->msg_queue = NULL;
+   slot->id       = id;
+   slot->prio     = prio;
+   slot->duration = duration;
+   slot->flush    = flush;
+   slot->len      = msg ? strlen(msg) : 0;
+   if (slot->len >= sizeof(slot->msg))
+      slot->len   = sizeof(slot->msg) - 1;
+   memcpy(slot->msg, msg ? msg : "", slot->len);
+   slot->msg[slot->len] = '\0';
+
+   MSG_QUEUE_STORE(&slot->seq, pos + 1);
+}
+
+void rarch_main_msg_queue_push(const char *msg, unsigned prio, unsigned duration,
+      bool flush)
+{
+   rarch_main_msg_queue_push_id(
+         djb2_calculate(msg ? msg : "") | MSG_QUEUE_ID_TEXT,
+         msg, prio, duration, flush);
+}
+
+void rarch_main_msg_queue_free(void)
+{
+   mq.alive        = false;
+   mq.active_count = 0;
 }
 
 void rarch_main_msg_queue_init(void)
 {
-   runloop_t *runloop = rarch_main_get_ptr();
-   if (!runloop)
-      return;
+   unsigned i;
 
-   if (!runloop->msg_queue)
+   if (!mq.ready)
    {
-      runloop->msg_queue = msg_queue_new(8);
-      rarch_assert(runloop->msg_queue);
-
-#ifdef HAVE_THREADS
-      mq_lock = slock_new();
-      rarch_assert(mq_lock);
-#endif
+      for (i = 0; i < MSG_QUEUE_SLOTS; i++)
+         mq.slots[i].seq = i;
+      mq.ready = true;
    }
+
+   /* Drop anything left over from before. */
+   rarch_main_msg_queue_drain();
+
+   mq.active_count = 0;
+   mq.alive        = true;
 }
 
 global_t *global_get_ptr(void)
@@ -869,6 +1088,9 @@ void rarch_main_state_free(void)
 
 void rarch_main_global_free(void)
 {
+#ifdef HAVE_COMPRESSION
+   compressed_file_cache_free();
+#endif
    event_command(EVENT_CMD_TEMPORARY_CONTENT_DEINIT);
    event_command(EVENT_CMD_SUBSYSTEM_FULLPATHS_DEINIT);
    event_command(EVENT_CMD_RECORD_DEINIT);
@@ -979,6 +1201,83 @@ static void rarch_main_cmd_get_state(event_cmd_state_t *cmd,
    cmd->hotkeys_toggle_pressed      = BIT64_GET(trigger_input, RARCH_TOGGLE_HOTKEYS);
 }
 
+/* Time kept free between the core handing over its frame and
+ * the next vblank, for presentation and run time jitter. */
+#define FRAME_DELAY_AUTO_MARGIN(period) (1000 + (period) / 8)
+
+/* How much the delay may grow per frame, in usec. */
+#define FRAME_DELAY_AUTO_STEP 250
+
+/**
+ * rarch_frame_delay_auto:
+ *
+ * Evaluates the previous frame, then sleeps for the largest
+ * delay that still leaves the core enough time to finish its
+ * next frame before vblank.
+ *
+ * Run time is measured until the core hands its frame to the
+ * video driver, so blocking on VSync is not counted. A decaying
+ * peak of it sets how far the delay may grow. Missed frames
+ * halve the delay at once and stop it from growing for a while.
+ **/
+static void rarch_frame_delay_auto(void)
+{
+   runloop_t *runloop   = rarch_main_get_ptr();
+   settings_t *settings = config_get_ptr();
+   retro_time_t now     = rarch_get_time_usec();
+   retro_time_t period  = 0;
+   retro_time_t limit   = (settings->video.frame_delay ?
+         settings->video.frame_delay : 15) * 1000;
+
+   if (settings->video.refresh_rate > 0.0f)
+      period = (retro_time_t)(1000000.0f / settings->video.refresh_rate);
+
+   if (period && runloop->frames.delay.run_start)
+   {
+      retro_time_t run_start = runloop->frames.delay.run_start;
+      retro_time_t target    = 0;
+
+      if (runloop->frames.delay.submit_time > run_start)
+      {
+         retro_time_t run  = runloop->frames.delay.submit_time - run_start;
+         retro_time_t peak = runloop->frames.delay.run_peak;
+
+         runloop->frames.delay.run_peak = max(run, peak - peak / 64);
+      }
+
+      target = period - runloop->frames.delay.run_peak
+         - FRAME_DELAY_AUTO_MARGIN(period);
+      target = max(0, min(target, limit));
+
+      /* The previous frame took delay + run + present. Well past
+       * one period, it has missed its vblank. */
+      if (runloop->frames.delay.current
+            && (now - run_start) + runloop->frames.delay.current
+            > period + period / 2)
+      {
+         runloop->frames.delay.current /= 2;
+         runloop->frames.delay.hold     = 2 * settings->video.refresh_rate;
+         runloop->frames.delay.overruns++;
+
+         RARCH_LOG("Frame delay overrun, backing off to %u usec.\n",
+               (unsigned)runloop->frames.delay.current);
+      }
+      else if (target < runloop->frames.delay.current)
+         runloop->frames.delay.current = target;
+      else if (runloop->frames.delay.hold)
+         runloop->frames.delay.hold--;
+      else
+         runloop->frames.delay.current += min(FRAME_DELAY_AUTO_STEP,
+               target - runloop->frames.delay.current);
+   }
+
+   if (runloop->frames.delay.current > 0)
+      rarch_wait_until_usec(now + runloop->frames.delay.current,
+            settings->frame_throttle_spin);
+
+   runloop->frames.delay.run_start = rarch_get_time_usec();
+}
+
 /**
  * rarch_main_iterate:
  *
@@ -990,6 +1289,8 @@ static void rarch_main_cmd_get_state(event_cmd_state_t *cmd,
 int rarch_main_iterate(void)
 {
    retro_input_t trigger_input;
+   retro_time_t frame_start        = benchmark_stage_begin();
+   retro_time_t stage_start        = 0;
    event_cmd_state_t    cmd        = {0};
    int ret                         = 0;
    static retro_input_t last_input = 0;
@@ -999,6 +1300,7 @@ int rarch_main_iterate(void)
    driver_t *driver                = driver_get_ptr();
    settings_t *settings            = config_get_ptr();
    global_t   *global              = global_get_ptr();
+   runloop_t *runloop              = rarch_main_get_ptr();
 
    if (driver->flushing_input)
       driver->flushing_input = (input) ? input_flush(&input) : false;
@@ -1022,6 +1324,7 @@ int rarch_main_iterate(void)
    if (do_state_checks(&cmd))
    {
       /* RetroArch has been paused */
+      runloop->frames.delay.run_start = 0;
       driver->retro_ctx.poll_cb();
       rarch_sleep(10);
       
@@ -1032,6 +1335,7 @@ int rarch_main_iterate(void)
    if (menu_driver_alive())
    {
       menu_handle_t *menu = menu_driver_get_ptr();
+      runloop->frames.delay.run_start = 0;
       if (menu)
          if (menu_iterate(input, old_input, trigger_input) == -1)
             rarch_main_set_state(RARCH_ACTION_STATE_MENU_RUNNING_FINISHED);
@@ -1055,30 +1359,62 @@ int rarch_main_iterate(void)
    if (global->system.camera_callback.caps)
       driver_camera_poll();
 
-   if ((settings->video.frame_delay > 0) && !driver->nonblock_state)
+   if (global->movie.handle)
+      movie_pre_frame(global->movie.handle);
+
+   check_movie_seek(movie_is_seeking(global->movie.handle));
+
+   if (!driver->nonblock_state && !global->benchmark.enable
+         && !runloop->is_seeking)
+   {
+      if (settings->video.frame_delay_auto)
+         rarch_frame_delay_auto();
+      else if (settings->video.frame_delay > 0)
          rarch_sleep(settings->video.frame_delay);
+   }
+   else
+      runloop->frames.delay.run_start = 0;
 
    if (driver->preempt_data)
+   {
+      stage_start = benchmark_stage_begin();
       preempt_pre_frame((preempt_t*)driver->preempt_data);
+      benchmark_stage_end(BENCHMARK_STAGE_PREEMPT, stage_start);
+   }
 #ifdef HAVE_NETPLAY
    else if (driver->netplay_data)
+   {
+      stage_start = benchmark_stage_begin();
       netplay_pre_frame((netplay_t*)driver->netplay_data);
+      benchmark_stage_end(BENCHMARK_STAGE_NETPLAY, stage_start);
+   }
 #endif
 
    /* Run libretro for one frame. */
+   stage_start = benchmark_stage_begin();
    pretro_run();
+   benchmark_stage_end(BENCHMARK_STAGE_RUN, stage_start);
+
+   cheat_search_iterate(global->cheat_search);
 
 #ifdef HAVE_NETPLAY
    if (driver->netplay_data)
+   {
+      stage_start = benchmark_stage_begin();
       netplay_post_frame((netplay_t*)driver->netplay_data);
+      benchmark_stage_end(BENCHMARK_STAGE_NETPLAY, stage_start);
+   }
 #endif
 
 #if defined(HAVE_THREADS)
    unlock_autosave();
 #endif
 
+   benchmark_frame_end(frame_start);
+
 success:
-   rarch_limit_frame_time();
+   if (!global->benchmark.enable && !runloop->is_seeking)
+      rarch_limit_frame_time();
 
    return ret;
 }
@@ -25,6 +25,8 @@
 #include "rewind.h"
 #include "autosave.h"
 #include "cheats.h"
+#include "cheat_search.h"
+#include "movie.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +41,8 @@ typedef struct runloop
    bool is_idle;
    bool ui_companion_is_on_foreground;
    bool is_slowmotion;
+   /* An input log is running frames up to a seek target. */
+   bool is_seeking;
 
    struct
    {
@@ -52,9 +56,18 @@ typedef struct runloop
          retro_time_t minimum_time;
          retro_time_t last_time;
       } limit;
-   } frames;
 
-   msg_queue_t *msg_queue;
+      /* Automatic frame delay, all times in usec. */
+      struct
+      {
+         retro_time_t current;
+         retro_time_t run_peak;
+         retro_time_t run_start;
+         retro_time_t submit_time;
+         unsigned hold;
+         unsigned overruns;
+      } delay;
+   } frames;
 } runloop_t;
 
 typedef struct rarch_resolution
@@ -227,6 +240,24 @@ typedef struct global
    autosave_t **autosave;
    unsigned num_autosave;
 
+   /* Input log recording and playback. */
+   struct
+   {
+      movie_t *handle;
+      char play_path[PATH_MAX_LENGTH];
+      char record_path[PATH_MAX_LENGTH];
+      bool eof_exit;
+      uint64_t seek_frame;
+      unsigned checkpoint_interval;
+   } movie;
+
+   /* Unthrottled run with per-frame timings. */
+   struct
+   {
+      bool enable;
+      char report_path[PATH_MAX_LENGTH];
+   } benchmark;
+
 #ifdef HAVE_NETPLAY
    /* Netplay. */
    char netplay_server[46];
@@ -268,6 +299,7 @@ typedef struct global
    } filter_dir;
 
    cheat_manager_t *cheat;
+   cheat_search_t *cheat_search;
 
    bool block_config_read;
 
@@ -339,9 +371,22 @@ global_t *global_get_ptr(void);
  **/
 int rarch_main_iterate(void);
 
+/* Ids for rarch_main_msg_queue_push_id(). Pushes with the same
+ * id replace each other instead of queueing up, plain pushes
+ * use the message text as id. */
+enum rarch_msg_queue_id
+{
+   RARCH_MSG_QUEUE_ID_FRAME = 1,
+   RARCH_MSG_QUEUE_ID_PROGRESS,
+   RARCH_MSG_QUEUE_ID_DOWNLOAD
+};
+
 void rarch_main_msg_queue_push(const char *msg, unsigned prio,
       unsigned duration, bool flush);
 
+void rarch_main_msg_queue_push_id(uint32_t id, const char *msg,
+      unsigned prio, unsigned duration, bool flush);
+
 const char *rarch_main_msg_queue_pull(void);
 
 void rarch_main_msg_queue_free(void);
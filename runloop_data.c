@@ -17,6 +17,7 @@
 #include "runloop_data.h"
 #include "general.h"
 #include "input/input_overlay.h"
+#include "tasks/tasks.h"
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
@@ -49,6 +50,10 @@ void rarch_main_data_free(void)
 {
    data_runloop_t *runloop = rarch_main_data_get_ptr();
 
+#if defined(HAVE_RPNG) && defined(HAVE_THREADS)
+   rarch_main_data_image_decode_deinit();
+#endif
+
    if (runloop)
       free(runloop);
    runloop = NULL;
@@ -59,6 +64,9 @@ static void data_runloop_iterate(data_runloop_t *runloop)
    rarch_main_data_nbio_iterate(runloop);
 #ifdef HAVE_RPNG
    rarch_main_data_nbio_image_iterate(runloop);
+#ifdef HAVE_THREADS
+   rarch_main_data_image_decode_iterate(runloop);
+#endif
 #endif
 #ifdef HAVE_OVERLAY
    rarch_main_data_overlay_iterate(runloop);
@@ -93,6 +101,10 @@ bool rarch_main_data_active(data_runloop_t *runloop)
 #endif
 #ifdef HAVE_RPNG
    image_active                 = image && image->handle != NULL;
+#ifdef HAVE_THREADS
+   image_active                 = image_active ||
+      rarch_main_data_image_decode_active();
+#endif
    active                       = active || image_active;
 #endif
    nbio_active                  = nbio->handle != NULL;
@@ -45,6 +45,172 @@
 #include <formats/rpng.h>
 #define IMG_EXT "png"
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+
+/* PNG screenshots are encoded on a worker thread, so taking one
+ * only costs a copy of the frame on the main thread. */
+#define HAVE_SCREENSHOT_THREAD
+
+/* Number of row strips an image is filtered and deflated in. */
+#define SCREENSHOT_STRIPS 4
+
+/* Screenshots waiting to be encoded before taking
+ * another one waits for the encoder. */
+#define SCREENSHOT_MAX_PENDING 8
+
+struct screenshot_job
+{
+   char path[PATH_MAX_LENGTH];
+   uint8_t *buffer;
+   size_t capacity;
+   unsigned width;
+   unsigned height;
+   bool fast;
+
+   struct screenshot_job *next;
+};
+
+static struct
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   bool quit;
+
+   /* Jobs waiting for the encoder, oldest first. */
+   struct screenshot_job *head;
+   struct screenshot_job *tail;
+   unsigned pending;
+
+   /* Finished jobs, kept for their buffers. */
+   struct screenshot_job *pool;
+} screenshot_encoder;
+
+static void screenshot_thread(void *data)
+{
+   (void)data;
+
+   for (;;)
+   {
+      struct screenshot_job *job = NULL;
+
+      slock_lock(screenshot_encoder.lock);
+      while (!screenshot_encoder.head && !screenshot_encoder.quit)
+         scond_wait(screenshot_encoder.cond, screenshot_encoder.lock);
+
+      job = screenshot_encoder.head;
+      if (job)
+      {
+         screenshot_encoder.head = job->next;
+         if (!screenshot_encoder.head)
+            screenshot_encoder.tail = NULL;
+      }
+      slock_unlock(screenshot_encoder.lock);
+
+      /* Pending screenshots are written before quitting. */
+      if (!job)
+         break;
+
+      if (rpng_save_image_bgr24_ex(job->path, job->buffer,
+               job->width, job->height, job->width * 3,
+               SCREENSHOT_STRIPS, job->fast))
+         RARCH_LOG("Screenshot saved: %s.\n", job->path);
+      else
+         RARCH_ERR("Failed to take screenshot.\n");
+
+      slock_lock(screenshot_encoder.lock);
+      job->next               = screenshot_encoder.pool;
+      screenshot_encoder.pool = job;
+      screenshot_encoder.pending--;
+      scond_broadcast(screenshot_encoder.cond);
+      slock_unlock(screenshot_encoder.lock);
+   }
+}
+
+static bool screenshot_thread_init(void)
+{
+   if (screenshot_encoder.thread)
+      return true;
+
+   screenshot_encoder.quit = false;
+   screenshot_encoder.lock = slock_new();
+   screenshot_encoder.cond = scond_new();
+
+   if (screenshot_encoder.lock && screenshot_encoder.cond)
+      screenshot_encoder.thread = sthread_create(screenshot_thread, NULL);
+
+   if (screenshot_encoder.thread)
+      return true;
+
+   if (screenshot_encoder.lock)
+      slock_free(screenshot_encoder.lock);
+   if (screenshot_encoder.cond)
+      scond_free(screenshot_encoder.cond);
+   screenshot_encoder.lock = NULL;
+   screenshot_encoder.cond = NULL;
+   return false;
+}
+
+/**
+ * screenshot_job_new:
+ * @size            : size of the frame to encode.
+ *
+ * Takes a job from the pool, or allocates one, with a buffer
+ * of at least @size bytes. Waits for the encoder while too
+ * many screenshots are pending.
+ *
+ * Returns: job, or NULL on failure.
+ **/
+static struct screenshot_job *screenshot_job_new(size_t size)
+{
+   struct screenshot_job *job = NULL;
+
+   slock_lock(screenshot_encoder.lock);
+   while (screenshot_encoder.pending >= SCREENSHOT_MAX_PENDING)
+      scond_wait(screenshot_encoder.cond, screenshot_encoder.lock);
+
+   job = screenshot_encoder.pool;
+   if (job)
+      screenshot_encoder.pool = job->next;
+   slock_unlock(screenshot_encoder.lock);
+
+   if (!job && !(job = (struct screenshot_job*)calloc(1, sizeof(*job))))
+      return NULL;
+
+   if (job->capacity < size)
+   {
+      uint8_t *buffer = (uint8_t*)realloc(job->buffer, size);
+
+      if (!buffer)
+      {
+         free(job->buffer);
+         free(job);
+         return NULL;
+      }
+
+      job->buffer   = buffer;
+      job->capacity = size;
+   }
+
+   job->next = NULL;
+   return job;
+}
+
+static void screenshot_job_push(struct screenshot_job *job)
+{
+   slock_lock(screenshot_encoder.lock);
+   if (screenshot_encoder.tail)
+      screenshot_encoder.tail->next = job;
+   else
+      screenshot_encoder.head = job;
+   screenshot_encoder.tail = job;
+   screenshot_encoder.pending++;
+   scond_broadcast(screenshot_encoder.cond);
+   slock_unlock(screenshot_encoder.lock);
+}
+#endif
+
 #else
 
 #define IMG_EXT "bmp"
@@ -350,8 +516,13 @@ bool screenshot_dump(const char *folder, const void *frame,
    uint8_t *out_buffer            = NULL;
    bool ret                       = false;
    driver_t *driver               = driver_get_ptr();
+   settings_t *settings           = config_get_ptr();
+#ifdef HAVE_SCREENSHOT_THREAD
+   struct screenshot_job *job     = NULL;
+#endif
 
    (void)file;
+   (void)settings;
    (void)out_buffer;
    (void)scaler;
    (void)driver;
@@ -361,7 +532,6 @@ bool screenshot_dump(const char *folder, const void *frame,
 
 #ifdef _XBOX1
    d3d_video_t *d3d = (d3d_video_t*)driver->video_data;
-   settings_t *settings = config_get_ptr();
 
    D3DSurface *surf = NULL;
    d3d->dev->GetBackBuffer(-1, D3DBACKBUFFER_TYPE_MONO, &surf);
@@ -377,7 +547,17 @@ bool screenshot_dump(const char *folder, const void *frame,
 
    ret = false;
 #elif defined(HAVE_ZLIB_DEFLATE) && defined(HAVE_RPNG)
-   out_buffer = (uint8_t*)malloc(width * height * 3);
+#ifdef HAVE_SCREENSHOT_THREAD
+   if (screenshot_thread_init())
+   {
+      job = screenshot_job_new(width * height * 3);
+      if (!job)
+         return false;
+      out_buffer = job->buffer;
+   }
+   else
+#endif
+      out_buffer = (uint8_t*)malloc(width * height * 3);
    if (!out_buffer)
       return false;
 
@@ -402,9 +582,22 @@ bool screenshot_dump(const char *folder, const void *frame,
          (const uint8_t*)frame + ((int)height - 1) * pitch);
    scaler_ctx_gen_reset(&scaler);
 
+#ifdef HAVE_SCREENSHOT_THREAD
+   if (job)
+   {
+      strlcpy(job->path, filename, sizeof(job->path));
+      job->width  = width;
+      job->height = height;
+      job->fast   = settings->video.fast_screenshot;
+      screenshot_job_push(job);
+      return true;
+   }
+#endif
+
    RARCH_LOG("Using RPNG for PNG screenshots.\n");
-   ret = rpng_save_image_bgr24(filename,
-         out_buffer, width, height, width * 3);
+   ret = rpng_save_image_bgr24_ex(filename,
+         out_buffer, width, height, width * 3,
+         1, settings->video.fast_screenshot);
    if (!ret)
       RARCH_ERR("Failed to take screenshot.\n");
    free(out_buffer);
@@ -429,3 +622,37 @@ bool screenshot_dump(const char *folder, const void *frame,
    return ret;
 }
 
+/**
+ * deinit_screenshot:
+ *
+ * Waits for pending screenshots to be written
+ * and stops the encoder thread.
+ **/
+void deinit_screenshot(void)
+{
+#ifdef HAVE_SCREENSHOT_THREAD
+   if (!screenshot_encoder.thread)
+      return;
+
+   slock_lock(screenshot_encoder.lock);
+   screenshot_encoder.quit = true;
+   scond_broadcast(screenshot_encoder.cond);
+   slock_unlock(screenshot_encoder.lock);
+
+   sthread_join(screenshot_encoder.thread);
+   screenshot_encoder.thread = NULL;
+
+   while (screenshot_encoder.pool)
+   {
+      struct screenshot_job *job = screenshot_encoder.pool;
+      screenshot_encoder.pool    = job->next;
+      free(job->buffer);
+      free(job);
+   }
+
+   slock_free(screenshot_encoder.lock);
+   scond_free(screenshot_encoder.cond);
+   screenshot_encoder.lock = NULL;
+   screenshot_encoder.cond = NULL;
+#endif
+}
@@ -32,6 +32,14 @@ void screenshot_generate_filename(char *filename, size_t size);
 
 bool take_screenshot(void);
 
+/**
+ * deinit_screenshot:
+ *
+ * Waits for pending screenshots to be written
+ * and stops the encoder thread.
+ **/
+void deinit_screenshot(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -155,6 +155,53 @@ static int cb_image_menu_boxart(void *data, size_t len)
 }
 
 
+#ifdef HAVE_THREADS
+static void cb_image_menu_decoded(struct texture_image *ti,
+      bool success, void *userdata)
+{
+   if (success)
+      menu_driver_load_image(ti,
+            (menu_image_type_t)(uintptr_t)userdata);
+   texture_image_free(ti);
+}
+
+/**
+ * rarch_main_data_image_decode_menu:
+ * @path                 : "path|callback" message from the image queue.
+ *
+ * Hands a menu image request to the decode workers.
+ *
+ * Returns: true if the request was queued, otherwise false.
+ **/
+static bool rarch_main_data_image_decode_menu(const char *path)
+{
+   bool ret                     = false;
+   menu_image_type_t type       = MENU_IMAGE_NONE;
+   struct string_list *str_list = string_split(path, "|");
+
+   if (!str_list || str_list->size < 2)
+      goto end;
+
+   switch (djb2_calculate(str_list->elems[1].data))
+   {
+      case CB_MENU_WALLPAPER:
+         type = MENU_IMAGE_WALLPAPER;
+         break;
+      case CB_MENU_BOXART:
+         type = MENU_IMAGE_BOXART;
+         break;
+   }
+
+   if (type != MENU_IMAGE_NONE)
+      ret = rarch_main_data_image_decode_push(str_list->elems[0].data,
+            NULL, cb_image_menu_decoded, (void*)(uintptr_t)type);
+
+end:
+   string_list_free(str_list);
+   return ret;
+}
+#endif
+
 static int rarch_main_data_image_iterate_poll(nbio_handle_t *nbio)
 {
    const char *path    = NULL;
@@ -167,6 +214,16 @@ static int rarch_main_data_image_iterate_poll(nbio_handle_t *nbio)
    if (!path)
       return -1;
 
+#ifdef HAVE_THREADS
+   /* Decode off the main thread; completion is delivered by
+    * rarch_main_data_image_decode_iterate, so stay in POLL. */
+   if (rarch_main_data_image_decode_menu(path))
+   {
+      msg_queue_clear(nbio->image.msg_queue);
+      return -1;
+   }
+#endif
+
    /* Can only deal with one image transfer at a time for now */
    if (nbio->image.handle)
       return -1; 
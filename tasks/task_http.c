@@ -384,7 +384,8 @@ static bool rarch_main_data_http_iterate_cancel(http_handle_t *http)
       if (countdown > 0)
       {
          snprintf(msg, sizeof(msg), "Canceling download in %i", countdown);
-         rarch_main_msg_queue_push(msg, 1, 10, true);
+         rarch_main_msg_queue_push_id(RARCH_MSG_QUEUE_ID_DOWNLOAD,
+               msg, 1, 10, true);
       }
       else
          rarch_main_data_http_cancel_transfer(http, "Download Canceled");
@@ -421,7 +422,8 @@ static int rarch_main_data_http_iterate_transfer(void *data)
       if (tot > 0)
       {
          snprintf(msg, sizeof(msg), "Download progress: %d%%", percent);
-         rarch_main_msg_queue_push(msg, 1, 100, true);
+         rarch_main_msg_queue_push_id(RARCH_MSG_QUEUE_ID_DOWNLOAD,
+               msg, 1, 100, true);
          start_usec = 0;
       }
       else
@@ -0,0 +1,363 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2015 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <rthreads/rthreads.h>
+#include <formats/rpng.h>
+
+#include "../general.h"
+#include "tasks.h"
+
+#if defined(HAVE_RPNG) && defined(HAVE_THREADS)
+
+#define IMAGE_DECODE_THREADS 4
+
+/* Consoles post-process decoded textures inside texture_image_load,
+ * so only plain PNG decodes are handed to the workers there. */
+#if defined(GEKKO) || defined(__CELLOS_LV2__) || defined(_XBOX1)
+#define IMAGE_DECODE_WORKERS 0
+#else
+#define IMAGE_DECODE_WORKERS 1
+#endif
+
+enum image_decode_job_state
+{
+   IMAGE_DECODE_PENDING = 0,
+   IMAGE_DECODE_DECODING,
+   IMAGE_DECODE_DONE
+};
+
+typedef struct image_decode_job
+{
+   char *path;
+   void *owner;
+   image_decode_cb_t cb;
+   void *userdata;
+   unsigned r_shift, g_shift, b_shift, a_shift;
+   enum image_decode_job_state state;
+   bool success;
+   bool cancelled;
+   struct texture_image ti;
+   struct image_decode_job *next;
+} image_decode_job_t;
+
+typedef struct image_decoder
+{
+   sthread_t *threads[IMAGE_DECODE_THREADS];
+   unsigned num_threads;
+   slock_t *lock;
+   scond_t *cond;
+   bool quit;
+
+   /* Jobs in submission order. Completions are delivered from the
+    * head only, so callbacks fire in the order images were requested
+    * even though workers finish them out of order. */
+   image_decode_job_t *head;
+   image_decode_job_t *tail;
+} image_decoder_t;
+
+static image_decoder_t *g_image_decoder;
+
+static void image_decode_job_free(image_decode_job_t *job)
+{
+   if (!job)
+      return;
+
+   texture_image_free(&job->ti);
+   free(job->path);
+   free(job);
+}
+
+static image_decode_job_t *image_decode_next_pending(image_decoder_t *dec)
+{
+   image_decode_job_t *job;
+
+   for (job = dec->head; job; job = job->next)
+   {
+      if (job->state != IMAGE_DECODE_PENDING)
+         continue;
+
+      if (job->cancelled)
+      {
+         job->state = IMAGE_DECODE_DONE;
+         continue;
+      }
+
+      return job;
+   }
+
+   return NULL;
+}
+
+static void image_decode_thread(void *data)
+{
+   image_decoder_t *dec = (image_decoder_t*)data;
+
+   slock_lock(dec->lock);
+
+   for (;;)
+   {
+      image_decode_job_t *job = NULL;
+
+      while (!dec->quit && !(job = image_decode_next_pending(dec)))
+         scond_wait(dec->cond, dec->lock);
+
+      if (dec->quit)
+         break;
+
+      job->state = IMAGE_DECODE_DECODING;
+      slock_unlock(dec->lock);
+
+      job->success = rpng_load_image_argb(job->path,
+            &job->ti.pixels, &job->ti.width, &job->ti.height);
+      if (job->success)
+         texture_image_color_convert(job->r_shift, job->g_shift,
+               job->b_shift, job->a_shift, &job->ti);
+
+      slock_lock(dec->lock);
+      job->state = IMAGE_DECODE_DONE;
+   }
+
+   slock_unlock(dec->lock);
+}
+
+static image_decoder_t *image_decoder_init(void)
+{
+   unsigned i;
+   image_decoder_t *dec = (image_decoder_t*)calloc(1, sizeof(*dec));
+
+   if (!dec)
+      return NULL;
+
+   dec->lock = slock_new();
+   dec->cond = scond_new();
+
+   if (!dec->lock || !dec->cond)
+      goto error;
+
+   for (i = 0; i < IMAGE_DECODE_THREADS && IMAGE_DECODE_WORKERS; i++)
+   {
+      dec->threads[i] = sthread_create(image_decode_thread, dec);
+      if (!dec->threads[i])
+         break;
+      dec->num_threads++;
+   }
+
+   if (IMAGE_DECODE_WORKERS && !dec->num_threads)
+      RARCH_WARN("Could not start image decode threads, decoding inline.\n");
+
+   return dec;
+
+error:
+   if (dec->lock)
+      slock_free(dec->lock);
+   if (dec->cond)
+      scond_free(dec->cond);
+   free(dec);
+   return NULL;
+}
+
+/**
+ * rarch_main_data_image_decode_push:
+ * @path                 : Path to image file.
+ * @owner                : Tag used to cancel the request later, may be NULL.
+ * @cb                   : Invoked on the main thread with the result.
+ * @userdata             : Passed through to @cb.
+ *
+ * Queues @path for decoding. PNG files are decoded and color converted
+ * on a worker thread; anything else is loaded synchronously here and
+ * still delivered through @cb on a later frame, so callers see a single
+ * asynchronous contract. The texture handed to @cb belongs to the
+ * callback, which must free it.
+ *
+ * Returns: true if the request was queued, otherwise false.
+ **/
+bool rarch_main_data_image_decode_push(const char *path, void *owner,
+      image_decode_cb_t cb, void *userdata)
+{
+   image_decode_job_t *job;
+   image_decoder_t    *dec;
+
+   if (!path || !*path || !cb)
+      return false;
+
+   if (!g_image_decoder)
+      g_image_decoder = image_decoder_init();
+
+   dec = g_image_decoder;
+   if (!dec)
+      return false;
+
+   job = (image_decode_job_t*)calloc(1, sizeof(*job));
+   if (!job)
+      return false;
+
+   job->path     = strdup(path);
+   job->owner    = owner;
+   job->cb       = cb;
+   job->userdata = userdata;
+
+   if (!job->path)
+   {
+      free(job);
+      return false;
+   }
+
+   /* Video driver state is only safe to query from the main thread. */
+   texture_image_set_color_shifts(&job->r_shift, &job->g_shift,
+         &job->b_shift, &job->a_shift);
+
+   if (!dec->num_threads || !strstr(path, ".png"))
+   {
+      job->success = texture_image_load(&job->ti, path);
+      job->state   = IMAGE_DECODE_DONE;
+   }
+
+   slock_lock(dec->lock);
+   if (dec->tail)
+      dec->tail->next = job;
+   else
+      dec->head = job;
+   dec->tail = job;
+   scond_signal(dec->cond);
+   slock_unlock(dec->lock);
+
+   return true;
+}
+
+/**
+ * rarch_main_data_image_decode_iterate:
+ * @data                 : Data runloop, unused.
+ *
+ * Delivers finished decodes to their callbacks, in submission order.
+ **/
+void rarch_main_data_image_decode_iterate(void *data)
+{
+   image_decoder_t *dec = g_image_decoder;
+
+   (void)data;
+
+   if (!dec)
+      return;
+
+   for (;;)
+   {
+      image_decode_job_t *job = NULL;
+
+      slock_lock(dec->lock);
+      if (dec->head && dec->head->state == IMAGE_DECODE_DONE)
+      {
+         job       = dec->head;
+         dec->head = job->next;
+         if (!dec->head)
+            dec->tail = NULL;
+      }
+      slock_unlock(dec->lock);
+
+      if (!job)
+         break;
+
+      if (!job->cancelled)
+      {
+         /* Ownership of the pixels moves to the callback. */
+         job->cb(&job->ti, job->success, job->userdata);
+         memset(&job->ti, 0, sizeof(job->ti));
+      }
+
+      image_decode_job_free(job);
+   }
+}
+
+/**
+ * rarch_main_data_image_decode_cancel:
+ * @owner                : Tag passed to rarch_main_data_image_decode_push.
+ *
+ * Drops every outstanding request made by @owner. Their callbacks will
+ * not be invoked and any decoded pixels are freed, so @owner may be
+ * released as soon as this returns.
+ **/
+void rarch_main_data_image_decode_cancel(void *owner)
+{
+   image_decode_job_t *job;
+   image_decoder_t    *dec = g_image_decoder;
+
+   if (!dec || !owner)
+      return;
+
+   slock_lock(dec->lock);
+   for (job = dec->head; job; job = job->next)
+      if (job->owner == owner)
+         job->cancelled = true;
+   slock_unlock(dec->lock);
+}
+
+/**
+ * rarch_main_data_image_decode_active:
+ *
+ * Returns: true if any request is still queued or undelivered.
+ **/
+bool rarch_main_data_image_decode_active(void)
+{
+   bool active;
+   image_decoder_t *dec = g_image_decoder;
+
+   if (!dec)
+      return false;
+
+   slock_lock(dec->lock);
+   active = dec->head != NULL;
+   slock_unlock(dec->lock);
+
+   return active;
+}
+
+/**
+ * rarch_main_data_image_decode_deinit:
+ *
+ * Stops the decode workers and discards undelivered results.
+ **/
+void rarch_main_data_image_decode_deinit(void)
+{
+   unsigned i;
+   image_decoder_t *dec = g_image_decoder;
+
+   if (!dec)
+      return;
+
+   slock_lock(dec->lock);
+   dec->quit = true;
+   scond_broadcast(dec->cond);
+   slock_unlock(dec->lock);
+
+   for (i = 0; i < dec->num_threads; i++)
+      sthread_join(dec->threads[i]);
+
+   while (dec->head)
+   {
+      image_decode_job_t *next = dec->head->next;
+      image_decode_job_free(dec->head);
+      dec->head = next;
+   }
+
+   slock_free(dec->lock);
+   scond_free(dec->cond);
+   free(dec);
+   g_image_decoder = NULL;
+}
+
+#endif
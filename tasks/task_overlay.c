@@ -90,6 +90,9 @@ void rarch_main_data_overlay_finish()
            && driver->overlay->state != OVERLAY_STATUS_ALIVE
            && driver->overlay->state != OVERLAY_STATUS_NONE )
    {
+#if defined(HAVE_RPNG) && defined(HAVE_THREADS)
+      rarch_main_data_image_decode_iterate(runloop);
+#endif
       rarch_main_data_overlay_image_upload_iterate(runloop);
       rarch_main_data_overlay_iterate(runloop);
    }
@@ -18,6 +18,7 @@
 
 #include <stdint.h>
 #include <boolean.h>
+#include <formats/image.h>
 #include "../runloop_data.h"
 
 #ifdef __cplusplus
@@ -40,6 +41,22 @@ void core_info_queue_download();
 #ifdef HAVE_RPNG
 void rarch_main_data_nbio_image_iterate(void *data);
 void rarch_main_data_nbio_image_upload_iterate(void *data);
+
+#ifdef HAVE_THREADS
+typedef void (*image_decode_cb_t)(struct texture_image *ti,
+      bool success, void *userdata);
+
+bool rarch_main_data_image_decode_push(const char *path, void *owner,
+      image_decode_cb_t cb, void *userdata);
+
+void rarch_main_data_image_decode_iterate(void *data);
+
+void rarch_main_data_image_decode_cancel(void *owner);
+
+bool rarch_main_data_image_decode_active(void);
+
+void rarch_main_data_image_decode_deinit(void);
+#endif
 #endif
 
 #ifdef HAVE_OVERLAY